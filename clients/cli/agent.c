@@ -209,10 +209,10 @@ do_agent_all (NmCli *nmc, int argc, char **argv)
 }
 
 static const NMCCommand agent_cmds[] = {
-	{ "secret",  do_agent_secret,  usage_agent_secret,  TRUE,   TRUE },
-	{ "polkit",  do_agent_polkit,  usage_agent_polkit,  TRUE,   TRUE },
-	{ "all",     do_agent_all,     usage_agent_all,     TRUE,   TRUE },
-	{ NULL,      do_agent_all,     usage,               TRUE,   TRUE },
+	{ "secret",  do_agent_secret,  usage_agent_secret,  TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "polkit",  do_agent_polkit,  usage_agent_polkit,  TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "all",     do_agent_all,     usage_agent_all,     TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ NULL,      do_agent_all,     usage,               TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
 };
 
 NMCResultCode
@@ -1602,7 +1602,7 @@ got_client (GObject *source_object, GAsyncResult *res, gpointer user_data)
 	NmCli *nmc = call->nmc;
 
 	nmc->should_wait--;
-	nmc->client = nm_client_new_finish (res, &error);
+	nmc->client = NM_CLIENT (g_async_initable_new_finish (G_ASYNC_INITABLE (source_object), res, &error));
 
 	if (!nmc->client) {
 		g_simple_async_result_set_error (call->simple, NMCLI_ERROR, NMC_RESULT_ERROR_UNKNOWN,
@@ -1639,7 +1639,14 @@ call_cmd (NmCli *nmc, GSimpleAsyncResult *simple, const NMCCommand *cmd, int arg
 		call->argc = argc;
 		call->argv = argv;
 		call->simple = simple;
-		nm_client_new_async (NULL, got_client, call);
+
+		/* Only instantiate the objects the command is going to look at;
+		 * for scripted one-shot invocations that is the bulk of the
+		 * startup cost on systems with many devices and connections. */
+		g_async_initable_new_async (NM_TYPE_CLIENT, G_PRIORITY_DEFAULT,
+		                            NULL, got_client, call,
+		                            NM_CLIENT_OBJECTS, cmd->client_objects,
+		                            NULL);
 	}
 }
 
@@ -82,6 +82,9 @@ typedef struct {
 	void (*usage) (void);
 	gboolean needs_client;
 	gboolean needs_nm_running;
+	/* objects the command looks at; the NMClient created for the
+	 * command only instantiates these. */
+	NMClientObjects client_objects;
 } NMCCommand;
 
 void nmc_do_cmd (NmCli *nmc, const NMCCommand cmds[], const char *cmd, int argc, char **argv);
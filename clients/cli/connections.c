@@ -893,9 +893,9 @@ fill_output_connection (NMConnection *connection, NmCli *nmc, gboolean active_on
 	NMSettingConnection *s_con;
 	guint64 timestamp;
 	time_t timestamp_real;
-	char *timestamp_str;
-	char *timestamp_real_str = "";
-	char *prio_str;
+	char timestamp_str[30];
+	char timestamp_real_str[64];
+	char prio_str[30];
 	NmcOutputField *arr;
 	NMActiveConnection *ac = NULL;
 	const char *ac_path = NULL;
@@ -920,13 +920,13 @@ fill_output_connection (NMConnection *connection, NmCli *nmc, gboolean active_on
 
 	/* Obtain field values */
 	timestamp = nm_setting_connection_get_timestamp (s_con);
-	timestamp_str = g_strdup_printf ("%" G_GUINT64_FORMAT, timestamp);
+	nm_sprintf_buf (timestamp_str, "%" G_GUINT64_FORMAT, timestamp);
 	if (timestamp) {
 		timestamp_real = timestamp;
-		timestamp_real_str = g_malloc0 (64);
-		strftime (timestamp_real_str, 64, "%c", localtime (&timestamp_real));
+		if (!strftime (timestamp_real_str, sizeof (timestamp_real_str), "%c", localtime (&timestamp_real)))
+			timestamp_real_str[0] = '\0';
 	}
-	prio_str = g_strdup_printf ("%u", nm_setting_connection_get_autoconnect_priority (s_con));
+	nm_sprintf_buf (prio_str, "%u", nm_setting_connection_get_autoconnect_priority (s_con));
 
 	arr = nmc_dup_fields_array (nmc_fields_con_show,
 	                            sizeof (nmc_fields_con_show),
@@ -939,10 +939,13 @@ fill_output_connection (NMConnection *connection, NmCli *nmc, gboolean active_on
 	set_val_strc (arr, 0, nm_setting_connection_get_id (s_con));
 	set_val_strc (arr, 1, nm_setting_connection_get_uuid (s_con));
 	set_val_strc (arr, 2, nm_setting_connection_get_connection_type (s_con));
-	set_val_str  (arr, 3, timestamp_str);
-	set_val_str  (arr, 4, timestamp ? timestamp_real_str : g_strdup (_("never")));
+	set_val_str_tmp (nmc, arr, 3, timestamp_str);
+	if (timestamp)
+		set_val_str_tmp (nmc, arr, 4, timestamp_real_str);
+	else
+		set_val_strc (arr, 4, _("never"));
 	set_val_strc (arr, 5, nm_setting_connection_get_autoconnect (s_con) ? _("yes") : _("no"));
-	set_val_str  (arr, 6, prio_str);
+	set_val_str_tmp (nmc, arr, 6, prio_str);
 	set_val_strc (arr, 7, nm_setting_connection_get_read_only (s_con) ? _("yes") : _("no"));
 	set_val_strc (arr, 8, nm_connection_get_path (connection));
 	set_val_strc (arr, 9, ac ? _("yes") : _("no"));
@@ -951,7 +954,7 @@ fill_output_connection (NMConnection *connection, NmCli *nmc, gboolean active_on
 	set_val_strc (arr, 12, ac_path);
 	set_val_strc (arr, 13, nm_setting_connection_get_slave_type (s_con));
 
-	g_ptr_array_add (nmc->output_data, arr);
+	nmc_output_row (nmc, arr);
 }
 
 static void
@@ -988,7 +991,7 @@ fill_output_connection_for_invisible (NMActiveConnection *ac, NmCli *nmc)
 
 	set_val_color_fmt_all (arr, NMC_TERM_FORMAT_DIM);
 
-	g_ptr_array_add (nmc->output_data, arr);
+	nmc_output_row (nmc, arr);
 }
 
 static void
@@ -1792,7 +1795,7 @@ do_connections_show (NmCli *nmc, int argc, char **argv)
 		nmc->print_fields.header_name = active_only ? _("NetworkManager active profiles") :
 		                                              _("NetworkManager connection profiles");
 		arr = nmc_dup_fields_array (tmpl, tmpl_len, NMC_OF_FLAG_MAIN_HEADER_ADD | NMC_OF_FLAG_FIELD_NAMES);
-		g_ptr_array_add (nmc->output_data, arr);
+		nmc_output_row (nmc, arr);
 
 		/* There might be active connections not present in connection list
 		 * (e.g. private connections of a different user). Show them as well. */
@@ -8802,20 +8805,20 @@ nmcli_con_tab_completion (const char *text, int start, int end)
 }
 
 static const NMCCommand connection_cmds[] = {
-	{ "show",     do_connections_show,      usage_connection_show,     TRUE,   TRUE },
-	{ "up",       do_connection_up,         usage_connection_up,       TRUE,   TRUE },
-	{ "down",     do_connection_down,       usage_connection_down,     TRUE,   TRUE },
-	{ "add",      do_connection_add,        usage_connection_add,      TRUE,   TRUE },
-	{ "edit",     do_connection_edit,       usage_connection_edit,     TRUE,   TRUE },
-	{ "delete",   do_connection_delete,     usage_connection_delete,   TRUE,   TRUE },
-	{ "reload",   do_connection_reload,     usage_connection_reload,   TRUE,   TRUE },
-	{ "load",     do_connection_load,       usage_connection_load,     TRUE,   TRUE },
-	{ "modify",   do_connection_modify,     usage_connection_modify,   TRUE,   TRUE },
-	{ "clone",    do_connection_clone,      usage_connection_clone,    TRUE,   TRUE },
-	{ "import",   do_connection_import,     usage_connection_import,   TRUE,   TRUE },
-	{ "export",   do_connection_export,     usage_connection_export,   TRUE,   TRUE },
-	{ "monitor",  do_connection_monitor,    usage_connection_monitor,  TRUE,   TRUE },
-	{ NULL,       do_connections_show,      usage,                     TRUE,   TRUE },
+	{ "show",     do_connections_show,      usage_connection_show,     TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL & ~NM_CLIENT_OBJECTS_ACCESS_POINTS },
+	{ "up",       do_connection_up,         usage_connection_up,       TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "down",     do_connection_down,       usage_connection_down,     TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "add",      do_connection_add,        usage_connection_add,      TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "edit",     do_connection_edit,       usage_connection_edit,     TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "delete",   do_connection_delete,     usage_connection_delete,   TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "reload",   do_connection_reload,     usage_connection_reload,   TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
+	{ "load",     do_connection_load,       usage_connection_load,     TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
+	{ "modify",   do_connection_modify,     usage_connection_modify,   TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "clone",    do_connection_clone,      usage_connection_clone,    TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "import",   do_connection_import,     usage_connection_import,   TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "export",   do_connection_export,     usage_connection_export,   TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "monitor",  do_connection_monitor,    usage_connection_monitor,  TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ NULL,       do_connections_show,      usage,                     TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL & ~NM_CLIENT_OBJECTS_ACCESS_POINTS },
 };
 
 /* Entry point function for connections-related commands: 'nmcli connection' */
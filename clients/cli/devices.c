@@ -1473,7 +1473,7 @@ fill_output_device_status (NMDevice *device, NmCli *nmc)
 	set_val_strc (arr, 5, ac ? nm_active_connection_get_uuid (ac) : NULL);
 	set_val_strc (arr, 6, ac ? nm_object_get_path (NM_OBJECT (ac)) : NULL);
 
-	g_ptr_array_add (nmc->output_data, arr);
+	nmc_output_row (nmc, arr);
 }
 
 static NMCResultCode
@@ -1524,7 +1524,7 @@ do_devices_status (NmCli *nmc, int argc, char **argv)
 	/* Add headers */
 	nmc->print_fields.header_name = _("Status of devices");
 	arr = nmc_dup_fields_array (tmpl, tmpl_len, NMC_OF_FLAG_MAIN_HEADER_ADD | NMC_OF_FLAG_FIELD_NAMES);
-	g_ptr_array_add (nmc->output_data, arr);
+	nmc_output_row (nmc, arr);
 
 	devices = nmc_get_devices_sorted (nmc->client);
 	for (i = 0; devices[i]; i++)
@@ -3607,11 +3607,11 @@ finish:
 }
 
 static NMCCommand device_wifi_cmds[] = {
-	{ "list",     do_device_wifi_list,            NULL,             TRUE,   TRUE },
-	{ "connect",  do_device_wifi_connect_network, NULL,             TRUE,   TRUE },
-	{ "hotspot",  do_device_wifi_hotspot,         NULL,             TRUE,   TRUE },
-	{ "rescan",   do_device_wifi_rescan,          NULL,             TRUE,   TRUE },
-	{ NULL,       do_device_wifi_list,            NULL,             TRUE,   TRUE },
+	{ "list",     do_device_wifi_list,            NULL,             TRUE,   TRUE,   NM_CLIENT_OBJECTS_DEVICES | NM_CLIENT_OBJECTS_ACCESS_POINTS },
+	{ "connect",  do_device_wifi_connect_network, NULL,             TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "hotspot",  do_device_wifi_hotspot,         NULL,             TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "rescan",   do_device_wifi_rescan,          NULL,             TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ NULL,       do_device_wifi_list,            NULL,             TRUE,   TRUE,   NM_CLIENT_OBJECTS_DEVICES | NM_CLIENT_OBJECTS_ACCESS_POINTS },
 };
 
 static NMCResultCode
@@ -3782,8 +3782,8 @@ do_device_lldp_list (NmCli *nmc, int argc, char **argv)
 }
 
 static NMCCommand device_lldp_cmds[] = {
-	{ "list",  do_device_lldp_list,  NULL,             TRUE,   TRUE },
-	{ NULL,    do_device_lldp_list,  NULL,             TRUE,   TRUE },
+	{ "list",  do_device_lldp_list,  NULL,             TRUE,   TRUE,   NM_CLIENT_OBJECTS_DEVICES },
+	{ NULL,    do_device_lldp_list,  NULL,             TRUE,   TRUE,   NM_CLIENT_OBJECTS_DEVICES },
 };
 
 static NMCResultCode
@@ -3848,18 +3848,18 @@ nmcli_device_tab_completion (const char *text, int start, int end)
 }
 
 static const NMCCommand device_cmds[] = {
-	{ "status",      do_devices_status,      usage_device_status,      TRUE,   TRUE },
-	{ "show",        do_device_show,         usage_device_show,        TRUE,   TRUE },
-	{ "connect",     do_device_connect,      usage_device_connect,     TRUE,   TRUE },
-	{ "reapply",     do_device_reapply,      usage_device_reapply,     TRUE,   TRUE },
-	{ "disconnect",  do_devices_disconnect,  usage_device_disconnect,  TRUE,   TRUE },
-	{ "delete",      do_devices_delete,      usage_device_delete,      TRUE,   TRUE },
-	{ "set",         do_device_set,          usage_device_set,         TRUE,   TRUE },
-	{ "monitor",     do_devices_monitor,     usage_device_monitor,     TRUE,   TRUE },
-	{ "wifi",        do_device_wifi,         usage_device_wifi,        FALSE,  FALSE },
-	{ "lldp",        do_device_lldp,         usage_device_lldp,        FALSE,  FALSE },
-	{ "modify",      do_device_modify,       usage_device_modify,      TRUE,   TRUE },
-	{ NULL,          do_devices_status,      usage,                    TRUE,   TRUE },
+	{ "status",      do_devices_status,      usage_device_status,      TRUE,   TRUE,   NM_CLIENT_OBJECTS_DEVICES | NM_CLIENT_OBJECTS_ACTIVE_CONNECTIONS },
+	{ "show",        do_device_show,         usage_device_show,        TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "connect",     do_device_connect,      usage_device_connect,     TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "reapply",     do_device_reapply,      usage_device_reapply,     TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "disconnect",  do_devices_disconnect,  usage_device_disconnect,  TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "delete",      do_devices_delete,      usage_device_delete,      TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "set",         do_device_set,          usage_device_set,         TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "monitor",     do_devices_monitor,     usage_device_monitor,     TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ "wifi",        do_device_wifi,         usage_device_wifi,        FALSE,  FALSE,  NM_CLIENT_OBJECTS_ALL },
+	{ "lldp",        do_device_lldp,         usage_device_lldp,        FALSE,  FALSE,  NM_CLIENT_OBJECTS_ALL },
+	{ "modify",      do_device_modify,       usage_device_modify,      TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
+	{ NULL,          do_devices_status,      usage,                    TRUE,   TRUE,   NM_CLIENT_OBJECTS_DEVICES | NM_CLIENT_OBJECTS_ACTIVE_CONNECTIONS },
 };
 
 NMCResultCode
@@ -722,11 +722,11 @@ do_general_hostname (NmCli *nmc, int argc, char **argv)
 }
 
 static const NMCCommand general_cmds[] = {
-	{ "status",       do_general_status,       usage_general_status,       TRUE,   TRUE },
-	{ "hostname",     do_general_hostname,     usage_general_hostname,     TRUE,   TRUE },
-	{ "permissions",  do_general_permissions,  usage_general_permissions,  TRUE,   TRUE },
-	{ "logging",      do_general_logging,      usage_general_logging,      TRUE,   TRUE },
-	{ NULL,           do_general_status,       usage_general,              TRUE,   TRUE },
+	{ "status",       do_general_status,       usage_general_status,       TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
+	{ "hostname",     do_general_hostname,     usage_general_hostname,     TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
+	{ "permissions",  do_general_permissions,  usage_general_permissions,  TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
+	{ "logging",      do_general_logging,      usage_general_logging,      TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
+	{ NULL,           do_general_status,       usage_general,              TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
 };
 
 /*
@@ -854,10 +854,10 @@ do_networking_show (NmCli *nmc, int argc, char **argv)
 }
 
 static const NMCCommand networking_cmds[] = {
-	{ "on",           do_networking_on,           usage_networking_on,           TRUE,   TRUE },
-	{ "off",          do_networking_off,          usage_networking_off,          TRUE,   TRUE },
-	{ "connectivity", do_networking_connectivity, usage_networking_connectivity, TRUE,   TRUE },
-	{ NULL,           do_networking_show,         usage_networking,              TRUE,   TRUE },
+	{ "on",           do_networking_on,           usage_networking_on,           TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
+	{ "off",          do_networking_off,          usage_networking_off,          TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
+	{ "connectivity", do_networking_connectivity, usage_networking_connectivity, TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
+	{ NULL,           do_networking_show,         usage_networking,              TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
 };
 
 /*
@@ -958,10 +958,10 @@ do_radio_wwan (NmCli *nmc, int argc, char **argv)
 }
 
 static const NMCCommand radio_cmds[] = {
-	{ "all",   do_radio_all,   usage_radio_all,   TRUE,   TRUE },
-	{ "wifi",  do_radio_wifi,  usage_radio_wifi,  TRUE,   TRUE },
-	{ "wwan",  do_radio_wwan,  usage_radio_wwan,  TRUE,   TRUE },
-	{ NULL,    do_radio_all,   usage_radio,       TRUE,   TRUE },
+	{ "all",   do_radio_all,   usage_radio_all,   TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
+	{ "wifi",  do_radio_wifi,  usage_radio_wifi,  TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
+	{ "wwan",  do_radio_wwan,  usage_radio_wwan,  TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
+	{ NULL,    do_radio_all,   usage_radio,       TRUE,   TRUE,   NM_CLIENT_OBJECTS_NONE },
 };
 
 /*
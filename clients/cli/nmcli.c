@@ -183,7 +183,7 @@ usage (void)
 	              "OPTIONS\n"
 	              "  -t[erse]                                   terse output\n"
 	              "  -p[retty]                                  pretty output\n"
-	              "  -m[ode] tabular|multiline                  output mode\n"
+	              "  -m[ode] tabular|multiline|json             output mode\n"
 	              "  -c[olors] auto|yes|no                      whether to use colors in output\n"
 	              "  -f[ields] <field1,field2,...>|all|common   specify fields to output\n"
 	              "  -e[scape] yes|no                           escape columns separators in values\n"
@@ -205,14 +205,14 @@ usage (void)
 }
 
 static const NMCCommand nmcli_cmds[] = {
-	{ "general",     do_general,      NULL,   FALSE,  FALSE },
-	{ "monitor",     do_monitor,      NULL,   TRUE,   FALSE },
-	{ "networking",  do_networking,   NULL,   FALSE,  FALSE },
-	{ "radio",       do_radio,        NULL,   FALSE,  FALSE },
-	{ "connection",  do_connections,  NULL,   FALSE,  FALSE },
-	{ "device",      do_devices,      NULL,   FALSE,  FALSE },
-	{ "agent",       do_agent,        NULL,   FALSE,  FALSE },
-	{ NULL,          do_overview,     usage,  TRUE,   TRUE },
+	{ "general",     do_general,      NULL,   FALSE,  FALSE,  NM_CLIENT_OBJECTS_ALL },
+	{ "monitor",     do_monitor,      NULL,   TRUE,   FALSE,  NM_CLIENT_OBJECTS_ALL },
+	{ "networking",  do_networking,   NULL,   FALSE,  FALSE,  NM_CLIENT_OBJECTS_ALL },
+	{ "radio",       do_radio,        NULL,   FALSE,  FALSE,  NM_CLIENT_OBJECTS_ALL },
+	{ "connection",  do_connections,  NULL,   FALSE,  FALSE,  NM_CLIENT_OBJECTS_ALL },
+	{ "device",      do_devices,      NULL,   FALSE,  FALSE,  NM_CLIENT_OBJECTS_ALL },
+	{ "agent",       do_agent,        NULL,   FALSE,  FALSE,  NM_CLIENT_OBJECTS_ALL },
+	{ NULL,          do_overview,     usage,  TRUE,   TRUE,   NM_CLIENT_OBJECTS_ALL },
 };
 
 static gboolean
@@ -287,12 +287,17 @@ process_command_line (NmCli *nmc, int argc, char **argv)
 				return FALSE;
 			}
 			if (argc == 1 && nmc->complete)
-				nmc_complete_strings (argv[0], "tabular", "multiline", NULL);
-			if (matches (argv[0], "tabular") == 0)
+				nmc_complete_strings (argv[0], "tabular", "multiline", "json", NULL);
+			if (matches (argv[0], "tabular") == 0) {
 				nmc->multiline_output = FALSE;
-			else if (matches (argv[0], "multiline") == 0)
+				nmc->json_output = FALSE;
+			} else if (matches (argv[0], "multiline") == 0) {
 				nmc->multiline_output = TRUE;
-			else {
+				nmc->json_output = FALSE;
+			} else if (matches (argv[0], "json") == 0) {
+				nmc->multiline_output = FALSE;
+				nmc->json_output = TRUE;
+			} else {
 				g_string_printf (nmc->return_text, _("Error: '%s' is not valid argument for '%s' option."), argv[0], opt);
 				nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
 				return FALSE;
@@ -533,6 +538,7 @@ nmc_init (NmCli *nmc)
 	nmc->nowait_flag = TRUE;
 	nmc->print_output = NMC_PRINT_NORMAL;
 	nmc->multiline_output = FALSE;
+	nmc->json_output = FALSE;
 	nmc->mode_specified = FALSE;
 	nmc->escape_values = TRUE;
 	nmc->required_fields = NULL;
@@ -146,6 +146,7 @@ typedef struct _NmCli {
 	gboolean nowait_flag;                             /* '--nowait' option; used for passing to callbacks */
 	NMCPrintOutput print_output;                      /* Output mode */
 	gboolean multiline_output;                        /* Multiline output instead of default tabular */
+	gboolean json_output;                             /* One JSON object per line instead of tabular output */
 	gboolean mode_specified;                          /* Whether tabular/multiline mode was specified via '--mode' option */
 	NmcColorOption use_colors;                        /* Whether to use colors for output: option '--color' */
 	gboolean escape_values;                           /* Whether to escape ':' and '\' in terse tabular mode */
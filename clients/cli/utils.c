@@ -755,6 +755,20 @@ set_val_arrc (NmcOutputField fields_array[], guint32 idx, const char **value)
 	fields_array[idx].free_value = FALSE;
 }
 
+/*
+ * Set a value that only needs to stay valid until the row is passed to
+ * nmc_output_row(). Rows that are printed right away use it as is, rows
+ * that are kept for later get a copy.
+ */
+void
+set_val_str_tmp (NmCli *nmc, NmcOutputField fields_array[], guint32 idx, const char *value)
+{
+	if (nmc_output_streamed (nmc))
+		set_val_strc (fields_array, idx, value);
+	else
+		set_val_str (fields_array, idx, g_strdup (value));
+}
+
 void
 set_val_color_all (NmcOutputField fields_array[], NmcTermColor color)
 {
@@ -971,6 +985,33 @@ nmc_dup_fields_array (NmcOutputField fields[], size_t size, guint32 flags)
 	return row;
 }
 
+/*
+ * Whether rows can be printed as soon as they are produced. Terse and JSON
+ * output don't align columns, so they don't need to see all rows first.
+ */
+gboolean
+nmc_output_streamed (NmCli *nmc)
+{
+	return    !nmc->multiline_output
+	       && (nmc->json_output || nmc->print_output == NMC_PRINT_TERSE);
+}
+
+/*
+ * Output a row of fields allocated with nmc_dup_fields_array(). When the
+ * output is streamed, the row is printed and freed right away, otherwise
+ * it is added to nmc->output_data for print_data().
+ */
+void
+nmc_output_row (NmCli *nmc, NmcOutputField *row)
+{
+	if (nmc_output_streamed (nmc)) {
+		print_required_fields (nmc, row);
+		nmc_free_output_field_values (row);
+		g_free (row);
+	} else
+		g_ptr_array_add (nmc->output_data, row);
+}
+
 void
 nmc_empty_output_fields (NmCli *nmc)
 {
@@ -1044,6 +1085,93 @@ get_value_to_print (NmCli *nmc,
 	return out;
 }
 
+static GString *
+_output_row_buffer (void)
+{
+	static GString *buf = NULL;
+
+	/* Reused for every row, so that printing many rows doesn't allocate */
+	if (!buf)
+		buf = g_string_sized_new (256);
+	else
+		g_string_truncate (buf, 0);
+	return buf;
+}
+
+static void
+_json_append_string (GString *str, const char *value)
+{
+	const char *p;
+
+	g_string_append_c (str, '"');
+	for (p = value; *p; p++) {
+		switch (*p) {
+		case '"':
+			g_string_append (str, "\\\"");
+			break;
+		case '\\':
+			g_string_append (str, "\\\\");
+			break;
+		case '\n':
+			g_string_append (str, "\\n");
+			break;
+		case '\r':
+			g_string_append (str, "\\r");
+			break;
+		case '\t':
+			g_string_append (str, "\\t");
+			break;
+		default:
+			if ((guchar) *p < 0x20)
+				g_string_append_printf (str, "\\u%04x", (guint) (guchar) *p);
+			else
+				g_string_append_c (str, *p);
+			break;
+		}
+	}
+	g_string_append_c (str, '"');
+}
+
+/*
+ * Print the values of 'field_values' as one JSON object on a single line.
+ */
+static void
+print_required_fields_json (NmCli *nmc, const NmcOutputField field_values[])
+{
+	const NmcPrintFields fields = nmc->print_fields;
+	GString *str = _output_row_buffer ();
+	int i;
+
+	g_string_append_c (str, '{');
+	for (i = 0; i < fields.indices->len; i++) {
+		int idx = g_array_index (fields.indices, int, i);
+		const NmcOutputField *field = &field_values[idx];
+
+		if (i > 0)
+			g_string_append_c (str, ',');
+		_json_append_string (str, field->name);
+		g_string_append_c (str, ':');
+
+		if (!field->value)
+			g_string_append (str, "null");
+		else if (field->value_is_array) {
+			const char **p;
+
+			g_string_append_c (str, '[');
+			for (p = (const char **) field->value; *p; p++) {
+				if (p != (const char **) field->value)
+					g_string_append_c (str, ',');
+				_json_append_string (str, *p);
+			}
+			g_string_append_c (str, ']');
+		} else
+			_json_append_string (str, (const char *) field->value);
+	}
+	g_string_append_c (str, '}');
+
+	g_print ("%s\n", str->str);
+}
+
 /*
  * Print both headers or values of 'field_values' array.
  * Entries to print and their order are specified via indices in
@@ -1162,8 +1290,15 @@ print_required_fields (NmCli *nmc, const NmcOutputField field_values[])
 		return;
 	}
 
+	/* --- JSON mode: each line = one object, without headers --- */
+	if (nmc->json_output) {
+		if (!main_header_only && !field_names)
+			print_required_fields_json (nmc, field_values);
+		return;
+	}
+
 	/* --- Tabular mode: each line = one object --- */
-	str = g_string_new (NULL);
+	str = _output_row_buffer ();
 
 	for (i = 0; i < fields.indices->len; i++) {
 		int idx = g_array_index (fields.indices, int, i);
@@ -1229,8 +1364,6 @@ print_required_fields (NmCli *nmc, const NmcOutputField field_values[])
 			g_free (line);
 		}
 	}
-
-	g_string_free (str, TRUE);
 }
 
 /*
@@ -1252,6 +1385,10 @@ print_data (NmCli *nmc)
 	if (!nmc->output_data || nmc->output_data->len < 1)
 		return;
 
+	/* Column widths are not used for terse and JSON output */
+	if (nmc_output_streamed (nmc))
+		goto print;
+
 	/* How many fields? */
 	row = g_ptr_array_index (nmc->output_data, 0);
 	while (row->name) {
@@ -1279,6 +1416,7 @@ print_data (NmCli *nmc)
 		}
 	}
 
+print:
 	/* Now we can print the data. */
 	for (i = 0; i < nmc->output_data->len; i++) {
 		row = g_ptr_array_index (nmc->output_data, i);
@@ -86,6 +86,7 @@ char **nmc_strsplit_set (const char *str, const char *delimiter, int max_tokens)
 int nmc_string_screen_width (const char *start, const char *end);
 void set_val_str  (NmcOutputField fields_array[], guint32 index, char *value);
 void set_val_strc (NmcOutputField fields_array[], guint32 index, const char *value);
+void set_val_str_tmp (NmCli *nmc, NmcOutputField fields_array[], guint32 index, const char *value);
 void set_val_arr  (NmcOutputField fields_array[], guint32 index, char **value);
 void set_val_arrc (NmcOutputField fields_array[], guint32 index, const char **value);
 void set_val_color_all (NmcOutputField fields_array[], NmcTermColor color);
@@ -99,6 +100,8 @@ GArray *parse_output_fields (const char *fields_str,
 char *nmc_get_allowed_fields (const NmcOutputField fields_array[], int group_idx);
 gboolean nmc_terse_option_check (NMCPrintOutput print_output, const char *fields, GError **error);
 NmcOutputField *nmc_dup_fields_array (NmcOutputField fields[], size_t size, guint32 flags);
+gboolean nmc_output_streamed (NmCli *nmc);
+void nmc_output_row (NmCli *nmc, NmcOutputField *row);
 void nmc_empty_output_fields (NmCli *nmc);
 void print_required_fields (NmCli *nmc, const NmcOutputField field_values[]);
 void print_data (NmCli *nmc);
@@ -27,6 +27,7 @@
 #include <strings.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 
 #include "crypto.h"
 #include "nm-errors.h"
@@ -319,6 +320,150 @@ file_to_g_byte_array (const char *filename, GError **error)
 	return array;
 }
 
+/*****************************************************************************/
+
+/* A process-wide cache of what was learned from parsing certificate and
+ * key files. Entries are keyed by path and only valid as long as the file's
+ * device, inode, size, mtime and ctime are unchanged, so a replaced, modified
+ * or chmod'ed file is parsed again. Only the results and, for X509
+ * certificates, the file content are kept; private key material is never
+ * cached. Results that depend on a password are not cached either. */
+
+#define FILE_CACHE_MAX 4096
+
+typedef struct {
+	dev_t dev;
+	ino_t ino;
+	gint64 size;
+	gint64 mtime_ns;
+	gint64 ctime_ns;
+} FileCacheId;
+
+typedef struct {
+	FileCacheId id;
+
+	GBytes *cert_data;
+	GError *cert_error;
+	NMCryptoFileFormat cert_format;
+
+	GError *pkcs12_error;
+
+	GError *key_error;
+	NMCryptoFileFormat key_format;
+
+	bool has_cert:1;
+	bool has_pkcs12:1;
+	bool is_pkcs12:1;
+	bool has_key:1;
+	bool key_is_encrypted:1;
+} FileCacheEntry;
+
+G_LOCK_DEFINE_STATIC (file_cache);
+static GHashTable *file_cache;
+
+static void
+_file_cache_entry_clear (FileCacheEntry *entry)
+{
+	g_clear_pointer (&entry->cert_data, g_bytes_unref);
+	g_clear_error (&entry->cert_error);
+	g_clear_error (&entry->pkcs12_error);
+	g_clear_error (&entry->key_error);
+	memset (entry, 0, sizeof (*entry));
+}
+
+static void
+_file_cache_entry_free (gpointer data)
+{
+	FileCacheEntry *entry = data;
+
+	_file_cache_entry_clear (entry);
+	g_slice_free (FileCacheEntry, entry);
+}
+
+static gboolean
+_file_cache_id_get (const char *file, FileCacheId *id)
+{
+	struct stat st;
+
+	if (stat (file, &st) != 0)
+		return FALSE;
+
+	memset (id, 0, sizeof (*id));
+	id->dev = st.st_dev;
+	id->ino = st.st_ino;
+	id->size = st.st_size;
+	id->mtime_ns = (gint64) st.st_mtim.tv_sec * G_GINT64_CONSTANT (1000000000) + st.st_mtim.tv_nsec;
+	id->ctime_ns = (gint64) st.st_ctim.tv_sec * G_GINT64_CONSTANT (1000000000) + st.st_ctim.tv_nsec;
+	return TRUE;
+}
+
+/* Returns the entry for @file if it still matches @id. Must be called
+ * with the lock held. */
+static FileCacheEntry *
+_file_cache_lookup_locked (const char *file, const FileCacheId *id)
+{
+	FileCacheEntry *entry;
+
+	if (!file_cache)
+		return NULL;
+
+	entry = g_hash_table_lookup (file_cache, file);
+	if (!entry || memcmp (&entry->id, id, sizeof (*id)) != 0)
+		return NULL;
+	return entry;
+}
+
+/* Returns the entry for @file to store a result, discarding the previous
+ * results if the file changed. Must be called with the lock held. */
+static FileCacheEntry *
+_file_cache_ensure_locked (const char *file, const FileCacheId *id)
+{
+	FileCacheEntry *entry;
+
+	if (!file_cache)
+		file_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, _file_cache_entry_free);
+
+	entry = g_hash_table_lookup (file_cache, file);
+	if (entry) {
+		if (memcmp (&entry->id, id, sizeof (*id)) != 0) {
+			_file_cache_entry_clear (entry);
+			entry->id = *id;
+		}
+		return entry;
+	}
+
+	if (g_hash_table_size (file_cache) >= FILE_CACHE_MAX)
+		g_hash_table_remove_all (file_cache);
+
+	entry = g_slice_new0 (FileCacheEntry);
+	entry->id = *id;
+	g_hash_table_insert (file_cache, g_strdup (file), entry);
+	return entry;
+}
+
+static void
+_file_cache_propagate_error (GError **error, const GError *cached_error)
+{
+	if (cached_error)
+		g_propagate_error (error, g_error_copy (cached_error));
+}
+
+/**
+ * crypto_file_cache_clear:
+ *
+ * Drops all results cached by crypto_load_and_verify_certificate(),
+ * crypto_is_pkcs12_file() and crypto_verify_private_key().
+ */
+void
+crypto_file_cache_clear (void)
+{
+	G_LOCK (file_cache);
+	g_clear_pointer (&file_cache, g_hash_table_unref);
+	G_UNLOCK (file_cache);
+}
+
+/*****************************************************************************/
+
 /*
  * Convert a hex string into bytes.
  */
@@ -587,20 +732,13 @@ done:
 	return cert;
 }
 
-GByteArray *
-crypto_load_and_verify_certificate (const char *file,
-                                    NMCryptoFileFormat *out_file_format,
-                                    GError **error)
+static GByteArray *
+_load_and_verify_certificate (const char *file,
+                              NMCryptoFileFormat *out_file_format,
+                              GError **error)
 {
 	GByteArray *array, *contents;
 
-	g_return_val_if_fail (file != NULL, NULL);
-	g_return_val_if_fail (out_file_format != NULL, NULL);
-	g_return_val_if_fail (*out_file_format == NM_CRYPTO_FILE_FORMAT_UNKNOWN, NULL);
-
-	if (!crypto_init (error))
-		return NULL;
-
 	contents = file_to_g_byte_array (file, error);
 	if (!contents)
 		return NULL;
@@ -633,6 +771,80 @@ crypto_load_and_verify_certificate (const char *file,
 	return contents;
 }
 
+GByteArray *
+crypto_load_and_verify_certificate (const char *file,
+                                    NMCryptoFileFlags flags,
+                                    NMCryptoFileFormat *out_file_format,
+                                    GError **error)
+{
+	GByteArray *contents;
+	GError *local = NULL;
+	FileCacheEntry *entry;
+	FileCacheId id;
+	gboolean has_id;
+
+	g_return_val_if_fail (file != NULL, NULL);
+	g_return_val_if_fail (out_file_format != NULL, NULL);
+	g_return_val_if_fail (*out_file_format == NM_CRYPTO_FILE_FORMAT_UNKNOWN, NULL);
+
+	if (!crypto_init (error))
+		return NULL;
+
+	has_id = _file_cache_id_get (file, &id);
+
+	if (has_id && !NM_FLAGS_HAS (flags, NM_CRYPTO_FILE_FLAGS_NO_CACHE)) {
+		gs_unref_bytes GBytes *cert_data = NULL;
+		gboolean hit = FALSE;
+
+		G_LOCK (file_cache);
+		entry = _file_cache_lookup_locked (file, &id);
+		if (entry && entry->has_cert) {
+			hit = TRUE;
+			*out_file_format = entry->cert_format;
+			cert_data = entry->cert_data ? g_bytes_ref (entry->cert_data) : NULL;
+			_file_cache_propagate_error (error, entry->cert_error);
+		}
+		G_UNLOCK (file_cache);
+
+		if (hit) {
+			if (*out_file_format == NM_CRYPTO_FILE_FORMAT_X509) {
+				contents = g_byte_array_sized_new (g_bytes_get_size (cert_data));
+				g_byte_array_append (contents,
+				                     g_bytes_get_data (cert_data, NULL),
+				                     g_bytes_get_size (cert_data));
+				return contents;
+			}
+			if (*out_file_format == NM_CRYPTO_FILE_FORMAT_PKCS12) {
+				/* PKCS#12 files contain the private key, their content is
+				 * not cached. */
+				return file_to_g_byte_array (file, error);
+			}
+			return NULL;
+		}
+	}
+
+	contents = _load_and_verify_certificate (file, out_file_format, &local);
+
+	if (   has_id
+	    && !(local && local->domain == G_FILE_ERROR)) {
+		G_LOCK (file_cache);
+		entry = _file_cache_ensure_locked (file, &id);
+		g_clear_pointer (&entry->cert_data, g_bytes_unref);
+		g_clear_error (&entry->cert_error);
+		entry->has_cert = TRUE;
+		entry->cert_format = *out_file_format;
+		if (contents && *out_file_format == NM_CRYPTO_FILE_FORMAT_X509)
+			entry->cert_data = g_bytes_new (contents->data, contents->len);
+		if (local)
+			entry->cert_error = g_error_copy (local);
+		G_UNLOCK (file_cache);
+	}
+
+	if (local)
+		g_propagate_error (error, local);
+	return contents;
+}
+
 gboolean
 crypto_is_pkcs12_data (const guint8 *data,
                        gsize data_len,
@@ -664,21 +876,59 @@ crypto_is_pkcs12_data (const guint8 *data,
 }
 
 gboolean
-crypto_is_pkcs12_file (const char *file, GError **error)
+crypto_is_pkcs12_file (const char *file, NMCryptoFileFlags flags, GError **error)
 {
 	GByteArray *contents;
 	gboolean success = FALSE;
+	GError *local = NULL;
+	FileCacheEntry *entry;
+	FileCacheId id;
+	gboolean has_id;
 
 	g_return_val_if_fail (file != NULL, FALSE);
 
 	if (!crypto_init (error))
 		return FALSE;
 
+	has_id = _file_cache_id_get (file, &id);
+
+	if (has_id && !NM_FLAGS_HAS (flags, NM_CRYPTO_FILE_FLAGS_NO_CACHE)) {
+		gboolean hit = FALSE;
+
+		G_LOCK (file_cache);
+		entry = _file_cache_lookup_locked (file, &id);
+		if (entry && entry->has_pkcs12) {
+			hit = TRUE;
+			success = entry->is_pkcs12;
+			_file_cache_propagate_error (error, entry->pkcs12_error);
+		}
+		G_UNLOCK (file_cache);
+
+		if (hit)
+			return success;
+	}
+
 	contents = file_to_g_byte_array (file, error);
-	if (contents) {
-		success = crypto_is_pkcs12_data (contents->data, contents->len, error);
-		g_byte_array_free (contents, TRUE);
+	if (!contents)
+		return FALSE;
+
+	success = crypto_is_pkcs12_data (contents->data, contents->len, &local);
+	memset (contents->data, 0, contents->len);
+	g_byte_array_free (contents, TRUE);
+
+	if (has_id) {
+		G_LOCK (file_cache);
+		entry = _file_cache_ensure_locked (file, &id);
+		g_clear_error (&entry->pkcs12_error);
+		entry->has_pkcs12 = TRUE;
+		entry->is_pkcs12 = success;
+		if (local)
+			entry->pkcs12_error = g_error_copy (local);
+		G_UNLOCK (file_cache);
 	}
+
+	if (local)
+		g_propagate_error (error, local);
 	return success;
 }
 
@@ -742,23 +992,72 @@ crypto_verify_private_key_data (const guint8 *data,
 
 NMCryptoFileFormat
 crypto_verify_private_key (const char *filename,
+                           NMCryptoFileFlags flags,
                            const char *password,
                            gboolean *out_is_encrypted,
                            GError **error)
 {
 	GByteArray *contents;
 	NMCryptoFileFormat format = NM_CRYPTO_FILE_FORMAT_UNKNOWN;
+	gboolean is_encrypted = FALSE;
+	GError *local = NULL;
+	FileCacheEntry *entry;
+	FileCacheId id;
+	gboolean has_id;
 
 	g_return_val_if_fail (filename != NULL, NM_CRYPTO_FILE_FORMAT_UNKNOWN);
+	g_return_val_if_fail (out_is_encrypted == NULL || *out_is_encrypted == FALSE, NM_CRYPTO_FILE_FORMAT_UNKNOWN);
 
 	if (!crypto_init (error))
 		return NM_CRYPTO_FILE_FORMAT_UNKNOWN;
 
+	/* whether the password decrypts the key is never cached. */
+	has_id = !password && _file_cache_id_get (filename, &id);
+
+	if (has_id && !NM_FLAGS_HAS (flags, NM_CRYPTO_FILE_FLAGS_NO_CACHE)) {
+		gboolean hit = FALSE;
+
+		G_LOCK (file_cache);
+		entry = _file_cache_lookup_locked (filename, &id);
+		if (entry && entry->has_key) {
+			hit = TRUE;
+			format = entry->key_format;
+			is_encrypted = entry->key_is_encrypted;
+			_file_cache_propagate_error (error, entry->key_error);
+		}
+		G_UNLOCK (file_cache);
+
+		if (hit) {
+			if (out_is_encrypted)
+				*out_is_encrypted = is_encrypted;
+			return format;
+		}
+	}
+
 	contents = file_to_g_byte_array (filename, error);
-	if (contents) {
-		format = crypto_verify_private_key_data (contents->data, contents->len, password, out_is_encrypted, error);
-		g_byte_array_free (contents, TRUE);
+	if (!contents)
+		return NM_CRYPTO_FILE_FORMAT_UNKNOWN;
+
+	format = crypto_verify_private_key_data (contents->data, contents->len, password, &is_encrypted, &local);
+	memset (contents->data, 0, contents->len);
+	g_byte_array_free (contents, TRUE);
+
+	if (has_id) {
+		G_LOCK (file_cache);
+		entry = _file_cache_ensure_locked (filename, &id);
+		g_clear_error (&entry->key_error);
+		entry->has_key = TRUE;
+		entry->key_format = format;
+		entry->key_is_encrypted = is_encrypted;
+		if (local)
+			entry->key_error = g_error_copy (local);
+		G_UNLOCK (file_cache);
 	}
+
+	if (local)
+		g_propagate_error (error, local);
+	if (out_is_encrypted)
+		*out_is_encrypted = is_encrypted;
 	return format;
 }
 
@@ -42,6 +42,14 @@ typedef enum {
 	NM_CRYPTO_FILE_FORMAT_PKCS12
 } NMCryptoFileFormat;
 
+typedef enum {
+	NM_CRYPTO_FILE_FLAGS_NONE     = 0,
+
+	/* Parse the file again instead of using a cached result. The
+	 * new result still replaces the cached one. */
+	NM_CRYPTO_FILE_FLAGS_NO_CACHE = (1LL << 0),
+} NMCryptoFileFlags;
+
 gboolean crypto_init (GError **error);
 
 GByteArray *crypto_decrypt_openssl_private_key_data (const guint8 *data,
@@ -56,10 +64,11 @@ GByteArray *crypto_decrypt_openssl_private_key (const char *file,
                                                 GError **error);
 
 GByteArray *crypto_load_and_verify_certificate (const char *file,
+                                                NMCryptoFileFlags flags,
                                                 NMCryptoFileFormat *out_file_format,
                                                 GError **error);
 
-gboolean crypto_is_pkcs12_file (const char *file, GError **error);
+gboolean crypto_is_pkcs12_file (const char *file, NMCryptoFileFlags flags, GError **error);
 
 gboolean crypto_is_pkcs12_data (const guint8 *data, gsize len, GError **error);
 
@@ -70,10 +79,13 @@ NMCryptoFileFormat crypto_verify_private_key_data (const guint8 *data,
                                                    GError **error);
 
 NMCryptoFileFormat crypto_verify_private_key (const char *file,
+                                              NMCryptoFileFlags flags,
                                               const char *password,
                                               gboolean *out_is_encrypted,
                                               GError **error);
 
+void crypto_file_cache_clear (void);
+
 /* Internal utils API bits for crypto providers */
 
 void crypto_md5_hash (const char *salt,
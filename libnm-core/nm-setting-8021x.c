@@ -498,7 +498,7 @@ load_and_verify_certificate (const char *cert_path,
 	NMCryptoFileFormat format = NM_CRYPTO_FILE_FORMAT_UNKNOWN;
 	GByteArray *array;
 
-	array = crypto_load_and_verify_certificate (cert_path, &format, error);
+	array = crypto_load_and_verify_certificate (cert_path, NM_CRYPTO_FILE_FLAGS_NONE, &format, error);
 
 	if (!array || !array->len || format == NM_CRYPTO_FILE_FORMAT_UNKNOWN) {
 		/* the array is empty or the format is already unknown. */
@@ -1887,7 +1887,7 @@ nm_setting_802_1x_set_private_key (NMSetting8021x *setting,
 	 * given, that it decrypts the private key.
 	 */
 	if (key_path) {
-		format = crypto_verify_private_key (key_path, password, NULL, &local_err);
+		format = crypto_verify_private_key (key_path, NM_CRYPTO_FILE_FLAGS_NONE, password, NULL, &local_err);
 		if (format == NM_CRYPTO_FILE_FORMAT_UNKNOWN) {
 			g_set_error_literal (error,
 			                     NM_CONNECTION_ERROR,
@@ -2013,7 +2013,7 @@ nm_setting_802_1x_get_private_key_format (NMSetting8021x *setting)
 		return NM_SETTING_802_1X_CK_FORMAT_RAW_KEY;
 	case NM_SETTING_802_1X_CK_SCHEME_PATH:
 		path = nm_setting_802_1x_get_private_key_path (setting);
-		if (crypto_is_pkcs12_file (path, &error))
+		if (crypto_is_pkcs12_file (path, NM_CRYPTO_FILE_FLAGS_NONE, &error))
 			return NM_SETTING_802_1X_CK_FORMAT_PKCS12;
 		if (error && error->domain == G_FILE_ERROR) {
 			g_error_free (error);
@@ -2199,7 +2199,7 @@ nm_setting_802_1x_set_phase2_private_key (NMSetting8021x *setting,
 	 * given, that it decrypts the private key.
 	 */
 	if (key_path) {
-		format = crypto_verify_private_key (key_path, password, NULL, &local_err);
+		format = crypto_verify_private_key (key_path, NM_CRYPTO_FILE_FLAGS_NONE, password, NULL, &local_err);
 		if (format == NM_CRYPTO_FILE_FORMAT_UNKNOWN) {
 			g_set_error_literal (error,
 			                     NM_CONNECTION_ERROR,
@@ -2295,7 +2295,7 @@ nm_setting_802_1x_get_phase2_private_key_format (NMSetting8021x *setting)
 		return NM_SETTING_802_1X_CK_FORMAT_RAW_KEY;
 	case NM_SETTING_802_1X_CK_SCHEME_PATH:
 		path = nm_setting_802_1x_get_phase2_private_key_path (setting);
-		if (crypto_is_pkcs12_file (path, &error))
+		if (crypto_is_pkcs12_file (path, NM_CRYPTO_FILE_FLAGS_NONE, &error))
 			return NM_SETTING_802_1X_CK_FORMAT_PKCS12;
 		if (error && error->domain == G_FILE_ERROR) {
 			g_error_free (error);
@@ -2345,7 +2345,7 @@ need_private_key_password (GBytes *blob,
 	/* Private key password is required */
 	if (password) {
 		if (path)
-			format = crypto_verify_private_key (path, password, NULL, NULL);
+			format = crypto_verify_private_key (path, NM_CRYPTO_FILE_FLAGS_NONE, password, NULL, NULL);
 		else if (blob)
 			format = crypto_verify_private_key_data (g_bytes_get_data (blob, NULL),
 			                                         g_bytes_get_size (blob),
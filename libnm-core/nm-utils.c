@@ -2416,7 +2416,7 @@ nm_utils_file_is_certificate (const char *filename)
 	if (!file_has_extension (filename, extensions))
 		return FALSE;
 
-	cert = crypto_load_and_verify_certificate (filename, &file_format, NULL);
+	cert = crypto_load_and_verify_certificate (filename, NM_CRYPTO_FILE_FLAGS_NONE, &file_format, NULL);
 	if (cert)
 		g_byte_array_unref (cert);
 
@@ -2445,7 +2445,7 @@ nm_utils_file_is_private_key (const char *filename, gboolean *out_encrypted)
 	if (!file_has_extension (filename, extensions))
 		return FALSE;
 
-	return crypto_verify_private_key (filename, NULL, out_encrypted, NULL) != NM_CRYPTO_FILE_FORMAT_UNKNOWN;
+	return crypto_verify_private_key (filename, NM_CRYPTO_FILE_FLAGS_NONE, NULL, out_encrypted, NULL) != NM_CRYPTO_FILE_FORMAT_UNKNOWN;
 }
 
 /**
@@ -2461,7 +2461,7 @@ nm_utils_file_is_pkcs12 (const char *filename)
 {
 	g_return_val_if_fail (filename != NULL, FALSE);
 
-	return crypto_is_pkcs12_file (filename, NULL);
+	return crypto_is_pkcs12_file (filename, NM_CRYPTO_FILE_FLAGS_NONE, NULL);
 }
 
 /*****************************************************************************/
@@ -103,7 +103,7 @@ test_cert (gconstpointer test_data)
 
 	path = g_build_filename (TEST_CERT_DIR, (const char *) test_data, NULL);
 
-	array = crypto_load_and_verify_certificate (path, &format, &error);
+	array = crypto_load_and_verify_certificate (path, NM_CRYPTO_FILE_FLAGS_NONE, &format, &error);
 	g_assert_no_error (error);
 	g_assert_cmpint (format, ==, NM_CRYPTO_FILE_FORMAT_X509);
 
@@ -185,7 +185,7 @@ test_load_pkcs12 (const char *path,
 
 	g_assert (nm_utils_file_is_private_key (path, NULL));
 
-	format = crypto_verify_private_key (path, password, &is_encrypted, &error);
+	format = crypto_verify_private_key (path, NM_CRYPTO_FILE_FLAGS_NONE, password, &is_encrypted, &error);
 	if (expected_error != -1) {
 		g_assert_error (error, NM_CRYPTO_ERROR, expected_error);
 		g_assert_cmpint (format, ==, NM_CRYPTO_FILE_FORMAT_UNKNOWN);
@@ -207,7 +207,7 @@ test_load_pkcs12_no_password (const char *path)
 	g_assert (nm_utils_file_is_private_key (path, NULL));
 
 	/* We should still get a valid returned crypto file format */
-	format = crypto_verify_private_key (path, NULL, &is_encrypted, &error);
+	format = crypto_verify_private_key (path, NM_CRYPTO_FILE_FLAGS_NONE, NULL, &is_encrypted, &error);
 	g_assert_no_error (error);
 	g_assert_cmpint (format, ==, NM_CRYPTO_FILE_FORMAT_PKCS12);
 	g_assert (is_encrypted);
@@ -219,7 +219,7 @@ test_is_pkcs12 (const char *path, gboolean expect_fail)
 	gboolean is_pkcs12;
 	GError *error = NULL;
 
-	is_pkcs12 = crypto_is_pkcs12_file (path, &error);
+	is_pkcs12 = crypto_is_pkcs12_file (path, NM_CRYPTO_FILE_FLAGS_NONE, &error);
 
 	if (expect_fail) {
 		g_assert_error (error, NM_CRYPTO_ERROR, NM_CRYPTO_ERROR_INVALID_DATA);
@@ -242,7 +242,7 @@ test_load_pkcs8 (const char *path,
 
 	g_assert (nm_utils_file_is_private_key (path, NULL));
 
-	format = crypto_verify_private_key (path, password, &is_encrypted, &error);
+	format = crypto_verify_private_key (path, NM_CRYPTO_FILE_FLAGS_NONE, password, &is_encrypted, &error);
 	if (expected_error != -1) {
 		g_assert_error (error, NM_CRYPTO_ERROR, expected_error);
 		g_assert_cmpint (format, ==, NM_CRYPTO_FILE_FORMAT_UNKNOWN);
@@ -431,6 +431,84 @@ test_md5 (void)
 	}
 }
 
+static void
+test_file_cache (void)
+{
+	gs_free char *cert_path = NULL;
+	gs_free char *key_path = NULL;
+	gs_free char *tmpdir = NULL;
+	gs_free char *path = NULL;
+	gs_free char *cert = NULL;
+	gs_free char *key = NULL;
+	gsize cert_len, key_len;
+	GByteArray *array, *array2;
+	NMCryptoFileFormat format;
+	GError *error = NULL;
+	guint i;
+
+	cert_path = g_build_filename (TEST_CERT_DIR, "test_ca_cert.pem", NULL);
+	key_path = g_build_filename (TEST_CERT_DIR, "test-key-only-decrypted.pem", NULL);
+	g_assert (g_file_get_contents (cert_path, &cert, &cert_len, NULL));
+	g_assert (g_file_get_contents (key_path, &key, &key_len, NULL));
+
+	tmpdir = g_dir_make_tmp ("nm-test-crypto-XXXXXX", &error);
+	g_assert_no_error (error);
+	path = g_build_filename (tmpdir, "file", NULL);
+
+	g_file_set_contents (path, cert, cert_len, &error);
+	g_assert_no_error (error);
+
+	format = NM_CRYPTO_FILE_FORMAT_UNKNOWN;
+	array = crypto_load_and_verify_certificate (path, NM_CRYPTO_FILE_FLAGS_NONE, &format, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (format, ==, NM_CRYPTO_FILE_FORMAT_X509);
+
+	/* repeated loads, from the cache or not, return the same. */
+	for (i = 0; i < 2; i++) {
+		format = NM_CRYPTO_FILE_FORMAT_UNKNOWN;
+		array2 = crypto_load_and_verify_certificate (path,
+		                                             i ? NM_CRYPTO_FILE_FLAGS_NO_CACHE : NM_CRYPTO_FILE_FLAGS_NONE,
+		                                             &format,
+		                                             &error);
+		g_assert_no_error (error);
+		g_assert_cmpint (format, ==, NM_CRYPTO_FILE_FORMAT_X509);
+		g_assert_cmpint (array2->len, ==, array->len);
+		g_assert (memcmp (array2->data, array->data, array->len) == 0);
+		g_byte_array_free (array2, TRUE);
+	}
+	g_byte_array_free (array, TRUE);
+
+	for (i = 0; i < 2; i++) {
+		g_assert (!crypto_is_pkcs12_file (path, NM_CRYPTO_FILE_FLAGS_NONE, &error));
+		g_assert_error (error, NM_CRYPTO_ERROR, NM_CRYPTO_ERROR_INVALID_DATA);
+		g_clear_error (&error);
+	}
+
+	/* replacing the file invalidates the cached results. */
+	g_file_set_contents (path, key, key_len, &error);
+	g_assert_no_error (error);
+
+	format = NM_CRYPTO_FILE_FORMAT_UNKNOWN;
+	array = crypto_load_and_verify_certificate (path, NM_CRYPTO_FILE_FLAGS_NONE, &format, &error);
+	g_assert (!array);
+	g_assert (error);
+	g_clear_error (&error);
+
+	for (i = 0; i < 2; i++) {
+		gboolean is_encrypted = FALSE;
+
+		format = crypto_verify_private_key (path, NM_CRYPTO_FILE_FLAGS_NONE, NULL, &is_encrypted, &error);
+		g_assert_no_error (error);
+		g_assert_cmpint (format, ==, NM_CRYPTO_FILE_FORMAT_RAW_KEY);
+		g_assert (!is_encrypted);
+	}
+
+	crypto_file_cache_clear ();
+
+	unlink (path);
+	rmdir (tmpdir);
+}
+
 NMTST_DEFINE ();
 
 int
@@ -493,6 +571,7 @@ main (int argc, char **argv)
 	                      test_pkcs8);
 
 	g_test_add_func ("/libnm/crypto/md5", test_md5);
+	g_test_add_func ("/libnm/crypto/file-cache", test_file_cache);
 
 	ret = g_test_run ();
 
@@ -93,6 +93,7 @@ typedef struct {
 	NMDnsManager *dns_manager;
 	GDBusObjectManager *object_manager;
 	GCancellable *new_object_manager_cancellable;
+	NMClientObjects objects;
 } NMClientPrivate;
 
 enum {
@@ -121,6 +122,7 @@ enum {
 	PROP_DNS_MODE,
 	PROP_DNS_RC_MANAGER,
 	PROP_DNS_CONFIGURATION,
+	PROP_OBJECTS,
 
 	LAST_PROP
 };
@@ -2020,8 +2022,32 @@ proxy_type (GDBusObjectManagerClient *manager,
 	return G_TYPE_DBUS_PROXY;
 }
 
+static gboolean
+obj_nm_type_wanted (NMClient *client, GType type)
+{
+	NMClientObjects objects = NM_CLIENT_GET_PRIVATE (client)->objects;
+	NMClientObjects kind;
+
+	if (g_type_is_a (type, NM_TYPE_DEVICE))
+		kind = NM_CLIENT_OBJECTS_DEVICES;
+	else if (g_type_is_a (type, NM_TYPE_ACTIVE_CONNECTION))
+		kind = NM_CLIENT_OBJECTS_ACTIVE_CONNECTIONS;
+	else if (type == NM_TYPE_REMOTE_CONNECTION)
+		kind = NM_CLIENT_OBJECTS_CONNECTIONS;
+	else if (   type == NM_TYPE_ACCESS_POINT
+	         || type == NM_TYPE_WIMAX_NSP)
+		kind = NM_CLIENT_OBJECTS_ACCESS_POINTS;
+	else if (   g_type_is_a (type, NM_TYPE_IP_CONFIG)
+	         || g_type_is_a (type, NM_TYPE_DHCP_CONFIG))
+		kind = NM_CLIENT_OBJECTS_IP_CONFIGS;
+	else
+		return TRUE;
+
+	return !!(objects & kind);
+}
+
 static NMObject *
-obj_nm_for_gdbus_object (GDBusObject *object, GDBusObjectManager *object_manager)
+obj_nm_for_gdbus_object (NMClient *client, GDBusObject *object, GDBusObjectManager *object_manager)
 {
 	GList *interfaces;
 	GList *l;
@@ -2106,6 +2132,11 @@ obj_nm_for_gdbus_object (GDBusObject *object, GDBusObjectManager *object_manager
 	if (type == G_TYPE_INVALID)
 		return NULL;
 
+	/* Objects of a kind the client was not asked for are not created at
+	 * all; whoever references them sees a NULL object instead. */
+	if (!obj_nm_type_wanted (client, type))
+		return NULL;
+
 	obj_nm = g_object_new (type,
 	                       NM_OBJECT_DBUS_OBJECT, object,
 	                       NM_OBJECT_DBUS_OBJECT_MANAGER, object_manager,
@@ -2131,7 +2162,7 @@ object_added (GDBusObjectManager *object_manager, GDBusObject *object, gpointer
 {
 	NMObject *obj_nm;
 
-	obj_nm = obj_nm_for_gdbus_object (object, object_manager);
+	obj_nm = obj_nm_for_gdbus_object (user_data, object, object_manager);
 	if (obj_nm) {
 		g_async_initable_init_async (G_ASYNC_INITABLE (obj_nm),
 		                             G_PRIORITY_DEFAULT, NULL,
@@ -2158,7 +2189,7 @@ objects_created (NMClient *client, GDBusObjectManager *object_manager, GError **
 	/* First just ensure all the NMObjects for known GDBusObjects exist. */
 	objects = g_dbus_object_manager_get_objects (object_manager);
 	for (iter = objects; iter; iter = iter->next)
-		obj_nm_for_gdbus_object (iter->data, object_manager);
+		obj_nm_for_gdbus_object (client, iter->data, object_manager);
 	g_list_free_full (objects, g_object_unref);
 
 	manager = g_dbus_object_manager_get_object (object_manager, NM_DBUS_PATH);
@@ -2577,6 +2608,10 @@ set_property (GObject *object, guint prop_id,
 		if (priv->manager)
 			g_object_set_property (G_OBJECT (priv->manager), pspec->name, value);
 		break;
+	case PROP_OBJECTS:
+		/* construct-only */
+		priv->objects = g_value_get_flags (value);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -2698,6 +2733,9 @@ get_property (GObject *object, guint prop_id,
 		} else
 			g_value_take_boxed (value, NULL);
 		break;
+	case PROP_OBJECTS:
+		g_value_set_flags (value, priv->objects);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -3037,6 +3075,26 @@ nm_client_class_init (NMClientClass *client_class)
 		                     G_PARAM_READABLE |
 		                     G_PARAM_STATIC_STRINGS));
 
+	/**
+	 * NMClient:objects:
+	 *
+	 * The kinds of objects the client instantiates. Tools that only look
+	 * at a few object types can restrict this to save the cost of
+	 * creating and initializing everything else. Objects of other kinds
+	 * are not tracked; properties referencing them read as %NULL and
+	 * arrays of them are empty.
+	 *
+	 * Since: 1.6
+	 **/
+	g_object_class_install_property
+		(object_class, PROP_OBJECTS,
+		 g_param_spec_flags (NM_CLIENT_OBJECTS, "", "",
+		                     NM_TYPE_CLIENT_OBJECTS,
+		                     NM_CLIENT_OBJECTS_ALL,
+		                     G_PARAM_READWRITE |
+		                     G_PARAM_CONSTRUCT_ONLY |
+		                     G_PARAM_STATIC_STRINGS));
+
 	/* signals */
 
 	/**
@@ -61,6 +61,7 @@ G_BEGIN_DECLS
 #define NM_CLIENT_DNS_MODE "dns-mode"
 #define NM_CLIENT_DNS_RC_MANAGER "dns-rc-manager"
 #define NM_CLIENT_DNS_CONFIGURATION "dns-configuration"
+#define NM_CLIENT_OBJECTS "objects"
 
 #define NM_CLIENT_DEVICE_ADDED "device-added"
 #define NM_CLIENT_DEVICE_REMOVED "device-removed"
@@ -169,6 +170,34 @@ typedef enum {
 	NM_CLIENT_ERROR_OBJECT_CREATION_FAILED,
 } NMClientError;
 
+/**
+ * NMClientObjects:
+ * @NM_CLIENT_OBJECTS_NONE: only the manager, settings and DNS manager objects
+ * @NM_CLIENT_OBJECTS_DEVICES: #NMDevice objects
+ * @NM_CLIENT_OBJECTS_ACTIVE_CONNECTIONS: #NMActiveConnection and
+ *   #NMVpnConnection objects
+ * @NM_CLIENT_OBJECTS_CONNECTIONS: #NMRemoteConnection objects
+ * @NM_CLIENT_OBJECTS_ACCESS_POINTS: #NMAccessPoint and #NMWimaxNsp objects
+ * @NM_CLIENT_OBJECTS_IP_CONFIGS: #NMIPConfig and #NMDhcpConfig objects
+ * @NM_CLIENT_OBJECTS_ALL: all objects
+ *
+ * Selects which kinds of objects a #NMClient instantiates, see
+ * #NMClient:objects. The manager, settings and DNS manager objects are
+ * always created. References to objects of a kind that is not selected
+ * read as %NULL and are left out of object arrays.
+ *
+ * Since: 1.6
+ **/
+typedef enum { /*< flags >*/
+	NM_CLIENT_OBJECTS_NONE               = 0,
+	NM_CLIENT_OBJECTS_DEVICES            = 0x1,
+	NM_CLIENT_OBJECTS_ACTIVE_CONNECTIONS = 0x2,
+	NM_CLIENT_OBJECTS_CONNECTIONS        = 0x4,
+	NM_CLIENT_OBJECTS_ACCESS_POINTS      = 0x8,
+	NM_CLIENT_OBJECTS_IP_CONFIGS         = 0x10,
+	NM_CLIENT_OBJECTS_ALL                = 0x1f,
+} NMClientObjects;
+
 #define NM_CLIENT_ERROR nm_client_error_quark ()
 GQuark nm_client_error_quark (void);
 
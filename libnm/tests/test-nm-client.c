@@ -764,6 +764,58 @@ test_devices_array (void)
 	g_clear_pointer (&sinfo, nmtstc_service_cleanup);
 }
 
+static void
+test_client_objects (void)
+{
+	NMClient *client;
+	NMClient *client2;
+	NMDevice *wlan0;
+	const GPtrArray *devices;
+	NMClientObjects objects;
+	GError *error = NULL;
+
+	sinfo = nmtstc_service_init ();
+
+	client = nm_client_new (NULL, &error);
+	g_assert_no_error (error);
+
+	g_object_get (client, NM_CLIENT_OBJECTS, &objects, NULL);
+	g_assert_cmpint (objects, ==, NM_CLIENT_OBJECTS_ALL);
+
+	wlan0 = nmtstc_service_add_device (sinfo, client, "AddWifiDevice", "wlan0");
+	nmtstc_service_add_device (sinfo, client, "AddWiredDevice", "eth0");
+
+	/* Without devices, the manager is there but the device list is empty */
+	client2 = g_initable_new (NM_TYPE_CLIENT, NULL, &error,
+	                          NM_CLIENT_OBJECTS, NM_CLIENT_OBJECTS_NONE,
+	                          NULL);
+	g_assert_no_error (error);
+	g_assert (nm_client_get_nm_running (client2));
+	g_assert_cmpint (nm_client_get_state (client2), ==, nm_client_get_state (client));
+
+	devices = nm_client_get_devices (client2);
+	g_assert (devices);
+	g_assert_cmpint (devices->len, ==, 0);
+	g_assert (!nm_client_get_device_by_path (client2, nm_object_get_path (NM_OBJECT (wlan0))));
+	g_object_unref (client2);
+
+	/* With devices only, they are all there */
+	client2 = g_initable_new (NM_TYPE_CLIENT, NULL, &error,
+	                          NM_CLIENT_OBJECTS, NM_CLIENT_OBJECTS_DEVICES,
+	                          NULL);
+	g_assert_no_error (error);
+
+	devices = nm_client_get_devices (client2);
+	g_assert (devices);
+	g_assert_cmpint (devices->len, ==, 2);
+	g_assert (NM_IS_DEVICE_WIFI (nm_client_get_device_by_iface (client2, "wlan0")));
+	g_assert (NM_IS_DEVICE_ETHERNET (nm_client_get_device_by_iface (client2, "eth0")));
+	g_object_unref (client2);
+
+	g_object_unref (client);
+	g_clear_pointer (&sinfo, nmtstc_service_cleanup);
+}
+
 static void
 nm_running_changed (GObject *client,
                     GParamSpec *pspec,
@@ -1586,6 +1638,7 @@ main (int argc, char **argv)
 	g_test_add_func ("/libnm/wifi-ap-added-removed", test_wifi_ap_added_removed);
 	g_test_add_func ("/libnm/wimax-nsp-added-removed", test_wimax_nsp_added_removed);
 	g_test_add_func ("/libnm/devices-array", test_devices_array);
+	g_test_add_func ("/libnm/client-objects", test_client_objects);
 	g_test_add_func ("/libnm/client-nm-running", test_client_nm_running);
 	g_test_add_func ("/libnm/active-connections", test_active_connections);
 	g_test_add_func ("/libnm/activate-virtual", test_activate_virtual);
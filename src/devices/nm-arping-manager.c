@@ -19,15 +19,30 @@
 #include "nm-arping-manager.h"
 
 #include <netinet/in.h>
-#include <sys/types.h>
-#include <sys/wait.h>
+#include <netinet/if_ether.h>
+#include <netpacket/packet.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 #include "platform/nm-platform.h"
 #include "nm-utils.h"
+#include "nm-core-internal.h"
 #include "NetworkManagerUtils.h"
 
 /*****************************************************************************/
 
+/* Number of probes sent for each address, see RFC 5227 section 2.1.1.
+ * The first probe is delayed randomly by up to PROBE_WAIT, then the probes
+ * are spread evenly over the rest of the probe timeout, but never further
+ * apart than PROBE_MAX. As NetworkManager's DAD timeout is usually much
+ * shorter than what the RFC suggests, the random delay is also limited to
+ * a fraction of the timeout. */
+#define PROBE_WAIT_MSEC        1000
+#define PROBE_NUM              3
+#define PROBE_MAX_MSEC         2000
+
+#define ANNOUNCE_INTERVAL_SEC  2
+
 typedef enum {
 	STATE_INIT,
 	STATE_PROBING,
@@ -37,10 +52,7 @@ typedef enum {
 
 typedef struct {
 	in_addr_t address;
-	GPid pid;
-	guint watch;
 	gboolean duplicate;
-	NMArpingManager *manager;
 } AddressInfo;
 
 /*****************************************************************************/
@@ -56,7 +68,14 @@ typedef struct {
 	int            ifindex;
 	State          state;
 	GHashTable    *addresses;
-	guint          completed;
+	guint          n_duplicates;
+	guint8         hwaddr[ETH_ALEN];
+	int            fd;
+	GIOChannel    *channel;
+	guint          event_id;
+	guint          probes_sent;
+	guint          probe_interval;
+	guint          probe_id;
 	guint          timer;
 	guint          round2_id;
 } NMArpingManagerPrivate;
@@ -119,67 +138,303 @@ nm_arping_manager_add_address (NMArpingManager *self, in_addr_t address)
 
 	info = g_slice_new0 (AddressInfo);
 	info->address = address;
-	info->manager = self;
 
 	g_hash_table_insert (priv->addresses, GUINT_TO_POINTER (address), info);
 
 	return TRUE;
 }
 
+/*****************************************************************************/
+
 static void
-arping_watch_cb (GPid pid, gint status, gpointer user_data)
+socket_close (NMArpingManager *self)
 {
-	AddressInfo *info = user_data;
-	NMArpingManager *self = info->manager;
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
-	const char *addr;
-
-	info->pid = 0;
-	info->watch = 0;
-	addr = nm_utils_inet4_ntop (info->address, NULL);
-
-	if (WIFEXITED (status)) {
-		if (WEXITSTATUS (status) != 0) {
-			_LOGD ("%s already used in the %s network",
-			       addr, nm_platform_link_get_name (NM_PLATFORM_GET, priv->ifindex));
-			info->duplicate = TRUE;
-		} else
-			_LOGD ("DAD succeeded for %s", addr);
-	} else {
-		_LOGD ("stopped unexpectedly with status %d for %s", status, addr);
+
+	nm_clear_g_source (&priv->event_id);
+	g_clear_pointer (&priv->channel, g_io_channel_unref);
+	if (priv->fd >= 0) {
+		close (priv->fd);
+		priv->fd = -1;
 	}
+}
+
+static gboolean receive_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data);
+
+/*
+ * socket_open:
+ * @self: a #NMArpingManager
+ * @receive: whether incoming ARP packets should be delivered to the socket
+ * @error: location to store error, or %NULL
+ *
+ * Open the AF_PACKET socket shared by all the addresses of @self. Only
+ * Ethernet-like interfaces are supported.
+ */
+static gboolean
+socket_open (NMArpingManager *self, gboolean receive, GError **error)
+{
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+	const NMPlatformLink *plink;
+	struct sockaddr_ll sll = {
+		.sll_family = AF_PACKET,
+		.sll_ifindex = priv->ifindex,
+	};
+	int errsv;
 
-	if (++priv->completed == g_hash_table_size (priv->addresses)) {
-		priv->state = STATE_PROBE_DONE;
-		nm_clear_g_source (&priv->timer);
-		g_signal_emit (self, signals[PROBE_TERMINATED], 0);
+	nm_assert (priv->fd < 0);
+
+	plink = nm_platform_link_get (NM_PLATFORM_GET, priv->ifindex);
+	if (!plink) {
+		/* The device was probably just removed. */
+		g_set_error (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
+		             "can't find link for ifindex %d", priv->ifindex);
+		return FALSE;
 	}
+
+	if (   plink->arptype != ARPHRD_ETHER
+	    || plink->addr.len != ETH_ALEN) {
+		g_set_error (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
+		             "unsupported hardware type %u for ARP on %s",
+		             (guint) plink->arptype, plink->name);
+		return FALSE;
+	}
+	memcpy (priv->hwaddr, plink->addr.data, ETH_ALEN);
+
+	/* A protocol of zero means that no packet is delivered to the socket,
+	 * which is what we want when only sending announcements. */
+	sll.sll_protocol = receive ? htons (ETH_P_ARP) : 0;
+
+	priv->fd = socket (AF_PACKET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, sll.sll_protocol);
+	if (priv->fd < 0) {
+		errsv = errno;
+		g_set_error (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
+		             "could not create ARP socket: %s", strerror (errsv));
+		return FALSE;
+	}
+
+	if (bind (priv->fd, (struct sockaddr *) &sll, sizeof (sll)) < 0) {
+		errsv = errno;
+		g_set_error (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
+		             "could not bind ARP socket to %s: %s",
+		             plink->name, strerror (errsv));
+		socket_close (self);
+		return FALSE;
+	}
+
+	if (receive) {
+		priv->channel = g_io_channel_unix_new (priv->fd);
+		g_io_channel_set_encoding (priv->channel, NULL, NULL);
+		g_io_channel_set_buffered (priv->channel, FALSE);
+		priv->event_id = g_io_add_watch (priv->channel,
+		                                 G_IO_IN | G_IO_ERR | G_IO_HUP,
+		                                 receive_cb, self);
+	}
+
+	return TRUE;
 }
 
 static gboolean
-arping_timeout_cb (gpointer user_data)
+send_arp (NMArpingManager *self, guint16 op, in_addr_t sender, in_addr_t target, gboolean target_hw_self)
+{
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+	struct sockaddr_ll sll = {
+		.sll_family = AF_PACKET,
+		.sll_protocol = htons (ETH_P_ARP),
+		.sll_ifindex = priv->ifindex,
+		.sll_halen = ETH_ALEN,
+		.sll_addr = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff },
+	};
+	struct ether_arp arp = {
+		.ea_hdr = {
+			.ar_hrd = htons (ARPHRD_ETHER),
+			.ar_pro = htons (ETHERTYPE_IP),
+			.ar_hln = ETH_ALEN,
+			.ar_pln = sizeof (in_addr_t),
+			.ar_op = htons (op),
+		},
+	};
+	int errsv;
+
+	memcpy (arp.arp_sha, priv->hwaddr, ETH_ALEN);
+	memcpy (arp.arp_spa, &sender, sizeof (in_addr_t));
+	if (target_hw_self)
+		memcpy (arp.arp_tha, priv->hwaddr, ETH_ALEN);
+	memcpy (arp.arp_tpa, &target, sizeof (in_addr_t));
+
+	if (sendto (priv->fd, &arp, sizeof (arp), 0,
+	            (struct sockaddr *) &sll, sizeof (sll)) < 0) {
+		errsv = errno;
+		_LOGW ("could not send ARP for address %s: %s",
+		       nm_utils_inet4_ntop (target, NULL), strerror (errsv));
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+static void
+probe_done (NMArpingManager *self)
 {
-	NMArpingManager *self = user_data;
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
 	GHashTableIter iter;
 	AddressInfo *info;
 
-	priv->timer = 0;
+	nm_clear_g_source (&priv->timer);
+	nm_clear_g_source (&priv->probe_id);
+	socket_close (self);
 
 	g_hash_table_iter_init (&iter, priv->addresses);
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
-		nm_clear_g_source (&info->watch);
-		if (info->pid) {
-			_LOGD ("DAD timed out for %s",
-			       nm_utils_inet4_ntop (info->address, NULL));
-			nm_utils_kill_child_async (info->pid, SIGTERM, LOGD_IP4,
-			                           "arping", 1000, NULL, NULL);
-			info->pid = 0;
-		}
+		if (!info->duplicate)
+			_LOGD ("DAD succeeded for %s", nm_utils_inet4_ntop (info->address, NULL));
 	}
 
 	priv->state = STATE_PROBE_DONE;
 	g_signal_emit (self, signals[PROBE_TERMINATED], 0);
+}
+
+static void
+handle_arp (NMArpingManager *self, const struct ether_arp *arp)
+{
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+	AddressInfo *info;
+	in_addr_t sender, target;
+	char sbuf[NM_UTILS_HWADDR_LEN_MAX * 3];
+
+	if (   arp->ea_hdr.ar_hrd != htons (ARPHRD_ETHER)
+	    || arp->ea_hdr.ar_pro != htons (ETHERTYPE_IP)
+	    || arp->ea_hdr.ar_hln != ETH_ALEN
+	    || arp->ea_hdr.ar_pln != sizeof (in_addr_t))
+		return;
+	if (!NM_IN_SET (ntohs (arp->ea_hdr.ar_op), ARPOP_REQUEST, ARPOP_REPLY))
+		return;
+
+	/* Our own probes must never be taken as a conflict. */
+	if (memcmp (arp->arp_sha, priv->hwaddr, ETH_ALEN) == 0)
+		return;
+
+	memcpy (&sender, arp->arp_spa, sizeof (in_addr_t));
+	memcpy (&target, arp->arp_tpa, sizeof (in_addr_t));
+
+	/* RFC 5227, section 2.1.1: any ARP packet with the probed address as
+	 * sender is a conflict, and so is a probe for the same address from
+	 * another host. */
+	info = NULL;
+	if (sender)
+		info = g_hash_table_lookup (priv->addresses, GUINT_TO_POINTER (sender));
+	else if (ntohs (arp->ea_hdr.ar_op) == ARPOP_REQUEST)
+		info = g_hash_table_lookup (priv->addresses, GUINT_TO_POINTER (target));
+
+	if (!info || info->duplicate)
+		return;
+
+	_LOGD ("%s already used in the %s network by %s",
+	       nm_utils_inet4_ntop (info->address, NULL),
+	       nm_platform_link_get_name (NM_PLATFORM_GET, priv->ifindex),
+	       nm_utils_hwaddr_ntoa_buf (arp->arp_sha, ETH_ALEN, FALSE, sbuf, sizeof (sbuf)));
+	info->duplicate = TRUE;
+	priv->n_duplicates++;
+}
+
+static gboolean
+receive_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	NMArpingManager *self = user_data;
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+	struct sockaddr_ll sll;
+	socklen_t sll_len;
+	struct ether_arp arp;
+	ssize_t n;
+	int errsv;
+
+	nm_assert (priv->state == STATE_PROBING);
+
+	while (TRUE) {
+		sll_len = sizeof (sll);
+		n = recvfrom (priv->fd, &arp, sizeof (arp), 0,
+		              (struct sockaddr *) &sll, &sll_len);
+		if (n < 0) {
+			errsv = errno;
+			if (errsv == EINTR)
+				continue;
+			if (errsv == EAGAIN || errsv == EWOULDBLOCK)
+				break;
+			_LOGW ("error receiving ARP packets: %s", strerror (errsv));
+			priv->event_id = 0;
+			g_clear_pointer (&priv->channel, g_io_channel_unref);
+			return G_SOURCE_REMOVE;
+		}
+
+		if (   (gsize) n < sizeof (arp)
+		    || sll.sll_pkttype == PACKET_OUTGOING)
+			continue;
+
+		handle_arp (self, &arp);
+	}
+
+	if (priv->n_duplicates == g_hash_table_size (priv->addresses)) {
+		/* Nothing left to probe, there is no need to wait for the timeout. */
+		priv->event_id = 0;
+		probe_done (self);
+		return G_SOURCE_REMOVE;
+	}
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void
+send_probes (NMArpingManager *self)
+{
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+	GHashTableIter iter;
+	AddressInfo *info;
+
+	g_hash_table_iter_init (&iter, priv->addresses);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
+		if (!info->duplicate)
+			send_arp (self, ARPOP_REQUEST, INADDR_ANY, info->address, FALSE);
+	}
+	priv->probes_sent++;
+}
+
+static gboolean
+probe_cb (gpointer user_data)
+{
+	NMArpingManager *self = user_data;
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+
+	send_probes (self);
+	if (priv->probes_sent < PROBE_NUM)
+		return G_SOURCE_CONTINUE;
+
+	priv->probe_id = 0;
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+probe_wait_cb (gpointer user_data)
+{
+	NMArpingManager *self = user_data;
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+
+	priv->probe_id = 0;
+	send_probes (self);
+	if (priv->probe_interval)
+		priv->probe_id = g_timeout_add (priv->probe_interval, probe_cb, self);
+
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+arping_timeout_cb (gpointer user_data)
+{
+	NMArpingManager *self = user_data;
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+
+	priv->timer = 0;
+	probe_done (self);
 
 	return G_SOURCE_REMOVE;
 }
@@ -191,19 +446,16 @@ arping_timeout_cb (gpointer user_data)
  * @error: location to store error, or %NULL
  *
  * Start probing IP addresses for duplicates; when the probe terminates a
- * PROBE_TERMINATED signal is emitted.
+ * PROBE_TERMINATED signal is emitted. All addresses are probed in parallel
+ * through a single packet socket bound to the interface.
  *
- * Returns: %TRUE if at least one probe could be started, %FALSE otherwise
+ * Returns: %TRUE if the probe could be started, %FALSE otherwise
  */
 gboolean
 nm_arping_manager_start_probe (NMArpingManager *self, guint timeout, GError **error)
 {
-	const char *argv[] = { NULL, "-D", "-q", "-I", NULL, "-c", NULL, "-w", NULL, NULL, NULL };
 	NMArpingManagerPrivate *priv;
-	GHashTableIter iter;
-	AddressInfo *info;
-	gs_free char *timeout_str = NULL;
-	gboolean success = FALSE;
+	guint probe_wait;
 
 	g_return_val_if_fail (NM_IS_ARPING_MANAGER (self), FALSE);
 	g_return_val_if_fail (!error || !*error, FALSE);
@@ -212,54 +464,33 @@ nm_arping_manager_start_probe (NMArpingManager *self, guint timeout, GError **er
 	priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
 	g_return_val_if_fail (priv->state == STATE_INIT, FALSE);
 
-	argv[4] = nm_platform_link_get_name (NM_PLATFORM_GET, priv->ifindex);
-	if (!argv[4]) {
-		/* The device was probably just removed. */
-		g_set_error (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
-		             "can't find a name for ifindex %d", priv->ifindex);
+	if (!g_hash_table_size (priv->addresses)) {
+		g_set_error_literal (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
+		                     "no address to probe");
 		return FALSE;
 	}
 
-	priv->completed = 0;
-
-	argv[0] = nm_utils_find_helper ("arping", NULL, NULL);
-	if (!argv[0]) {
-		g_set_error_literal (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
-		                     "arping could not be found");
+	if (!socket_open (self, TRUE, error))
 		return FALSE;
-	}
 
-	timeout_str = g_strdup_printf ("%u", timeout / 1000 + 2);
-	argv[6] = timeout_str;
-	argv[8] = timeout_str;
+	_LOGD ("probe %u addresses with timeout %u ms",
+	       g_hash_table_size (priv->addresses), timeout);
 
-	g_hash_table_iter_init (&iter, priv->addresses);
+	priv->state = STATE_PROBING;
+	priv->n_duplicates = 0;
+	priv->probes_sent = 0;
 
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
-		gs_free char *tmp_str = NULL;
-
-		argv[9] = nm_utils_inet4_ntop (info->address, NULL);
-		_LOGD ("run %s", (tmp_str = g_strjoinv (" ", (char **) argv)));
-
-		if (g_spawn_async (NULL, (char **) argv, NULL,
-		                   G_SPAWN_STDOUT_TO_DEV_NULL |
-		                   G_SPAWN_STDERR_TO_DEV_NULL |
-		                   G_SPAWN_DO_NOT_REAP_CHILD,
-		                   NULL, NULL, &info->pid, NULL)) {
-			info->watch = g_child_watch_add (info->pid, arping_watch_cb, info);
-			success = TRUE;
-		}
-	}
+	/* Hosts that come up at the same time (for example after a power
+	 * failure) must not probe in lockstep, see RFC 5227 section 2.1.1. */
+	probe_wait = g_random_int_range (0, MIN (timeout / (PROBE_NUM + 1), PROBE_WAIT_MSEC) + 1);
+	priv->probe_interval = MIN ((timeout - probe_wait) / PROBE_NUM, PROBE_MAX_MSEC);
 
-	if (success) {
-		priv->timer = g_timeout_add (timeout, arping_timeout_cb, self);
-		priv->state = STATE_PROBING;
-	} else {
-		g_set_error_literal (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
-		                     "could not spawn arping process");
-	}
+	/* Conflicting packets are already taken into account while waiting
+	 * for the first probe. */
+	priv->probe_id = g_timeout_add (probe_wait, probe_wait_cb, self);
+	priv->timer = g_timeout_add (timeout, arping_timeout_cb, self);
 
-	return success;
+	return TRUE;
 }
 
 /**
@@ -277,7 +508,9 @@ nm_arping_manager_reset (NMArpingManager *self)
 	priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
 
 	nm_clear_g_source (&priv->timer);
+	nm_clear_g_source (&priv->probe_id);
 	nm_clear_g_source (&priv->round2_id);
+	socket_close (self);
 	g_hash_table_remove_all (priv->addresses);
 
 	priv->state = STATE_INIT;
@@ -326,49 +559,22 @@ nm_arping_manager_check_address (NMArpingManager *self, in_addr_t address)
 }
 
 static void
-send_announcements (NMArpingManager *self, const char *mode_arg)
+send_announcements (NMArpingManager *self, guint16 op)
 {
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
-	const char *argv[] = { NULL, mode_arg, "-q", "-I", NULL, "-c", "1", NULL, NULL };
-	int ip_arg = G_N_ELEMENTS (argv) - 2;
-	GError *error = NULL;
 	GHashTableIter iter;
 	AddressInfo *info;
 
-	argv[4] = nm_platform_link_get_name (NM_PLATFORM_GET, priv->ifindex);
-	if (!argv[4]) {
-		/* The device was probably just removed. */
-		_LOGW ("can't find a name for ifindex %d", priv->ifindex);
-		return;
-	}
-
-	argv[0] = nm_utils_find_helper ("arping", NULL, NULL);
-	if (!argv[0]) {
-		_LOGW ("arping could not be found; no ARPs will be sent");
-		return;
-	}
-
 	g_hash_table_iter_init (&iter, priv->addresses);
 
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
-		gs_free char *tmp_str = NULL;
-		gboolean success;
-
 		if (info->duplicate)
 			continue;
 
-		argv[ip_arg] = nm_utils_inet4_ntop (info->address, NULL);
-		_LOGD ("run %s", (tmp_str = g_strjoinv (" ", (char **) argv)));
-
-		success = g_spawn_async (NULL, (char **) argv, NULL,
-		                         G_SPAWN_STDOUT_TO_DEV_NULL |
-		                         G_SPAWN_STDERR_TO_DEV_NULL,
-		                         NULL, NULL, NULL, &error);
-		if (!success) {
-			_LOGW ("could not send ARP for address %s: %s", argv[ip_arg],
-			       error->message);
-			g_clear_error (&error);
-		}
+		_LOGD ("announce %s (%s)",
+		       nm_utils_inet4_ntop (info->address, NULL),
+		       op == ARPOP_REPLY ? "reply" : "request");
+		send_arp (self, op, info->address, info->address, op == ARPOP_REPLY);
 	}
 }
 
@@ -378,7 +584,8 @@ arp_announce_round2 (gpointer self)
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE ((NMArpingManager *) self);
 
 	priv->round2_id = 0;
-	send_announcements (self, "-U");
+	send_announcements (self, ARPOP_REQUEST);
+	socket_close (self);
 	priv->state = STATE_INIT;
 	g_hash_table_remove_all (priv->addresses);
 
@@ -395,29 +602,31 @@ void
 nm_arping_manager_announce_addresses (NMArpingManager *self)
 {
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+	GError *error = NULL;
 
 	g_return_if_fail (   priv->state == STATE_INIT
 	                  || priv->state == STATE_PROBE_DONE);
 
-	send_announcements (self, "-A");
 	nm_clear_g_source (&priv->round2_id);
-	priv->round2_id = g_timeout_add_seconds (2, arp_announce_round2, self);
+	socket_close (self);
+
+	if (!socket_open (self, FALSE, &error)) {
+		_LOGW ("no ARPs will be sent: %s", error->message);
+		g_clear_error (&error);
+		return;
+	}
+
+	/* Like "arping -A" followed by "arping -U": first an ARP reply, then
+	 * an unsolicited ARP request. */
+	send_announcements (self, ARPOP_REPLY);
+	priv->round2_id = g_timeout_add_seconds (ANNOUNCE_INTERVAL_SEC, arp_announce_round2, self);
 	priv->state = STATE_ANNOUNCING;
 }
 
 static void
 destroy_address_info (gpointer data)
 {
-	AddressInfo *info = (AddressInfo *) data;
-
-	nm_clear_g_source (&info->watch);
-
-	if (info->pid) {
-		nm_utils_kill_child_async (info->pid, SIGTERM, LOGD_IP4, "arping",
-		                           1000, NULL, NULL);
-	}
-
-	g_slice_free (AddressInfo, info);
+	g_slice_free (AddressInfo, data);
 }
 
 /*****************************************************************************/
@@ -430,6 +639,7 @@ nm_arping_manager_init (NMArpingManager *self)
 	priv->addresses = g_hash_table_new_full (g_direct_hash, g_direct_equal,
 	                                         NULL, destroy_address_info);
 	priv->state = STATE_INIT;
+	priv->fd = -1;
 }
 
 NMArpingManager *
@@ -451,7 +661,9 @@ dispose (GObject *object)
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
 
 	nm_clear_g_source (&priv->timer);
+	nm_clear_g_source (&priv->probe_id);
 	nm_clear_g_source (&priv->round2_id);
+	socket_close (self);
 	g_clear_pointer (&priv->addresses, g_hash_table_destroy);
 
 	G_OBJECT_CLASS (nm_arping_manager_parent_class)->dispose (object);
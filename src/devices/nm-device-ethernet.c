@@ -256,6 +256,7 @@ _update_s390_subchannels (NMDeviceEthernet *self)
 	       nm_device_get_driver ((NMDevice *) self) ?: "(unknown driver)",
 	       priv->subchannels);
 
+	nm_device_spec_match_changed ((NMDevice *) self);
 	_notify (self, PROP_S390_SUBCHANNELS);
 }
 
@@ -1586,13 +1587,13 @@ new_default_connection (NMDevice *self)
 }
 
 static NMMatchSpecMatchType
-spec_match_list (NMDevice *device, const GSList *specs)
+spec_match_list (NMDevice *device, const NMMatchSpecCompiled *specs)
 {
 	NMMatchSpecMatchType matched = NM_MATCH_SPEC_NO_MATCH, m;
 	NMDeviceEthernetPrivate *priv = NM_DEVICE_ETHERNET_GET_PRIVATE ((NMDeviceEthernet *) device);
 
 	if (priv->subchannels)
-		matched = nm_match_spec_s390_subchannels (specs, priv->subchannels);
+		matched = nm_match_spec_compiled_match_device (specs, NULL, NULL, NULL, priv->subchannels);
 	if (matched != NM_MATCH_SPEC_NEG_MATCH) {
 		m = NM_DEVICE_CLASS (nm_device_ethernet_parent_class)->spec_match_list (device, specs);
 		matched = MAX (matched, m);
@@ -66,6 +66,12 @@ gboolean nm_device_hw_addr_reset (NMDevice *device, const char *detail);
 
 void nm_device_set_firmware_missing (NMDevice *self, gboolean missing);
 
+void nm_device_spec_match_changed (NMDevice *self);
+
+/* for testing */
+void _nm_device_set_iface_for_testing (NMDevice *self, const char *iface);
+void _nm_device_set_perm_hw_address_for_testing (NMDevice *self, const char *hw_addr);
+
 void nm_device_activate_schedule_stage1_device_prepare (NMDevice *device);
 void nm_device_activate_schedule_stage2_device_config (NMDevice *device);
 
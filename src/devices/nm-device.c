@@ -40,6 +40,7 @@
 #include "NetworkManagerUtils.h"
 #include "nm-manager.h"
 #include "platform/nm-platform.h"
+#include "platform/nmp-object.h"
 #include "ndisc/nm-ndisc.h"
 #include "ndisc/nm-lndp-ndisc.h"
 #include "dhcp/nm-dhcp-manager.h"
@@ -66,6 +67,7 @@
 #include "nm-lldp-listener.h"
 #include "nm-audit-manager.h"
 #include "nm-arping-manager.h"
+#include "nm-connectivity.h"
 
 #include "nm-device-logging.h"
 _LOG_DECLARE_SELF (NMDevice);
@@ -129,6 +131,7 @@ NM_GOBJECT_PROPERTIES_DEFINE (NMDevice,
 	PROP_METERED,
 	PROP_LLDP_NEIGHBORS,
 	PROP_REAL,
+	PROP_CONNECTIVITY,
 	PROP_SLAVES,
 	PROP_REFRESH_RATE_MS,
 	PROP_TX_BYTES,
@@ -214,6 +217,10 @@ typedef enum {
 typedef struct _NMDevicePrivate {
 	bool in_state_changed;
 
+	/* changes whenever a property that nm_device_spec_match_list()
+	 * depends on changes. See nm_device_get_spec_match_generation(). */
+	guint spec_match_generation;
+
 	guint device_link_changed_id;
 	guint device_ip_link_changed_id;
 
@@ -388,6 +395,9 @@ typedef struct _NMDevicePrivate {
 
 	GHashTable *   ip6_saved_properties;
 
+	/* counts the sysctl accesses since the start of the activation. */
+	NMPlatformSysctlStats sysctl_stats;
+
 	struct {
 		NMDhcpClient *   client;
 		NMNDiscDHCPLevel mode;
@@ -420,6 +430,8 @@ typedef struct _NMDevicePrivate {
 
 	NMMetered       metered;
 
+	NMConnectivityState connectivity_state;
+
 	NMSettings *settings;
 
 	NMLldpListener *lldp_listener;
@@ -629,13 +641,47 @@ init_ip6_config_dns_priority (NMDevice *self, NMIP6Config *config)
 gboolean
 nm_device_ipv6_sysctl_set (NMDevice *self, const char *property, const char *value)
 {
-	return nm_platform_sysctl_set (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (nm_device_get_ip_iface (self), property)), value);
+	return nm_platform_sysctl_ip_conf_set (NM_PLATFORM_GET,
+	                                       AF_INET6,
+	                                       nm_device_get_ip_iface (self),
+	                                       property,
+	                                       value,
+	                                       &NM_DEVICE_GET_PRIVATE (self)->sysctl_stats);
+}
+
+static gboolean
+nm_device_ipv6_sysctl_set_multi (NMDevice *self, const NMPlatformSysctlIPConfSetData *data, guint n_data)
+{
+	return nm_platform_sysctl_ip_conf_set_multi (NM_PLATFORM_GET,
+	                                             AF_INET6,
+	                                             nm_device_get_ip_iface (self),
+	                                             data,
+	                                             n_data,
+	                                             &NM_DEVICE_GET_PRIVATE (self)->sysctl_stats);
+}
+
+static char *
+nm_device_ipv6_sysctl_get (NMDevice *self, const char *property)
+{
+	return nm_platform_sysctl_ip_conf_get (NM_PLATFORM_GET,
+	                                       AF_INET6,
+	                                       nm_device_get_ip_iface (self),
+	                                       property,
+	                                       &NM_DEVICE_GET_PRIVATE (self)->sysctl_stats);
 }
 
 static guint32
 nm_device_ipv6_sysctl_get_int32 (NMDevice *self, const char *property, gint32 fallback)
 {
-	return nm_platform_sysctl_get_int32 (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (nm_device_get_ip_iface (self), property)), fallback);
+	return nm_platform_sysctl_ip_conf_get_int_checked (NM_PLATFORM_GET,
+	                                                   AF_INET6,
+	                                                   nm_device_get_ip_iface (self),
+	                                                   property,
+	                                                   10,
+	                                                   G_MININT32,
+	                                                   G_MAXINT32,
+	                                                   fallback,
+	                                                   &NM_DEVICE_GET_PRIVATE (self)->sysctl_stats);
 }
 
 gboolean
@@ -1048,6 +1094,38 @@ nm_device_get_metered (NMDevice *self)
 	return NM_DEVICE_GET_PRIVATE (self)->metered;
 }
 
+/**
+ * nm_device_get_connectivity_state:
+ * @self: the #NMDevice
+ *
+ * Returns: the result of the connectivity check bound to this device.
+ */
+NMConnectivityState
+nm_device_get_connectivity_state (NMDevice *self)
+{
+	g_return_val_if_fail (NM_IS_DEVICE (self), NM_CONNECTIVITY_UNKNOWN);
+
+	return NM_DEVICE_GET_PRIVATE (self)->connectivity_state;
+}
+
+void
+nm_device_set_connectivity_state (NMDevice *self, NMConnectivityState state)
+{
+	NMDevicePrivate *priv;
+
+	g_return_if_fail (NM_IS_DEVICE (self));
+
+	priv = NM_DEVICE_GET_PRIVATE (self);
+	if (priv->connectivity_state == state)
+		return;
+
+	_LOGD (LOGD_CONCHECK, "connectivity state changed from %s to %s",
+	       nm_connectivity_state_to_string (priv->connectivity_state),
+	       nm_connectivity_state_to_string (state));
+	priv->connectivity_state = state;
+	_notify (self, PROP_CONNECTIVITY);
+}
+
 /**
  * nm_device_get_priority():
  * @self: the #NMDevice
@@ -1963,6 +2041,7 @@ device_link_changed (NMDevice *self)
 		else
 			update_unmanaged_specs = TRUE;
 
+		nm_device_spec_match_changed (self);
 		_notify (self, PROP_IFACE);
 		if (ip_ifname_changed)
 			_notify (self, PROP_IP_IFACE);
@@ -2281,6 +2360,7 @@ update_device_from_platform_link (NMDevice *self, const NMPlatformLink *plink)
 	if (!g_strcmp0 (plink->name, priv->iface)) {
 		g_free (priv->iface);
 		priv->iface = g_strdup (plink->name);
+		nm_device_spec_match_changed (self);
 		_notify (self, PROP_IFACE);
 	}
 
@@ -2616,8 +2696,10 @@ nm_device_unrealize (NMDevice *self, gboolean remove_resources, GError **error)
 	if (nm_clear_g_free (&priv->hw_addr))
 		_notify (self, PROP_HW_ADDRESS);
 	priv->hw_addr_type = HW_ADDR_TYPE_UNSET;
-	if (nm_clear_g_free (&priv->hw_addr_perm))
+	if (nm_clear_g_free (&priv->hw_addr_perm)) {
+		nm_device_spec_match_changed (self);
 		_notify (self, PROP_PERM_HW_ADDRESS);
+	}
 	g_clear_pointer (&priv->hw_addr_initial, g_free);
 
 	priv->capabilities = NM_DEVICE_CAP_NM_SUPPORTED;
@@ -4660,12 +4742,12 @@ _device_get_default_route_from_platform (NMDevice *self, int addr_family, NMPlat
 {
 	gboolean success = FALSE;
 	int ifindex = nm_device_get_ip_ifindex (self);
-	GArray *routes;
+	GPtrArray *routes;
 
 	if (addr_family == AF_INET)
-		routes = nm_platform_ip4_route_get_all (NM_PLATFORM_GET, ifindex, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT);
+		routes = nm_platform_ip4_route_lookup_clone (NM_PLATFORM_GET, ifindex, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT);
 	else
-		routes = nm_platform_ip6_route_get_all (NM_PLATFORM_GET, ifindex, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT);
+		routes = nm_platform_ip6_route_lookup_clone (NM_PLATFORM_GET, ifindex, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT);
 
 	if (routes) {
 		guint route_metric = G_MAXUINT32, m;
@@ -4674,13 +4756,11 @@ _device_get_default_route_from_platform (NMDevice *self, int addr_family, NMPlat
 
 		/* if there are several default routes, find the one with the best metric */
 		for (i = 0; i < routes->len; i++) {
-			if (addr_family == AF_INET) {
-				r = (const NMPlatformIPRoute *) &g_array_index (routes, NMPlatformIP4Route, i);
+			r = &((const NMPObject *) routes->pdata[i])->ipx_route.rx;
+			if (addr_family == AF_INET)
 				m = r->metric;
-			} else {
-				r = (const NMPlatformIPRoute *) &g_array_index (routes, NMPlatformIP6Route, i);
+			else
 				m = nm_utils_ip6_route_metric_normalize (r->metric);
-			}
 			if (!route || m < route_metric) {
 				route = r;
 				route_metric = m;
@@ -4694,7 +4774,7 @@ _device_get_default_route_from_platform (NMDevice *self, int addr_family, NMPlat
 				*((NMPlatformIP6Route *) out_route) = *((NMPlatformIP6Route *) route);
 			success = TRUE;
 		}
-		g_array_free (routes, TRUE);
+		g_ptr_array_unref (routes);
 	}
 	return success;
 }
@@ -4776,6 +4856,18 @@ dhcp4_cleanup (NMDevice *self, CleanupType cleanup_type, gboolean release)
 		g_clear_object (&priv->dhcp4.client);
 	}
 
+	/* keep the exported object (and its D-Bus path) while DHCP is
+	 * restarted, only drop the lease options. When DHCP stops for good,
+	 * the caller unexports it with dhcp4_config_clear(). */
+	if (priv->dhcp4.config)
+		nm_dhcp4_config_reset (priv->dhcp4.config);
+}
+
+static void
+dhcp4_config_clear (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+
 	if (priv->dhcp4.config) {
 		nm_exported_object_clear_and_unexport (&priv->dhcp4.config);
 		_notify (self, PROP_DHCP4_CONFIG);
@@ -5029,7 +5121,9 @@ dhcp4_fail (NMDevice *self, gboolean timeout)
 	_LOGD (LOGD_DHCP4, "DHCPv4 failed: timeout %d, num tries left %u",
 	       timeout, priv->dhcp4.num_tries_left);
 
+	/* there is no lease anymore, don't keep exporting an empty config. */
 	dhcp4_cleanup (self, CLEANUP_TYPE_DECONFIGURE, FALSE);
+	dhcp4_config_clear (self);
 
 	/* Don't fail if there are static addresses configured on
 	 * the device, instead retry after some time.
@@ -5183,8 +5277,10 @@ dhcp4_start (NMDevice *self,
 	s_ip4 = nm_connection_get_setting_ip4_config (connection);
 
 	/* Clear old exported DHCP options */
-	nm_exported_object_clear_and_unexport (&priv->dhcp4.config);
-	priv->dhcp4.config = nm_dhcp4_config_new ();
+	if (priv->dhcp4.config)
+		nm_dhcp4_config_reset (priv->dhcp4.config);
+	else
+		priv->dhcp4.config = nm_dhcp4_config_new ();
 
 	hw_addr = nm_platform_link_get_address (NM_PLATFORM_GET, nm_device_get_ip_ifindex (self), &hw_addr_len);
 	if (hw_addr_len) {
@@ -5526,6 +5622,18 @@ dhcp6_cleanup (NMDevice *self, CleanupType cleanup_type, gboolean release)
 
 	nm_device_remove_pending_action (self, PENDING_ACTION_DHCP6, FALSE);
 
+	/* keep the exported object (and its D-Bus path) while DHCP is
+	 * restarted, only drop the lease options. When DHCP stops for good,
+	 * the caller unexports it with dhcp6_config_clear(). */
+	if (priv->dhcp6.config)
+		nm_dhcp6_config_reset (priv->dhcp6.config);
+}
+
+static void
+dhcp6_config_clear (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+
 	if (priv->dhcp6.config) {
 		nm_exported_object_clear_and_unexport (&priv->dhcp6.config);
 		_notify (self, PROP_DHCP6_CONFIG);
@@ -5833,7 +5941,9 @@ dhcp6_fail (NMDevice *self, gboolean timeout)
 	_LOGD (LOGD_DHCP6, "DHCPv6 failed: timeout %d, num tries left %u",
            timeout, priv->dhcp6.num_tries_left);
 
+	/* there is no lease anymore, don't keep exporting an empty config. */
 	dhcp6_cleanup (self, CLEANUP_TYPE_DECONFIGURE, FALSE);
+	dhcp6_config_clear (self);
 
 	if (priv->dhcp6.mode == NM_NDISC_DHCP_LEVEL_MANAGED) {
 		/* Don't fail if there are static addresses configured on
@@ -5886,6 +5996,7 @@ dhcp6_timeout (NMDevice *self, NMDhcpClient *client)
 	else {
 		/* not a hard failure; just live with the RA info */
 		dhcp6_cleanup (self, CLEANUP_TYPE_DECONFIGURE, FALSE);
+		dhcp6_config_clear (self);
 		if (priv->ip6_state == IP_CONF)
 			nm_device_activate_schedule_ip6_config_result (self);
 	}
@@ -6045,8 +6156,10 @@ dhcp6_start (NMDevice *self, gboolean wait_for_ll, NMDeviceStateReason *reason)
 	NMConnection *connection;
 	NMSettingIPConfig *s_ip6;
 
-	nm_exported_object_clear_and_unexport (&priv->dhcp6.config);
-	priv->dhcp6.config = nm_dhcp6_config_new ();
+	if (priv->dhcp6.config)
+		nm_dhcp6_config_reset (priv->dhcp6.config);
+	else
+		priv->dhcp6.config = nm_dhcp6_config_new ();
 
 	g_warn_if_fail (priv->dhcp6.ip6_config == NULL);
 	g_clear_object (&priv->dhcp6.ip6_config);
@@ -6562,7 +6675,11 @@ ndisc_config_changed (NMNDisc *ndisc, const NMNDiscData *rdata, guint changed_in
 					nm_device_state_changed (self, NM_DEVICE_STATE_FAILED, reason);
 					return;
 				}
+				dhcp6_config_clear (self);
 			}
+		} else {
+			/* DHCPv6 is no longer wanted by the router */
+			dhcp6_config_clear (self);
 		}
 	}
 
@@ -6624,11 +6741,17 @@ addrconf6_start_with_link_ready (NMDevice *self)
 	/* XXX: These sysctls would probably be better set by the lndp ndisc itself. */
 	switch (nm_ndisc_get_node_type (priv->ndisc)) {
 	case NM_NDISC_NODE_TYPE_HOST:
-		/* Accepting prefixes from discovered routers. */
-		nm_device_ipv6_sysctl_set (self, "accept_ra", "1");
-		nm_device_ipv6_sysctl_set (self, "accept_ra_defrtr", "0");
-		nm_device_ipv6_sysctl_set (self, "accept_ra_pinfo", "0");
-		nm_device_ipv6_sysctl_set (self, "accept_ra_rtr_pref", "0");
+		{
+			static const NMPlatformSysctlIPConfSetData data[] = {
+				/* Accepting prefixes from discovered routers. */
+				{ "accept_ra",          "1" },
+				{ "accept_ra_defrtr",   "0" },
+				{ "accept_ra_pinfo",    "0" },
+				{ "accept_ra_rtr_pref", "0" },
+			};
+
+			nm_device_ipv6_sysctl_set_multi (self, data, G_N_ELEMENTS (data));
+		}
 		break;
 	case NM_NDISC_NODE_TYPE_ROUTER:
 		/* We're the router. */
@@ -6764,14 +6887,13 @@ static void
 save_ip6_properties (NMDevice *self)
 {
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
-	const char *ifname = nm_device_get_ip_iface (self);
 	char *value;
 	int i;
 
 	g_hash_table_remove_all (priv->ip6_saved_properties);
 
 	for (i = 0; i < G_N_ELEMENTS (ip6_properties_to_save); i++) {
-		value = nm_platform_sysctl_get (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (ifname, ip6_properties_to_save[i])));
+		value = nm_device_ipv6_sysctl_get (self, ip6_properties_to_save[i]);
 		if (value) {
 			g_hash_table_insert (priv->ip6_saved_properties,
 			                     (char *) ip6_properties_to_save[i],
@@ -6784,16 +6906,22 @@ static void
 restore_ip6_properties (NMDevice *self)
 {
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	NMPlatformSysctlIPConfSetData data[G_N_ELEMENTS (ip6_properties_to_save)];
 	GHashTableIter iter;
 	gpointer key, value;
+	guint n_data = 0;
 
 	g_hash_table_iter_init (&iter, priv->ip6_saved_properties);
 	while (g_hash_table_iter_next (&iter, &key, &value)) {
 		/* Don't touch "disable_ipv6" if we're doing userland IPv6LL */
 		if (priv->nm_ipv6ll && strcmp (key, "disable_ipv6") == 0)
 			continue;
-		nm_device_ipv6_sysctl_set (self, key, value);
+		g_return_if_fail (n_data < G_N_ELEMENTS (data));
+		data[n_data].property = key;
+		data[n_data].value = value;
+		n_data++;
 	}
+	nm_device_ipv6_sysctl_set_multi (self, data, n_data);
 }
 
 static inline void
@@ -6831,8 +6959,7 @@ set_nm_ipv6ll (NMDevice *self, gboolean enable)
 
 		if (enable) {
 			/* Bounce IPv6 to ensure the kernel stops IPv6LL address generation */
-			value = nm_platform_sysctl_get (NM_PLATFORM_GET,
-			                                NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (nm_device_get_ip_iface (self), "disable_ipv6")));
+			value = nm_device_ipv6_sysctl_get (self, "disable_ipv6");
 			if (g_strcmp0 (value, "0") == 0)
 				nm_device_ipv6_sysctl_set (self, "disable_ipv6", "1");
 			g_free (value);
@@ -7965,6 +8092,7 @@ _cleanup_ip4_pre (NMDevice *self, CleanupType cleanup_type)
 	priv->queued_ip4_config_pending = FALSE;
 
 	dhcp4_cleanup (self, cleanup_type, FALSE);
+	dhcp4_config_clear (self);
 	arp_cleanup (self);
 	dnsmasq_cleanup (self);
 	ipv4ll_cleanup (self);
@@ -7983,6 +8111,7 @@ _cleanup_ip6_pre (NMDevice *self, CleanupType cleanup_type)
 
 	g_clear_object (&priv->dad6_ip6_config);
 	dhcp6_cleanup (self, cleanup_type, FALSE);
+	dhcp6_config_clear (self);
 	linklocal6_cleanup (self);
 	addrconf6_cleanup (self);
 }
@@ -11122,9 +11251,13 @@ nm_device_cleanup (NMDevice *self, NMDeviceStateReason reason, CleanupType clean
 
 	/* Turn off kernel IPv6 */
 	if (cleanup_type == CLEANUP_TYPE_DECONFIGURE) {
+		static const NMPlatformSysctlIPConfSetData data[] = {
+			{ "accept_ra",    "0" },
+			{ "use_tempaddr", "0" },
+		};
+
 		set_disable_ipv6 (self, "1");
-		nm_device_ipv6_sysctl_set (self, "accept_ra", "0");
-		nm_device_ipv6_sysctl_set (self, "use_tempaddr", "0");
+		nm_device_ipv6_sysctl_set_multi (self, data, G_N_ELEMENTS (data));
 	}
 
 	/* Call device type-specific deactivation */
@@ -11375,13 +11508,17 @@ notify_ip_properties (NMDevice *self)
 static void
 ip6_managed_setup (NMDevice *self)
 {
+	static const NMPlatformSysctlIPConfSetData data[] = {
+		{ "accept_ra_defrtr",   "0" },
+		{ "accept_ra_pinfo",    "0" },
+		{ "accept_ra_rtr_pref", "0" },
+		{ "use_tempaddr",       "0" },
+		{ "forwarding",         "0" },
+	};
+
 	set_nm_ipv6ll (self, TRUE);
 	set_disable_ipv6 (self, "1");
-	nm_device_ipv6_sysctl_set (self, "accept_ra_defrtr", "0");
-	nm_device_ipv6_sysctl_set (self, "accept_ra_pinfo", "0");
-	nm_device_ipv6_sysctl_set (self, "accept_ra_rtr_pref", "0");
-	nm_device_ipv6_sysctl_set (self, "use_tempaddr", "0");
-	nm_device_ipv6_sysctl_set (self, "forwarding", "0");
+	nm_device_ipv6_sysctl_set_multi (self, data, G_N_ELEMENTS (data));
 }
 
 static void
@@ -11585,6 +11722,11 @@ _set_state_full (NMDevice *self,
 		}
 		break;
 	case NM_DEVICE_STATE_PREPARE:
+		memset (&priv->sysctl_stats, 0, sizeof (priv->sysctl_stats));
+		/* somebody else might have changed the sysctls since we last
+		 * wrote them. Don't trust the cached values for the new activation. */
+		if (priv->ip_ifindex > 0)
+			nm_platform_sysctl_ip_conf_invalidate (NM_PLATFORM_GET, priv->ip_ifindex);
 		nm_device_update_initial_hw_address (self);
 		break;
 	case NM_DEVICE_STATE_NEED_AUTH:
@@ -11674,6 +11816,8 @@ _set_state_full (NMDevice *self,
 		break;
 	case NM_DEVICE_STATE_ACTIVATED:
 		_LOGI (LOGD_DEVICE, "Activation: successful, device activated.");
+		_LOGD (LOGD_DEVICE, "Activation: %u sysctl syscalls, %u sysctl writes skipped",
+		       priv->sysctl_stats.n_syscalls, priv->sysctl_stats.n_skipped);
 		nm_device_update_metered (self);
 		nm_dispatcher_call (DISPATCHER_ACTION_UP,
 		                    nm_act_request_get_settings_connection (req),
@@ -12102,6 +12246,7 @@ nm_device_update_permanent_hw_address (NMDevice *self, gboolean force_freeze)
 	priv->hw_addr_perm = g_strdup (priv->hw_addr);
 
 notify_and_out:
+	nm_device_spec_match_changed (self);
 	_notify (self, PROP_PERM_HW_ADDRESS);
 }
 
@@ -12476,10 +12621,69 @@ nm_device_get_initial_hw_address (NMDevice *self)
 	return NM_DEVICE_GET_PRIVATE (self)->hw_addr_initial;
 }
 
+/**
+ * nm_device_spec_match_changed:
+ * @self: an #NMDevice
+ *
+ * Must be called whenever a property changes that affects the result of
+ * spec_match_list(). This invalidates results that were cached based on
+ * nm_device_get_spec_match_generation().
+ */
+void
+nm_device_spec_match_changed (NMDevice *self)
+{
+	static guint generation_counter = 0;
+
+	/* the counter is global, so that a generation number never repeats,
+	 * not even for another device that is allocated at the same address. */
+	if (G_UNLIKELY (++generation_counter == 0))
+		generation_counter++;
+	NM_DEVICE_GET_PRIVATE (self)->spec_match_generation = generation_counter;
+}
+
+/* for testing: change the properties that spec matching uses, like a
+ * rename or a change of the permanent MAC address would do. */
+void
+_nm_device_set_iface_for_testing (NMDevice *self, const char *iface)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+
+	g_free (priv->iface);
+	priv->iface = g_strdup (iface);
+	nm_device_spec_match_changed (self);
+	_notify (self, PROP_IFACE);
+}
+
+void
+_nm_device_set_perm_hw_address_for_testing (NMDevice *self, const char *hw_addr)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+
+	g_free (priv->hw_addr_perm);
+	priv->hw_addr_perm = g_strdup (hw_addr);
+	nm_device_spec_match_changed (self);
+	_notify (self, PROP_PERM_HW_ADDRESS);
+}
+
+/**
+ * nm_device_get_spec_match_generation:
+ * @self: an #NMDevice
+ *
+ * Returns: a non-zero number that identifies the current state of the
+ *   properties that nm_device_spec_match_list() matches against.
+ */
+guint
+nm_device_get_spec_match_generation (NMDevice *self)
+{
+	g_return_val_if_fail (NM_IS_DEVICE (self), 0);
+
+	return NM_DEVICE_GET_PRIVATE (self)->spec_match_generation;
+}
+
 /**
  * nm_device_spec_match_list:
  * @self: an #NMDevice
- * @specs: (element-type utf8): a list of device specs
+ * @specs: (allow-none): the device specs, as compiled by nm_match_spec_compile()
  *
  * Checks if @self matches any of the specifications in @specs. The
  * currently-supported spec types are:
@@ -12498,7 +12702,7 @@ nm_device_get_initial_hw_address (NMDevice *self)
  * Returns: #TRUE if @self matches one of the specs in @specs
  */
 gboolean
-nm_device_spec_match_list (NMDevice *self, const GSList *specs)
+nm_device_spec_match_list (NMDevice *self, const NMMatchSpecCompiled *specs)
 {
 	g_return_val_if_fail (NM_IS_DEVICE (self), FALSE);
 
@@ -12509,33 +12713,13 @@ nm_device_spec_match_list (NMDevice *self, const GSList *specs)
 }
 
 static NMMatchSpecMatchType
-spec_match_list (NMDevice *self, const GSList *specs)
+spec_match_list (NMDevice *self, const NMMatchSpecCompiled *specs)
 {
-	NMMatchSpecMatchType matched = NM_MATCH_SPEC_NO_MATCH, m;
-	const GSList *iter;
-	const char *hw_addr_perm;
-
-	for (iter = specs; iter; iter = g_slist_next (iter)) {
-		if (!strcmp ((const char *) iter->data, "*")) {
-			matched = NM_MATCH_SPEC_MATCH;
-			break;
-		}
-	}
-
-	hw_addr_perm = nm_device_get_permanent_hw_address (self);
-	if (hw_addr_perm) {
-		m = nm_match_spec_hwaddr (specs, hw_addr_perm);
-		matched = MAX (matched, m);
-	}
-	if (matched != NM_MATCH_SPEC_NEG_MATCH) {
-		m = nm_match_spec_interface_name (specs, nm_device_get_iface (self));
-		matched = MAX (matched, m);
-	}
-	if (matched != NM_MATCH_SPEC_NEG_MATCH) {
-		m = nm_match_spec_device_type (specs, nm_device_get_type_description (self));
-		matched = MAX (matched, m);
-	}
-	return matched;
+	return nm_match_spec_compiled_match_device (specs,
+	                                            nm_device_get_iface (self),
+	                                            nm_device_get_type_description (self),
+	                                            nm_device_get_permanent_hw_address (self),
+	                                            NULL);
 }
 
 /*****************************************************************************/
@@ -12571,6 +12755,7 @@ nm_device_init (NMDevice *self)
 
 	priv->type = NM_DEVICE_TYPE_UNKNOWN;
 	priv->capabilities = NM_DEVICE_CAP_NM_SUPPORTED;
+	nm_device_spec_match_changed (self);
 	priv->state = NM_DEVICE_STATE_UNMANAGED;
 	priv->state_reason = NM_DEVICE_STATE_REASON_NONE;
 	priv->dhcp_timeout = 0;
@@ -13027,6 +13212,9 @@ get_property (GObject *object, guint prop_id,
 	case PROP_REAL:
 		g_value_set_boolean (value, nm_device_is_real (self));
 		break;
+	case PROP_CONNECTIVITY:
+		g_value_set_uint (value, priv->connectivity_state);
+		break;
 	case PROP_SLAVES: {
 		GSList *slave_iter;
 		char **slave_list;
@@ -13295,6 +13483,11 @@ nm_device_class_init (NMDeviceClass *klass)
 	                          FALSE,
 	                          G_PARAM_READABLE |
 	                          G_PARAM_STATIC_STRINGS);
+	obj_properties[PROP_CONNECTIVITY] =
+	    g_param_spec_uint (NM_DEVICE_CONNECTIVITY, "", "",
+	                       NM_CONNECTIVITY_UNKNOWN, NM_CONNECTIVITY_FULL, NM_CONNECTIVITY_UNKNOWN,
+	                       G_PARAM_READABLE |
+	                       G_PARAM_STATIC_STRINGS);
 	obj_properties[PROP_SLAVES] =
 	    g_param_spec_boxed (NM_DEVICE_SLAVES, "", "",
 	                        G_TYPE_STRV,
@@ -13402,6 +13595,10 @@ nm_device_class_init (NMDeviceClass *klass)
 	                                        "Delete", impl_device_delete,
 	                                        NULL);
 
+	/* Device.Statistics also has the deprecated "PropertiesChanged" signal,
+	 * but it is not rate-limited with nm_exported_object_class_set_min_notify_interval().
+	 * The counters are only updated every RefreshRateMs (at least 200 msec), which
+	 * the client chooses; a further limit would break that guarantee. */
 	nm_exported_object_class_add_interface (NM_EXPORTED_OBJECT_CLASS (klass),
 	                                        NMDBUS_TYPE_DEVICE_STATISTICS_SKELETON,
 	                                        NULL);
@@ -65,6 +65,7 @@
 #define NM_DEVICE_METERED          "metered"
 #define NM_DEVICE_LLDP_NEIGHBORS  "lldp-neighbors"
 #define NM_DEVICE_REAL             "real"
+#define NM_DEVICE_CONNECTIVITY     "connectivity"
 
 /* the "slaves" property is internal in the parent class, but exposed
  * by the derived classes NMDeviceBond, NMDeviceBridge and NMDeviceTeam.
@@ -288,7 +289,7 @@ typedef struct {
 
 	const char *(*get_type_description) (NMDevice *self);
 
-	NMMatchSpecMatchType (* spec_match_list)   (NMDevice *self, const GSList *specs);
+	NMMatchSpecMatchType (* spec_match_list)   (NMDevice *self, const NMMatchSpecCompiled *specs);
 
 	/* Update the connection with currently configured L2 settings */
 	void            (* update_connection) (NMDevice *device, NMConnection *connection);
@@ -359,6 +360,10 @@ NMDeviceType    nm_device_get_device_type       (NMDevice *dev);
 NMLinkType      nm_device_get_link_type         (NMDevice *dev);
 NMMetered       nm_device_get_metered           (NMDevice *dev);
 
+NMConnectivityState nm_device_get_connectivity_state (NMDevice *self);
+void                nm_device_set_connectivity_state (NMDevice *self,
+                                                      NMConnectivityState state);
+
 int             nm_device_get_priority          (NMDevice *dev);
 guint32         nm_device_get_ip4_route_metric  (NMDevice *dev);
 guint32         nm_device_get_ip6_route_metric  (NMDevice *dev);
@@ -428,7 +433,8 @@ gboolean nm_device_uses_assumed_connection (NMDevice *device);
 
 gboolean nm_device_unmanage_on_quit (NMDevice *self);
 
-gboolean nm_device_spec_match_list (NMDevice *device, const GSList *specs);
+gboolean nm_device_spec_match_list (NMDevice *device, const NMMatchSpecCompiled *specs);
+guint nm_device_get_spec_match_generation (NMDevice *device);
 
 gboolean nm_device_is_activating (NMDevice *dev);
 gboolean nm_device_autoconnect_allowed (NMDevice *self);
@@ -20,6 +20,10 @@
 
 #include "nm-default.h"
 
+#include <netinet/if_ether.h>
+#include <netpacket/packet.h>
+#include <sys/socket.h>
+
 #include "devices/nm-arping-manager.h"
 #include "platform/tests/test-common.h"
 
@@ -67,11 +71,6 @@ test_arping_common (test_fixture *fixture, TestInfo *info)
 	GMainLoop *loop;
 	int i;
 
-	if (!nm_utils_find_helper ("arping", NULL, NULL)) {
-		g_test_skip ("arping binary is missing");
-		return;
-	}
-
 	manager = nm_arping_manager_new (fixture->ifindex0);
 	g_assert (manager != NULL);
 
@@ -118,6 +117,67 @@ test_arping_2 (test_fixture *fixture, gconstpointer user_data)
 	test_arping_common (fixture, &info);
 }
 
+/* Send an RFC 5227 probe for @address from @ifindex, as another host
+ * probing for the same address at the same time would do. */
+static void
+send_probe (int ifindex, in_addr_t address)
+{
+	const NMPlatformLink *plink;
+	struct sockaddr_ll sll = {
+		.sll_family = AF_PACKET,
+		.sll_protocol = htons (ETH_P_ARP),
+		.sll_ifindex = ifindex,
+		.sll_halen = ETH_ALEN,
+		.sll_addr = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff },
+	};
+	struct ether_arp arp = {
+		.ea_hdr = {
+			.ar_hrd = htons (ARPHRD_ETHER),
+			.ar_pro = htons (ETHERTYPE_IP),
+			.ar_hln = ETH_ALEN,
+			.ar_pln = sizeof (in_addr_t),
+			.ar_op = htons (ARPOP_REQUEST),
+		},
+	};
+	int fd;
+
+	plink = nm_platform_link_get (NM_PLATFORM_GET, ifindex);
+	g_assert (plink);
+	g_assert_cmpint (plink->addr.len, ==, ETH_ALEN);
+
+	memcpy (arp.arp_sha, plink->addr.data, ETH_ALEN);
+	memcpy (arp.arp_tpa, &address, sizeof (in_addr_t));
+
+	fd = socket (AF_PACKET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	g_assert_cmpint (fd, >=, 0);
+	g_assert_cmpint (sendto (fd, &arp, sizeof (arp), 0, (struct sockaddr *) &sll, sizeof (sll)), ==, sizeof (arp));
+	close (fd);
+}
+
+static void
+test_arping_conflicting_probe (test_fixture *fixture, gconstpointer user_data)
+{
+	gs_unref_object NMArpingManager *manager = NULL;
+	GMainLoop *loop;
+
+	manager = nm_arping_manager_new (fixture->ifindex0);
+	g_assert (nm_arping_manager_add_address (manager, ADDR1));
+
+	loop = g_main_loop_new (NULL, FALSE);
+	g_signal_connect (manager, NM_ARPING_MANAGER_PROBE_TERMINATED,
+	                  G_CALLBACK (arping_manager_probe_terminated), loop);
+
+	/* nobody owns ADDR1, but another host probes for it. As that was the
+	 * only address, the probe terminates long before the timeout. */
+	g_assert (nm_arping_manager_start_probe (manager, 5000, NULL));
+	send_probe (fixture->ifindex1, ADDR1);
+	g_assert (nmtst_main_loop_run (loop, 2000));
+
+	g_assert (!nm_arping_manager_check_address (manager, ADDR1));
+
+	g_main_loop_unref (loop);
+}
+
 static void
 fixture_teardown (test_fixture *fixture, gconstpointer user_data)
 {
@@ -138,4 +198,5 @@ _nmtstp_setup_tests (void)
 {
 	g_test_add ("/arping/1", test_fixture, NULL, fixture_setup, test_arping_1, fixture_teardown);
 	g_test_add ("/arping/2", test_fixture, NULL, fixture_setup, test_arping_2, fixture_teardown);
+	g_test_add ("/arping/conflicting-probe", test_fixture, NULL, fixture_setup, test_arping_conflicting_probe, fixture_teardown);
 }
@@ -89,7 +89,11 @@ static guint signals[LAST_SIGNAL] = { 0 };
 typedef struct {
 	gint8             invalid_strength_counter;
 
-	GHashTable *      aps;
+	GHashTable *      aps;              /* D-Bus path => NMWifiAP */
+	GPtrArray *       aps_sorted;       /* all APs, sorted by id */
+	GHashTable *      aps_by_sup_path;  /* supplicant path => NMWifiAP */
+	GHashTable *      aps_by_ssid;      /* GBytes SSID => GPtrArray of NMWifiAP, sorted by id */
+	GHashTable *      ap_ssid_keys;     /* NMWifiAP => its key in aps_by_ssid (owned) */
 	NMWifiAP *        current_ap;
 	guint32           rate;
 	bool              enabled:1; /* rfkilled or not */
@@ -184,6 +188,12 @@ static void supplicant_iface_notify_current_bss (NMSupplicantInterface *iface,
 
 static void request_wireless_scan (NMDeviceWifi *self, GVariant *scan_options);
 
+static void wifi_station_changed_cb (NMPlatform *platform,
+                                     int ifindex,
+                                     int quality,
+                                     guint rate,
+                                     NMDeviceWifi *self);
+
 static void ap_add_remove (NMDeviceWifi *self,
                            guint signum,
                            NMWifiAP *ap,
@@ -208,6 +218,10 @@ constructed (GObject *object)
 
 	/* Connect to the supplicant manager */
 	priv->sup_mgr = g_object_ref (nm_supplicant_manager_get ());
+
+	g_signal_connect (NM_PLATFORM_GET, NM_PLATFORM_SIGNAL_WIFI_STATION_CHANGED,
+	                  G_CALLBACK (wifi_station_changed_cb),
+	                  self);
 }
 
 static gboolean
@@ -333,17 +347,118 @@ get_ap_by_path (NMDeviceWifi *self, const char *path)
 static NMWifiAP *
 get_ap_by_supplicant_path (NMDeviceWifi *self, const char *path)
 {
-	GHashTableIter iter;
-	NMWifiAP *ap;
-
 	g_return_val_if_fail (path != NULL, NULL);
+	return g_hash_table_lookup (NM_DEVICE_WIFI_GET_PRIVATE (self)->aps_by_sup_path, path);
+}
 
-	g_hash_table_iter_init (&iter, NM_DEVICE_WIFI_GET_PRIVATE (self)->aps);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &ap)) {
-		if (g_strcmp0 (path, nm_wifi_ap_get_supplicant_path (ap)) == 0)
-			return ap;
+/*****************************************************************************/
+
+/* The SSID index uses the SSID without a trailing NUL byte, so that lookups
+ * match like nm_utils_same_ssid(). APs without SSID are never compatible with
+ * a connection and are not indexed. */
+static GBytes *
+_ssid_key_new (const guint8 *ssid, gsize len)
+{
+	if (len && ssid[len - 1] == '\0')
+		len--;
+	if (!len)
+		return NULL;
+	return g_bytes_new (ssid, len);
+}
+
+static void
+_ap_index_ssid_add (NMDeviceWifi *self, NMWifiAP *ap)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	const GByteArray *ssid;
+	GBytes *key;
+	GPtrArray *bucket;
+	guint32 id;
+	guint i;
+
+	ssid = nm_wifi_ap_get_ssid (ap);
+	if (!ssid)
+		return;
+	key = _ssid_key_new (ssid->data, ssid->len);
+	if (!key)
+		return;
+
+	bucket = g_hash_table_lookup (priv->aps_by_ssid, key);
+	if (!bucket) {
+		bucket = g_ptr_array_new ();
+		g_hash_table_insert (priv->aps_by_ssid, g_bytes_ref (key), bucket);
 	}
-	return NULL;
+
+	/* Usually the AP is the newest one and goes to the end. */
+	id = nm_wifi_ap_get_id (ap);
+	for (i = bucket->len; i > 0; i--) {
+		if (nm_wifi_ap_get_id (bucket->pdata[i - 1]) < id)
+			break;
+	}
+	g_ptr_array_insert (bucket, i, ap);
+
+	g_hash_table_insert (priv->ap_ssid_keys, ap, key);
+}
+
+static void
+_ap_index_ssid_remove (NMDeviceWifi *self, NMWifiAP *ap)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	GBytes *key;
+	GPtrArray *bucket;
+
+	key = g_hash_table_lookup (priv->ap_ssid_keys, ap);
+	if (!key)
+		return;
+
+	bucket = g_hash_table_lookup (priv->aps_by_ssid, key);
+	if (bucket) {
+		g_ptr_array_remove (bucket, ap);
+		if (!bucket->len)
+			g_hash_table_remove (priv->aps_by_ssid, key);
+	}
+	g_hash_table_remove (priv->ap_ssid_keys, ap);
+}
+
+static void
+ap_ssid_changed_cb (NMWifiAP *ap, GParamSpec *pspec, NMDeviceWifi *self)
+{
+	_ap_index_ssid_remove (self, ap);
+	_ap_index_ssid_add (self, ap);
+}
+
+static void
+_ap_index_add (NMDeviceWifi *self, NMWifiAP *ap)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	const char *sup_path;
+
+	/* AP ids increase with every export, so the new AP is the last one. */
+	g_ptr_array_add (priv->aps_sorted, ap);
+
+	sup_path = nm_wifi_ap_get_supplicant_path (ap);
+	if (sup_path)
+		g_hash_table_insert (priv->aps_by_sup_path, (gpointer) sup_path, ap);
+
+	_ap_index_ssid_add (self, ap);
+	g_signal_connect (ap, "notify::" NM_WIFI_AP_SSID, G_CALLBACK (ap_ssid_changed_cb), self);
+}
+
+static void
+_ap_index_remove (NMDeviceWifi *self, NMWifiAP *ap)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	const char *sup_path;
+
+	g_signal_handlers_disconnect_by_func (ap, G_CALLBACK (ap_ssid_changed_cb), self);
+	_ap_index_ssid_remove (self, ap);
+
+	sup_path = nm_wifi_ap_get_supplicant_path (ap);
+	if (   sup_path
+	    && g_hash_table_lookup (priv->aps_by_sup_path, sup_path) == ap)
+		g_hash_table_remove (priv->aps_by_sup_path, sup_path);
+
+	g_ptr_array_remove (priv->aps_sorted, ap);
 }
 
 static void
@@ -399,13 +514,10 @@ set_current_ap (NMDeviceWifi *self, NMWifiAP *new_ap, gboolean recheck_available
 	_notify (self, PROP_ACTIVE_ACCESS_POINT);
 }
 
-static void
-periodic_update (NMDeviceWifi *self)
+static gboolean
+periodic_update_check (NMDeviceWifi *self)
 {
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
-	int ifindex = nm_device_get_ifindex (NM_DEVICE (self));
-	guint32 new_rate;
-	int percent;
 	NMDeviceState state;
 	guint32 supplicant_state;
 
@@ -414,7 +526,7 @@ periodic_update (NMDeviceWifi *self)
 	 */
 	state = nm_device_get_state (NM_DEVICE (self));
 	if (state != NM_DEVICE_STATE_ACTIVATED)
-		return;
+		return FALSE;
 
 	/* Only update current AP if we're actually talking to something, otherwise
 	 * assume the old one (if any) is still valid until we're told otherwise or
@@ -424,28 +536,71 @@ periodic_update (NMDeviceWifi *self)
 	if (   supplicant_state < NM_SUPPLICANT_INTERFACE_STATE_AUTHENTICATING
 	    || supplicant_state > NM_SUPPLICANT_INTERFACE_STATE_COMPLETED
 	    || nm_supplicant_interface_get_scanning (priv->sup_iface))
-		return;
+		return FALSE;
 
 	/* In AP mode we currently have nothing to do. */
 	if (priv->mode == NM_802_11_MODE_AP)
-		return;
+		return FALSE;
+
+	return TRUE;
+}
+
+static void
+periodic_update_apply (NMDeviceWifi *self, int percent, guint32 new_rate)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 
 	if (priv->current_ap) {
 		/* Smooth out the strength to work around crappy drivers */
-		percent = nm_platform_wifi_get_quality (NM_PLATFORM_GET, ifindex);
 		if (percent >= 0 || ++priv->invalid_strength_counter > 3) {
 			nm_wifi_ap_set_strength (priv->current_ap, (gint8) percent);
 			priv->invalid_strength_counter = 0;
 		}
 	}
 
-	new_rate = nm_platform_wifi_get_rate (NM_PLATFORM_GET, ifindex);
 	if (new_rate != priv->rate) {
 		priv->rate = new_rate;
 		_notify (self, PROP_BITRATE);
 	}
 }
 
+static void
+periodic_update (NMDeviceWifi *self)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	int ifindex = nm_device_get_ifindex (NM_DEVICE (self));
+	int percent = -1;
+
+	if (!periodic_update_check (self))
+		return;
+
+	/* The result arrives with wifi_station_changed_cb(). */
+	if (nm_platform_wifi_request_station (NM_PLATFORM_GET, ifindex))
+		return;
+
+	if (priv->current_ap)
+		percent = nm_platform_wifi_get_quality (NM_PLATFORM_GET, ifindex);
+	periodic_update_apply (self,
+	                       percent,
+	                       nm_platform_wifi_get_rate (NM_PLATFORM_GET, ifindex));
+}
+
+static void
+wifi_station_changed_cb (NMPlatform *platform,
+                         int ifindex,
+                         int quality,
+                         guint rate,
+                         NMDeviceWifi *self)
+{
+	if (ifindex != nm_device_get_ifindex (NM_DEVICE (self)))
+		return;
+
+	if (!periodic_update_check (self))
+		return;
+
+	periodic_update_apply (self, quality, rate);
+}
+
 static gboolean
 periodic_update_cb (gpointer user_data)
 {
@@ -467,11 +622,13 @@ ap_add_remove (NMDeviceWifi *self,
 		g_hash_table_insert (priv->aps,
 		                     (gpointer) nm_exported_object_export ((NMExportedObject *) ap),
 		                     g_object_ref (ap));
+		_ap_index_add (self, ap);
 	}
 
 	g_signal_emit (self, signals[signum], 0, ap);
 
 	if (signum == ACCESS_POINT_REMOVED) {
+		_ap_index_remove (self, ap);
 		g_hash_table_remove (priv->aps, nm_exported_object_get_path ((NMExportedObject *) ap));
 		nm_exported_object_unexport ((NMExportedObject *) ap);
 		g_object_unref (ap);
@@ -488,19 +645,17 @@ static void
 remove_all_aps (NMDeviceWifi *self)
 {
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
-	GHashTableIter iter;
-	NMWifiAP *ap;
 
-	if (!g_hash_table_size (priv->aps))
+	if (!priv->aps_sorted->len)
 		return;
 
 	set_current_ap (self, NULL, FALSE);
 
-again:
-	g_hash_table_iter_init (&iter, priv->aps);
-	if (g_hash_table_iter_next (&iter, NULL, (gpointer) &ap)) {
-		ap_add_remove (self, ACCESS_POINT_REMOVED, ap, FALSE);
-		goto again;
+	while (priv->aps_sorted->len) {
+		ap_add_remove (self,
+		               ACCESS_POINT_REMOVED,
+		               priv->aps_sorted->pdata[priv->aps_sorted->len - 1],
+		               FALSE);
 	}
 
 	nm_device_recheck_available_connections (NM_DEVICE (self));
@@ -653,25 +808,39 @@ check_connection_compatible (NMDevice *device, NMConnection *connection)
 
 static NMWifiAP *
 find_first_compatible_ap (NMDeviceWifi *self,
-                          NMConnection *connection,
-                          gboolean allow_unstable_order)
+                          NMConnection *connection)
 {
-	GHashTableIter iter;
-	NMWifiAP *ap;
-	NMWifiAP *cand_ap = NULL;
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	NMSettingWireless *s_wifi;
+	GBytes *ssid;
+	gs_unref_bytes GBytes *key = NULL;
+	GPtrArray *candidates;
+	guint i;
 
 	g_return_val_if_fail (connection != NULL, NULL);
 
-	g_hash_table_iter_init (&iter, NM_DEVICE_WIFI_GET_PRIVATE (self)->aps);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &ap)) {
-		if (!nm_wifi_ap_check_compatible (ap, connection))
-			continue;
-		if (allow_unstable_order)
+	s_wifi = nm_connection_get_setting_wireless (connection);
+	if (!s_wifi)
+		return NULL;
+	ssid = nm_setting_wireless_get_ssid (s_wifi);
+	if (!ssid)
+		return NULL;
+
+	/* Only APs with the connection's SSID can be compatible. */
+	key = _ssid_key_new (g_bytes_get_data (ssid, NULL), g_bytes_get_size (ssid));
+	candidates = key ? g_hash_table_lookup (priv->aps_by_ssid, key) : NULL;
+	if (!candidates)
+		return NULL;
+
+	/* The candidates are sorted by id, so the first compatible AP from the
+	 * end is the one with the highest id. */
+	for (i = candidates->len; i > 0; i--) {
+		NMWifiAP *ap = candidates->pdata[i - 1];
+
+		if (nm_wifi_ap_check_compatible (ap, connection))
 			return ap;
-		if (!cand_ap || (nm_wifi_ap_get_id (cand_ap) < nm_wifi_ap_get_id (ap)))
-			cand_ap = ap;
 	}
-	return cand_ap;
+	return NULL;
 }
 
 static gboolean
@@ -716,7 +885,7 @@ check_connection_available (NMDevice *device,
 		return TRUE;
 
 	/* check at least one AP is compatible with this connection */
-	return !!find_first_compatible_ap (NM_DEVICE_WIFI (device), connection, TRUE);
+	return !!find_first_compatible_ap (NM_DEVICE_WIFI (device), connection);
 }
 
 static gboolean
@@ -792,7 +961,7 @@ complete_connection (NMDevice *device,
 		}
 
 		/* Find a compatible AP in the scan list */
-		ap = find_first_compatible_ap (self, connection, FALSE);
+		ap = find_first_compatible_ap (self, connection);
 
 		/* If we still don't have an AP, then the WiFI settings needs to be
 		 * fully specified by the client.  Might not be able to find an AP
@@ -987,7 +1156,7 @@ can_auto_connect (NMDevice *device,
 			return FALSE;
 	}
 
-	ap = find_first_compatible_ap (self, connection, FALSE);
+	ap = find_first_compatible_ap (self, connection);
 	if (ap) {
 		/* All good; connection is usable */
 		NM_SET_OUT (specific_object, g_strdup (nm_exported_object_get_path (NM_EXPORTED_OBJECT (ap))));
@@ -997,66 +1166,42 @@ can_auto_connect (NMDevice *device,
 	return FALSE;
 }
 
-static gint
-ap_id_compare (NMWifiAP *a, NMWifiAP *b)
+static const char **
+get_sorted_ap_paths (NMDeviceWifi *self, gboolean include_without_ssid)
 {
-	guint32 a_id = nm_wifi_ap_get_id (a);
-	guint32 b_id = nm_wifi_ap_get_id (b);
-
-	return a_id < b_id ? -1 : (a_id == b_id ? 0 : 1);
-}
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	const char **paths;
+	guint i, j;
 
-static GSList *
-get_sorted_ap_list (NMDeviceWifi *self)
-{
-	GSList *sorted = NULL;
-	GHashTableIter iter;
-	NMWifiAP *ap;
+	paths = g_new (const char *, priv->aps_sorted->len + 1);
+	for (i = 0, j = 0; i < priv->aps_sorted->len; i++) {
+		NMWifiAP *ap = priv->aps_sorted->pdata[i];
 
-	g_hash_table_iter_init (&iter, NM_DEVICE_WIFI_GET_PRIVATE (self)->aps);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &ap))
-		sorted = g_slist_prepend (sorted, ap);
-	return g_slist_sort (sorted, (GCompareFunc) ap_id_compare);
+		if (include_without_ssid || nm_wifi_ap_get_ssid (ap))
+			paths[j++] = nm_exported_object_get_path (NM_EXPORTED_OBJECT (ap));
+	}
+	paths[j] = NULL;
+	return paths;
 }
 
 static void
 impl_device_wifi_get_access_points (NMDeviceWifi *self,
                                     GDBusMethodInvocation *context)
 {
-	GSList *sorted, *iter;
-	GPtrArray *paths;
-
-	paths = g_ptr_array_new ();
-	sorted = get_sorted_ap_list (self);
-	for (iter = sorted; iter; iter = iter->next) {
-		NMWifiAP *ap = NM_WIFI_AP (iter->data);
-
-		if (nm_wifi_ap_get_ssid (ap))
-			g_ptr_array_add (paths, g_strdup (nm_exported_object_get_path (NM_EXPORTED_OBJECT (ap))));
-	}
-	g_ptr_array_add (paths, NULL);
-	g_slist_free (sorted);
+	gs_free const char **paths = NULL;
 
-	g_dbus_method_invocation_return_value (context, g_variant_new ("(^ao)", (char **) paths->pdata));
-	g_ptr_array_unref (paths);
+	paths = get_sorted_ap_paths (self, FALSE);
+	g_dbus_method_invocation_return_value (context, g_variant_new ("(^ao)", paths));
 }
 
 static void
 impl_device_wifi_get_all_access_points (NMDeviceWifi *self,
                                         GDBusMethodInvocation *context)
 {
-	GSList *sorted, *iter;
-	GPtrArray *paths;
+	gs_free const char **paths = NULL;
 
-	paths = g_ptr_array_new ();
-	sorted = get_sorted_ap_list (self);
-	for (iter = sorted; iter; iter = iter->next)
-		g_ptr_array_add (paths, g_strdup (nm_exported_object_get_path (NM_EXPORTED_OBJECT (iter->data))));
-	g_ptr_array_add (paths, NULL);
-	g_slist_free (sorted);
-
-	g_dbus_method_invocation_return_value (context, g_variant_new ("(^ao)", (char **) paths->pdata));
-	g_ptr_array_unref (paths);
+	paths = get_sorted_ap_paths (self, TRUE);
+	g_dbus_method_invocation_return_value (context, g_variant_new ("(^ao)", paths));
 }
 
 static void
@@ -1523,17 +1668,15 @@ ap_list_dump (gpointer user_data)
 {
 	NMDeviceWifi *self = NM_DEVICE_WIFI (user_data);
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
-	GSList *sorted, *iter;
+	guint i;
 
 	priv->ap_dump_id = 0;
 	_LOGD (LOGD_WIFI_SCAN, "APs: [now:%u last:%u next:%u]",
 	       nm_utils_get_monotonic_timestamp_s (),
 	       priv->last_scan,
 	       priv->scheduled_scan_time);
-	sorted = get_sorted_ap_list (self);
-	for (iter = sorted; iter; iter = iter->next)
-		nm_wifi_ap_dump (NM_WIFI_AP (iter->data), "dump    ", nm_device_get_iface (NM_DEVICE (self)));
-	g_slist_free (sorted);
+	for (i = 0; i < priv->aps_sorted->len; i++)
+		nm_wifi_ap_dump (priv->aps_sorted->pdata[i], "dump    ", nm_device_get_iface (NM_DEVICE (self)));
 	return G_SOURCE_REMOVE;
 }
 
@@ -1605,6 +1748,15 @@ supplicant_iface_new_bss_cb (NMSupplicantInterface *iface,
 	if (NM_DEVICE_WIFI_GET_PRIVATE (self)->mode == NM_802_11_MODE_AP)
 		return;
 
+	/* The supplicant re-announces all known BSSs after each scan; update
+	 * those in place instead of creating a temporary AP. */
+	found_ap = get_ap_by_supplicant_path (self, object_path);
+	if (found_ap) {
+		nm_wifi_ap_update_from_properties (found_ap, object_path, properties);
+		nm_wifi_ap_dump (found_ap, "updated ", nm_device_get_iface (NM_DEVICE (self)));
+		goto out;
+	}
+
 	ap = nm_wifi_ap_new_from_properties (object_path, properties);
 	if (!ap) {
 		_LOGD (LOGD_WIFI_SCAN, "invalid AP properties received for %s", object_path);
@@ -1629,17 +1781,11 @@ supplicant_iface_new_bss_cb (NMSupplicantInterface *iface,
 		}
 	}
 
-	found_ap = get_ap_by_supplicant_path (self, object_path);
-	if (found_ap) {
-		nm_wifi_ap_dump (ap, "updated ", nm_device_get_iface (NM_DEVICE (self)));
-		nm_wifi_ap_update_from_properties (found_ap, object_path, properties);
-	} else {
-		nm_wifi_ap_dump (ap, "added   ", nm_device_get_iface (NM_DEVICE (self)));
-		ap_add_remove (self, ACCESS_POINT_ADDED, ap, TRUE);
-	}
-
+	nm_wifi_ap_dump (ap, "added   ", nm_device_get_iface (NM_DEVICE (self)));
+	ap_add_remove (self, ACCESS_POINT_ADDED, ap, TRUE);
 	g_object_unref (ap);
 
+out:
 	/* Update the current AP if the supplicant notified a current BSS change
 	 * before it sent the current BSS's scan result.
 	 */
@@ -2461,7 +2607,7 @@ act_stage1_prepare (NMDevice *device, NMDeviceStateReason *reason)
 		if (ap)
 			goto done;
 
-		ap = find_first_compatible_ap (self, connection, FALSE);
+		ap = find_first_compatible_ap (self, connection);
 	}
 
 	if (ap) {
@@ -3071,6 +3217,12 @@ nm_device_wifi_init (NMDeviceWifi *self)
 
 	priv->mode = NM_802_11_MODE_INFRA;
 	priv->aps = g_hash_table_new (g_str_hash, g_str_equal);
+	priv->aps_sorted = g_ptr_array_new ();
+	priv->aps_by_sup_path = g_hash_table_new (g_str_hash, g_str_equal);
+	priv->aps_by_ssid = g_hash_table_new_full (g_bytes_hash, g_bytes_equal,
+	                                           (GDestroyNotify) g_bytes_unref,
+	                                           (GDestroyNotify) g_ptr_array_unref);
+	priv->ap_ssid_keys = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_bytes_unref);
 }
 
 static void
@@ -3080,6 +3232,7 @@ dispose (GObject *object)
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 
 	nm_clear_g_source (&priv->periodic_source_id);
+	g_signal_handlers_disconnect_by_func (NM_PLATFORM_GET, G_CALLBACK (wifi_station_changed_cb), self);
 
 	wifi_secrets_cancel (self);
 
@@ -3103,6 +3256,10 @@ finalize (GObject *object)
 	nm_assert (g_hash_table_size (priv->aps) == 0);
 
 	g_hash_table_unref (priv->aps);
+	g_ptr_array_unref (priv->aps_sorted);
+	g_hash_table_unref (priv->aps_by_sup_path);
+	g_hash_table_unref (priv->aps_by_ssid);
+	g_hash_table_unref (priv->ap_ssid_keys);
 
 	g_free (priv->hw_addr_scan);
 
@@ -1036,5 +1036,10 @@ nm_wifi_ap_class_init (NMWifiAPClass *ap_class)
 	nm_exported_object_class_add_interface (NM_EXPORTED_OBJECT_CLASS (ap_class),
 	                                        NMDBUS_TYPE_ACCESS_POINT_SKELETON,
 	                                        NULL);
+
+	/* the strength changes with every scan result; don't flood clients. */
+	nm_exported_object_class_set_min_notify_interval (NM_EXPORTED_OBJECT_CLASS (ap_class),
+	                                                  NM_WIFI_AP_STRENGTH,
+	                                                  1000);
 }
 
@@ -33,4 +33,29 @@
 
 /*****************************************************************************/
 
+/* The helper first tries to notify NetworkManager through a SOCK_SEQPACKET
+ * unix socket, falling back to the D-Bus method above.
+ *
+ * It sends a single message: a NMDhcpHelperEventHeader followed by
+ * @n_options entries, each made of a NMDhcpHelperEventOption and then the
+ * name and value bytes, without trailing NUL. Integers are in host byte
+ * order. Once the event is handled, the listener replies with one byte
+ * and closes the connection. */
+
+#define NM_DHCP_HELPER_EVENT_SOCKET_PATH        NMRUNDIR "/private-dhcp-event"
+#define NM_DHCP_HELPER_EVENT_MAGIC              0x4e4d4845u /* "NMHE" */
+#define NM_DHCP_HELPER_EVENT_MAX_SIZE           (64 * 1024)
+
+typedef struct {
+	guint32 magic;
+	guint32 n_options;
+} NMDhcpHelperEventHeader;
+
+typedef struct {
+	guint16 name_len;
+	guint16 value_len;
+} NMDhcpHelperEventOption;
+
+/*****************************************************************************/
+
 #endif /* __NM_DHCP_HELPER_API_H__ */
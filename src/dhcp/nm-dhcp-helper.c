@@ -24,6 +24,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <signal.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #include "nm-utils/nm-vpn-plugin-macros.h"
 
@@ -64,6 +67,18 @@
 
 static const char * ignore[] = {"PATH", "SHLVL", "_", "PWD", "dhc_dbus", NULL};
 
+static gboolean
+ignore_variable (const char *name)
+{
+	const char **p;
+
+	for (p = ignore; *p; p++) {
+		if (strncmp (name, *p, strlen (*p)) == 0)
+			return TRUE;
+	}
+	return FALSE;
+}
+
 static GVariant *
 build_signal_parameters (void)
 {
@@ -74,7 +89,7 @@ build_signal_parameters (void)
 
 	/* List environment and format for dbus dict */
 	for (item = environ; *item; item++) {
-		char *name, *val, **p;
+		char *name, *val;
 
 		/* Split on the = */
 		name = g_strdup (*item);
@@ -84,10 +99,8 @@ build_signal_parameters (void)
 		*val++ = '\0';
 
 		/* Ignore non-DCHP-related environment variables */
-		for (p = (char **) ignore; *p; p++) {
-			if (strncmp (name, *p, strlen (*p)) == 0)
-				goto next;
-		}
+		if (ignore_variable (name))
+			goto next;
 
 		/* Value passed as a byte array rather than a string, because there are
 		 * no character encoding guarantees with DHCP, and D-Bus requires
@@ -108,6 +121,127 @@ build_signal_parameters (void)
 	return g_variant_ref_sink (g_variant_new ("(a{sv})", &builder));
 }
 
+/* Encode the environment in the format of the event channel, see
+ * nm-dhcp-helper-api.h. Returns %NULL if the message would be too large. */
+static GByteArray *
+build_event_message (void)
+{
+	GByteArray *buf;
+	NMDhcpHelperEventHeader header = {
+		.magic = NM_DHCP_HELPER_EVENT_MAGIC,
+	};
+	char **item;
+
+	buf = g_byte_array_sized_new (4096);
+	g_byte_array_append (buf, (const guint8 *) &header, sizeof (header));
+
+	for (item = environ; *item; item++) {
+		NMDhcpHelperEventOption option;
+		const char *val;
+		gs_free char *name = NULL;
+		gsize name_len, val_len;
+
+		val = strchr (*item, '=');
+		if (!val || val == *item)
+			continue;
+		name_len = val - *item;
+		name = g_strndup (*item, name_len);
+		if (ignore_variable (name))
+			continue;
+		val++;
+		val_len = strlen (val);
+
+		if (   name_len > G_MAXUINT16
+		    || val_len > G_MAXUINT16
+		    || buf->len + sizeof (option) + name_len + val_len > NM_DHCP_HELPER_EVENT_MAX_SIZE) {
+			g_byte_array_free (buf, TRUE);
+			return NULL;
+		}
+
+		option.name_len = name_len;
+		option.value_len = val_len;
+		g_byte_array_append (buf, (const guint8 *) &option, sizeof (option));
+		g_byte_array_append (buf, (const guint8 *) *item, name_len);
+		g_byte_array_append (buf, (const guint8 *) val, val_len);
+		header.n_options++;
+	}
+
+	memcpy (buf->data, &header, sizeof (header));
+	return buf;
+}
+
+typedef enum {
+	NOTIFY_EVENT_OK,
+	NOTIFY_EVENT_UNAVAILABLE,
+	NOTIFY_EVENT_FAILED,
+} NotifyEventResult;
+
+/* Send the event over the SOCK_SEQPACKET channel and wait for the
+ * acknowledgement. NOTIFY_EVENT_UNAVAILABLE means that nothing was sent,
+ * and the D-Bus interface should be tried instead. */
+static NotifyEventResult
+notify_event (void)
+{
+	struct sockaddr_un addr = {
+		.sun_family = AF_UNIX,
+		.sun_path = NM_DHCP_HELPER_EVENT_SOCKET_PATH,
+	};
+	struct timeval tv = { .tv_sec = 1 };
+	GByteArray *buf;
+	guint8 ack;
+	ssize_t n;
+	int fd, errsv;
+	NotifyEventResult result = NOTIFY_EVENT_UNAVAILABLE;
+
+	buf = build_event_message ();
+	if (!buf) {
+		_LOGi ("event too large for the event socket");
+		return NOTIFY_EVENT_UNAVAILABLE;
+	}
+
+	fd = socket (AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		errsv = errno;
+		_LOGi ("could not create event socket: %s", strerror (errsv));
+		goto out;
+	}
+
+	setsockopt (fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof (tv));
+	setsockopt (fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof (tv));
+
+	if (connect (fd, (struct sockaddr *) &addr, sizeof (addr)) < 0) {
+		errsv = errno;
+		_LOGi ("could not connect to %s: %s", NM_DHCP_HELPER_EVENT_SOCKET_PATH, strerror (errsv));
+		goto out;
+	}
+
+	if (send (fd, buf->data, buf->len, MSG_NOSIGNAL) != (ssize_t) buf->len) {
+		errsv = errno;
+		_LOGi ("could not send event: %s", strerror (errsv));
+		goto out;
+	}
+
+	/* From now on the event may have been handled, don't send it twice. */
+	result = NOTIFY_EVENT_FAILED;
+
+	do {
+		n = recv (fd, &ack, sizeof (ack), 0);
+	} while (n < 0 && errno == EINTR);
+	if (n != sizeof (ack)) {
+		errsv = errno;
+		_LOGE ("no acknowledgement for event: %s", n < 0 ? strerror (errsv) : "connection closed");
+		goto out;
+	}
+
+	result = NOTIFY_EVENT_OK;
+
+out:
+	if (fd >= 0)
+		close (fd);
+	g_byte_array_free (buf, TRUE);
+	return result;
+}
+
 static void
 kill_pid (void)
 {
@@ -134,6 +268,17 @@ main (int argc, char *argv[])
 	guint try_count = 0;
 	gint64 time_end;
 
+	switch (notify_event ()) {
+	case NOTIFY_EVENT_OK:
+		return EXIT_SUCCESS;
+	case NOTIFY_EVENT_FAILED:
+		kill_pid ();
+		return EXIT_FAILURE;
+	case NOTIFY_EVENT_UNAVAILABLE:
+		/* an older NetworkManager, try D-Bus. */
+		break;
+	}
+
 	nm_g_type_init ();
 
 	/* FIXME: g_dbus_connection_new_for_address_sync() tries to connect to the socket in
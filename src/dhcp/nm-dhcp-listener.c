@@ -22,6 +22,8 @@
 #include "nm-dhcp-listener.h"
 
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <sys/wait.h>
 #include <signal.h>
 #include <string.h>
@@ -60,6 +62,10 @@ typedef struct {
 	gulong              new_conn_id;
 	gulong              dis_conn_id;
 	GHashTable *        connections;
+
+	int                 event_fd;
+	guint               event_id;
+	GSList *            event_conns;
 } NMDhcpListenerPrivate;
 
 struct _NMDhcpListener {
@@ -135,31 +141,13 @@ get_option (GVariant *options, const char *key)
 }
 
 static void
-_method_call (GDBusConnection *connection,
-              const char *sender,
-              const char *object_path,
-              const char *interface_name,
-              const char *method_name,
-              GVariant *parameters,
-              GDBusMethodInvocation *invocation,
-              gpointer user_data)
+handle_event (NMDhcpListener *self, GVariant *options)
 {
-	NMDhcpListener *self = NM_DHCP_LISTENER (user_data);
 	char *iface = NULL;
 	char *pid_str = NULL;
 	char *reason = NULL;
 	gint pid;
 	gboolean handled = FALSE;
-	GVariant *options;
-
-	if (!nm_streq0 (interface_name, NM_DHCP_HELPER_SERVER_INTERFACE_NAME))
-		g_return_if_reached ();
-	if (!nm_streq0 (method_name, NM_DHCP_HELPER_SERVER_METHOD_NOTIFY))
-		g_return_if_reached ();
-	if (!g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(a{sv})")))
-		g_return_if_reached ();
-
-	g_variant_get (parameters, "(@a{sv})", &options);
 
 	iface = get_option (options, "interface");
 	if (iface == NULL) {
@@ -193,6 +181,30 @@ out:
 	g_free (iface);
 	g_free (pid_str);
 	g_free (reason);
+}
+
+static void
+_method_call (GDBusConnection *connection,
+              const char *sender,
+              const char *object_path,
+              const char *interface_name,
+              const char *method_name,
+              GVariant *parameters,
+              GDBusMethodInvocation *invocation,
+              gpointer user_data)
+{
+	NMDhcpListener *self = NM_DHCP_LISTENER (user_data);
+	GVariant *options;
+
+	if (!nm_streq0 (interface_name, NM_DHCP_HELPER_SERVER_INTERFACE_NAME))
+		g_return_if_reached ();
+	if (!nm_streq0 (method_name, NM_DHCP_HELPER_SERVER_METHOD_NOTIFY))
+		g_return_if_reached ();
+	if (!g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(a{sv})")))
+		g_return_if_reached ();
+
+	g_variant_get (parameters, "(@a{sv})", &options);
+	handle_event (self, options);
 	g_variant_unref (options);
 	g_dbus_method_invocation_return_value (invocation, NULL);
 }
@@ -287,6 +299,214 @@ dis_connection_cb (NMBusManager *mgr,
 
 /*****************************************************************************/
 
+typedef struct {
+	NMDhcpListener *self;
+	int fd;
+	guint watch_id;
+} EventConn;
+
+static void
+event_conn_free (EventConn *conn)
+{
+	nm_clear_g_source (&conn->watch_id);
+	close (conn->fd);
+	g_slice_free (EventConn, conn);
+}
+
+static void
+event_conn_close (EventConn *conn)
+{
+	NMDhcpListenerPrivate *priv = NM_DHCP_LISTENER_GET_PRIVATE (conn->self);
+
+	priv->event_conns = g_slist_remove (priv->event_conns, conn);
+	conn->watch_id = 0;
+	event_conn_free (conn);
+}
+
+/* Parse a message of the helper event channel, see nm-dhcp-helper-api.h.
+ * The options are returned in the same form as the D-Bus Notify call. */
+GVariant *
+nm_dhcp_listener_event_parse (const guint8 *buf, gsize len)
+{
+	NMDhcpHelperEventHeader header;
+	NMDhcpHelperEventOption option;
+	GVariantBuilder builder;
+	gs_free char *name = NULL;
+	gsize pos;
+	guint32 i;
+
+	if (len < sizeof (header))
+		return NULL;
+	memcpy (&header, buf, sizeof (header));
+	if (header.magic != NM_DHCP_HELPER_EVENT_MAGIC)
+		return NULL;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+
+	pos = sizeof (header);
+	for (i = 0; i < header.n_options; i++) {
+		if (len - pos < sizeof (option))
+			goto fail;
+		memcpy (&option, &buf[pos], sizeof (option));
+		pos += sizeof (option);
+
+		if (   option.name_len == 0
+		    || len - pos < (gsize) option.name_len + option.value_len)
+			goto fail;
+
+		g_free (name);
+		name = g_strndup ((const char *) &buf[pos], option.name_len);
+		pos += option.name_len;
+
+		g_variant_builder_add (&builder, "{sv}",
+		                       name,
+		                       g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE,
+		                                                  &buf[pos], option.value_len, 1));
+		pos += option.value_len;
+	}
+
+	if (pos != len)
+		goto fail;
+
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
+
+fail:
+	g_variant_builder_clear (&builder);
+	return NULL;
+}
+
+static gboolean
+event_conn_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	EventConn *conn = user_data;
+	NMDhcpListener *self = conn->self;
+	gs_free guint8 *buf = NULL;
+	gs_unref_variant GVariant *options = NULL;
+	struct iovec iov;
+	struct msghdr msg = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+	};
+	const guint8 ack = 0;
+	ssize_t n;
+	int errsv;
+
+	buf = g_malloc (NM_DHCP_HELPER_EVENT_MAX_SIZE);
+	iov.iov_base = buf;
+	iov.iov_len = NM_DHCP_HELPER_EVENT_MAX_SIZE;
+
+	n = recvmsg (conn->fd, &msg, MSG_DONTWAIT);
+	if (n < 0) {
+		errsv = errno;
+		if (NM_IN_SET (errsv, EAGAIN, EINTR))
+			return G_SOURCE_CONTINUE;
+		_LOGW ("dhcp-event: error reading event: %s", strerror (errsv));
+		goto out;
+	}
+	if (n == 0) {
+		/* the helper went away without sending anything. */
+		goto out;
+	}
+
+	if (msg.msg_flags & MSG_TRUNC) {
+		_LOGW ("dhcp-event: event message too large");
+		goto out;
+	}
+
+	options = nm_dhcp_listener_event_parse (buf, n);
+	if (!options) {
+		_LOGW ("dhcp-event: invalid event message");
+		goto out;
+	}
+
+	handle_event (self, options);
+
+	if (send (conn->fd, &ack, sizeof (ack), MSG_DONTWAIT | MSG_NOSIGNAL) < 0) {
+		errsv = errno;
+		_LOGD ("dhcp-event: error acknowledging event: %s", strerror (errsv));
+	}
+
+out:
+	event_conn_close (conn);
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+event_accept_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	NMDhcpListener *self = user_data;
+	NMDhcpListenerPrivate *priv = NM_DHCP_LISTENER_GET_PRIVATE (self);
+	GIOChannel *conn_channel;
+	EventConn *conn;
+	struct ucred cred;
+	socklen_t cred_len = sizeof (cred);
+	int fd;
+
+	fd = accept4 (priv->event_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+	if (fd < 0)
+		return G_SOURCE_CONTINUE;
+
+	/* like the D-Bus private server, only accept events from root. */
+	if (   getsockopt (fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) < 0
+	    || cred.uid != 0) {
+		_LOGW ("dhcp-event: rejecting event connection from unprivileged peer");
+		close (fd);
+		return G_SOURCE_CONTINUE;
+	}
+
+	conn = g_slice_new0 (EventConn);
+	conn->self = self;
+	conn->fd = fd;
+
+	conn_channel = g_io_channel_unix_new (fd);
+	conn->watch_id = g_io_add_watch (conn_channel,
+	                                 G_IO_IN | G_IO_ERR | G_IO_HUP,
+	                                 event_conn_cb, conn);
+	g_io_channel_unref (conn_channel);
+
+	priv->event_conns = g_slist_prepend (priv->event_conns, conn);
+	return G_SOURCE_CONTINUE;
+}
+
+/* The socket is created by NetworkManager itself, it is not socket-activated
+ * through a systemd unit. The helper only runs while NetworkManager manages
+ * a DHCP client, and it falls back to D-Bus when the socket is missing. */
+static void
+event_socket_setup (NMDhcpListener *self)
+{
+	NMDhcpListenerPrivate *priv = NM_DHCP_LISTENER_GET_PRIVATE (self);
+	struct sockaddr_un addr = {
+		.sun_family = AF_UNIX,
+		.sun_path = NM_DHCP_HELPER_EVENT_SOCKET_PATH,
+	};
+	GIOChannel *channel;
+	int errsv;
+
+	priv->event_fd = socket (AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	if (priv->event_fd < 0) {
+		errsv = errno;
+		_LOGW ("failure to create event socket: %s", strerror (errsv));
+		return;
+	}
+
+	unlink (NM_DHCP_HELPER_EVENT_SOCKET_PATH);
+	if (   bind (priv->event_fd, (struct sockaddr *) &addr, sizeof (addr)) < 0
+	    || chmod (NM_DHCP_HELPER_EVENT_SOCKET_PATH, 0600) < 0
+	    || listen (priv->event_fd, 64) < 0) {
+		errsv = errno;
+		_LOGW ("failure to listen on %s: %s", NM_DHCP_HELPER_EVENT_SOCKET_PATH, strerror (errsv));
+		close (priv->event_fd);
+		priv->event_fd = -1;
+		return;
+	}
+
+	channel = g_io_channel_unix_new (priv->event_fd);
+	priv->event_id = g_io_add_watch (channel, G_IO_IN, event_accept_cb, self);
+	g_io_channel_unref (channel);
+}
+
+/*****************************************************************************/
+
 static void
 nm_dhcp_listener_init (NMDhcpListener *self)
 {
@@ -294,6 +514,7 @@ nm_dhcp_listener_init (NMDhcpListener *self)
 
 	/* Maps GDBusConnection :: signal-id */
 	priv->connections = g_hash_table_new (NULL, NULL);
+	priv->event_fd = -1;
 
 	priv->dbus_mgr = nm_bus_manager_get ();
 
@@ -307,6 +528,9 @@ nm_dhcp_listener_init (NMDhcpListener *self)
 	                                      NM_BUS_MANAGER_PRIVATE_CONNECTION_DISCONNECTED "::" PRIV_SOCK_TAG,
 	                                      G_CALLBACK (dis_connection_cb),
 	                                      self);
+
+	/* The lightweight channel preferred by the helper. */
+	event_socket_setup (self);
 }
 
 static void
@@ -320,6 +544,15 @@ dispose (GObject *object)
 
 	g_clear_pointer (&priv->connections, g_hash_table_destroy);
 
+	g_slist_free_full (priv->event_conns, (GDestroyNotify) event_conn_free);
+	priv->event_conns = NULL;
+	nm_clear_g_source (&priv->event_id);
+	if (priv->event_fd >= 0) {
+		close (priv->event_fd);
+		priv->event_fd = -1;
+		unlink (NM_DHCP_HELPER_EVENT_SOCKET_PATH);
+	}
+
 	G_OBJECT_CLASS (nm_dhcp_listener_parent_class)->dispose (object);
 }
 
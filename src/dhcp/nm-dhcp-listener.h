@@ -33,4 +33,7 @@ GType nm_dhcp_listener_get_type (void);
 
 NMDhcpListener *nm_dhcp_listener_get (void);
 
+/* for testing */
+GVariant *nm_dhcp_listener_event_parse (const guint8 *buf, gsize len);
+
 #endif /* __NETWORKMANAGER_DHCP_LISTENER_H__ */
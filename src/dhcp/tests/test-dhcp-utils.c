@@ -26,6 +26,8 @@
 #include "nm-utils.h"
 
 #include "dhcp/nm-dhcp-utils.h"
+#include "dhcp/nm-dhcp-listener.h"
+#include "dhcp/nm-dhcp-helper-api.h"
 #include "platform/nm-platform.h"
 
 #include "nm-test-utils-core.h"
@@ -715,6 +717,106 @@ test_client_id_from_string (void)
 	COMPARE_ID (endcolon, TRUE, endcolon, strlen (endcolon));
 }
 
+static void
+_event_append_option (GByteArray *msg, const char *name, const char *value)
+{
+	NMDhcpHelperEventOption option = {
+		.name_len = strlen (name),
+		.value_len = strlen (value),
+	};
+
+	g_byte_array_append (msg, (const guint8 *) &option, sizeof (option));
+	g_byte_array_append (msg, (const guint8 *) name, option.name_len);
+	g_byte_array_append (msg, (const guint8 *) value, option.value_len);
+}
+
+static GByteArray *
+_event_new (guint32 n_options)
+{
+	NMDhcpHelperEventHeader header = {
+		.magic = NM_DHCP_HELPER_EVENT_MAGIC,
+		.n_options = n_options,
+	};
+	GByteArray *msg;
+
+	msg = g_byte_array_new ();
+	g_byte_array_append (msg, (const guint8 *) &header, sizeof (header));
+	return msg;
+}
+
+static void
+_event_assert_option (GVariant *options, const char *name, const char *expected)
+{
+	gs_unref_variant GVariant *value = NULL;
+	const guint8 *data;
+	gsize len;
+
+	value = g_variant_lookup_value (options, name, G_VARIANT_TYPE_BYTESTRING);
+	g_assert (value);
+	data = g_variant_get_fixed_array (value, &len, 1);
+	g_assert_cmpint (len, ==, strlen (expected));
+	g_assert (len == 0 || memcmp (data, expected, len) == 0);
+}
+
+static void
+test_event_parse (void)
+{
+	GByteArray *msg;
+	GVariant *options;
+	guint32 magic = 0;
+
+	msg = _event_new (3);
+	_event_append_option (msg, "interface", "eth0");
+	_event_append_option (msg, "reason", "BOUND");
+	_event_append_option (msg, "new_domain_name", "");
+	options = nm_dhcp_listener_event_parse (msg->data, msg->len);
+	g_assert (options);
+	g_assert (g_variant_is_of_type (options, G_VARIANT_TYPE_VARDICT));
+	g_assert_cmpint (g_variant_n_children (options), ==, 3);
+	_event_assert_option (options, "interface", "eth0");
+	_event_assert_option (options, "reason", "BOUND");
+	_event_assert_option (options, "new_domain_name", "");
+	g_variant_unref (options);
+
+	/* every truncation is rejected. */
+	while (msg->len > 0) {
+		g_byte_array_set_size (msg, msg->len - 1);
+		g_assert (!nm_dhcp_listener_event_parse (msg->data, msg->len));
+	}
+	g_byte_array_unref (msg);
+
+	/* no options */
+	msg = _event_new (0);
+	options = nm_dhcp_listener_event_parse (msg->data, msg->len);
+	g_assert (options);
+	g_assert_cmpint (g_variant_n_children (options), ==, 0);
+	g_variant_unref (options);
+
+	/* trailing garbage */
+	g_byte_array_append (msg, (const guint8 *) "x", 1);
+	g_assert (!nm_dhcp_listener_event_parse (msg->data, msg->len));
+	g_byte_array_unref (msg);
+
+	/* more options announced than present */
+	msg = _event_new (2);
+	_event_append_option (msg, "reason", "BOUND");
+	g_assert (!nm_dhcp_listener_event_parse (msg->data, msg->len));
+	g_byte_array_unref (msg);
+
+	/* empty name */
+	msg = _event_new (1);
+	_event_append_option (msg, "", "BOUND");
+	g_assert (!nm_dhcp_listener_event_parse (msg->data, msg->len));
+	g_byte_array_unref (msg);
+
+	/* bad magic */
+	msg = _event_new (1);
+	_event_append_option (msg, "reason", "BOUND");
+	memcpy (msg->data, &magic, sizeof (magic));
+	g_assert (!nm_dhcp_listener_event_parse (msg->data, msg->len));
+	g_byte_array_unref (msg);
+}
+
 NMTST_DEFINE ();
 
 int main (int argc, char **argv)
@@ -742,6 +844,7 @@ int main (int argc, char **argv)
 	g_test_add_func ("/dhcp/ip4-prefix-classless", test_ip4_prefix_classless);
 	g_test_add_func ("/dhcp/client-id-from-string", test_client_id_from_string);
 	g_test_add_func ("/dhcp/vendor-option-metered", test_vendor_option_metered);
+	g_test_add_func ("/dhcp/event-parse", test_event_parse);
 
 	return g_test_run ();
 }
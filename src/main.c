@@ -46,6 +46,7 @@
 #include "nm-session-monitor.h"
 #include "nm-dispatcher.h"
 #include "settings/nm-settings.h"
+#include "settings/nm-settings-connection.h"
 #include "nm-auth-manager.h"
 #include "nm-core-internal.h"
 #include "nm-exported-object.h"
@@ -329,6 +330,16 @@ main (int argc, char *argv[])
 		}
 	}
 
+	if (!nm_logging_ring_setup (nm_config_data_get_value_cached (NM_CONFIG_GET_DATA_ORIG,
+	                                                             NM_CONFIG_KEYFILE_GROUP_LOGGING,
+	                                                             NM_CONFIG_KEYFILE_KEY_LOGGING_RING_LEVEL,
+	                                                             NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY),
+	                            &error)) {
+		fprintf (stderr, _("Error in configuration file: %s.\n"),
+		         error->message);
+		exit (1);
+	}
+
 	if (global_opt.become_daemon && !nm_config_get_is_debug (config)) {
 		if (daemon (0, 0) < 0) {
 			int saved_errno;
@@ -422,16 +433,17 @@ main (int argc, char *argv[])
 
 done:
 
-	/* write the device-state to file. Note that we only persist the
-	 * state here. We don't bother updating the state as devices
-	 * change during regular operation. If NM is killed with SIGKILL,
-	 * it misses to update the state. */
+	/* write the device-state to file. The state is also updated as
+	 * devices change during regular operation, here we update it for
+	 * all devices once more and write it out right away. */
 	nm_manager_write_device_state (nm_manager_get ());
 
 	nm_exported_object_class_set_quitting ();
 
 	nm_manager_stop (nm_manager_get ());
 
+	nm_settings_connection_flush_databases ();
+
 	nm_config_state_set (config, TRUE, TRUE);
 
 	if (global_opt.pidfile && wrote_pidfile)
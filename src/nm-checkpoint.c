@@ -116,139 +116,228 @@ nm_checkpoint_includes_device (NMCheckpoint *self, NMDevice *device)
 	return g_hash_table_contains (priv->devices, device);
 }
 
+typedef enum {
+	ROLLBACK_ACTION_NONE,
+	ROLLBACK_ACTION_UNMANAGE,
+	ROLLBACK_ACTION_DISCONNECT,
+	ROLLBACK_ACTION_ACTIVATE,
+} RollbackAction;
+
+typedef struct {
+	DeviceCheckpoint *dev_checkpoint;
+	RollbackAction action;
+	guint32 result;
+	/* for ROLLBACK_ACTION_ACTIVATE, the settings connection to activate.
+	 * Set when the settings are restored. */
+	NMSettingsConnection *connection;
+} RollbackStep;
+
+static void
+rollback_plan_device (NMCheckpoint *self,
+                      RollbackStep *step)
+{
+	DeviceCheckpoint *dev_checkpoint = step->dev_checkpoint;
+	NMDevice *device = dev_checkpoint->device;
+
+	step->action = ROLLBACK_ACTION_NONE;
+	step->result = NM_ROLLBACK_RESULT_OK;
+
+	_LOGD ("rollback: planning device %s (state %d, realized %d, explicitly unmanaged %d)",
+	       nm_device_get_iface (device),
+	       (int) dev_checkpoint->state,
+	       dev_checkpoint->realized,
+	       dev_checkpoint->unmanaged_explicit);
+
+	if (nm_device_is_real (device)) {
+		if (!dev_checkpoint->realized) {
+			_LOGD ("rollback: device was not realized, unmanage it");
+			step->action = ROLLBACK_ACTION_UNMANAGE;
+			return;
+		}
+	} else {
+		if (!dev_checkpoint->realized)
+			return;
+		if (!nm_device_is_software (device)) {
+			_LOGD ("rollback: device is not realized");
+			step->result = NM_ROLLBACK_RESULT_ERR_FAILED;
+			return;
+		}
+		/* try to recreate software device */
+		_LOGD ("rollback: software device not realized, will re-activate");
+	}
+
+	if (dev_checkpoint->state == NM_DEVICE_STATE_UNMANAGED) {
+		if (   nm_device_get_state (device) != NM_DEVICE_STATE_UNMANAGED
+		    || dev_checkpoint->unmanaged_explicit)
+			step->action = ROLLBACK_ACTION_UNMANAGE;
+		return;
+	}
+
+	if (!dev_checkpoint->applied_connection) {
+		/* The device was initially disconnected, deactivate any existing connection */
+		step->action = ROLLBACK_ACTION_DISCONNECT;
+		return;
+	}
+
+	step->action = ROLLBACK_ACTION_ACTIVATE;
+}
+
+static void
+rollback_restore_connection (NMCheckpoint *self,
+                             RollbackStep *step,
+                             GHashTable *connections_by_uuid)
+{
+	NMConnection *saved = step->dev_checkpoint->settings_connection;
+	const char *con_uuid = nm_connection_get_uuid (saved);
+	GError *local_error = NULL;
+
+	/* Look the connection up only now. Several devices can have the same
+	 * connection, which an earlier step might already have re-added. */
+	step->connection = g_hash_table_lookup (connections_by_uuid, con_uuid);
+	if (step->connection) {
+		/* If the connection is still there, restore its content
+		 * and save it. Skip the write if nothing changed. */
+		if (nm_connection_compare (NM_CONNECTION (step->connection),
+		                           saved,
+		                           NM_SETTING_COMPARE_FLAG_EXACT)) {
+			_LOGD ("rollback: connection %s still exists and is unchanged", con_uuid);
+			return;
+		}
+
+		_LOGD ("rollback: connection %s still exists", con_uuid);
+		nm_connection_replace_settings_from_connection (NM_CONNECTION (step->connection),
+		                                                saved);
+		nm_settings_connection_commit_changes (step->connection,
+		                                       NM_SETTINGS_CONNECTION_COMMIT_REASON_NONE,
+		                                       NULL,
+		                                       NULL);
+		return;
+	}
+
+	/* The connection was deleted, recreate it */
+	_LOGD ("rollback: adding connection %s again", con_uuid);
+
+	step->connection = nm_settings_add_connection (nm_settings_get (),
+	                                               saved,
+	                                               TRUE,
+	                                               &local_error);
+	if (!step->connection) {
+		_LOGD ("rollback: connection add failure: %s", local_error->message);
+		g_clear_error (&local_error);
+		step->action = ROLLBACK_ACTION_NONE;
+		step->result = NM_ROLLBACK_RESULT_ERR_FAILED;
+		return;
+	}
+
+	g_hash_table_insert (connections_by_uuid,
+	                     (gpointer) nm_settings_connection_get_uuid (step->connection),
+	                     step->connection);
+}
+
+static void
+rollback_apply_device (NMCheckpoint *self, RollbackStep *step)
+{
+	NMCheckpointPrivate *priv = NM_CHECKPOINT_GET_PRIVATE (self);
+	DeviceCheckpoint *dev_checkpoint = step->dev_checkpoint;
+	NMDevice *device = dev_checkpoint->device;
+	gs_unref_object NMAuthSubject *subject = NULL;
+	GError *local_error = NULL;
+
+	switch (step->action) {
+	case ROLLBACK_ACTION_NONE:
+		break;
+	case ROLLBACK_ACTION_UNMANAGE:
+		_LOGD ("rollback: explicitly unmanage device %s", nm_device_get_iface (device));
+		nm_device_set_unmanaged_by_flags_queue (device,
+		                                        NM_UNMANAGED_USER_EXPLICIT,
+		                                        TRUE,
+		                                        NM_DEVICE_STATE_REASON_NOW_UNMANAGED);
+		break;
+	case ROLLBACK_ACTION_DISCONNECT:
+		_LOGD ("rollback: disconnecting device %s", nm_device_get_iface (device));
+		if (   nm_device_get_state (device) > NM_DEVICE_STATE_DISCONNECTED
+		    && nm_device_get_state (device) < NM_DEVICE_STATE_DEACTIVATING) {
+			nm_device_state_changed (device,
+			                         NM_DEVICE_STATE_DEACTIVATING,
+			                         NM_DEVICE_STATE_REASON_USER_REQUESTED);
+		}
+		break;
+	case ROLLBACK_ACTION_ACTIVATE:
+		/* Activation only queues the activation request, the devices
+		 * then proceed concurrently. */
+		subject = nm_auth_subject_new_internal ();
+		if (!nm_manager_activate_connection (priv->manager,
+		                                     step->connection,
+		                                     dev_checkpoint->applied_connection,
+		                                     NULL,
+		                                     device,
+		                                     subject,
+		                                     &local_error)) {
+			_LOGW ("rollback: reactivation of connection %s/%s failed: %s",
+			       nm_connection_get_id ((NMConnection *) step->connection),
+			       nm_connection_get_uuid ((NMConnection *) step->connection),
+			       local_error->message);
+			g_clear_error (&local_error);
+			step->result = NM_ROLLBACK_RESULT_ERR_FAILED;
+		}
+		break;
+	}
+}
+
+/* The rollback is done in three phases. First, the actions for all devices
+ * are determined without changing anything. Then all settings connections
+ * are restored, before any device is touched. Finally, all devices are
+ * reconfigured in one go, so that their activations run in parallel.
+ *
+ * With NM_CHECKPOINT_CREATE_FLAG_DELETE_NEW_CONNECTIONS, the new connections
+ * are deleted in the second phase, that is before the devices are activated
+ * again. A device that still has one of them active gets disconnected by the
+ * deletion and is then activated with its old connection. */
 GVariant *
 nm_checkpoint_rollback (NMCheckpoint *self)
 {
 	NMCheckpointPrivate *priv = NM_CHECKPOINT_GET_PRIVATE (self);
+	gs_unref_hashtable GHashTable *connections_by_uuid = NULL;
+	gs_free RollbackStep *steps = NULL;
+	NMSettingsConnection *const *con;
 	DeviceCheckpoint *dev_checkpoint;
 	GHashTableIter iter;
-	NMSettingsConnection *connection;
-	NMDevice *device;
-	GError *local_error = NULL;
 	GVariantBuilder builder;
+	gint64 ts_start, ts_plan, ts_settings, ts_devices;
+	guint n_steps, i;
 
 	_LOGI ("rollback of %s", nm_exported_object_get_path ((NMExportedObject *) self));
-	 g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{su}"));
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{su}"));
 
-	/* Start rolling-back each device */
+	ts_start = nm_utils_get_monotonic_timestamp_us ();
+
+	/* Phase 1: plan */
+	steps = g_new0 (RollbackStep, g_hash_table_size (priv->devices));
+	n_steps = 0;
 	g_hash_table_iter_init (&iter, priv->devices);
-	while (g_hash_table_iter_next (&iter, (gpointer *) &device, (gpointer *) &dev_checkpoint)) {
-		gs_unref_object NMAuthSubject *subject = NULL;
-		guint32 result = NM_ROLLBACK_RESULT_OK;
-		const char *con_uuid;
-
-		_LOGD ("rollback: restoring device %s (state %d, realized %d, explicitly unmanaged %d)",
-		       nm_device_get_iface (device),
-		       (int) dev_checkpoint->state,
-		       dev_checkpoint->realized,
-		       dev_checkpoint->unmanaged_explicit);
-
-		if (nm_device_is_real (device)) {
-			if (!dev_checkpoint->realized) {
-				_LOGD ("rollback: device was not realized, unmanage it");
-				nm_device_set_unmanaged_by_flags_queue (device,
-				                                        NM_UNMANAGED_USER_EXPLICIT,
-				                                        TRUE,
-				                                        NM_DEVICE_STATE_REASON_NOW_UNMANAGED);
-				goto next_dev;
-			}
-		} else {
-			if (dev_checkpoint->realized) {
-				if (nm_device_is_software (device)) {
-					/* try to recreate software device */
-					_LOGD ("rollback: software device not realized, will re-activate");
-					goto activate;
-				} else {
-					_LOGD ("rollback: device is not realized");
-					result = NM_ROLLBACK_RESULT_ERR_FAILED;
-				}
-			}
-			goto next_dev;
-		}
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &dev_checkpoint)) {
+		RollbackStep *step = &steps[n_steps++];
 
-activate:
-		if (dev_checkpoint->state == NM_DEVICE_STATE_UNMANAGED) {
-			if (   nm_device_get_state (device) != NM_DEVICE_STATE_UNMANAGED
-			    || dev_checkpoint->unmanaged_explicit) {
-				_LOGD ("rollback: explicitly unmanage device");
-				nm_device_set_unmanaged_by_flags_queue (device,
-				                                        NM_UNMANAGED_USER_EXPLICIT,
-				                                        TRUE,
-				                                        NM_DEVICE_STATE_REASON_NOW_UNMANAGED);
-			}
-			goto next_dev;
-		}
+		step->dev_checkpoint = dev_checkpoint;
+		rollback_plan_device (self, step);
+	}
 
-		if (dev_checkpoint->applied_connection) {
-			/* The device had an active connection, check if the
-			 * connection still exists
-			 * */
-			con_uuid = nm_connection_get_uuid (dev_checkpoint->settings_connection);
-			connection = nm_settings_get_connection_by_uuid (nm_settings_get (), con_uuid);
-
-			if (connection) {
-				/* If the connection is still there, restore its content
-				 * and save it
-				 * */
-				_LOGD ("rollback: connection %s still exists", con_uuid);
-
-				nm_connection_replace_settings_from_connection (NM_CONNECTION (connection),
-				                                                dev_checkpoint->settings_connection);
-				nm_settings_connection_commit_changes (connection,
-				                                       NM_SETTINGS_CONNECTION_COMMIT_REASON_NONE,
-				                                       NULL,
-				                                       NULL);
-			} else {
-				/* The connection was deleted, recreate it */
-				_LOGD ("rollback: adding connection %s again", con_uuid);
-
-				connection = nm_settings_add_connection (nm_settings_get (),
-				                                         dev_checkpoint->settings_connection,
-				                                         TRUE,
-				                                         &local_error);
-				if (!connection) {
-					_LOGD ("rollback: connection add failure: %s", local_error->message);
-					g_clear_error (&local_error);
-					result = NM_ROLLBACK_RESULT_ERR_FAILED;
-					goto next_dev;
-				}
-			}
+	ts_plan = nm_utils_get_monotonic_timestamp_us ();
 
-			/* Now re-activate the connection */
-			subject = nm_auth_subject_new_internal ();
-			if (!nm_manager_activate_connection (priv->manager,
-			                                     connection,
-			                                     dev_checkpoint->applied_connection,
-			                                     NULL,
-			                                     device,
-			                                     subject,
-			                                     &local_error)) {
-				_LOGW ("rollback: reactivation of connection %s/%s failed: %s",
-				       nm_connection_get_id ((NMConnection *) connection),
-				       nm_connection_get_uuid ((NMConnection *	) connection),
-				       local_error->message);
-				g_clear_error (&local_error);
-				result = NM_ROLLBACK_RESULT_ERR_FAILED;
-				goto next_dev;
-			}
-		} else {
-			/* The device was initially disconnected, deactivate any existing connection */
-			_LOGD ("rollback: disconnecting device");
-
-			if (   nm_device_get_state (device) > NM_DEVICE_STATE_DISCONNECTED
-			    && nm_device_get_state (device) < NM_DEVICE_STATE_DEACTIVATING) {
-				nm_device_state_changed (device,
-				                         NM_DEVICE_STATE_DEACTIVATING,
-				                         NM_DEVICE_STATE_REASON_USER_REQUESTED);
-			}
-		}
+	/* Phase 2: restore settings */
+	connections_by_uuid = g_hash_table_new (g_str_hash, g_str_equal);
+	for (con = nm_settings_get_connections (nm_settings_get (), NULL); *con; con++) {
+		g_hash_table_insert (connections_by_uuid,
+		                     (gpointer) nm_settings_connection_get_uuid (*con),
+		                     *con);
+	}
 
-next_dev:
-		g_variant_builder_add (&builder, "{su}", dev_checkpoint->original_dev_path, result);
+	for (i = 0; i < n_steps; i++) {
+		if (steps[i].action == ROLLBACK_ACTION_ACTIVATE)
+			rollback_restore_connection (self, &steps[i], connections_by_uuid);
 	}
 
 	if (NM_FLAGS_HAS (priv->flags, NM_CHECKPOINT_CREATE_FLAG_DELETE_NEW_CONNECTIONS)) {
-		NMSettingsConnection *con;
 		gs_free_slist GSList *list = NULL;
 		GSList *item;
 
@@ -256,19 +345,30 @@ next_dev:
 		list = nm_settings_get_connections_sorted (nm_settings_get ());
 
 		for (item = list; item; item = g_slist_next (item)) {
-			con = item->data;
+			NMSettingsConnection *c = item->data;
+
 			if (!g_hash_table_contains (priv->connection_uuids,
-			                            nm_settings_connection_get_uuid (con))) {
+			                            nm_settings_connection_get_uuid (c))) {
 				_LOGD ("rollback: deleting new connection %s (%s)",
-				       nm_settings_connection_get_uuid (con),
-				       nm_settings_connection_get_id (con));
-				nm_settings_connection_delete (con, NULL, NULL);
+				       nm_settings_connection_get_uuid (c),
+				       nm_settings_connection_get_id (c));
+				nm_settings_connection_delete (c, NULL, NULL);
 			}
 		}
 	}
 
+	ts_settings = nm_utils_get_monotonic_timestamp_us ();
+
+	/* Phase 3: reconfigure devices */
+	for (i = 0; i < n_steps; i++) {
+		rollback_apply_device (self, &steps[i]);
+		g_variant_builder_add (&builder, "{su}",
+		                       steps[i].dev_checkpoint->original_dev_path,
+		                       steps[i].result);
+	}
+
 	if (NM_FLAGS_HAS (priv->flags, NM_CHECKPOINT_CREATE_FLAG_DISCONNECT_NEW_DEVICES)) {
-		const GSList *list = nm_manager_get_devices (priv->manager);
+		const GSList *list;
 		NMDeviceState state;
 		NMDevice *dev;
 
@@ -285,9 +385,16 @@ next_dev:
 				}
 			}
 		}
-
 	}
 
+	ts_devices = nm_utils_get_monotonic_timestamp_us ();
+
+	_LOGI ("rollback of %u devices done: plan %"G_GINT64_FORMAT" us, settings %"G_GINT64_FORMAT" us, devices %"G_GINT64_FORMAT" us",
+	       n_steps,
+	       ts_plan - ts_start,
+	       ts_settings - ts_plan,
+	       ts_devices - ts_settings);
+
 	return g_variant_new ("(a{su})", &builder);
 }
 
@@ -40,10 +40,26 @@ typedef struct {
 		 * value %NULL does not necessarily mean, that the property
 		 * "match-device" was unspecified. */
 		gboolean has;
-		GSList *spec;
+		NMMatchSpecCompiled *spec;
 	} match_device;
 } MatchSectionInfo;
 
+/* An already resolved nm_config_data_get_connection_default() lookup.
+ * @device is only used for identity and not referenced. Together with
+ * @spec_match_generation it can never match a different device, even
+ * if that one is allocated at the same address. */
+typedef struct {
+	gconstpointer device;
+	guint spec_match_generation;
+	char *property;
+	char *value;
+} ConnectionDefaultEntry;
+
+/* Upper bound for the number of cached entries. Entries for devices
+ * that are gone or have changed are never looked up again; once the
+ * limit is reached, the cache is simply dropped and refilled. */
+#define CONNECTION_DEFAULTS_CACHE_MAX 4096
+
 struct _NMGlobalDnsDomain {
 	char *name;
 	char **servers;
@@ -97,10 +113,12 @@ typedef struct {
 		char **arr;
 		GSList *specs;
 		GSList *specs_config;
+		NMMatchSpecCompiled *specs_compiled;
+		NMMatchSpecCompiled *specs_config_compiled;
 	} no_auto_default;
 
-	GSList *ignore_carrier;
-	GSList *assume_ipv6ll_only;
+	NMMatchSpecCompiled *ignore_carrier;
+	NMMatchSpecCompiled *assume_ipv6ll_only;
 
 	char *dns_mode;
 	char *rc_manager;
@@ -109,6 +127,9 @@ typedef struct {
 
 	/* mutable field */
 	char *value_cached;
+
+	/* mutable field: set of ConnectionDefaultEntry */
+	GHashTable *connection_defaults_cache;
 } NMConfigDataPrivate;
 
 struct _NMConfigData {
@@ -279,8 +300,8 @@ nm_config_data_get_no_auto_default_for_device (const NMConfigData *self, NMDevic
 	g_return_val_if_fail (NM_IS_DEVICE (device), FALSE);
 
 	priv = NM_CONFIG_DATA_GET_PRIVATE (self);
-	return    nm_device_spec_match_list (device, priv->no_auto_default.specs)
-	       || nm_device_spec_match_list (device, priv->no_auto_default.specs_config);
+	return    nm_device_spec_match_list (device, priv->no_auto_default.specs_compiled)
+	       || nm_device_spec_match_list (device, priv->no_auto_default.specs_config_compiled);
 }
 
 const char *
@@ -1239,38 +1260,115 @@ nm_config_data_get_device_config_boolean (const NMConfigData *self,
 	return nm_config_parse_boolean (value, val_invalid);
 }
 
+static guint
+_connection_default_entry_hash (gconstpointer ptr)
+{
+	const ConnectionDefaultEntry *entry = ptr;
+	guint h;
+
+	h = g_str_hash (entry->property);
+	h = (h * 33) + g_direct_hash (entry->device);
+	h = (h * 33) + entry->spec_match_generation;
+	return h;
+}
+
+static gboolean
+_connection_default_entry_equal (gconstpointer a, gconstpointer b)
+{
+	const ConnectionDefaultEntry *entry_a = a;
+	const ConnectionDefaultEntry *entry_b = b;
+
+	return    entry_a->device == entry_b->device
+	       && entry_a->spec_match_generation == entry_b->spec_match_generation
+	       && nm_streq (entry_a->property, entry_b->property);
+}
+
+static void
+_connection_default_entry_free (gpointer ptr)
+{
+	ConnectionDefaultEntry *entry = ptr;
+
+	g_free (entry->property);
+	g_free (entry->value);
+	g_slice_free (ConnectionDefaultEntry, entry);
+}
+
 char *
 nm_config_data_get_connection_default (const NMConfigData *self,
                                        const char *property,
                                        NMDevice *device)
 {
-	const NMConfigDataPrivate *priv;
+	NMConfigDataPrivate *priv;
+	ConnectionDefaultEntry needle;
+	ConnectionDefaultEntry *entry;
 	char *value = NULL;
 
 	g_return_val_if_fail (self, NULL);
 	g_return_val_if_fail (property && *property, NULL);
 	g_return_val_if_fail (strchr (property, '.'), NULL);
 
-	priv = NM_CONFIG_DATA_GET_PRIVATE (self);
+	/* we modify @connection_defaults_cache. In C++ jargon, the field is mutable. */
+	priv = (NMConfigDataPrivate *) NM_CONFIG_DATA_GET_PRIVATE (self);
+
+	if (!priv->connection_infos)
+		return NULL;
+
+	/* The result only depends on the device's properties that are used for
+	 * matching "match-device". Cache it until they change. */
+	needle.device = device;
+	needle.spec_match_generation = device ? nm_device_get_spec_match_generation (device) : 0;
+	needle.property = (char *) property;
+
+	if (G_UNLIKELY (!priv->connection_defaults_cache)) {
+		priv->connection_defaults_cache = g_hash_table_new_full (_connection_default_entry_hash,
+		                                                         _connection_default_entry_equal,
+		                                                         _connection_default_entry_free,
+		                                                         NULL);
+	} else {
+		entry = g_hash_table_lookup (priv->connection_defaults_cache, &needle);
+		if (entry)
+			return g_strdup (entry->value);
+	}
 
 	_match_section_infos_lookup (&priv->connection_infos[0],
 	                             priv->keyfile,
 	                             property,
 	                             device,
 	                             &value);
+
+	if (g_hash_table_size (priv->connection_defaults_cache) >= CONNECTION_DEFAULTS_CACHE_MAX)
+		g_hash_table_remove_all (priv->connection_defaults_cache);
+
+	entry = g_slice_new (ConnectionDefaultEntry);
+	entry->device = needle.device;
+	entry->spec_match_generation = needle.spec_match_generation;
+	entry->property = g_strdup (property);
+	entry->value = g_strdup (value);
+	g_hash_table_add (priv->connection_defaults_cache, entry);
+
 	return value;
 }
 
+static NMMatchSpecCompiled *
+_match_spec_compile_take (GSList *specs)
+{
+	NMMatchSpecCompiled *compiled;
+
+	compiled = nm_match_spec_compile (specs);
+	g_slist_free_full (specs, g_free);
+	return compiled;
+}
+
 static void
 _get_connection_info_init (MatchSectionInfo *connection_info, GKeyFile *keyfile, char *group)
 {
 	/* pass ownership of @group on... */
 	connection_info->group_name = group;
 
-	connection_info->match_device.spec = nm_config_get_match_spec (keyfile,
-	                                                               group,
-	                                                               "match-device",
-	                                                               &connection_info->match_device.has);
+	connection_info->match_device.spec = _match_spec_compile_take (nm_config_get_match_spec (keyfile,
+	                                                                                         group,
+	                                                                                         "match-device",
+	                                                                                         &connection_info->match_device.has));
 	connection_info->stop_match = nm_config_keyfile_get_boolean (keyfile, group, "stop-match", FALSE);
 }
 
@@ -1283,7 +1381,7 @@ _match_section_infos_free (MatchSectionInfo *match_section_infos)
 		return;
 	for (i = 0; match_section_infos[i].group_name; i++) {
 		g_free (match_section_infos[i].group_name);
-		g_slist_free_full (match_section_infos[i].match_device.spec, g_free);
+		nm_match_spec_compiled_free (match_section_infos[i].match_device.spec);
 	}
 	g_free (match_section_infos);
 }
@@ -1520,10 +1618,12 @@ constructed (GObject *object)
 	priv->dns_mode = nm_strstrip (g_key_file_get_string (priv->keyfile, NM_CONFIG_KEYFILE_GROUP_MAIN, "dns", NULL));
 	priv->rc_manager = nm_strstrip (g_key_file_get_string (priv->keyfile, NM_CONFIG_KEYFILE_GROUP_MAIN, "rc-manager", NULL));
 
-	priv->ignore_carrier = nm_config_get_match_spec (priv->keyfile, NM_CONFIG_KEYFILE_GROUP_MAIN, "ignore-carrier", NULL);
-	priv->assume_ipv6ll_only = nm_config_get_match_spec (priv->keyfile, NM_CONFIG_KEYFILE_GROUP_MAIN, "assume-ipv6ll-only", NULL);
+	priv->ignore_carrier = _match_spec_compile_take (nm_config_get_match_spec (priv->keyfile, NM_CONFIG_KEYFILE_GROUP_MAIN, "ignore-carrier", NULL));
+	priv->assume_ipv6ll_only = _match_spec_compile_take (nm_config_get_match_spec (priv->keyfile, NM_CONFIG_KEYFILE_GROUP_MAIN, "assume-ipv6ll-only", NULL));
 
 	priv->no_auto_default.specs_config = nm_config_get_match_spec (priv->keyfile, NM_CONFIG_KEYFILE_GROUP_MAIN, "no-auto-default", NULL);
+	priv->no_auto_default.specs_compiled = nm_match_spec_compile (priv->no_auto_default.specs);
+	priv->no_auto_default.specs_config_compiled = nm_match_spec_compile (priv->no_auto_default.specs_config);
 
 	priv->global_dns = load_global_dns (priv->keyfile_user, FALSE);
 	if (!priv->global_dns)
@@ -1590,18 +1690,22 @@ finalize (GObject *gobject)
 
 	g_slist_free_full (priv->no_auto_default.specs, g_free);
 	g_slist_free_full (priv->no_auto_default.specs_config, g_free);
+	nm_match_spec_compiled_free (priv->no_auto_default.specs_compiled);
+	nm_match_spec_compiled_free (priv->no_auto_default.specs_config_compiled);
 	g_strfreev (priv->no_auto_default.arr);
 
 	g_free (priv->dns_mode);
 	g_free (priv->rc_manager);
 
-	g_slist_free_full (priv->ignore_carrier, g_free);
-	g_slist_free_full (priv->assume_ipv6ll_only, g_free);
+	nm_match_spec_compiled_free (priv->ignore_carrier);
+	nm_match_spec_compiled_free (priv->assume_ipv6ll_only);
 
 	nm_global_dns_config_free (priv->global_dns);
 
 	_match_section_infos_free (priv->connection_infos);
 	_match_section_infos_free (priv->device_infos);
+	if (priv->connection_defaults_cache)
+		g_hash_table_unref (priv->connection_defaults_cache);
 
 	g_key_file_unref (priv->keyfile);
 	if (priv->keyfile_user)
@@ -50,6 +50,7 @@ struct NMConfigCmdLineOptions {
 	char *system_config_dir;
 	char *state_file;
 	char *no_auto_default_file;
+	char *device_state_file;
 	char *plugins;
 	gboolean configure_and_quit;
 	gboolean is_debug;
@@ -90,6 +91,8 @@ typedef struct {
 	char *system_config_dir;
 	char *no_auto_default_file;
 	char *intern_config_file;
+	char *device_state_file;
+	char *device_state_dir;
 
 	gboolean monitor_connection_files;
 
@@ -112,6 +115,19 @@ typedef struct {
 	 * because the state changes only on explicit actions from the daemon
 	 * itself. */
 	State *state;
+
+	/* The run state of the devices, ifindex => NMConfigDeviceStateData.
+	 * It is loaded once from NM_CONFIG_DEVICE_STATE_FILE, updated in
+	 * memory, and written back with a delay. */
+	GHashTable *device_states;
+	guint device_states_flush_id;
+	bool device_states_loaded:1;
+	bool device_states_dirty:1;
+
+	/* whether NM_CONFIG_DEVICE_STATE_FILE did not exist and the state
+	 * was read from the per-device files of older versions. They are
+	 * removed after the first write. */
+	bool device_states_legacy:1;
 } NMConfigPrivate;
 
 struct _NMConfig {
@@ -404,6 +420,7 @@ _nm_config_cmd_line_options_clear (NMConfigCmdLineOptions *cli)
 	g_clear_pointer (&cli->config_dir, g_free);
 	g_clear_pointer (&cli->system_config_dir, g_free);
 	g_clear_pointer (&cli->no_auto_default_file, g_free);
+	g_clear_pointer (&cli->device_state_file, g_free);
 	g_clear_pointer (&cli->intern_config_file, g_free);
 	g_clear_pointer (&cli->state_file, g_free);
 	g_clear_pointer (&cli->plugins, g_free);
@@ -426,6 +443,7 @@ _nm_config_cmd_line_options_copy (const NMConfigCmdLineOptions *cli, NMConfigCmd
 	dst->system_config_dir = g_strdup (cli->system_config_dir);
 	dst->config_main_file = g_strdup (cli->config_main_file);
 	dst->no_auto_default_file = g_strdup (cli->no_auto_default_file);
+	dst->device_state_file = g_strdup (cli->device_state_file);
 	dst->intern_config_file = g_strdup (cli->intern_config_file);
 	dst->state_file = g_strdup (cli->state_file);
 	dst->plugins = g_strdup (cli->plugins);
@@ -469,6 +487,7 @@ nm_config_cmd_line_options_add_to_entries (NMConfigCmdLineOptions *cli,
 			{ "intern-config", 0, 0, G_OPTION_ARG_FILENAME, &cli->intern_config_file, N_("Internal config file location"), N_(DEFAULT_INTERN_CONFIG_FILE) },
 			{ "state-file", 0, 0, G_OPTION_ARG_FILENAME, &cli->state_file, N_("State file location"), N_(DEFAULT_STATE_FILE) },
 			{ "no-auto-default", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_FILENAME, &cli->no_auto_default_file, N_("State file for no-auto-default devices"), N_(DEFAULT_NO_AUTO_DEFAULT_FILE) },
+			{ "device-state-file", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_FILENAME, &cli->device_state_file, N_("Run state file for devices"), N_(NM_CONFIG_DEVICE_STATE_FILE) },
 			{ "plugins", 0, 0, G_OPTION_ARG_STRING, &cli->plugins, N_("List of plugins separated by ','"), N_(NM_CONFIG_DEFAULT_MAIN_PLUGINS) },
 			{ "configure-and-quit", 0, 0, G_OPTION_ARG_NONE, &cli->configure_and_quit, N_("Quit after initial configuration"), NULL },
 			{ "debug", 'd', 0, G_OPTION_ARG_NONE, &cli->is_debug, N_("Don't become a daemon, and log to stderr"), NULL },
@@ -505,6 +524,7 @@ static gboolean
 ignore_config_snippet (GKeyFile *keyfile, gboolean is_base_config)
 {
 	GSList *specs;
+	NMMatchSpecCompiled *specs_compiled;
 	gboolean as_bool;
 	NMMatchSpecMatchType match_type;
 
@@ -529,10 +549,12 @@ ignore_config_snippet (GKeyFile *keyfile, gboolean is_base_config)
 
 	/* second, interpret the value as match-spec. */
 	specs = nm_config_get_match_spec (keyfile, NM_CONFIG_KEYFILE_GROUP_CONFIG, NM_CONFIG_KEYFILE_KEY_CONFIG_ENABLE, NULL);
-	match_type = nm_match_spec_match_config (specs,
-	                                         _nm_config_match_nm_version,
-	                                         _nm_config_match_env);
+	specs_compiled = nm_match_spec_compile (specs);
 	g_slist_free_full (specs, g_free);
+	match_type = nm_match_spec_compiled_match_config (specs_compiled,
+	                                                  _nm_config_match_nm_version,
+	                                                  _nm_config_match_env);
+	nm_match_spec_compiled_free (specs_compiled);
 
 	return match_type != NM_MATCH_SPEC_MATCH;
 }
@@ -1852,24 +1874,66 @@ _nm_config_state_set (NMConfig *self,
 #define DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_PERM_HW_ADDR_FAKE   "perm-hw-addr-fake"
 #define DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_CONNECTION_UUID     "connection-uuid"
 
+/* Changes to the device states are written at most once per this
+ * many seconds. */
+#define DEVICE_STATE_FLUSH_DELAY_SEC 1
+
+#define DEVICE_STATE_KEYFILE_GROUP_PREFIX "device-"
+
 static NMConfigDeviceStateData *
-_config_device_state_data_new (int ifindex, GKeyFile *kf)
+_config_device_state_data_new_full (int ifindex,
+                                    NMConfigDeviceStateManagedType managed_type,
+                                    const char *connection_uuid,
+                                    const char *perm_hw_addr_fake)
 {
 	NMConfigDeviceStateData *device_state;
-	NMConfigDeviceStateManagedType managed_type = NM_CONFIG_DEVICE_STATE_MANAGED_TYPE_UNKNOWN;
-	gs_free char *connection_uuid = NULL;
-	gs_free char *perm_hw_addr_fake = NULL;
 	gsize connection_uuid_len;
 	gsize perm_hw_addr_fake_len;
 	char *p;
 
 	nm_assert (ifindex > 0);
 
+	connection_uuid_len = connection_uuid ? strlen (connection_uuid) + 1 : 0;
+	perm_hw_addr_fake_len = perm_hw_addr_fake ? strlen (perm_hw_addr_fake) + 1 : 0;
+
+	device_state = g_malloc (sizeof (NMConfigDeviceStateData) +
+	                         connection_uuid_len +
+	                         perm_hw_addr_fake_len);
+
+	device_state->ifindex = ifindex;
+	device_state->managed = managed_type;
+	device_state->connection_uuid = NULL;
+	device_state->perm_hw_addr_fake = NULL;
+
+	p = (char *) (&device_state[1]);
+	if (connection_uuid) {
+		memcpy (p, connection_uuid, connection_uuid_len);
+		device_state->connection_uuid = p;
+		p += connection_uuid_len;
+	}
+	if (perm_hw_addr_fake) {
+		memcpy (p, perm_hw_addr_fake, perm_hw_addr_fake_len);
+		device_state->perm_hw_addr_fake = p;
+		p += perm_hw_addr_fake_len;
+	}
+
+	return device_state;
+}
+
+static NMConfigDeviceStateData *
+_config_device_state_data_new (int ifindex, GKeyFile *kf, const char *group)
+{
+	NMConfigDeviceStateManagedType managed_type = NM_CONFIG_DEVICE_STATE_MANAGED_TYPE_UNKNOWN;
+	gs_free char *connection_uuid = NULL;
+	gs_free char *perm_hw_addr_fake = NULL;
+
+	nm_assert (ifindex > 0);
+
 	if (kf) {
 		gboolean managed;
 
 		managed = nm_config_keyfile_get_boolean (kf,
-		                                         DEVICE_RUN_STATE_KEYFILE_GROUP_DEVICE,
+		                                         group,
 		                                         DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_MANAGED,
 		                                         FALSE);
 		managed_type = managed
@@ -1878,13 +1942,13 @@ _config_device_state_data_new (int ifindex, GKeyFile *kf)
 
 		if (managed) {
 			connection_uuid = nm_config_keyfile_get_value (kf,
-			                                               DEVICE_RUN_STATE_KEYFILE_GROUP_DEVICE,
+			                                               group,
 			                                               DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_CONNECTION_UUID,
 			                                               NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
 		}
 
 		perm_hw_addr_fake = nm_config_keyfile_get_value (kf,
-		                                                 DEVICE_RUN_STATE_KEYFILE_GROUP_DEVICE,
+		                                                 group,
 		                                                 DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_PERM_HW_ADDR_FAKE,
 		                                                 NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
 		if (perm_hw_addr_fake) {
@@ -1896,31 +1960,193 @@ _config_device_state_data_new (int ifindex, GKeyFile *kf)
 		}
 	}
 
-	connection_uuid_len = connection_uuid ? strlen (connection_uuid) + 1 : 0;
-	perm_hw_addr_fake_len = perm_hw_addr_fake ? strlen (perm_hw_addr_fake) + 1 : 0;
+	return _config_device_state_data_new_full (ifindex, managed_type, connection_uuid, perm_hw_addr_fake);
+}
 
-	device_state = g_malloc (sizeof (NMConfigDeviceStateData) +
-	                         connection_uuid_len +
-	                         perm_hw_addr_fake_len);
+/* Reads the per-device files that older versions wrote to
+ * NM_CONFIG_DEVICE_STATE_DIR. If @device_states is %NULL, the
+ * files are removed instead. */
+static void
+_device_states_legacy_files (NMConfig *self, GHashTable *device_states)
+{
+	NMConfigPrivate *priv = NM_CONFIG_GET_PRIVATE (self);
+	GDir *dir;
+	const char *fn;
+	int ifindex;
+	gsize fn_len;
+	gsize i;
 
-	device_state->ifindex = ifindex;
-	device_state->managed = managed_type;
-	device_state->connection_uuid = NULL;
-	device_state->perm_hw_addr_fake = NULL;
+	dir = g_dir_open (priv->device_state_dir, 0, NULL);
+	if (!dir)
+		return;
 
-	p = (char *) (&device_state[1]);
-	if (connection_uuid) {
-		memcpy (p, connection_uuid, connection_uuid_len);
-		device_state->connection_uuid = p;
-		p += connection_uuid_len;
+	while ((fn = g_dir_read_name (dir))) {
+		gs_free char *path = NULL;
+
+		fn_len = strlen (fn);
+
+		/* skip over file names that are not plain integers. */
+		for (i = 0; i < fn_len; i++) {
+			if (!g_ascii_isdigit (fn[i]))
+				break;
+		}
+		if (fn_len == 0 || i != fn_len)
+			continue;
+
+		ifindex = _nm_utils_ascii_str_to_int64 (fn, 10, 1, G_MAXINT, 0);
+		if (!ifindex)
+			continue;
+
+		path = g_build_filename (priv->device_state_dir, fn, NULL);
+
+		if (device_states) {
+			gs_unref_keyfile GKeyFile *kf = NULL;
+
+			kf = nm_config_create_keyfile ();
+			if (!g_key_file_load_from_file (kf, path, G_KEY_FILE_NONE, NULL))
+				continue;
+			_LOGT ("device-state: read #%d (%s)", ifindex, path);
+			g_hash_table_insert (device_states,
+			                     GINT_TO_POINTER (ifindex),
+			                     _config_device_state_data_new (ifindex, kf, DEVICE_RUN_STATE_KEYFILE_GROUP_DEVICE));
+		} else {
+			_LOGT ("device-state: remove #%d (%s)", ifindex, path);
+			(void) unlink (path);
+		}
 	}
-	if (perm_hw_addr_fake) {
-		memcpy (p, perm_hw_addr_fake, perm_hw_addr_fake_len);
-		device_state->perm_hw_addr_fake = p;
-		p += perm_hw_addr_fake_len;
+
+	g_dir_close (dir);
+}
+
+static GHashTable *
+_device_states_get (NMConfig *self)
+{
+	NMConfigPrivate *priv = NM_CONFIG_GET_PRIVATE (self);
+	gs_unref_keyfile GKeyFile *kf = NULL;
+	gs_strfreev char **groups = NULL;
+	GError *local = NULL;
+	gsize i;
+
+	if (priv->device_states_loaded)
+		return priv->device_states;
+
+	priv->device_states_loaded = TRUE;
+	priv->device_states = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+	kf = nm_config_create_keyfile ();
+	if (!g_key_file_load_from_file (kf, priv->device_state_file, G_KEY_FILE_NONE, &local)) {
+		if (g_error_matches (local, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+			/* take over the state that an older version wrote. */
+			_device_states_legacy_files (self, priv->device_states);
+			priv->device_states_legacy = TRUE;
+		} else
+			_LOGW ("device-state: failed to read %s: %s", priv->device_state_file, local->message);
+		g_error_free (local);
+		return priv->device_states;
 	}
 
-	return device_state;
+	groups = g_key_file_get_groups (kf, NULL);
+	for (i = 0; groups && groups[i]; i++) {
+		int ifindex;
+
+		if (!g_str_has_prefix (groups[i], DEVICE_STATE_KEYFILE_GROUP_PREFIX))
+			continue;
+		ifindex = _nm_utils_ascii_str_to_int64 (&groups[i][NM_STRLEN (DEVICE_STATE_KEYFILE_GROUP_PREFIX)],
+		                                        10, 1, G_MAXINT, 0);
+		if (!ifindex)
+			continue;
+
+		g_hash_table_insert (priv->device_states,
+		                     GINT_TO_POINTER (ifindex),
+		                     _config_device_state_data_new (ifindex, kf, groups[i]));
+	}
+
+	_LOGT ("device-state: read %u devices from %s",
+	       g_hash_table_size (priv->device_states),
+	       priv->device_state_file);
+	return priv->device_states;
+}
+
+static void
+_device_states_write (NMConfig *self)
+{
+	NMConfigPrivate *priv = NM_CONFIG_GET_PRIVATE (self);
+	gs_unref_keyfile GKeyFile *kf = NULL;
+	GHashTableIter iter;
+	NMConfigDeviceStateData *device_state;
+	GError *local = NULL;
+
+	nm_clear_g_source (&priv->device_states_flush_id);
+	if (!priv->device_states_dirty)
+		return;
+
+	kf = nm_config_create_keyfile ();
+	g_hash_table_iter_init (&iter, priv->device_states);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &device_state)) {
+		char group[NM_STRLEN (DEVICE_STATE_KEYFILE_GROUP_PREFIX) + 30];
+
+		nm_sprintf_buf (group, DEVICE_STATE_KEYFILE_GROUP_PREFIX"%d", device_state->ifindex);
+		g_key_file_set_boolean (kf,
+		                        group,
+		                        DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_MANAGED,
+		                        device_state->managed == NM_CONFIG_DEVICE_STATE_MANAGED_TYPE_MANAGED);
+		if (device_state->perm_hw_addr_fake) {
+			g_key_file_set_string (kf,
+			                       group,
+			                       DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_PERM_HW_ADDR_FAKE,
+			                       device_state->perm_hw_addr_fake);
+		}
+		if (device_state->connection_uuid) {
+			g_key_file_set_string (kf,
+			                       group,
+			                       DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_CONNECTION_UUID,
+			                       device_state->connection_uuid);
+		}
+	}
+
+	/* g_key_file_save_to_file() replaces the file atomically. */
+	if (!g_key_file_save_to_file (kf, priv->device_state_file, &local)) {
+		/* stay dirty, so that the next change or flush retries. */
+		_LOGW ("device-state: write %s failed: %s", priv->device_state_file, local->message);
+		g_error_free (local);
+		return;
+	}
+	priv->device_states_dirty = FALSE;
+	_LOGT ("device-state: wrote %u devices to %s",
+	       g_hash_table_size (priv->device_states),
+	       priv->device_state_file);
+
+	if (priv->device_states_legacy) {
+		/* the per-device files of older versions are superseded now. */
+		priv->device_states_legacy = FALSE;
+		_device_states_legacy_files (self, NULL);
+	}
+}
+
+static gboolean
+_device_states_flush_cb (gpointer user_data)
+{
+	NMConfig *self = user_data;
+
+	NM_CONFIG_GET_PRIVATE (self)->device_states_flush_id = 0;
+	_device_states_write (self);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+_device_states_set_dirty (NMConfig *self)
+{
+	NMConfigPrivate *priv = NM_CONFIG_GET_PRIVATE (self);
+
+	priv->device_states_dirty = TRUE;
+
+	/* don't postpone a pending write, so that there is at most one
+	 * write per delay, no matter how often the state changes. */
+	if (!priv->device_states_flush_id) {
+		priv->device_states_flush_id = g_timeout_add_seconds (DEVICE_STATE_FLUSH_DELAY_SEC,
+		                                                      _device_states_flush_cb,
+		                                                      self);
+	}
 }
 
 /**
@@ -1936,33 +2162,41 @@ nm_config_device_state_load (NMConfig *self,
                              int ifindex)
 {
 	NMConfigDeviceStateData *device_state;
-	char path[NM_STRLEN (NM_CONFIG_DEVICE_STATE_DIR) + 60];
-	gs_unref_keyfile GKeyFile *kf = NULL;
 
+	g_return_val_if_fail (NM_IS_CONFIG (self), NULL);
 	g_return_val_if_fail (ifindex > 0, NULL);
 
-	nm_sprintf_buf (path, "%s/%d", NM_CONFIG_DEVICE_STATE_DIR, ifindex);
-
-	kf = nm_config_create_keyfile ();
-	if (!g_key_file_load_from_file (kf, path, G_KEY_FILE_NONE, NULL))
-		g_clear_pointer (&kf, g_key_file_unref);
-
-	device_state = _config_device_state_data_new (ifindex, kf);
-
-	if (kf) {
-		_LOGT ("device-state: read #%d (%s); managed=%d%s%s%s%s%s%s",
-		       ifindex, path,
-		       device_state->managed,
-		       NM_PRINT_FMT_QUOTED (device_state->connection_uuid, ", connection-uuid=", device_state->connection_uuid, "", ""),
-		       NM_PRINT_FMT_QUOTED (device_state->perm_hw_addr_fake, ", perm-hw-addr-fake=", device_state->perm_hw_addr_fake, "", ""));
-	} else {
-		_LOGT ("device-state: read #%d (%s); no persistent state",
-		       ifindex, path);
+	device_state = g_hash_table_lookup (_device_states_get (self), GINT_TO_POINTER (ifindex));
+	if (!device_state) {
+		_LOGT ("device-state: read #%d; no persistent state", ifindex);
+		return _config_device_state_data_new (ifindex, NULL, NULL);
 	}
 
-	return device_state;
+	_LOGT ("device-state: read #%d; managed=%d%s%s%s%s%s%s",
+	       ifindex,
+	       device_state->managed,
+	       NM_PRINT_FMT_QUOTED (device_state->connection_uuid, ", connection-uuid=", device_state->connection_uuid, "", ""),
+	       NM_PRINT_FMT_QUOTED (device_state->perm_hw_addr_fake, ", perm-hw-addr-fake=", device_state->perm_hw_addr_fake, "", ""));
+
+	return _config_device_state_data_new_full (ifindex,
+	                                           device_state->managed,
+	                                           device_state->connection_uuid,
+	                                           device_state->perm_hw_addr_fake);
 }
 
+/**
+ * nm_config_device_state_write:
+ * @self: the NMConfig instance
+ * @ifindex: the ifindex of the device
+ * @managed: whether the device is managed
+ * @perm_hw_addr_fake: the fake permanent MAC address, or %NULL
+ * @connection_uuid: the UUID of the active connection, or %NULL
+ *
+ * Updates the run state of the device. The change is written to disk
+ * with a delay, or on nm_config_device_state_flush().
+ *
+ * Returns: %TRUE
+ */
 gboolean
 nm_config_device_state_write (NMConfig *self,
                               int ifindex,
@@ -1970,9 +2204,9 @@ nm_config_device_state_write (NMConfig *self,
                               const char *perm_hw_addr_fake,
                               const char *connection_uuid)
 {
-	char path[NM_STRLEN (NM_CONFIG_DEVICE_STATE_DIR) + 60];
-	GError *local = NULL;
-	gs_unref_keyfile GKeyFile *kf = NULL;
+	GHashTable *device_states;
+	NMConfigDeviceStateData *device_state;
+	NMConfigDeviceStateManagedType managed_type;
 
 	g_return_val_if_fail (NM_IS_CONFIG (self), FALSE);
 	g_return_val_if_fail (ifindex > 0, FALSE);
@@ -1981,33 +2215,25 @@ nm_config_device_state_write (NMConfig *self,
 
 	nm_assert (!perm_hw_addr_fake || nm_utils_hwaddr_valid (perm_hw_addr_fake, -1));
 
-	nm_sprintf_buf (path, "%s/%d", NM_CONFIG_DEVICE_STATE_DIR, ifindex);
+	managed_type = managed
+	               ? NM_CONFIG_DEVICE_STATE_MANAGED_TYPE_MANAGED
+	               : NM_CONFIG_DEVICE_STATE_MANAGED_TYPE_UNMANAGED;
 
-	kf = nm_config_create_keyfile ();
-	g_key_file_set_boolean (kf,
-	                        DEVICE_RUN_STATE_KEYFILE_GROUP_DEVICE,
-	                        DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_MANAGED,
-	                        !!managed);
-	if (perm_hw_addr_fake) {
-		g_key_file_set_string (kf,
-		                       DEVICE_RUN_STATE_KEYFILE_GROUP_DEVICE,
-		                       DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_PERM_HW_ADDR_FAKE,
-		                       perm_hw_addr_fake);
-	}
-	if (connection_uuid) {
-		g_key_file_set_string (kf,
-		                       DEVICE_RUN_STATE_KEYFILE_GROUP_DEVICE,
-		                       DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_CONNECTION_UUID,
-		                       connection_uuid);
-	}
+	device_states = _device_states_get (self);
+	device_state = g_hash_table_lookup (device_states, GINT_TO_POINTER (ifindex));
+	if (   device_state
+	    && device_state->managed == managed_type
+	    && nm_streq0 (device_state->connection_uuid, connection_uuid)
+	    && nm_streq0 (device_state->perm_hw_addr_fake, perm_hw_addr_fake))
+		return TRUE;
 
-	if (!g_key_file_save_to_file (kf, path, &local)) {
-		_LOGW ("device-state: write #%d (%s) failed: %s", ifindex, path, local->message);
-		g_error_free (local);
-		return FALSE;
-	}
-	_LOGT ("device-state: write #%d (%s); managed=%d%s%s%s%s%s%s",
-	       ifindex, path,
+	g_hash_table_insert (device_states,
+	                     GINT_TO_POINTER (ifindex),
+	                     _config_device_state_data_new_full (ifindex, managed_type, connection_uuid, perm_hw_addr_fake));
+	_device_states_set_dirty (self);
+
+	_LOGT ("device-state: set #%d; managed=%d%s%s%s%s%s%s",
+	       ifindex,
 	       (bool) managed,
 	       NM_PRINT_FMT_QUOTED (connection_uuid, ", connection-uuid=", connection_uuid, "", ""),
 	       NM_PRINT_FMT_QUOTED (perm_hw_addr_fake, ", perm-hw-addr-fake=", perm_hw_addr_fake, "", ""));
@@ -2018,44 +2244,61 @@ void
 nm_config_device_state_prune_unseen (NMConfig *self,
                                      GHashTable *seen_ifindexes)
 {
-	GDir *dir;
-	const char *fn;
-	int ifindex;
-	gsize fn_len;
-	gsize i;
-	char buf[NM_STRLEN (NM_CONFIG_DEVICE_STATE_DIR"/") + 30 + 3] = NM_CONFIG_DEVICE_STATE_DIR"/";
-	char *buf_p = &buf[NM_STRLEN (NM_CONFIG_DEVICE_STATE_DIR"/")];
+	GHashTableIter iter;
+	gpointer ifindex;
+	gboolean changed = FALSE;
 
+	g_return_if_fail (NM_IS_CONFIG (self));
 	g_return_if_fail (seen_ifindexes);
 
-	dir = g_dir_open (NM_CONFIG_DEVICE_STATE_DIR, 0, NULL);
-	if (!dir)
-		return;
+	g_hash_table_iter_init (&iter, _device_states_get (self));
+	while (g_hash_table_iter_next (&iter, &ifindex, NULL)) {
+		if (g_hash_table_contains (seen_ifindexes, ifindex))
+			continue;
+		_LOGT ("device-state: prune #%d", GPOINTER_TO_INT (ifindex));
+		g_hash_table_iter_remove (&iter);
+		changed = TRUE;
+	}
 
-	while ((fn = g_dir_read_name (dir))) {
-		fn_len = strlen (fn);
+	if (changed)
+		_device_states_set_dirty (self);
+}
 
-		/* skip over file names that are not plain integers. */
-		for (i = 0; i < fn_len; i++) {
-			if (!g_ascii_isdigit (fn[i]))
-				break;
-		}
-		if (fn_len == 0 || i != fn_len)
-			continue;
+/**
+ * nm_config_device_state_remove:
+ * @self: the NMConfig instance
+ * @ifindex: the ifindex of a link that is gone
+ *
+ * Drops the run state of a link that was removed at runtime. The
+ * change is written to disk with a delay, like other changes.
+ */
+void
+nm_config_device_state_remove (NMConfig *self,
+                               int ifindex)
+{
+	g_return_if_fail (NM_IS_CONFIG (self));
+	g_return_if_fail (ifindex > 0);
 
-		ifindex = _nm_utils_ascii_str_to_int64 (fn, 10, 1, G_MAXINT, 0);
-		if (!ifindex)
-			continue;
+	if (!g_hash_table_remove (_device_states_get (self), GINT_TO_POINTER (ifindex)))
+		return;
 
-		if (g_hash_table_contains (seen_ifindexes, GINT_TO_POINTER (ifindex)))
-			continue;
+	_LOGT ("device-state: remove #%d", ifindex);
+	_device_states_set_dirty (self);
+}
 
-		memcpy (buf_p, fn, fn_len + 1);
-		_LOGT ("device-state: prune #%d (%s)", ifindex, buf);
-		(void) unlink (buf);
-	}
+/**
+ * nm_config_device_state_flush:
+ * @self: the NMConfig instance
+ *
+ * Writes pending changes of the device run state to disk right away.
+ */
+void
+nm_config_device_state_flush (NMConfig *self)
+{
+	g_return_if_fail (NM_IS_CONFIG (self));
 
-	g_dir_close (dir);
+	if (NM_CONFIG_GET_PRIVATE (self)->device_states_loaded)
+		_device_states_write (self);
 }
 
 /*****************************************************************************/
@@ -2301,6 +2544,17 @@ init_sync (GInitable *initable, GCancellable *cancellable, GError **error)
 	else
 		priv->no_auto_default_file = g_strdup (DEFAULT_NO_AUTO_DEFAULT_FILE);
 
+	if (priv->cli.device_state_file) {
+		gs_free char *dirname = g_path_get_dirname (priv->cli.device_state_file);
+
+		/* older versions wrote one file per device to a directory next to it. */
+		priv->device_state_file = g_strdup (priv->cli.device_state_file);
+		priv->device_state_dir = g_build_filename (dirname, "devices", NULL);
+	} else {
+		priv->device_state_file = g_strdup (NM_CONFIG_DEVICE_STATE_FILE);
+		priv->device_state_dir = g_strdup (NM_CONFIG_DEVICE_STATE_DIR);
+	}
+
 	priv->monitor_connection_files = nm_config_keyfile_get_boolean (keyfile, NM_CONFIG_KEYFILE_GROUP_MAIN, "monitor-connection-files", FALSE);
 
 	priv->log_level = nm_strstrip (g_key_file_get_string (keyfile, NM_CONFIG_KEYFILE_GROUP_LOGGING, "level", NULL));
@@ -2356,9 +2610,15 @@ finalize (GObject *gobject)
 
 	state_free (priv->state);
 
+	if (priv->device_states_loaded)
+		_device_states_write ((NMConfig *) gobject);
+	g_clear_pointer (&priv->device_states, g_hash_table_unref);
+
 	g_free (priv->config_dir);
 	g_free (priv->system_config_dir);
 	g_free (priv->no_auto_default_file);
+	g_free (priv->device_state_file);
+	g_free (priv->device_state_dir);
 	g_free (priv->intern_config_file);
 	g_free (priv->log_level);
 	g_free (priv->log_domains);
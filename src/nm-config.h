@@ -63,6 +63,7 @@
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DHCP                     "dhcp"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DEBUG                    "debug"
 #define NM_CONFIG_KEYFILE_KEY_LOGGING_BACKEND               "backend"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_RING_LEVEL            "ring-level"
 #define NM_CONFIG_KEYFILE_KEY_CONFIG_ENABLE                 "enable"
 #define NM_CONFIG_KEYFILE_KEY_ATOMIC_SECTION_WAS            ".was"
 #define NM_CONFIG_KEYFILE_KEY_KEYFILE_PATH                  "path"
@@ -181,6 +182,7 @@ extern char *_nm_config_match_env;
 /*****************************************************************************/
 
 #define NM_CONFIG_DEVICE_STATE_DIR ""NMRUNDIR"/devices"
+#define NM_CONFIG_DEVICE_STATE_FILE ""NMRUNDIR"/devices.state"
 
 #define NM_CONFIG_DEFAULT_MAIN_AUTH_POLKIT_BOOL     (nm_streq (""NM_CONFIG_DEFAULT_MAIN_AUTH_POLKIT, "true"))
 #define NM_CONFIG_DEFAULT_LOGGING_AUDIT_BOOL        (nm_streq (""NM_CONFIG_DEFAULT_LOGGING_AUDIT, "true"))
@@ -210,6 +212,8 @@ gboolean nm_config_device_state_write (NMConfig *self,
                                        const char *perm_hw_addr_fake,
                                        const char *connection_uuid);
 void nm_config_device_state_prune_unseen (NMConfig *self, GHashTable *seen_ifindexes);
+void nm_config_device_state_remove (NMConfig *self, int ifindex);
+void nm_config_device_state_flush (NMConfig *self);
 
 /*****************************************************************************/
 
@@ -24,6 +24,8 @@
 #include "nm-connectivity.h"
 
 #include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
 #if WITH_CONCHECK
 #include <libsoup/soup.h>
 #endif
@@ -41,6 +43,17 @@ NM_GOBJECT_PROPERTIES_DEFINE (NMConnectivity,
 	PROP_STATE,
 );
 
+enum {
+	DEVICE_STATE_CHANGED,
+	LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL] = { 0 };
+
+/* After a failed per-device check, the next one is done after this many
+ * seconds, doubling with each further failure up to the regular interval. */
+#define DEVICE_CHECK_BACKOFF_MIN_SEC 5
+
 typedef struct {
 	char *uri;
 	char *response;
@@ -54,6 +67,9 @@ typedef struct {
 #endif
 
 	NMConnectivityState state;
+
+	/* int ifindex => DeviceCheck */
+	GHashTable *device_checks;
 } NMConnectivityPrivate;
 
 struct _NMConnectivity {
@@ -118,6 +134,55 @@ typedef struct {
 	guint check_id_when_scheduled;
 } ConCheckCbData;
 
+static NMConnectivityState
+_check_evaluate (SoupMessage *msg, const char *uri, const char *response, const char *ifname)
+{
+	const char *nm_header;
+	const char *dev_prefix = ifname ? "[" : "";
+	const char *dev_suffix = ifname ? "] " : "";
+
+	if (!ifname)
+		ifname = "";
+	if (!response)
+		response = NM_CONFIG_DEFAULT_CONNECTIVITY_RESPONSE;
+
+	if (SOUP_STATUS_IS_TRANSPORT_ERROR (msg->status_code)) {
+		_LOGI ("%s%s%scheck for uri '%s' failed with '%s'",
+		       dev_prefix, ifname, dev_suffix, uri, msg->reason_phrase);
+		return NM_CONNECTIVITY_LIMITED;
+	}
+
+	if (msg->status_code == 511) {
+		_LOGD ("%s%s%scheck for uri '%s' returned status '%d %s'; captive portal present.",
+		       dev_prefix, ifname, dev_suffix, uri, msg->status_code, msg->reason_phrase);
+		return NM_CONNECTIVITY_PORTAL;
+	}
+
+	/* Check headers; if we find the NM-specific one we're done */
+	nm_header = soup_message_headers_get_one (msg->response_headers, "X-NetworkManager-Status");
+	if (g_strcmp0 (nm_header, "online") == 0) {
+		_LOGD ("%s%s%scheck for uri '%s' with Status header successful.",
+		       dev_prefix, ifname, dev_suffix, uri);
+		return NM_CONNECTIVITY_FULL;
+	}
+
+	if (msg->status_code == SOUP_STATUS_OK) {
+		/* check response */
+		if (msg->response_body->data && g_str_has_prefix (msg->response_body->data, response)) {
+			_LOGD ("%s%s%scheck for uri '%s' successful.",
+			       dev_prefix, ifname, dev_suffix, uri);
+			return NM_CONNECTIVITY_FULL;
+		}
+		_LOGI ("%s%s%scheck for uri '%s' did not match expected response '%s'; assuming captive portal.",
+		       dev_prefix, ifname, dev_suffix, uri, response);
+		return NM_CONNECTIVITY_PORTAL;
+	}
+
+	_LOGI ("%s%s%scheck for uri '%s' returned status '%d %s'; assuming captive portal.",
+	       dev_prefix, ifname, dev_suffix, uri, msg->status_code, msg->reason_phrase);
+	return NM_CONNECTIVITY_PORTAL;
+}
+
 static void
 nm_connectivity_check_cb (SoupSession *session, SoupMessage *msg, gpointer user_data)
 {
@@ -126,49 +191,14 @@ nm_connectivity_check_cb (SoupSession *session, SoupMessage *msg, gpointer user_
 	ConCheckCbData *cb_data = user_data;
 	GSimpleAsyncResult *simple = cb_data->simple;
 	NMConnectivityState new_state;
-	const char *nm_header;
-	const char *uri = cb_data->uri;
-	const char *response = cb_data->response ? cb_data->response : NM_CONFIG_DEFAULT_CONNECTIVITY_RESPONSE;
 
 	self = NM_CONNECTIVITY (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
 	/* it is safe to unref @self here, @simple holds yet another reference. */
 	g_object_unref (self);
 	priv = NM_CONNECTIVITY_GET_PRIVATE (self);
 
-	if (SOUP_STATUS_IS_TRANSPORT_ERROR (msg->status_code)) {
-		_LOGI ("check for uri '%s' failed with '%s'", uri, msg->reason_phrase);
-		new_state = NM_CONNECTIVITY_LIMITED;
-		goto done;
-	}
+	new_state = _check_evaluate (msg, cb_data->uri, cb_data->response, NULL);
 
-	if (msg->status_code == 511) {
-		_LOGD ("check for uri '%s' returned status '%d %s'; captive portal present.",
-		       uri, msg->status_code, msg->reason_phrase);
-		new_state = NM_CONNECTIVITY_PORTAL;
-	} else {
-		/* Check headers; if we find the NM-specific one we're done */
-		nm_header = soup_message_headers_get_one (msg->response_headers, "X-NetworkManager-Status");
-		if (g_strcmp0 (nm_header, "online") == 0) {
-			_LOGD ("check for uri '%s' with Status header successful.", uri);
-			new_state = NM_CONNECTIVITY_FULL;
-		} else if (msg->status_code == SOUP_STATUS_OK) {
-			/* check response */
-			if (msg->response_body->data && g_str_has_prefix (msg->response_body->data, response)) {
-				_LOGD ("check for uri '%s' successful.", uri);
-				new_state = NM_CONNECTIVITY_FULL;
-			} else {
-				_LOGI ("check for uri '%s' did not match expected response '%s'; assuming captive portal.",
-					   uri, response);
-				new_state = NM_CONNECTIVITY_PORTAL;
-			}
-		} else {
-			_LOGI ("check for uri '%s' returned status '%d %s'; assuming captive portal.",
-			       uri, msg->status_code, msg->reason_phrase);
-			new_state = NM_CONNECTIVITY_PORTAL;
-		}
-	}
-
- done:
 	/* Only update the state, if the call was done from external, or if the periodic check
 	 * is still the one that called this async check. */
 	if (!cb_data->check_id_when_scheduled || cb_data->check_id_when_scheduled == priv->check_id) {
@@ -230,6 +260,318 @@ idle_start_periodic_checks (gpointer user_data)
 }
 #endif
 
+/*****************************************************************************/
+
+/* Per-device checks. Each device that was added via nm_connectivity_device_add()
+ * gets its own periodic probe, with its own soup session. The sockets of that
+ * session are bound to the interface, so the result tells whether that
+ * particular uplink reaches the internet. The checks of different devices
+ * run independently of each other and of the global check.
+ *
+ * Only the HTTP connection is bound, with SO_BINDTODEVICE. That restricts the
+ * route lookup to the interface, and the kernel picks the source address from
+ * it; no local address is bound explicitly. The host name of the URI is still
+ * resolved by the system resolver, i.e. via the DNS servers of the default
+ * route. A device whose own DNS servers are unreachable can thus still
+ * report full connectivity. */
+typedef struct {
+	NMConnectivity *self;
+	char *ifname;
+	int ifindex;
+	NMConnectivityState state;
+	guint n_failures;
+#if WITH_CONCHECK
+	guint timeout_id;
+	SoupSession *soup_session;
+	SoupMessage *msg;
+	bool bind_failed:1;
+#endif
+} DeviceCheck;
+
+#if WITH_CONCHECK
+static void
+_device_check_set_state (DeviceCheck *dc, NMConnectivityState state)
+{
+	NMConnectivity *self = dc->self;
+
+	if (dc->state == state)
+		return;
+
+	_LOGD ("[%s] state changed from %s to %s",
+	       dc->ifname,
+	       nm_connectivity_state_to_string (dc->state),
+	       nm_connectivity_state_to_string (state));
+	dc->state = state;
+	g_signal_emit (self, signals[DEVICE_STATE_CHANGED], 0, dc->ifindex, (guint) state);
+}
+
+static void _device_check_schedule (DeviceCheck *dc, gboolean immediately);
+
+static void
+_device_check_network_event (SoupMessage *msg,
+                             GSocketClientEvent event,
+                             GIOStream *connection,
+                             gpointer user_data)
+{
+	DeviceCheck *dc = user_data;
+	GSocket *socket;
+
+	/* bind the socket to the interface before it connects. Connections are
+	 * reused for later checks, they stay bound. An unbound connection is
+	 * dropped before the next check. */
+	if (event != G_SOCKET_CLIENT_CONNECTING)
+		return;
+
+	socket = g_socket_connection_get_socket (G_SOCKET_CONNECTION (connection));
+	if (setsockopt (g_socket_get_fd (socket),
+	                SOL_SOCKET,
+	                SO_BINDTODEVICE,
+	                dc->ifname,
+	                strlen (dc->ifname) + 1) != 0) {
+		int errsv = errno;
+
+		_LOGW ("[%s] failed to bind connectivity check to interface: %s",
+		       dc->ifname, g_strerror (errsv));
+		dc->bind_failed = TRUE;
+	}
+}
+
+static void
+_device_check_cb (SoupSession *session, SoupMessage *msg, gpointer user_data)
+{
+	DeviceCheck *dc = user_data;
+	NMConnectivityPrivate *priv;
+	NMConnectivityState state;
+
+	/* aborted by _device_check_free() or by a reschedule. */
+	if (msg->status_code == SOUP_STATUS_CANCELLED)
+		return;
+
+	priv = NM_CONNECTIVITY_GET_PRIVATE (dc->self);
+
+	dc->msg = NULL;
+
+	if (dc->bind_failed) {
+		/* the request didn't necessarily go out via this device, the
+		 * response says nothing about it. */
+		state = NM_CONNECTIVITY_UNKNOWN;
+	} else
+		state = _check_evaluate (msg, priv->uri, priv->response, dc->ifname);
+	if (state == NM_CONNECTIVITY_FULL)
+		dc->n_failures = 0;
+	else
+		dc->n_failures++;
+
+	_device_check_schedule (dc, FALSE);
+	_device_check_set_state (dc, state);
+}
+
+static gboolean
+_device_check_run (gpointer user_data)
+{
+	DeviceCheck *dc = user_data;
+	NMConnectivity *self = dc->self;
+	NMConnectivityPrivate *priv = NM_CONNECTIVITY_GET_PRIVATE (self);
+	SoupMessage *msg;
+
+	dc->timeout_id = 0;
+
+	if (dc->bind_failed) {
+		/* drop the unbound connection, so that the next request connects
+		 * (and tries to bind) anew. */
+		soup_session_abort (dc->soup_session);
+		dc->bind_failed = FALSE;
+	}
+
+	msg = soup_message_new ("GET", priv->uri);
+	if (!msg) {
+		_device_check_schedule (dc, FALSE);
+		return G_SOURCE_REMOVE;
+	}
+	soup_message_set_flags (msg, SOUP_MESSAGE_NO_REDIRECT);
+	g_signal_connect (msg, "network-event",
+	                  G_CALLBACK (_device_check_network_event), dc);
+
+	dc->msg = msg;
+	soup_session_queue_message (dc->soup_session, msg, _device_check_cb, dc);
+
+	_LOGD ("[%s] check: send request to '%s'", dc->ifname, priv->uri);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+_device_check_schedule (DeviceCheck *dc, gboolean immediately)
+{
+	NMConnectivityPrivate *priv = NM_CONNECTIVITY_GET_PRIVATE (dc->self);
+	guint interval_ms, jitter_ms;
+
+	nm_clear_g_source (&dc->timeout_id);
+	if (dc->msg) {
+		soup_session_cancel_message (dc->soup_session, dc->msg, SOUP_STATUS_CANCELLED);
+		dc->msg = NULL;
+	}
+
+	if (!priv->uri || !priv->interval) {
+		dc->n_failures = 0;
+		_device_check_set_state (dc, NM_CONNECTIVITY_UNKNOWN);
+		return;
+	}
+
+	if (immediately) {
+		dc->timeout_id = g_idle_add (_device_check_run, dc);
+		return;
+	}
+
+	interval_ms = priv->interval * 1000;
+	if (dc->n_failures > 0) {
+		guint backoff_ms = (DEVICE_CHECK_BACKOFF_MIN_SEC * 1000) << MIN (dc->n_failures - 1, 10);
+
+		interval_ms = MIN (interval_ms, backoff_ms);
+	}
+
+	/* add up to 10% jitter in either direction, so that the checks of
+	 * many devices don't all fire at the same time. */
+	jitter_ms = interval_ms / 10;
+	if (jitter_ms > 0)
+		interval_ms = interval_ms - jitter_ms + g_random_int_range (0, 2 * jitter_ms + 1);
+
+	dc->timeout_id = g_timeout_add (interval_ms, _device_check_run, dc);
+}
+#endif
+
+static void
+_device_check_free (gpointer data)
+{
+	DeviceCheck *dc = data;
+
+#if WITH_CONCHECK
+	nm_clear_g_source (&dc->timeout_id);
+	dc->msg = NULL;
+	if (dc->soup_session) {
+		soup_session_abort (dc->soup_session);
+		g_object_unref (dc->soup_session);
+	}
+#endif
+	g_free (dc->ifname);
+	g_slice_free (DeviceCheck, dc);
+}
+
+static void
+_device_checks_reschedule (NMConnectivity *self)
+{
+#if WITH_CONCHECK
+	NMConnectivityPrivate *priv = NM_CONNECTIVITY_GET_PRIVATE (self);
+	GHashTableIter iter;
+	DeviceCheck *dc;
+
+	if (!priv->device_checks)
+		return;
+
+	g_hash_table_iter_init (&iter, priv->device_checks);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &dc)) {
+		dc->n_failures = 0;
+		_device_check_schedule (dc, TRUE);
+	}
+#endif
+}
+
+/**
+ * nm_connectivity_device_add:
+ * @self: the #NMConnectivity
+ * @ifindex: the interface index
+ * @ifname: the interface name
+ *
+ * Starts periodic connectivity checks bound to the interface. Changes of
+ * the result are announced via the #NMConnectivity::device-state-changed
+ * signal. Adding an interface that is already checked restarts its checks.
+ */
+void
+nm_connectivity_device_add (NMConnectivity *self, int ifindex, const char *ifname)
+{
+	NMConnectivityPrivate *priv;
+	DeviceCheck *dc;
+
+	g_return_if_fail (NM_IS_CONNECTIVITY (self));
+	g_return_if_fail (ifindex > 0);
+	g_return_if_fail (ifname && *ifname);
+
+	priv = NM_CONNECTIVITY_GET_PRIVATE (self);
+	if (!priv->device_checks)
+		return;
+
+	dc = g_hash_table_lookup (priv->device_checks, GINT_TO_POINTER (ifindex));
+	if (dc && !nm_streq (dc->ifname, ifname)) {
+		g_hash_table_remove (priv->device_checks, GINT_TO_POINTER (ifindex));
+		dc = NULL;
+	}
+
+	if (!dc) {
+		dc = g_slice_new0 (DeviceCheck);
+		dc->self = self;
+		dc->ifindex = ifindex;
+		dc->ifname = g_strdup (ifname);
+		dc->state = NM_CONNECTIVITY_UNKNOWN;
+#if WITH_CONCHECK
+		dc->soup_session = soup_session_async_new_with_options (SOUP_SESSION_TIMEOUT, 15, NULL);
+#endif
+		g_hash_table_insert (priv->device_checks, GINT_TO_POINTER (ifindex), dc);
+		_LOGD ("[%s] start checking connectivity", ifname);
+	}
+
+	dc->n_failures = 0;
+#if WITH_CONCHECK
+	_device_check_schedule (dc, TRUE);
+#endif
+}
+
+/**
+ * nm_connectivity_device_remove:
+ * @self: the #NMConnectivity
+ * @ifindex: the interface index
+ *
+ * Stops the checks that were started by nm_connectivity_device_add().
+ */
+void
+nm_connectivity_device_remove (NMConnectivity *self, int ifindex)
+{
+	NMConnectivityPrivate *priv;
+
+	g_return_if_fail (NM_IS_CONNECTIVITY (self));
+
+	priv = NM_CONNECTIVITY_GET_PRIVATE (self);
+	if (!priv->device_checks)
+		return;
+
+	if (g_hash_table_remove (priv->device_checks, GINT_TO_POINTER (ifindex)))
+		_LOGD ("[%d] stop checking connectivity", ifindex);
+}
+
+/**
+ * nm_connectivity_device_get_state:
+ * @self: the #NMConnectivity
+ * @ifindex: the interface index
+ *
+ * Returns: the last result of the checks for @ifindex, or
+ *   %NM_CONNECTIVITY_UNKNOWN if the interface is not checked.
+ */
+NMConnectivityState
+nm_connectivity_device_get_state (NMConnectivity *self, int ifindex)
+{
+	NMConnectivityPrivate *priv;
+	DeviceCheck *dc;
+
+	g_return_val_if_fail (NM_IS_CONNECTIVITY (self), NM_CONNECTIVITY_UNKNOWN);
+
+	priv = NM_CONNECTIVITY_GET_PRIVATE (self);
+	if (!priv->device_checks)
+		return NM_CONNECTIVITY_UNKNOWN;
+
+	dc = g_hash_table_lookup (priv->device_checks, GINT_TO_POINTER (ifindex));
+	return dc ? dc->state : NM_CONNECTIVITY_UNKNOWN;
+}
+
+/*****************************************************************************/
+
 static void
 _reschedule_periodic_checks (NMConnectivity *self, gboolean force_reschedule)
 {
@@ -402,6 +744,7 @@ set_property (GObject *object, guint property_id,
 			g_free (priv->uri);
 			priv->uri = g_strdup (uri);
 			_reschedule_periodic_checks (self, TRUE);
+			_device_checks_reschedule (self);
 		}
 		break;
 	case PROP_INTERVAL:
@@ -409,6 +752,7 @@ set_property (GObject *object, guint property_id,
 		if (priv->interval != interval) {
 			priv->interval = interval;
 			_reschedule_periodic_checks (self, TRUE);
+			_device_checks_reschedule (self);
 		}
 		break;
 	case PROP_RESPONSE:
@@ -419,6 +763,7 @@ set_property (GObject *object, guint property_id,
 			g_free (priv->response);
 			priv->response = g_strdup (response);
 			_reschedule_periodic_checks (self, TRUE);
+			_device_checks_reschedule (self);
 		}
 		break;
 	default:
@@ -438,6 +783,7 @@ nm_connectivity_init (NMConnectivity *self)
 	priv->soup_session = soup_session_async_new_with_options (SOUP_SESSION_TIMEOUT, 15, NULL);
 #endif
 	priv->state = NM_CONNECTIVITY_NONE;
+	priv->device_checks = g_hash_table_new_full (NULL, NULL, NULL, _device_check_free);
 }
 
 NMConnectivity *
@@ -458,6 +804,7 @@ dispose (GObject *object)
 	NMConnectivity *self = NM_CONNECTIVITY (object);
 	NMConnectivityPrivate *priv = NM_CONNECTIVITY_GET_PRIVATE (self);
 
+	g_clear_pointer (&priv->device_checks, g_hash_table_unref);
 	g_clear_pointer (&priv->uri, g_free);
 	g_clear_pointer (&priv->response, g_free);
 
@@ -510,5 +857,12 @@ nm_connectivity_class_init (NMConnectivityClass *klass)
 	                        G_PARAM_STATIC_STRINGS);
 
 	g_object_class_install_properties (object_class, _PROPERTY_ENUMS_LAST, obj_properties);
+
+	signals[DEVICE_STATE_CHANGED] =
+	    g_signal_new (NM_CONNECTIVITY_DEVICE_STATE_CHANGED,
+	                  G_OBJECT_CLASS_TYPE (object_class),
+	                  G_SIGNAL_RUN_FIRST,
+	                  0, NULL, NULL, NULL,
+	                  G_TYPE_NONE, 2, G_TYPE_INT, G_TYPE_UINT);
 }
 
@@ -35,6 +35,9 @@
 #define NM_CONNECTIVITY_RESPONSE  "response"
 #define NM_CONNECTIVITY_STATE     "state"
 
+/* Signals */
+#define NM_CONNECTIVITY_DEVICE_STATE_CHANGED "device-state-changed"
+
 typedef struct _NMConnectivityClass NMConnectivityClass;
 
 GType nm_connectivity_get_type (void);
@@ -57,4 +60,12 @@ NMConnectivityState  nm_connectivity_check_finish (NMConnectivity       *self,
                                                    GAsyncResult         *result,
                                                    GError              **error);
 
+void                 nm_connectivity_device_add       (NMConnectivity *self,
+                                                       int ifindex,
+                                                       const char *ifname);
+void                 nm_connectivity_device_remove    (NMConnectivity *self,
+                                                       int ifindex);
+NMConnectivityState  nm_connectivity_device_get_state (NMConnectivity *self,
+                                                       int ifindex);
+
 #endif /* __NETWORKMANAGER_CONNECTIVITY_H__ */
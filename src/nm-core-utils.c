@@ -1461,12 +1461,11 @@ nm_match_spec_s390_subchannels (const GSList *specs, const char *subchannels)
 }
 
 static gboolean
-_match_config_nm_version (const char *str, const char *tag, guint cur_nm_version)
+_match_config_nm_version_parse (const char *str, gint *out_v_maj, gint *out_v_min, gint *out_v_mic)
 {
 	gs_free char *s_ver = NULL;
 	gs_strfreev char **s_ver_tokens = NULL;
 	gint v_maj = -1, v_min = -1, v_mic = -1;
-	guint c_maj = -1, c_min = -1, c_mic = -1;
 	guint n_tokens;
 
 	s_ver = g_strdup (str);
@@ -1496,6 +1495,17 @@ _match_config_nm_version (const char *str, const char *tag, guint cur_nm_version
 			return FALSE;
 	}
 
+	*out_v_maj = v_maj;
+	*out_v_min = v_min;
+	*out_v_mic = v_mic;
+	return TRUE;
+}
+
+static gboolean
+_match_config_nm_version_check (const char *tag, gint v_maj, gint v_min, gint v_mic, guint cur_nm_version)
+{
+	guint c_maj = -1, c_min = -1, c_mic = -1;
+
 	nm_decode_version (cur_nm_version, &c_maj, &c_min, &c_mic);
 
 #define CHECK_AND_RETURN_FALSE(cur, val, tag, is_last_digit) \
@@ -1523,6 +1533,15 @@ _match_config_nm_version (const char *str, const char *tag, guint cur_nm_version
 	return TRUE;
 }
 
+static gboolean
+_match_config_nm_version (const char *str, const char *tag, guint cur_nm_version)
+{
+	gint v_maj, v_min, v_mic;
+
+	return    _match_config_nm_version_parse (str, &v_maj, &v_min, &v_mic)
+	       && _match_config_nm_version_check (tag, v_maj, v_min, v_mic, cur_nm_version);
+}
+
 NMMatchSpecMatchType
 nm_match_spec_match_config (const GSList *specs, guint cur_nm_version, const char *env)
 {
@@ -1562,6 +1581,349 @@ nm_match_spec_match_config (const GSList *specs, guint cur_nm_version, const cha
 	return match;
 }
 
+/*****************************************************************************/
+
+typedef struct {
+	guint32 a, b, c;
+} MatchSpecSubchannels;
+
+typedef struct {
+	const char *tag;
+	gint v_maj, v_min, v_mic;
+} MatchSpecNMVersion;
+
+typedef struct {
+	/* exact values are hashed, so that matching is independent of the
+	 * number of specs. All fields are %NULL unless there is such a spec. */
+	GHashTable *interface_names;
+	GHashTable *hwaddrs;
+	GHashTable *device_types;
+	GHashTable *envs;
+	GPtrArray *interface_patterns;
+	GArray *subchannels;
+	GArray *nm_versions;
+} MatchSpecSet;
+
+struct _NMMatchSpecCompiled {
+	/* "except:" specs are kept in @neg, all others in @pos. */
+	MatchSpecSet pos;
+	MatchSpecSet neg;
+	bool match_all:1;
+};
+
+static const char *
+_match_spec_hwaddr_to_key (const char *hwaddr, char *buf)
+{
+	guint8 bin[NM_UTILS_HWADDR_LEN_MAX];
+	gsize len;
+
+	if (!_nm_utils_hwaddr_aton (hwaddr, bin, sizeof (bin), &len))
+		return NULL;
+
+	/* nm_utils_hwaddr_matches() only compares the last 8 bytes of
+	 * InfiniBand addresses. Normalize the key accordingly. */
+	if (len == INFINIBAND_ALEN)
+		memset (bin, 0, INFINIBAND_ALEN - 8);
+
+	return nm_utils_hwaddr_ntoa_buf (bin, len, FALSE, buf, NM_UTILS_HWADDR_LEN_MAX_STR);
+}
+
+static void
+_match_spec_set_add_str (GHashTable **p_hash, const char *str)
+{
+	if (!*p_hash)
+		*p_hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	g_hash_table_add (*p_hash, g_strdup (str));
+}
+
+static void
+_match_spec_set_add_hwaddr (MatchSpecSet *set, const char *hwaddr)
+{
+	char buf[NM_UTILS_HWADDR_LEN_MAX_STR];
+	const char *key;
+
+	key = _match_spec_hwaddr_to_key (hwaddr, buf);
+	if (key)
+		_match_spec_set_add_str (&set->hwaddrs, key);
+}
+
+static void
+_match_spec_set_add_interface_name (MatchSpecSet *set, const char *interface_name, gboolean use_pattern)
+{
+	if (   use_pattern
+	    && strpbrk (interface_name, "*?")) {
+		if (!set->interface_patterns)
+			set->interface_patterns = g_ptr_array_new_with_free_func ((GDestroyNotify) g_pattern_spec_free);
+		g_ptr_array_add (set->interface_patterns, g_pattern_spec_new (interface_name));
+		return;
+	}
+
+	/* a pattern without wildcards only matches itself. */
+	_match_spec_set_add_str (&set->interface_names, interface_name);
+}
+
+static void
+_match_spec_set_clear (MatchSpecSet *set)
+{
+	g_clear_pointer (&set->interface_names, g_hash_table_unref);
+	g_clear_pointer (&set->hwaddrs, g_hash_table_unref);
+	g_clear_pointer (&set->device_types, g_hash_table_unref);
+	g_clear_pointer (&set->envs, g_hash_table_unref);
+	g_clear_pointer (&set->interface_patterns, g_ptr_array_unref);
+	g_clear_pointer (&set->subchannels, g_array_unref);
+	g_clear_pointer (&set->nm_versions, g_array_unref);
+}
+
+static void
+_match_spec_compile_one (NMMatchSpecCompiled *self, const char *spec_str)
+{
+	MatchSpecSet *set;
+	gboolean except;
+	const char *spec_config;
+
+	if (!spec_str || !*spec_str)
+		return;
+
+	if (!strcmp (spec_str, "*")) {
+		self->match_all = TRUE;
+		return;
+	}
+
+	spec_str = _match_except (spec_str, &except);
+	set = except ? &self->neg : &self->pos;
+
+	if (_spec_has_prefix (&spec_str, DEVICE_TYPE_TAG)) {
+		_match_spec_set_add_str (&set->device_types, spec_str);
+		return;
+	}
+
+	if (_spec_has_prefix (&spec_str, SUBCHAN_TAG)) {
+		MatchSpecSubchannels sc = { 0 };
+
+		if (parse_subchannels (spec_str, &sc.a, &sc.b, &sc.c)) {
+			if (!set->subchannels)
+				set->subchannels = g_array_new (FALSE, FALSE, sizeof (MatchSpecSubchannels));
+			g_array_append_val (set->subchannels, sc);
+		}
+		return;
+	}
+
+	if (_spec_has_prefix (&spec_str, MAC_TAG)) {
+		_match_spec_set_add_hwaddr (set, spec_str);
+		return;
+	}
+
+	if (_spec_has_prefix (&spec_str, INTERFACE_NAME_TAG)) {
+		if (spec_str[0] == '=')
+			_match_spec_set_add_interface_name (set, &spec_str[1], FALSE);
+		else
+			_match_spec_set_add_interface_name (set, spec_str[0] == '~' ? &spec_str[1] : spec_str, TRUE);
+		return;
+	}
+
+	/* Config specs are only considered by nm_match_spec_compiled_match_config().
+	 * For devices, they are untagged specs just like with the uncompiled
+	 * matchers. */
+	spec_config = spec_str;
+	if (_spec_has_prefix (&spec_config, MATCH_TAG_CONFIG_ENV))
+		_match_spec_set_add_str (&set->envs, spec_config);
+	else {
+		MatchSpecNMVersion v = { 0 };
+
+		if (_spec_has_prefix (&spec_config, MATCH_TAG_CONFIG_NM_VERSION))
+			v.tag = MATCH_TAG_CONFIG_NM_VERSION;
+		else if (_spec_has_prefix (&spec_config, MATCH_TAG_CONFIG_NM_VERSION_MIN))
+			v.tag = MATCH_TAG_CONFIG_NM_VERSION_MIN;
+		else if (_spec_has_prefix (&spec_config, MATCH_TAG_CONFIG_NM_VERSION_MAX))
+			v.tag = MATCH_TAG_CONFIG_NM_VERSION_MAX;
+
+		if (   v.tag
+		    && _match_config_nm_version_parse (spec_config, &v.v_maj, &v.v_min, &v.v_mic)) {
+			if (!set->nm_versions)
+				set->nm_versions = g_array_new (FALSE, FALSE, sizeof (MatchSpecNMVersion));
+			g_array_append_val (set->nm_versions, v);
+		}
+	}
+
+	/* untagged specs are matched against the interface name and
+	 * the MAC address, but "except:" requires an explicit tag. */
+	if (!except) {
+		_match_spec_set_add_interface_name (set, spec_str, FALSE);
+		_match_spec_set_add_hwaddr (set, spec_str);
+	}
+}
+
+/**
+ * nm_match_spec_compile:
+ * @specs: (element-type utf8): a list of specs, as returned
+ *   by nm_match_spec_split().
+ *
+ * Parses @specs once, so that they can be matched repeatedly without
+ * re-parsing them. The result matches the same as the individual
+ * nm_match_spec_*() functions.
+ *
+ * Returns: (transfer full): the compiled specs, or %NULL if @specs
+ *   contains no spec at all. %NULL is a valid argument for the
+ *   matching functions and never matches. Free with
+ *   nm_match_spec_compiled_free().
+ */
+NMMatchSpecCompiled *
+nm_match_spec_compile (const GSList *specs)
+{
+	NMMatchSpecCompiled *self;
+	const GSList *iter;
+
+	if (!specs)
+		return NULL;
+
+	self = g_slice_new0 (NMMatchSpecCompiled);
+	for (iter = specs; iter; iter = iter->next)
+		_match_spec_compile_one (self, iter->data);
+	return self;
+}
+
+void
+nm_match_spec_compiled_free (NMMatchSpecCompiled *self)
+{
+	if (!self)
+		return;
+
+	_match_spec_set_clear (&self->pos);
+	_match_spec_set_clear (&self->neg);
+	g_slice_free (NMMatchSpecCompiled, self);
+}
+
+static gboolean
+_match_spec_set_match_device (const MatchSpecSet *set,
+                              const char *interface_name,
+                              const char *device_type,
+                              const char *hwaddr_key,
+                              const MatchSpecSubchannels *subchannels)
+{
+	guint i;
+
+	if (interface_name) {
+		if (   set->interface_names
+		    && g_hash_table_contains (set->interface_names, interface_name))
+			return TRUE;
+		if (set->interface_patterns) {
+			for (i = 0; i < set->interface_patterns->len; i++) {
+				if (g_pattern_match_string (set->interface_patterns->pdata[i], interface_name))
+					return TRUE;
+			}
+		}
+	}
+
+	if (   hwaddr_key
+	    && set->hwaddrs
+	    && g_hash_table_contains (set->hwaddrs, hwaddr_key))
+		return TRUE;
+
+	if (   device_type
+	    && set->device_types
+	    && g_hash_table_contains (set->device_types, device_type))
+		return TRUE;
+
+	if (   subchannels
+	    && set->subchannels) {
+		for (i = 0; i < set->subchannels->len; i++) {
+			const MatchSpecSubchannels *sc = &g_array_index (set->subchannels, MatchSpecSubchannels, i);
+
+			if (   sc->a == subchannels->a
+			    && sc->b == subchannels->b
+			    && sc->c == subchannels->c)
+				return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+ * nm_match_spec_compiled_match_device:
+ * @self: (allow-none): the compiled specs
+ * @interface_name: (allow-none): the interface name of the device
+ * @device_type: (allow-none): the type description of the device
+ * @hwaddr: (allow-none): the permanent MAC address of the device
+ * @s390_subchannels: (allow-none): the s390 subchannels of the device
+ *
+ * Matches the device properties against all specs at once. Arguments
+ * that are %NULL are not considered. A "*" spec matches every device.
+ *
+ * Returns: %NM_MATCH_SPEC_NEG_MATCH if any "except:" spec matches,
+ *   otherwise %NM_MATCH_SPEC_MATCH if any spec matches.
+ */
+NMMatchSpecMatchType
+nm_match_spec_compiled_match_device (const NMMatchSpecCompiled *self,
+                                     const char *interface_name,
+                                     const char *device_type,
+                                     const char *hwaddr,
+                                     const char *s390_subchannels)
+{
+	char hwaddr_buf[NM_UTILS_HWADDR_LEN_MAX_STR];
+	const char *hwaddr_key = NULL;
+	MatchSpecSubchannels sc = { 0 };
+	gboolean has_sc = FALSE;
+
+	if (!self)
+		return NM_MATCH_SPEC_NO_MATCH;
+
+	if (device_type && !*device_type)
+		device_type = NULL;
+	if (hwaddr) {
+		hwaddr_key = _match_spec_hwaddr_to_key (hwaddr, hwaddr_buf);
+		nm_assert (hwaddr_key);
+	}
+	if (s390_subchannels)
+		has_sc = parse_subchannels (s390_subchannels, &sc.a, &sc.b, &sc.c);
+
+	if (_match_spec_set_match_device (&self->neg, interface_name, device_type,
+	                                  hwaddr_key, has_sc ? &sc : NULL))
+		return NM_MATCH_SPEC_NEG_MATCH;
+
+	if (   self->match_all
+	    || _match_spec_set_match_device (&self->pos, interface_name, device_type,
+	                                     hwaddr_key, has_sc ? &sc : NULL))
+		return NM_MATCH_SPEC_MATCH;
+
+	return NM_MATCH_SPEC_NO_MATCH;
+}
+
+static gboolean
+_match_spec_set_match_config (const MatchSpecSet *set, guint cur_nm_version, const char *env)
+{
+	guint i;
+
+	if (   env && env[0]
+	    && set->envs
+	    && g_hash_table_contains (set->envs, env))
+		return TRUE;
+
+	if (set->nm_versions) {
+		for (i = 0; i < set->nm_versions->len; i++) {
+			const MatchSpecNMVersion *v = &g_array_index (set->nm_versions, MatchSpecNMVersion, i);
+
+			if (_match_config_nm_version_check (v->tag, v->v_maj, v->v_min, v->v_mic, cur_nm_version))
+				return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+NMMatchSpecMatchType
+nm_match_spec_compiled_match_config (const NMMatchSpecCompiled *self, guint cur_nm_version, const char *env)
+{
+	if (!self)
+		return NM_MATCH_SPEC_NO_MATCH;
+
+	if (_match_spec_set_match_config (&self->neg, cur_nm_version, env))
+		return NM_MATCH_SPEC_NEG_MATCH;
+	if (_match_spec_set_match_config (&self->pos, cur_nm_version, env))
+		return NM_MATCH_SPEC_MATCH;
+	return NM_MATCH_SPEC_NO_MATCH;
+}
+
 /**
  * nm_match_spec_split:
  * @value: the string of device specs
@@ -150,6 +150,15 @@ NMMatchSpecMatchType nm_match_spec_match_config (const GSList *specs, guint nm_v
 GSList *nm_match_spec_split (const char *value);
 char *nm_match_spec_join (GSList *specs);
 
+NMMatchSpecCompiled *nm_match_spec_compile (const GSList *specs);
+void nm_match_spec_compiled_free (NMMatchSpecCompiled *self);
+NMMatchSpecMatchType nm_match_spec_compiled_match_device (const NMMatchSpecCompiled *self,
+                                                          const char *interface_name,
+                                                          const char *device_type,
+                                                          const char *hwaddr,
+                                                          const char *s390_subchannels);
+NMMatchSpecMatchType nm_match_spec_compiled_match_config (const NMMatchSpecCompiled *self, guint nm_version, const char *env);
+
 extern char _nm_utils_to_string_buffer[2096];
 
 void     nm_utils_to_string_buffer_init (char **buf, gsize *len);
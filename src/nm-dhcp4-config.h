@@ -39,6 +39,8 @@ NMDhcp4Config *nm_dhcp4_config_new (void);
 void nm_dhcp4_config_set_options (NMDhcp4Config *config,
                                   GHashTable *options);
 
+void nm_dhcp4_config_reset (NMDhcp4Config *config);
+
 const char *nm_dhcp4_config_get_option (NMDhcp4Config *config, const char *option);
 
 GVariant *nm_dhcp4_config_get_options (NMDhcp4Config *config);
@@ -55,28 +55,56 @@ G_DEFINE_TYPE (NMDhcp6Config, nm_dhcp6_config, NM_TYPE_EXPORTED_OBJECT)
 
 /*****************************************************************************/
 
+static void
+_set_options (NMDhcp6Config *self, GVariant *options)
+{
+	NMDhcp6ConfigPrivate *priv = NM_DHCP6_CONFIG_GET_PRIVATE (self);
+
+	g_variant_ref_sink (options);
+
+	/* the object is kept across lease renewals. Only emit a change
+	 * if the options really differ. */
+	if (g_variant_equal (priv->options, options)) {
+		g_variant_unref (options);
+		return;
+	}
+
+	g_variant_unref (priv->options);
+	priv->options = options;
+	_notify (self, PROP_OPTIONS);
+}
+
 void
 nm_dhcp6_config_set_options (NMDhcp6Config *self,
                              GHashTable *options)
 {
-	NMDhcp6ConfigPrivate *priv = NM_DHCP6_CONFIG_GET_PRIVATE (self);
-	GHashTableIter iter;
-	const char *key, *value;
+	gs_free const char **keys = NULL;
 	GVariantBuilder builder;
+	guint i, len;
 
 	g_return_if_fail (NM_IS_DHCP6_CONFIG (self));
 	g_return_if_fail (options != NULL);
 
-	g_variant_unref (priv->options);
+	/* sort the keys, so that equal options give an equal variant. */
+	keys = (const char **) g_hash_table_get_keys_as_array (options, &len);
+	if (len > 1)
+		g_qsort_with_data (keys, len, sizeof (keys[0]), nm_strcmp_p_with_data, NULL);
 
 	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
-	g_hash_table_iter_init (&iter, options);
-	while (g_hash_table_iter_next (&iter, (gpointer) &key, (gpointer) &value))
-		g_variant_builder_add (&builder, "{sv}", key, g_variant_new_string (value));
+	for (i = 0; i < len; i++) {
+		g_variant_builder_add (&builder, "{sv}", keys[i],
+		                       g_variant_new_string (g_hash_table_lookup (options, keys[i])));
+	}
 
-	priv->options = g_variant_builder_end (&builder);
-	g_variant_ref_sink (priv->options);
-	_notify (self, PROP_OPTIONS);
+	_set_options (self, g_variant_builder_end (&builder));
+}
+
+void
+nm_dhcp6_config_reset (NMDhcp6Config *self)
+{
+	g_return_if_fail (NM_IS_DHCP6_CONFIG (self));
+
+	_set_options (self, g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0));
 }
 
 const char *
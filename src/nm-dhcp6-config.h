@@ -39,6 +39,8 @@ NMDhcp6Config *nm_dhcp6_config_new (void);
 void nm_dhcp6_config_set_options (NMDhcp6Config *config,
                                   GHashTable *options);
 
+void nm_dhcp6_config_reset (NMDhcp6Config *config);
+
 const char *nm_dhcp6_config_get_option (NMDhcp6Config *config, const char *option);
 
 GVariant *nm_dhcp6_config_get_options (NMDhcp6Config *self);
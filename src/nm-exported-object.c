@@ -26,6 +26,7 @@
 #include <string.h>
 
 #include "nm-bus-manager.h"
+#include "nm-core-utils.h"
 
 #include "devices/nm-device.h"
 #include "nm-active-connection.h"
@@ -40,7 +41,13 @@ static gboolean quitting = FALSE;
 typedef struct {
 	GDBusInterfaceSkeleton *interface;
 	guint property_changed_signal_id;
+
+	/* set of PropertyInfo */
 	GHashTable *pending_notifies;
+
+	/* PropertyInfo => (guint32) timestamp in msec of the last emission,
+	 * only for properties with a minimal notify interval. */
+	GHashTable *last_emitted;
 } InterfaceData;
 
 typedef struct _NMExportedObjectPrivate {
@@ -50,7 +57,12 @@ typedef struct _NMExportedObjectPrivate {
 	InterfaceData *interfaces;
 	guint num_interfaces;
 
-	guint notify_idle_id;
+	guint throttle_id;
+
+	/* position in _notify_pending_objects or _notify_dispatching_objects,
+	 * valid while notify_pending is set. */
+	guint notify_idx;
+	bool notify_pending:1;
 
 #ifdef _ASSERT_NO_EARLY_EXPORT
 	bool _constructed:1;
@@ -63,6 +75,15 @@ G_DEFINE_ABSTRACT_TYPE (NMExportedObject, nm_exported_object, G_TYPE_DBUS_OBJECT
 
 /*****************************************************************************/
 
+typedef struct {
+	const char *property_name;
+	const char *dbus_property_name;
+	GType value_type;
+	GType skeleton_type;
+	const GVariantType *vtype;
+	guint min_interval_ms;
+} PropertyInfo;
+
 typedef struct {
 	GHashTable *properties;
 	GSList *skeleton_types;
@@ -72,6 +93,11 @@ typedef struct {
 GQuark nm_exported_object_class_info_quark (void);
 G_DEFINE_QUARK (NMExportedObjectClassInfo, nm_exported_object_class_info)
 
+/* Per instance type, a table from GParamSpec to the PropertyInfo of the
+ * class that exports it (or %NULL). Filled on first notification. */
+GQuark nm_exported_object_notify_table_quark (void);
+G_DEFINE_QUARK (NMExportedObjectNotifyTable, nm_exported_object_notify_table)
+
 /*****************************************************************************/
 
 #define _NMLOG_DOMAIN      LOGD_CORE
@@ -255,6 +281,7 @@ nm_exported_object_class_add_interface (NMExportedObjectClass *object_class,
 	gs_free GParamSpec **dbus_properties = NULL;
 	GParamSpec *object_property;
 	guint n_dbus_properties;
+	GDBusInterfaceInfo *iinfo;
 
 	g_return_if_fail (NM_IS_EXPORTED_OBJECT_CLASS (object_class));
 	g_return_if_fail (g_type_is_a (dbus_skeleton_type, G_TYPE_DBUS_INTERFACE_SKELETON));
@@ -290,9 +317,16 @@ nm_exported_object_class_add_interface (NMExportedObjectClass *object_class,
 	}
 	va_end (ap);
 
+	/* The gdbus-codegen implementation of get_info() ignores its argument. */
+	iinfo = G_DBUS_INTERFACE_SKELETON_CLASS (dbus_object_class)->get_info (NULL);
+	g_assert (iinfo);
+
 	/* Properties */
 	dbus_properties = g_object_class_list_properties (dbus_object_class, &n_dbus_properties);
 	for (i = 0; i < n_dbus_properties; i++) {
+		GDBusPropertyInfo *dbus_pinfo;
+		PropertyInfo *pinfo;
+		gs_free char *dbus_name = NULL;
 		char *hyphen_name;
 
 		if (g_str_has_prefix (dbus_properties[i]->name, "g-"))
@@ -303,16 +337,27 @@ nm_exported_object_class_add_interface (NMExportedObjectClass *object_class,
 		g_assert (object_property != NULL);
 		g_assert (object_property->value_type == dbus_properties[i]->value_type);
 
+		pinfo = g_slice_new0 (PropertyInfo);
+		pinfo->property_name = g_intern_string (object_property->name);
+		dbus_name = dbusify_name (dbus_properties[i]->name);
+		pinfo->dbus_property_name = g_intern_string (dbus_name);
+		pinfo->value_type = object_property->value_type;
+		pinfo->skeleton_type = dbus_skeleton_type;
+
+		dbus_pinfo = g_dbus_interface_info_lookup_property (iinfo, pinfo->dbus_property_name);
+		g_assert (dbus_pinfo);
+		pinfo->vtype = G_VARIANT_TYPE (dbus_pinfo->signature);
+
 		g_assert (!g_hash_table_contains (classinfo->properties, dbus_properties[i]->name));
 		g_hash_table_insert (classinfo->properties,
 		                     g_strdup (dbus_properties[i]->name),
-		                     dbusify_name (dbus_properties[i]->name));
+		                     pinfo);
 		hyphen_name = hyphenify_name (dbus_properties[i]->name);
 		if (hyphen_name) {
 			g_assert (!g_hash_table_contains (classinfo->properties, hyphen_name));
 			g_hash_table_insert (classinfo->properties,
 			                     hyphen_name,
-			                     dbusify_name (dbus_properties[i]->name));
+			                     pinfo);
 		}
 	}
 
@@ -495,10 +540,8 @@ nm_exported_object_create_skeletons (NMExportedObject *self,
 
 		ifdata->property_changed_signal_id = g_signal_lookup ("properties-changed", G_OBJECT_TYPE (ifdata->interface));
 
-		ifdata->pending_notifies = g_hash_table_new_full (g_direct_hash,
-		                                                  g_direct_equal,
-		                                                  NULL,
-		                                                  (GDestroyNotify) g_variant_unref);
+		ifdata->pending_notifies = g_hash_table_new (g_direct_hash, g_direct_equal);
+		ifdata->last_emitted = NULL;
 	}
 	nm_assert (i == 0);
 
@@ -553,6 +596,8 @@ nm_exported_object_destroy_skeletons (NMExportedObject *self)
 		g_dbus_object_skeleton_remove_interface ((GDBusObjectSkeleton *) self, ifdata->interface);
 		nm_exported_object_skeleton_release (ifdata->interface);
 		g_hash_table_destroy (ifdata->pending_notifies);
+		if (ifdata->last_emitted)
+			g_hash_table_destroy (ifdata->last_emitted);
 	}
 
 	g_slice_free1 (sizeof (InterfaceData) * n, priv->interfaces);
@@ -685,6 +730,8 @@ nm_exported_object_export (NMExportedObject *self)
  * Unexports @self on all active D-Bus connections (and prevents it from being
  * auto-exported on future connections).
  */
+static void _notify_cancel (NMExportedObject *self);
+
 void
 nm_exported_object_unexport (NMExportedObject *self)
 {
@@ -712,7 +759,7 @@ nm_exported_object_unexport (NMExportedObject *self)
 
 	g_clear_pointer (&priv->path, g_free);
 
-	nm_clear_g_source (&priv->notify_idle_id);
+	_notify_cancel (self);
 }
 
 /*****************************************************************************/
@@ -775,32 +822,95 @@ nm_exported_object_class_set_quitting (void)
 
 /*****************************************************************************/
 
+/* All objects with pending notifications, dispatched together from
+ * a single idle handler. */
+static GPtrArray *_notify_pending_objects;
+static GPtrArray *_notify_dispatching_objects;
+static guint _notify_idle_id;
+
+static gboolean _notify_dispatch (gpointer user_data);
+
+static void
+_notify_schedule (NMExportedObject *self)
+{
+	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (self);
+
+	if (priv->notify_pending)
+		return;
+
+	priv->notify_pending = TRUE;
+	if (!_notify_pending_objects)
+		_notify_pending_objects = g_ptr_array_new ();
+	priv->notify_idx = _notify_pending_objects->len;
+	g_ptr_array_add (_notify_pending_objects, self);
+	if (!_notify_idle_id)
+		_notify_idle_id = g_idle_add (_notify_dispatch, NULL);
+}
+
+static void
+_notify_array_drop (GPtrArray *arr, NMExportedObject *self, guint idx)
+{
+	/* don't reorder the array, just clear the slot. */
+	if (   arr
+	    && idx < arr->len
+	    && arr->pdata[idx] == self)
+		arr->pdata[idx] = NULL;
+}
+
+static void
+_notify_cancel (NMExportedObject *self)
+{
+	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (self);
+
+	nm_clear_g_source (&priv->throttle_id);
+
+	if (!priv->notify_pending)
+		return;
+
+	priv->notify_pending = FALSE;
+	/* the object is in one of the arrays, depending on whether
+	 * the dispatch of it already started. */
+	_notify_array_drop (_notify_pending_objects, self, priv->notify_idx);
+	_notify_array_drop (_notify_dispatching_objects, self, priv->notify_idx);
+}
+
+static gboolean
+_notify_throttle_cb (gpointer user_data)
+{
+	NMExportedObject *self = user_data;
+
+	NM_EXPORTED_OBJECT_GET_PRIVATE (self)->throttle_id = 0;
+	_notify_schedule (self);
+	return G_SOURCE_REMOVE;
+}
+
 typedef struct {
-	const char *property_name;
+	const PropertyInfo *pinfo;
 	GVariant *variant;
 } PendingNotifiesItem;
 
 static int
 _sort_pending_notifies (gconstpointer a, gconstpointer b, gpointer       user_data)
 {
-	return strcmp (((const PendingNotifiesItem *) a)->property_name,
-	               ((const PendingNotifiesItem *) b)->property_name);
+	return strcmp (((const PendingNotifiesItem *) a)->pinfo->dbus_property_name,
+	               ((const PendingNotifiesItem *) b)->pinfo->dbus_property_name);
 }
 
-static gboolean
-idle_emit_properties_changed (gpointer self)
+static void
+emit_properties_changed (NMExportedObject *self)
 {
-	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (NM_EXPORTED_OBJECT (self));
+	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (self);
+	guint32 now = 0;
+	guint32 throttle_wait = G_MAXUINT32;
 	guint k;
 
-	priv->notify_idle_id = 0;
-
 	for (k = 0; k < priv->num_interfaces; k++) {
 		InterfaceData *ifdata = &priv->interfaces[k];
 		gs_unref_variant GVariant *variant = NULL;
 		PendingNotifiesItem *values;
 		GVariantBuilder notifies;
 		GHashTableIter hash_iter;
+		const PropertyInfo *pinfo;
 		guint i, n;
 
 		n = g_hash_table_size (ifdata->pending_notifies);
@@ -817,18 +927,53 @@ idle_emit_properties_changed (gpointer self)
 
 		i = 0;
 		g_hash_table_iter_init (&hash_iter, ifdata->pending_notifies);
-		while (g_hash_table_iter_next (&hash_iter, (gpointer) &values[i].property_name, (gpointer) &values[i].variant))
+		while (g_hash_table_iter_next (&hash_iter, NULL, (gpointer *) &pinfo)) {
+			if (pinfo->min_interval_ms) {
+				gpointer last;
+
+				if (!now)
+					now = (guint32) nm_utils_get_monotonic_timestamp_ms ();
+				if (!ifdata->last_emitted)
+					ifdata->last_emitted = g_hash_table_new (g_direct_hash, g_direct_equal);
+				else if (g_hash_table_lookup_extended (ifdata->last_emitted, pinfo, NULL, &last)) {
+					guint32 elapsed = now - GPOINTER_TO_UINT (last);
+
+					if (elapsed < pinfo->min_interval_ms) {
+						/* too early, leave it pending until the throttle timeout. */
+						throttle_wait = MIN (throttle_wait, pinfo->min_interval_ms - elapsed);
+						continue;
+					}
+				}
+				g_hash_table_insert (ifdata->last_emitted, (gpointer) pinfo, GUINT_TO_POINTER (now));
+			}
+			g_hash_table_iter_remove (&hash_iter);
+			values[i].pinfo = pinfo;
 			i++;
-		nm_assert (i == n);
+		}
+		n = i;
+		if (n == 0)
+			continue;
 
 		g_qsort_with_data (values, n, sizeof (values[0]), _sort_pending_notifies, NULL);
 
+		/* read the values only now, so that a property changing several
+		 * times within one main loop iteration is converted only once. */
+		for (i = 0; i < n; i++) {
+			GValue value = G_VALUE_INIT;
+
+			g_value_init (&value, values[i].pinfo->value_type);
+			g_object_get_property ((GObject *) self, values[i].pinfo->property_name, &value);
+			values[i].variant = g_dbus_gvalue_to_gvariant (&value, values[i].pinfo->vtype);
+			g_value_unset (&value);
+		}
+
 		g_variant_builder_init (&notifies, G_VARIANT_TYPE_VARDICT);
-		for (i = 0; i < n; i++)
-			g_variant_builder_add (&notifies, "{sv}", values[i].property_name, values[i].variant);
+		for (i = 0; i < n; i++) {
+			g_variant_builder_add (&notifies, "{sv}", values[i].pinfo->dbus_property_name, values[i].variant);
+			g_variant_unref (values[i].variant);
+		}
 		variant = g_variant_ref_sink (g_variant_builder_end (&notifies));
 
-
 		if (_LOG2D_ENABLED ()) {
 			gs_free char *notification = g_variant_print (variant, TRUE);
 
@@ -839,25 +984,108 @@ idle_emit_properties_changed (gpointer self)
 
 		g_signal_emit (ifdata->interface, ifdata->property_changed_signal_id, 0, variant);
 
-		g_hash_table_remove_all (ifdata->pending_notifies);
+		/* a signal handler might have unexported the object. */
+		if (!priv->interfaces)
+			return;
+	}
+
+	if (   throttle_wait != G_MAXUINT32
+	    && !priv->throttle_id)
+		priv->throttle_id = g_timeout_add (throttle_wait, _notify_throttle_cb, self);
+}
+
+static gboolean
+_notify_dispatch (gpointer user_data)
+{
+	GPtrArray *arr;
+	guint i;
+
+	_notify_idle_id = 0;
+
+	arr = _notify_pending_objects;
+	_notify_pending_objects = NULL;
+	if (!arr)
+		return G_SOURCE_REMOVE;
+
+	nm_assert (!_notify_dispatching_objects);
+	_notify_dispatching_objects = arr;
+
+	for (i = 0; i < arr->len; i++) {
+		NMExportedObject *self = arr->pdata[i];
+
+		if (!self)
+			continue;
+
+		/* clear the slot first. Notifications raised during emission
+		 * schedule the object again for the next dispatch. */
+		arr->pdata[i] = NULL;
+		NM_EXPORTED_OBJECT_GET_PRIVATE (self)->notify_pending = FALSE;
+		g_object_ref (self);
+		emit_properties_changed (self);
+		g_object_unref (self);
 	}
 
+	_notify_dispatching_objects = NULL;
+	g_ptr_array_unref (arr);
 	return G_SOURCE_REMOVE;
 }
 
+static const PropertyInfo *
+_lookup_property_info (GType type, GParamSpec *pspec)
+{
+	NMExportedObjectClassInfo *classinfo;
+	GHashTable *table;
+	const PropertyInfo *pinfo = NULL;
+	gpointer value;
+	GType t;
+
+	table = g_type_get_qdata (type, nm_exported_object_notify_table_quark ());
+	if (!table) {
+		/* types are never unloaded, thus the table is never freed. */
+		table = g_hash_table_new (g_direct_hash, g_direct_equal);
+		g_type_set_qdata (type, nm_exported_object_notify_table_quark (), table);
+	} else if (g_hash_table_lookup_extended (table, pspec, NULL, &value))
+		return value;
+
+	for (t = type; t; t = g_type_parent (t)) {
+		classinfo = g_type_get_qdata (t, nm_exported_object_class_info_quark ());
+		if (!classinfo)
+			continue;
+
+		pinfo = g_hash_table_lookup (classinfo->properties, pspec->name);
+		if (pinfo)
+			break;
+	}
+
+	g_hash_table_insert (table, pspec, (gpointer) pinfo);
+	return pinfo;
+}
+
+static gboolean
+_pending_notify_add (InterfaceData *ifdata, const PropertyInfo *pinfo)
+{
+	if (!ifdata->property_changed_signal_id)
+		return FALSE;
+
+	/* nobody can be listening, if the interface isn't exported yet. */
+	if (!g_dbus_interface_skeleton_get_connection (ifdata->interface))
+		return FALSE;
+
+	/* @pinfo is inside classinfo and never freed. Also, we compare
+	 * pointers, not strings. */
+	g_hash_table_add (ifdata->pending_notifies, (gpointer) pinfo);
+	return TRUE;
+}
+
 static void
 nm_exported_object_notify (GObject *object, GParamSpec *pspec)
 {
 	NMExportedObject *self = (NMExportedObject *) object;
 	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (self);
-	NMExportedObjectClassInfo *classinfo;
-	GType type;
-	const char *dbus_property_name = NULL;
-	GValue value = G_VALUE_INIT;
-	GVariant *value_variant;
+	const PropertyInfo *pinfo;
 	InterfaceData *ifdata = NULL;
-	const GVariantType *vtype;
-	guint i, j;
+	gboolean scheduled = FALSE;
+	guint i;
 
 	/* Hook to emit deprecated "PropertiesChanged" signal on NetworkManager interfaces.
 	 * This is to preserve deprecated D-Bus API, nowadays we use instead
@@ -866,40 +1094,20 @@ nm_exported_object_notify (GObject *object, GParamSpec *pspec)
 	if (priv->num_interfaces == 0)
 		return;
 
-	for (type = G_OBJECT_TYPE (self); type; type = g_type_parent (type)) {
-		classinfo = g_type_get_qdata (type, nm_exported_object_class_info_quark ());
-		if (!classinfo)
-			continue;
-
-		dbus_property_name = g_hash_table_lookup (classinfo->properties, pspec->name);
-		if (dbus_property_name)
-			break;
-	}
-	if (!dbus_property_name) {
+	pinfo = _lookup_property_info (G_OBJECT_TYPE (self), pspec);
+	if (!pinfo) {
 		_LOG2T ("ignoring notification for prop %s on type %s",
 		        pspec->name, G_OBJECT_TYPE_NAME (self));
 		return;
 	}
 
 	for (i = 0; i < priv->num_interfaces; i++) {
-		GDBusInterfaceInfo *iinfo;
-
-		ifdata = &priv->interfaces[i];
-		iinfo = g_dbus_interface_skeleton_get_info (ifdata->interface);
-		for (j = 0; iinfo->properties[j]; j++) {
-			if (nm_streq (iinfo->properties[j]->name, dbus_property_name)) {
-				vtype = G_VARIANT_TYPE (iinfo->properties[j]->signature);
-				goto vtype_found;
-			}
+		if (G_TYPE_CHECK_INSTANCE_TYPE (priv->interfaces[i].interface, pinfo->skeleton_type)) {
+			ifdata = &priv->interfaces[i];
+			break;
 		}
 	}
-	g_return_if_reached ();
-
-vtype_found:
-	g_value_init (&value, pspec->value_type);
-	g_object_get_property ((GObject *) self, pspec->name, &value);
-	value_variant = g_dbus_gvalue_to_gvariant (&value, vtype);
-	g_value_unset (&value);
+	g_return_if_fail (ifdata);
 
 	if (   (   NM_IS_DEVICE (self)
 	        && !NMDBUS_IS_DEVICE_STATISTICS_SKELETON (ifdata->interface))
@@ -929,29 +1137,56 @@ vtype_found:
 		 * The Device.Statistics signal is special, because it was only added with 1.4.0
 		 * and didn't have above behavior. So let's save the overhead of emitting multiple
 		 * deprecated signals for wrong interfaces. */
-		for (i = 0, j = 0; i < priv->num_interfaces; i++) {
+		for (i = 0; i < priv->num_interfaces; i++) {
 			ifdata = &priv->interfaces[i];
-			if (   ifdata->property_changed_signal_id
-			    && !NMDBUS_IS_DEVICE_STATISTICS_SKELETON (ifdata->interface)) {
-				j++;
-				g_hash_table_insert (ifdata->pending_notifies,
-				                     (gpointer) dbus_property_name,
-				                     g_variant_ref (value_variant));
-			}
+			if (   !NMDBUS_IS_DEVICE_STATISTICS_SKELETON (ifdata->interface)
+			    && _pending_notify_add (ifdata, pinfo))
+				scheduled = TRUE;
 		}
-		nm_assert (j > 0);
-		g_variant_unref (value_variant);
-	} else if (ifdata->property_changed_signal_id) {
-		/* @dbus_property_name is inside classinfo and never freed, thus we don't clone it.
-		 * Also, we do a pointer, not string comparison. */
-		g_hash_table_insert (ifdata->pending_notifies,
-		                     (gpointer) dbus_property_name,
-		                     value_variant);
 	} else
-		g_variant_unref (value_variant);
+		scheduled = _pending_notify_add (ifdata, pinfo);
+
+	if (scheduled)
+		_notify_schedule (self);
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_exported_object_class_set_min_notify_interval:
+ * @object_class: an #NMExportedObjectClass
+ * @property_name: the name of a property exported by @object_class
+ * @interval_ms: the minimal interval in milliseconds between two
+ *   "PropertiesChanged" signals carrying @property_name, or 0 to
+ *   emit every change.
+ *
+ * Rate-limits the deprecated "PropertiesChanged" signal for a property
+ * that changes often, like signal strength or statistics. A change
+ * within @interval_ms of the last emission is delayed (and merged
+ * with further changes) until the interval passed.
+ *
+ * Must be called after nm_exported_object_class_add_interface() added
+ * the interface exporting @property_name.
+ */
+void
+nm_exported_object_class_set_min_notify_interval (NMExportedObjectClass *object_class,
+                                                  const char *property_name,
+                                                  guint interval_ms)
+{
+	NMExportedObjectClassInfo *classinfo;
+	PropertyInfo *pinfo;
+
+	g_return_if_fail (NM_IS_EXPORTED_OBJECT_CLASS (object_class));
+	g_return_if_fail (property_name);
+
+	classinfo = g_type_get_qdata (G_TYPE_FROM_CLASS (object_class),
+	                              nm_exported_object_class_info_quark ());
+	g_return_if_fail (classinfo);
+
+	pinfo = g_hash_table_lookup (classinfo->properties, property_name);
+	g_return_if_fail (pinfo);
 
-	if (!priv->notify_idle_id)
-		priv->notify_idle_id = g_idle_add (idle_emit_properties_changed, self);
+	pinfo->min_interval_ms = interval_ms;
 }
 
 /*****************************************************************************/
@@ -998,7 +1233,7 @@ dispose (GObject *object)
 	} else
 		g_clear_pointer (&priv->path, g_free);
 
-	nm_clear_g_source (&priv->notify_idle_id);
+	_notify_cancel ((NMExportedObject *) object);
 
 	G_OBJECT_CLASS (nm_exported_object_parent_class)->dispose (object);
 }
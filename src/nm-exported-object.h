@@ -69,6 +69,10 @@ void nm_exported_object_class_add_interface (NMExportedObjectClass *object_class
                                              GType                  dbus_skeleton_type,
                                              ...) G_GNUC_NULL_TERMINATED;
 
+void nm_exported_object_class_set_min_notify_interval (NMExportedObjectClass *object_class,
+                                                       const char *property_name,
+                                                       guint interval_ms);
+
 const char *nm_exported_object_export      (NMExportedObject *self);
 const char *nm_exported_object_get_path    (NMExportedObject *self);
 gboolean    nm_exported_object_is_exported (NMExportedObject *self);
@@ -90,8 +90,33 @@ NMLogDomain _nm_logging_enabled_state[_LOGL_N_REAL] = {
 	[LOGL_ERR]  = LOGD_DEFAULT,
 };
 
+/* The ring buffer keeps the last messages in memory, independent of
+ * the logging backend. Each entry has a fixed size, messages longer
+ * then RING_MSG_LEN are truncated. */
+#define RING_N_ENTRIES 2048
+#define RING_MSG_LEN   256
+
+G_STATIC_ASSERT ((RING_N_ENTRIES & (RING_N_ENTRIES - 1)) == 0);
+
+typedef struct {
+	/* the sequence number + 1 of the message, or 0 while the entry is written. */
+	int seq;
+	guint line;
+	NMLogLevel level;
+	NMLogDomain domain;
+	gint64 timestamp_ns;
+	const char *file;
+	char msg[RING_MSG_LEN];
+} RingEntry;
+
+static struct {
+	RingEntry *entries;
+	int next_seq;
+} ring;
+
 static struct Global {
 	NMLogLevel log_level;
+	NMLogLevel ring_level;
 	bool uses_syslog:1;
 	bool syslog_identifier_initialized:1;
 	const char *prefix;
@@ -102,6 +127,11 @@ static struct Global {
 		LOG_BACKEND_JOURNAL,
 	} log_backend;
 	char *logging_domains_to_string;
+
+	/* the domains enabled for the logging backend. _nm_logging_enabled_state
+	 * additionally contains the domains enabled for the ring buffer. */
+	NMLogDomain backend_state[_LOGL_N_REAL];
+
 	const LogLevelDesc level_desc[_LOGL_N];
 
 #define _DOMAIN_DESC_LEN 39
@@ -111,7 +141,13 @@ static struct Global {
 } global = {
 	/* nm_logging_setup ("INFO", LOGD_DEFAULT_STRING, NULL, NULL); */
 	.log_level = LOGL_INFO,
+	.ring_level = _LOGL_OFF,
 	.log_backend = LOG_BACKEND_GLIB,
+	.backend_state = {
+		[LOGL_INFO] = LOGD_DEFAULT,
+		[LOGL_WARN] = LOGD_DEFAULT,
+		[LOGL_ERR]  = LOGD_DEFAULT,
+	},
 	.syslog_identifier = "SYSLOG_IDENTIFIER="G_LOG_DOMAIN,
 	.prefix = "",
 	.level_desc = {
@@ -248,6 +284,27 @@ nm_logging_set_syslog_identifier (const char *domain)
 
 /*****************************************************************************/
 
+static NMLogDomain
+_ring_domains (NMLogLevel level)
+{
+	/* like for ALL, LOGD_VPN_PLUGIN is protected from the verbose levels. */
+	if (level < LOGL_INFO)
+		return LOGD_ALL & ~LOGD_VPN_PLUGIN;
+	return LOGD_ALL;
+}
+
+static void
+_update_enabled_state (void)
+{
+	int i;
+
+	for (i = 0; i < G_N_ELEMENTS (_nm_logging_enabled_state); i++) {
+		_nm_logging_enabled_state[i] = global.backend_state[i];
+		if (global.ring_level <= i)
+			_nm_logging_enabled_state[i] |= _ring_domains (i);
+	}
+}
+
 static gboolean
 match_log_level (const char  *level,
                  NMLogLevel  *out_level,
@@ -298,7 +355,7 @@ nm_logging_setup (const char  *level,
 		if (new_log_level == _LOGL_KEEP) {
 			new_log_level = global.log_level;
 			for (i = 0; i < G_N_ELEMENTS (new_logging); i++)
-				new_logging[i] = _nm_logging_enabled_state[i];
+				new_logging[i] = global.backend_state[i];
 		}
 	}
 
@@ -380,7 +437,7 @@ nm_logging_setup (const char  *level,
 
 		if (domain_log_level == _LOGL_KEEP) {
 			for (i = 0; i < G_N_ELEMENTS (new_logging); i++)
-				new_logging[i] = (new_logging[i] & ~bits) | (_nm_logging_enabled_state[i] & bits);
+				new_logging[i] = (new_logging[i] & ~bits) | (global.backend_state[i] & bits);
 		} else {
 			for (i = 0; i < G_N_ELEMENTS (new_logging); i++) {
 				if (i < domain_log_level)
@@ -402,7 +459,8 @@ nm_logging_setup (const char  *level,
 
 	global.log_level = new_log_level;
 	for (i = 0; i < G_N_ELEMENTS (new_logging); i++)
-		_nm_logging_enabled_state[i] = new_logging[i];
+		global.backend_state[i] = new_logging[i];
+	_update_enabled_state ();
 
 	if (   had_platform_debug
 	    && _nm_logging_clear_platform_logging_cache
@@ -467,7 +525,7 @@ _domains_to_string (gboolean include_level_override)
 	str = g_string_sized_new (75);
 	for (diter = &global.domain_desc[0]; diter->name; diter++) {
 		/* If it's set for any lower level, it will also be set for LOGL_ERR */
-		if (!(diter->num & _nm_logging_enabled_state[LOGL_ERR]))
+		if (!(diter->num & global.backend_state[LOGL_ERR]))
 			continue;
 
 		if (str->len)
@@ -479,15 +537,15 @@ _domains_to_string (gboolean include_level_override)
 
 		/* Check if it's logging at a lower level than the default. */
 		for (i = 0; i < global.log_level; i++) {
-			if (diter->num & _nm_logging_enabled_state[i]) {
+			if (diter->num & global.backend_state[i]) {
 				g_string_append_printf (str, ":%s", global.level_desc[i].name);
 				break;
 			}
 		}
 		/* Check if it's logging at a higher level than the default. */
-		if (!(diter->num & _nm_logging_enabled_state[global.log_level])) {
-			for (i = global.log_level + 1; i < G_N_ELEMENTS (_nm_logging_enabled_state); i++) {
-				if (diter->num & _nm_logging_enabled_state[i]) {
+		if (!(diter->num & global.backend_state[global.log_level])) {
+			for (i = global.log_level + 1; i < G_N_ELEMENTS (global.backend_state); i++) {
+				if (diter->num & global.backend_state[i]) {
 					g_string_append_printf (str, ":%s", global.level_desc[i].name);
 					break;
 				}
@@ -536,7 +594,7 @@ nm_logging_get_level (NMLogDomain domain)
 
 	G_STATIC_ASSERT (LOGL_TRACE == 0);
 	while (   sl > LOGL_TRACE
-	       && nm_logging_enabled (sl - 1, domain))
+	       && NM_FLAGS_ANY (global.backend_state[sl - 1], domain))
 		sl--;
 	return sl;
 }
@@ -586,6 +644,33 @@ _iovec_set_format (struct iovec *iov, gpointer *iov_free, const char *format, ..
 	} G_STMT_END
 #endif
 
+_nm_printf (5, 0)
+static void
+_ring_append (const char *file,
+              guint line,
+              NMLogLevel level,
+              NMLogDomain domain,
+              const char *fmt,
+              va_list args)
+{
+	RingEntry *entry;
+	guint seq;
+
+	/* reserve a slot. Writers don't lock each other out, a slot is only
+	 * reused after RING_N_ENTRIES further messages. */
+	seq = (guint) g_atomic_int_add (&ring.next_seq, 1);
+	entry = &ring.entries[seq & (RING_N_ENTRIES - 1)];
+
+	g_atomic_int_set (&entry->seq, 0);
+	entry->timestamp_ns = nm_utils_get_monotonic_timestamp_ns ();
+	entry->file = file;
+	entry->line = line;
+	entry->level = level;
+	entry->domain = domain;
+	g_vsnprintf (entry->msg, sizeof (entry->msg), fmt, args);
+	g_atomic_int_set (&entry->seq, (int) (seq + 1));
+}
+
 void
 _nm_log_impl (const char *file,
               guint line,
@@ -616,6 +701,22 @@ _nm_log_impl (const char *file,
 		errno = error;
 	}
 
+	if (   global.ring_level <= level
+	    && (_ring_domains (level) & domain)) {
+		va_start (args, fmt);
+		_ring_append (file, line, level, domain, fmt, args);
+		va_end (args);
+	}
+
+	if (!(global.backend_state[level] & domain)) {
+		/* only enabled for the ring buffer. */
+		errno = errno_saved;
+		return;
+	}
+
+	/* formatting for the ring buffer might have clobbered errno. */
+	errno = error ?: errno_saved;
+
 	va_start (args, fmt);
 	msg = g_strdup_vprintf (fmt, args);
 	va_end (args);
@@ -654,7 +755,7 @@ _nm_log_impl (const char *file,
 				int i_domain = _NUM_MAX_FIELDS_SYSLOG_FACILITY;
 				const char *s_domain_1 = NULL;
 				NMLogDomain dom_all = domain;
-				NMLogDomain dom = dom_all & _nm_logging_enabled_state[level];
+				NMLogDomain dom = dom_all & global.backend_state[level];
 
 				for (diter = &global.domain_desc[0]; diter->name; diter++) {
 					if (!NM_FLAGS_HAS (dom_all, diter->num))
@@ -786,6 +887,105 @@ nm_log_handler (const gchar *log_domain,
 	}
 }
 
+/**
+ * nm_logging_ring_setup:
+ * @level: the level from which on messages are kept in the
+ *   ring buffer, or %NULL or "OFF" to disable it.
+ * @error: the error
+ *
+ * The ring buffer records the latest messages of all domains at @level,
+ * regardless of the configured logging level and domains. This allows to
+ * keep verbose logging permanently enabled without writing it out to
+ * syslog or the journal. Use nm_logging_ring_dump() to fetch the content.
+ *
+ * Returns: %FALSE if @level is invalid.
+ */
+gboolean
+nm_logging_ring_setup (const char *level,
+                       GError **error)
+{
+	NMLogLevel new_level = _LOGL_OFF;
+
+	g_return_val_if_fail (!error || !*error, FALSE);
+
+	if (level && *level) {
+		if (!match_log_level (level, &new_level, error))
+			return FALSE;
+		if (new_level == _LOGL_KEEP) {
+			g_set_error (error, NM_MANAGER_ERROR, NM_MANAGER_ERROR_UNKNOWN_LOG_LEVEL,
+			             _("Invalid log level '%s' for the ring buffer"), level);
+			return FALSE;
+		}
+	}
+
+	if (   new_level != _LOGL_OFF
+	    && !ring.entries) {
+		/* reading the timestamp the first time causes a logging message. Do
+		 * it now, so that we don't recurse from within _ring_append(). */
+		nm_utils_get_monotonic_timestamp_ns ();
+
+		/* the buffer is never freed, also not when disabling it again. */
+		ring.entries = g_new0 (RingEntry, RING_N_ENTRIES);
+	}
+
+	global.ring_level = new_level;
+	_update_enabled_state ();
+	return TRUE;
+}
+
+/**
+ * nm_logging_ring_dump:
+ *
+ * Returns: (transfer full): the messages in the ring buffer, oldest
+ *   first, one per line. Entries that are overwritten while reading
+ *   them are skipped.
+ */
+char *
+nm_logging_ring_dump (void)
+{
+	GString *str;
+	guint next_seq, seq, n;
+
+	str = g_string_new (NULL);
+	if (!ring.entries)
+		return g_string_free (str, FALSE);
+
+	next_seq = (guint) g_atomic_int_get (&ring.next_seq);
+	n = MIN (next_seq, RING_N_ENTRIES);
+
+	for (seq = next_seq - n; seq != next_seq; seq++) {
+		const RingEntry *entry = &ring.entries[seq & (RING_N_ENTRIES - 1)];
+		const LogDesc *diter;
+		const char *domain_name = "";
+		RingEntry e;
+
+		if (g_atomic_int_get (&entry->seq) != (int) (seq + 1))
+			continue;
+		memcpy (&e, entry, sizeof (e));
+		if (g_atomic_int_get (&entry->seq) != (int) (seq + 1))
+			continue;
+
+		e.msg[sizeof (e.msg) - 1] = '\0';
+		for (diter = &global.domain_desc[0]; diter->name; diter++) {
+			if (NM_FLAGS_ANY (e.domain, diter->num)) {
+				domain_name = diter->name;
+				break;
+			}
+		}
+
+		g_string_append_printf (str, "[%lld.%06lld] %-7s [%s] %s:%u: %s\n",
+		                        (long long) (e.timestamp_ns / NM_UTILS_NS_PER_SECOND),
+		                        (long long) ((e.timestamp_ns % NM_UTILS_NS_PER_SECOND) / 1000),
+		                        global.level_desc[e.level].level_str,
+		                        domain_name,
+		                        e.file ?: "",
+		                        e.line,
+		                        e.msg);
+	}
+
+	return g_string_free (str, FALSE);
+}
+
 gboolean
 nm_logging_syslog_enabled (void)
 {
@@ -194,6 +194,10 @@ void nm_logging_set_prefix (const char *format, ...) _nm_printf (1, 2);
 void     nm_logging_syslog_openlog (const char *logging_backend);
 gboolean nm_logging_syslog_enabled (void);
 
+gboolean nm_logging_ring_setup (const char *level,
+                                GError **error);
+char    *nm_logging_ring_dump (void);
+
 /*****************************************************************************/
 
 /* This is the default definition of _NMLOG_ENABLED(). Special implementations
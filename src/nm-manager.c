@@ -480,6 +480,19 @@ _config_changed_cb (NMConfig *config, NMConfigData *config_data, NMConfigChangeF
 
 	if (NM_FLAGS_HAS (changes, NM_CONFIG_CHANGE_GLOBAL_DNS_CONFIG))
 		_notify (self, PROP_GLOBAL_DNS_CONFIGURATION);
+
+	if (NM_FLAGS_HAS (changes, NM_CONFIG_CHANGE_VALUES)) {
+		gs_free_error GError *error = NULL;
+
+		/* Unlike the logging level, which can be changed via D-Bus, the
+		 * ring buffer only follows the configuration. */
+		if (!nm_logging_ring_setup (nm_config_data_get_value_cached (config_data,
+		                                                             NM_CONFIG_KEYFILE_GROUP_LOGGING,
+		                                                             NM_CONFIG_KEYFILE_KEY_LOGGING_RING_LEVEL,
+		                                                             NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY),
+		                            &error))
+			_LOGW (LOGD_CORE, "config: keeping the current ring-level: %s", error->message);
+	}
 }
 
 static void
@@ -859,6 +872,8 @@ nm_manager_update_state (NMManager *manager)
 	set_state (manager, new_state);
 }
 
+static int _device_state_write (NMManager *self, NMDevice *device);
+
 static void
 manager_device_state_changed (NMDevice *device,
                               NMDeviceState new_state,
@@ -884,6 +899,36 @@ manager_device_state_changed (NMDevice *device,
 	if (   new_state == NM_DEVICE_STATE_UNAVAILABLE
 	    || new_state == NM_DEVICE_STATE_DISCONNECTED)
 		nm_settings_device_added (priv->settings, device);
+
+	switch (new_state) {
+	case NM_DEVICE_STATE_UNMANAGED:
+	case NM_DEVICE_STATE_UNAVAILABLE:
+	case NM_DEVICE_STATE_DISCONNECTED:
+	case NM_DEVICE_STATE_ACTIVATED:
+		/* keep the persisted run state current, so that a restart
+		 * can take over the devices even if we don't exit cleanly.
+		 * During startup, the devices are still taking over the
+		 * state that we loaded, don't overwrite it yet. */
+		if (!priv->startup)
+			_device_state_write (self, device);
+		break;
+	default:
+		break;
+	}
+
+	if (new_state == NM_DEVICE_STATE_ACTIVATED) {
+		int ip_ifindex = nm_device_get_ip_ifindex (device);
+
+		if (ip_ifindex > 0) {
+			nm_connectivity_device_add (priv->connectivity,
+			                            ip_ifindex,
+			                            nm_device_get_ip_iface (device));
+		}
+	} else if (old_state == NM_DEVICE_STATE_ACTIVATED) {
+		nm_connectivity_device_remove (priv->connectivity,
+		                               nm_device_get_ip_ifindex (device));
+		nm_device_set_connectivity_state (device, NM_CONNECTIVITY_UNKNOWN);
+	}
 }
 
 static void device_has_pending_action_changed (NMDevice *device,
@@ -2230,6 +2275,9 @@ _platform_link_cb_idle (PlatformLinkCbData *data)
 		NMDevice *device;
 		GError *error = NULL;
 
+		/* the ifindex is gone for good, don't keep its state around. */
+		nm_config_device_state_remove (NM_MANAGER_GET_PRIVATE (self)->config, data->ifindex);
+
 		device = nm_manager_get_device_by_ifindex (self, data->ifindex);
 		if (device) {
 			if (nm_device_is_software (device)) {
@@ -3369,51 +3417,23 @@ nm_manager_activate_connection (NMManager *self,
 	return active;
 }
 
-/**
- * validate_activation_request:
- * @self: the #NMManager
- * @context: the D-Bus context of the requestor
- * @connection: the partial or complete #NMConnection to be activated
- * @device_path: the object path of the device to be activated, or "/"
- * @out_device: on successful reutrn, the #NMDevice to be activated with @connection
- * @out_vpn: on successful return, %TRUE if @connection is a VPN connection
- * @error: location to store an error on failure
- *
- * Performs basic validation on an activation request, including ensuring that
- * the requestor is a valid Unix process, is not disallowed in @connection
- * permissions, and that a device exists that can activate @connection.
- *
- * Returns: on success, the #NMAuthSubject representing the requestor, or
- *   %NULL on error
- */
-static NMAuthSubject *
-validate_activation_request (NMManager *self,
-                             GDBusMethodInvocation *context,
-                             NMConnection *connection,
-                             const char *device_path,
-                             NMDevice **out_device,
-                             gboolean *out_vpn,
-                             GError **error)
+/* Checks that @subject is not disallowed in @connection permissions, and
+ * that a device exists that can activate @connection. If @devices_by_path is
+ * given, it is used to look up @device_path. */
+static gboolean
+_validate_activation (NMManager *self,
+                      NMAuthSubject *subject,
+                      NMConnection *connection,
+                      const char *device_path,
+                      GHashTable *devices_by_path,
+                      NMDevice **out_device,
+                      gboolean *out_vpn,
+                      GError **error)
 {
 	NMDevice *device = NULL;
 	gboolean vpn = FALSE;
-	NMAuthSubject *subject = NULL;
 	char *error_desc = NULL;
 
-	g_assert (connection);
-	g_assert (out_device);
-	g_assert (out_vpn);
-
-	/* Validate the caller */
-	subject = nm_auth_subject_new_unix_process_from_context (context);
-	if (!subject) {
-		g_set_error_literal (error,
-		                     NM_MANAGER_ERROR,
-		                     NM_MANAGER_ERROR_PERMISSION_DENIED,
-		                     "Failed to get request UID.");
-		return NULL;
-	}
-
 	/* Ensure the subject has permissions for this connection */
 	if (!nm_auth_is_subject_in_acl (connection,
 	                                subject,
@@ -3423,7 +3443,7 @@ validate_activation_request (NMManager *self,
 		                     NM_MANAGER_ERROR_PERMISSION_DENIED,
 		                     error_desc);
 		g_free (error_desc);
-		goto error;
+		return FALSE;
 	}
 
 	/* Check whether it's a VPN or not */
@@ -3437,13 +3457,15 @@ validate_activation_request (NMManager *self,
 
 	/* And validate it */
 	if (device_path) {
-		device = nm_manager_get_device_by_path (self, device_path);
+		device = devices_by_path
+		         ? g_hash_table_lookup (devices_by_path, device_path)
+		         : nm_manager_get_device_by_path (self, device_path);
 		if (!device) {
 			g_set_error_literal (error,
 			                     NM_MANAGER_ERROR,
 			                     NM_MANAGER_ERROR_UNKNOWN_DEVICE,
 			                     "Device not found");
-			goto error;
+			return FALSE;
 		}
 	} else
 		device = nm_manager_get_best_device_for_connection (self, connection, TRUE);
@@ -3457,7 +3479,7 @@ validate_activation_request (NMManager *self,
 			                     NM_MANAGER_ERROR,
 			                     NM_MANAGER_ERROR_UNKNOWN_DEVICE,
 			                     "No suitable device found for this connection.");
-			goto error;
+			return FALSE;
 		}
 
 		if (is_software) {
@@ -3466,7 +3488,7 @@ validate_activation_request (NMManager *self,
 			/* Look for an existing device with the connection's interface name */
 			iface = nm_manager_get_connection_iface (self, connection, NULL, error);
 			if (!iface)
-				goto error;
+				return FALSE;
 
 			device = find_device_by_iface (self, iface, connection, NULL);
 			g_free (iface);
@@ -3478,16 +3500,63 @@ validate_activation_request (NMManager *self,
 		                     NM_MANAGER_ERROR,
 		                     NM_MANAGER_ERROR_UNKNOWN_DEVICE,
 		                     "Failed to find a compatible device for this connection");
-		goto error;
+		return FALSE;
 	}
 
 	*out_device = device;
 	*out_vpn = vpn;
-	return subject;
+	return TRUE;
+}
 
-error:
-	g_object_unref (subject);
-	return NULL;
+/**
+ * validate_activation_request:
+ * @self: the #NMManager
+ * @context: the D-Bus context of the requestor
+ * @connection: the partial or complete #NMConnection to be activated
+ * @device_path: the object path of the device to be activated, or "/"
+ * @out_device: on successful reutrn, the #NMDevice to be activated with @connection
+ * @out_vpn: on successful return, %TRUE if @connection is a VPN connection
+ * @error: location to store an error on failure
+ *
+ * Performs basic validation on an activation request, including ensuring that
+ * the requestor is a valid Unix process, is not disallowed in @connection
+ * permissions, and that a device exists that can activate @connection.
+ *
+ * Returns: on success, the #NMAuthSubject representing the requestor, or
+ *   %NULL on error
+ */
+static NMAuthSubject *
+validate_activation_request (NMManager *self,
+                             GDBusMethodInvocation *context,
+                             NMConnection *connection,
+                             const char *device_path,
+                             NMDevice **out_device,
+                             gboolean *out_vpn,
+                             GError **error)
+{
+	NMAuthSubject *subject;
+
+	g_assert (connection);
+	g_assert (out_device);
+	g_assert (out_vpn);
+
+	/* Validate the caller */
+	subject = nm_auth_subject_new_unix_process_from_context (context);
+	if (!subject) {
+		g_set_error_literal (error,
+		                     NM_MANAGER_ERROR,
+		                     NM_MANAGER_ERROR_PERMISSION_DENIED,
+		                     "Failed to get request UID.");
+		return NULL;
+	}
+
+	if (!_validate_activation (self, subject, connection, device_path, NULL,
+	                           out_device, out_vpn, error)) {
+		g_object_unref (subject);
+		return NULL;
+	}
+
+	return subject;
 }
 
 /*****************************************************************************/
@@ -3626,6 +3695,274 @@ error:
 
 /*****************************************************************************/
 
+typedef struct {
+	NMSettingsConnection *connection;
+	NMDevice *device;
+	char *specific_object;
+	const char *wifi_permission;
+	GError *error;
+	char *active_path;
+} BatchActivationItem;
+
+typedef struct {
+	guint len;
+	BatchActivationItem items[];
+} BatchActivation;
+
+static void
+_batch_activation_free (gpointer data)
+{
+	BatchActivation *batch = data;
+	guint i;
+
+	for (i = 0; i < batch->len; i++) {
+		BatchActivationItem *item = &batch->items[i];
+
+		g_clear_object (&item->connection);
+		g_clear_object (&item->device);
+		g_free (item->specific_object);
+		g_clear_error (&item->error);
+		g_free (item->active_path);
+	}
+	g_free (batch);
+}
+
+static GVariant *
+_batch_activation_to_variant (BatchActivation *batch)
+{
+	GVariantBuilder builder;
+	guint i;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(os)"));
+	for (i = 0; i < batch->len; i++) {
+		BatchActivationItem *item = &batch->items[i];
+
+		g_variant_builder_add (&builder, "(os)",
+		                       item->active_path ?: "/",
+		                       item->error ? item->error->message : "");
+	}
+	return g_variant_new ("(a(os))", &builder);
+}
+
+static void
+_batch_activation_item_activate (NMManager *self,
+                                 BatchActivationItem *item,
+                                 NMAuthSubject *subject)
+{
+	gs_unref_object NMActiveConnection *active = NULL;
+
+	active = _new_active_connection (self,
+	                                 NM_CONNECTION (item->connection),
+	                                 NULL,
+	                                 item->specific_object,
+	                                 item->device,
+	                                 subject,
+	                                 &item->error);
+	if (!active)
+		return;
+
+	if (!_internal_activate_generic (self, active, &item->error)) {
+		_internal_activation_failed (self, active, item->error->message);
+		return;
+	}
+
+	item->active_path = g_strdup (nm_exported_object_get_path (NM_EXPORTED_OBJECT (active)));
+}
+
+static void
+activate_connections_auth_done_cb (NMAuthChain *chain,
+                                   GError *auth_error,
+                                   GDBusMethodInvocation *context,
+                                   gpointer user_data)
+{
+	NMManager *self = NM_MANAGER (user_data);
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	NMAuthSubject *subject = nm_auth_chain_get_subject (chain);
+	BatchActivation *batch;
+	guint i, n_activated = 0;
+
+	g_assert (context);
+
+	priv->auth_chains = g_slist_remove (priv->auth_chains, chain);
+
+	batch = nm_auth_chain_get_data (chain, "batch");
+
+	for (i = 0; i < batch->len; i++) {
+		BatchActivationItem *item = &batch->items[i];
+
+		if (item->error)
+			continue;
+
+		if (auth_error) {
+			item->error = g_error_new (NM_MANAGER_ERROR,
+			                           NM_MANAGER_ERROR_PERMISSION_DENIED,
+			                           "Activation request failed: %s",
+			                           auth_error->message);
+		} else if (nm_auth_chain_get_result (chain, NM_AUTH_PERMISSION_NETWORK_CONTROL) != NM_AUTH_CALL_RESULT_YES) {
+			item->error = g_error_new_literal (NM_MANAGER_ERROR,
+			                                   NM_MANAGER_ERROR_PERMISSION_DENIED,
+			                                   "Not authorized to control networking.");
+		} else if (   item->wifi_permission
+		           && nm_auth_chain_get_result (chain, item->wifi_permission) != NM_AUTH_CALL_RESULT_YES) {
+			item->error = g_error_new_literal (NM_MANAGER_ERROR,
+			                                   NM_MANAGER_ERROR_PERMISSION_DENIED,
+			                                   "Not authorized to share connections via wifi.");
+		} else
+			_batch_activation_item_activate (self, item, subject);
+
+		nm_audit_log_connection_op (NM_AUDIT_OP_CONN_ACTIVATE, item->connection,
+		                            !item->error, NULL, subject,
+		                            item->error ? item->error->message : NULL);
+		if (!item->error)
+			n_activated++;
+	}
+
+	_LOGD (LOGD_CORE, "ActivateConnections: activated %u of %u connections",
+	       n_activated, batch->len);
+
+	g_dbus_method_invocation_return_value (context, _batch_activation_to_variant (batch));
+	nm_auth_chain_unref (chain);
+}
+
+static void
+impl_manager_activate_connections (NMManager *self,
+                                   GDBusMethodInvocation *context,
+                                   GVariant *connections)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	gs_unref_object NMAuthSubject *subject = NULL;
+	gs_unref_hashtable GHashTable *devices_by_path = NULL;
+	gs_unref_hashtable GHashTable *wifi_permissions = NULL;
+	BatchActivation *batch;
+	NMAuthChain *chain;
+	GVariantIter iter;
+	const char *connection_path, *device_path, *specific_object_path;
+	gboolean any_valid = FALSE;
+	GHashTableIter h_iter;
+	const char *permission;
+	GSList *iter_d;
+	guint i;
+
+	/* Validate the caller */
+	subject = nm_auth_subject_new_unix_process_from_context (context);
+	if (!subject) {
+		g_dbus_method_invocation_return_error_literal (context,
+		                                               NM_MANAGER_ERROR,
+		                                               NM_MANAGER_ERROR_PERMISSION_DENIED,
+		                                               "Failed to get request UID.");
+		return;
+	}
+
+	/* Resolve device paths once for the whole request */
+	devices_by_path = g_hash_table_new (g_str_hash, g_str_equal);
+	for (iter_d = priv->devices; iter_d; iter_d = iter_d->next) {
+		NMDevice *device = iter_d->data;
+		const char *path = nm_exported_object_get_path (NM_EXPORTED_OBJECT (device));
+
+		if (path)
+			g_hash_table_insert (devices_by_path, (gpointer) path, device);
+	}
+
+	wifi_permissions = g_hash_table_new (g_str_hash, g_str_equal);
+
+	batch = g_malloc0 (sizeof (BatchActivation)
+	                   + g_variant_n_children (connections) * sizeof (BatchActivationItem));
+
+	g_variant_iter_init (&iter, connections);
+	for (i = 0; g_variant_iter_next (&iter, "(&o&o&o)", &connection_path, &device_path, &specific_object_path); i++) {
+		BatchActivationItem *item = &batch->items[i];
+		NMSettingsConnection *connection = NULL;
+		NMDevice *device = NULL;
+		gboolean is_vpn = FALSE;
+
+		batch->len++;
+
+		/* Normalize object paths */
+		if (nm_streq (connection_path, "/"))
+			connection_path = NULL;
+		if (nm_streq (specific_object_path, "/"))
+			specific_object_path = NULL;
+		if (nm_streq (device_path, "/"))
+			device_path = NULL;
+
+		if (connection_path) {
+			connection = nm_settings_get_connection_by_path (priv->settings, connection_path);
+			if (!connection) {
+				item->error = g_error_new_literal (NM_MANAGER_ERROR,
+				                                   NM_MANAGER_ERROR_UNKNOWN_CONNECTION,
+				                                   "Connection could not be found.");
+				continue;
+			}
+		} else {
+			if (!device_path) {
+				item->error = g_error_new_literal (NM_MANAGER_ERROR, NM_MANAGER_ERROR_UNKNOWN_DEVICE,
+				                                   "Only devices may be activated without a specifying a connection");
+				continue;
+			}
+			device = g_hash_table_lookup (devices_by_path, device_path);
+			if (!device) {
+				item->error = g_error_new (NM_MANAGER_ERROR, NM_MANAGER_ERROR_UNKNOWN_DEVICE,
+				                           "Can not activate an unknown device '%s'", device_path);
+				continue;
+			}
+
+			connection = nm_device_get_best_connection (device, specific_object_path, &item->error);
+			if (!connection)
+				continue;
+		}
+
+		item->connection = g_object_ref (connection);
+
+		if (!_validate_activation (self,
+		                           subject,
+		                           NM_CONNECTION (connection),
+		                           device_path,
+		                           devices_by_path,
+		                           &device,
+		                           &is_vpn,
+		                           &item->error)) {
+			nm_audit_log_connection_op (NM_AUDIT_OP_CONN_ACTIVATE, connection, FALSE, NULL,
+			                            subject, item->error->message);
+			continue;
+		}
+
+		item->device = device ? g_object_ref (device) : NULL;
+		item->specific_object = g_strdup (specific_object_path);
+		item->wifi_permission = nm_utils_get_shared_wifi_permission (NM_CONNECTION (connection));
+		if (item->wifi_permission)
+			g_hash_table_add (wifi_permissions, (gpointer) item->wifi_permission);
+		any_valid = TRUE;
+	}
+
+	if (!any_valid) {
+		/* Nothing to authorize; report the per-item errors right away. */
+		g_dbus_method_invocation_return_value (context, _batch_activation_to_variant (batch));
+		_batch_activation_free (batch);
+		return;
+	}
+
+	/* Authorize the whole request at once */
+	chain = nm_auth_chain_new_subject (subject, context, activate_connections_auth_done_cb, self);
+	if (!chain) {
+		_batch_activation_free (batch);
+		g_dbus_method_invocation_return_error_literal (context,
+		                                               NM_MANAGER_ERROR,
+		                                               NM_MANAGER_ERROR_PERMISSION_DENIED,
+		                                               "Unable to authenticate request.");
+		return;
+	}
+
+	priv->auth_chains = g_slist_append (priv->auth_chains, chain);
+	nm_auth_chain_set_data (chain, "batch", batch, _batch_activation_free);
+	nm_auth_chain_add_call (chain, NM_AUTH_PERMISSION_NETWORK_CONTROL, TRUE);
+
+	g_hash_table_iter_init (&h_iter, wifi_permissions);
+	while (g_hash_table_iter_next (&h_iter, (gpointer *) &permission, NULL))
+		nm_auth_chain_add_call (chain, permission, TRUE);
+}
+
+/*****************************************************************************/
+
 typedef struct {
 	NMManager *manager;
 	NMActiveConnection *active;
@@ -4596,6 +4933,26 @@ impl_manager_get_logging (NMManager *manager,
 	                                                      nm_logging_domains_to_string ()));
 }
 
+static void
+impl_manager_get_log_buffer (NMManager *self,
+                             GDBusMethodInvocation *context)
+{
+	gs_free char *log = NULL;
+
+	/* the buffer may contain verbose (and sensitive) messages, even if
+	 * they are not logged. Only root can read it. */
+	if (!nm_bus_manager_ensure_uid (nm_bus_manager_get (),
+	                                context,
+	                                0,
+	                                NM_MANAGER_ERROR,
+	                                NM_MANAGER_ERROR_PERMISSION_DENIED))
+		return;
+
+	log = nm_logging_ring_dump ();
+	g_dbus_method_invocation_return_value (context,
+	                                       g_variant_new ("(s)", log));
+}
+
 static void
 connectivity_check_done (GObject *object,
                          GAsyncResult *result,
@@ -4680,6 +5037,48 @@ start_factory (NMDeviceFactory *factory, gpointer user_data)
 	nm_device_factory_start (factory);
 }
 
+static int
+_device_state_write (NMManager *self, NMDevice *device)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	int ifindex;
+	gboolean managed;
+	NMConnection *settings_connection;
+	const char *uuid = NULL;
+	const char *perm_hw_addr_fake = NULL;
+	gboolean perm_hw_addr_is_fake;
+
+	ifindex = nm_device_get_ip_ifindex (device);
+	if (ifindex <= 0)
+		return 0;
+	if (ifindex == 1) {
+		/* ignore loopback */
+		return 0;
+	}
+
+	if (!nm_platform_link_get (NM_PLATFORM_GET, ifindex))
+		return 0;
+
+	managed = nm_device_get_managed (device, FALSE);
+	if (managed) {
+		settings_connection = NM_CONNECTION (nm_device_get_settings_connection (device));
+		if (settings_connection)
+			uuid = nm_connection_get_uuid (settings_connection);
+	}
+
+	perm_hw_addr_fake = nm_device_get_permanent_hw_address_full (device, FALSE, &perm_hw_addr_is_fake);
+	if (perm_hw_addr_fake && !perm_hw_addr_is_fake)
+		perm_hw_addr_fake = NULL;
+
+	if (!nm_config_device_state_write (priv->config,
+	                                   ifindex,
+	                                   managed,
+	                                   perm_hw_addr_fake,
+	                                   uuid))
+		return 0;
+	return ifindex;
+}
+
 void
 nm_manager_write_device_state (NMManager *self)
 {
@@ -4690,46 +5089,16 @@ nm_manager_write_device_state (NMManager *self)
 	seen_ifindexes = g_hash_table_new (NULL, NULL);
 
 	for (devices = priv->devices; devices; devices = devices->next) {
-		NMDevice *device = NM_DEVICE (devices->data);
 		int ifindex;
-		gboolean managed;
-		NMConnection *settings_connection;
-		const char *uuid = NULL;
-		const char *perm_hw_addr_fake = NULL;
-		gboolean perm_hw_addr_is_fake;
-
-		ifindex = nm_device_get_ip_ifindex (device);
-		if (ifindex <= 0)
-			continue;
-		if (ifindex == 1) {
-			/* ignore loopback */
-			continue;
-		}
 
-		if (!nm_platform_link_get (NM_PLATFORM_GET, ifindex))
-			continue;
-
-		managed = nm_device_get_managed (device, FALSE);
-		if (managed) {
-			settings_connection = NM_CONNECTION (nm_device_get_settings_connection (device));
-			if (settings_connection)
-				uuid = nm_connection_get_uuid (settings_connection);
-		}
-
-		perm_hw_addr_fake = nm_device_get_permanent_hw_address_full (device, FALSE, &perm_hw_addr_is_fake);
-		if (perm_hw_addr_fake && !perm_hw_addr_is_fake)
-			perm_hw_addr_fake = NULL;
-
-		if (nm_config_device_state_write (priv->config,
-		                                  ifindex,
-		                                  managed,
-		                                  perm_hw_addr_fake,
-		                                  uuid))
+		ifindex = _device_state_write (self, NM_DEVICE (devices->data));
+		if (ifindex > 0)
 			g_hash_table_add (seen_ifindexes, GINT_TO_POINTER (ifindex));
 	}
 
 	nm_config_device_state_prune_unseen (priv->config,
 	                                     seen_ifindexes);
+	nm_config_device_state_flush (priv->config);
 }
 
 gboolean
@@ -4855,6 +5224,27 @@ connectivity_changed (NMConnectivity *connectivity,
 	_notify (self, PROP_CONNECTIVITY);
 }
 
+static void
+connectivity_device_state_changed (NMConnectivity *connectivity,
+                                   int ifindex,
+                                   guint state,
+                                   gpointer user_data)
+{
+	NMManager *self = NM_MANAGER (user_data);
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	GSList *iter;
+
+	for (iter = priv->devices; iter; iter = iter->next) {
+		NMDevice *device = iter->data;
+
+		if (   nm_device_get_ip_ifindex (device) == ifindex
+		    && nm_device_get_state (device) == NM_DEVICE_STATE_ACTIVATED) {
+			nm_device_set_connectivity_state (device, state);
+			return;
+		}
+	}
+}
+
 static void
 firmware_dir_changed (GFileMonitor *monitor,
                       GFile *file,
@@ -5711,6 +6101,8 @@ constructed (GObject *object)
 	                                          nm_config_data_get_connectivity_response (config_data));
 	g_signal_connect (priv->connectivity, "notify::" NM_CONNECTIVITY_STATE,
 	                  G_CALLBACK (connectivity_changed), self);
+	g_signal_connect (priv->connectivity, NM_CONNECTIVITY_DEVICE_STATE_CHANGED,
+	                  G_CALLBACK (connectivity_device_state_changed), self);
 
 	state = nm_config_state_get (priv->config);
 
@@ -5996,6 +6388,7 @@ dispose (GObject *object)
 	}
 	if (priv->connectivity) {
 		g_signal_handlers_disconnect_by_func (priv->connectivity, connectivity_changed, manager);
+		g_signal_handlers_disconnect_by_func (priv->connectivity, connectivity_device_state_changed, manager);
 		g_clear_object (&priv->connectivity);
 	}
 
@@ -6316,6 +6709,7 @@ nm_manager_class_init (NMManagerClass *manager_class)
 	                                        "GetAllDevices", impl_manager_get_all_devices,
 	                                        "GetDeviceByIpIface", impl_manager_get_device_by_ip_iface,
 	                                        "ActivateConnection", impl_manager_activate_connection,
+	                                        "ActivateConnections", impl_manager_activate_connections,
 	                                        "AddAndActivateConnection", impl_manager_add_and_activate_connection,
 	                                        "DeactivateConnection", impl_manager_deactivate_connection,
 	                                        "Sleep", impl_manager_sleep,
@@ -6323,6 +6717,7 @@ nm_manager_class_init (NMManagerClass *manager_class)
 	                                        "GetPermissions", impl_manager_get_permissions,
 	                                        "SetLogging", impl_manager_set_logging,
 	                                        "GetLogging", impl_manager_get_logging,
+	                                        "GetLogBuffer", impl_manager_get_log_buffer,
 	                                        "CheckConnectivity", impl_manager_check_connectivity,
 	                                        "state", impl_manager_get_state,
 	                                        "CheckpointCreate", impl_manager_checkpoint_create,
@@ -178,12 +178,10 @@ ASSERT_route_index_valid (const VTableIP *vtable, const GArray *entries, const R
 
 	g_assert (index);
 
-	if (entries)
+	/* for an index created by _route_index_create_from_objs(), @entries is %NULL
+	 * and we cannot check that the entries point into the array. */
+	if (entries && entries->len > 0) {
 		g_assert_cmpint (entries->len, ==, index->len);
-	else
-		g_assert (index->len == 0);
-
-	if (index->len > 0) {
 		r_first = VTABLE_ROUTE_INDEX (vtable, entries, 0);
 		r_last = VTABLE_ROUTE_INDEX (vtable, entries, index->len - 1);
 	}
@@ -195,9 +193,11 @@ ASSERT_route_index_valid (const VTableIP *vtable, const GArray *entries, const R
 		r1 = index->entries[i];
 
 		g_assert (r1);
-		g_assert (r1 >= r_first);
-		g_assert (r1 <= r_last);
-		g_assert_cmpint ((((char *) r1) - ((char *) entries->data)) % vtable->vt->sizeof_route, ==, 0);
+		if (r_first) {
+			g_assert (r1 >= r_first);
+			g_assert (r1 <= r_last);
+			g_assert_cmpint ((((char *) r1) - ((char *) entries->data)) % vtable->vt->sizeof_route, ==, 0);
+		}
 
 		g_assert (!g_hash_table_contains (ptrs, (gpointer) r1));
 		g_hash_table_add (ptrs, (gpointer) r1);
@@ -301,6 +301,28 @@ _route_index_create (const VTableIP *vtable, const GArray *routes)
 	return index;
 }
 
+static RouteIndex *
+_route_index_create_from_objs (const VTableIP *vtable, const GPtrArray *objs)
+{
+	RouteIndex *index;
+	guint i;
+	guint len = objs ? objs->len : 0;
+
+	index = g_malloc (sizeof (RouteIndex) + len * sizeof (NMPlatformIPXRoute *));
+
+	index->len = len;
+	for (i = 0; i < len; i++)
+		index->entries[i] = &((NMPObject *) objs->pdata[i])->ipx_route;
+	index->entries[i] = NULL;
+
+	g_qsort_with_data (index->entries,
+	                   len,
+	                   sizeof (NMPlatformIPXRoute *),
+	                   (GCompareDataFunc) _route_index_create_sort,
+	                   (gpointer) vtable);
+	return index;
+}
+
 static int
 _vx_route_id_cmp_full (const NMPlatformIPXRoute *r1, const NMPlatformIPXRoute *r2, const VTableIP *vtable)
 {
@@ -449,14 +471,63 @@ _sort_indexes_cmp (guint *a, guint *b)
 
 /*****************************************************************************/
 
+typedef struct {
+	const VTableIP *vtable;
+	NMRouteManager *self;
+
+	/* the index of the first batched request that adds a route for
+	 * the synced ifindex. */
+	guint first_idx;
+
+	/* copies of the routes that were submitted in the batch. */
+	GArray *submitted;
+
+	gboolean success;
+} RouteSyncBatchData;
+
+static void
+_route_add_failed (RouteSyncBatchData *data, const NMPlatformIPXRoute *route)
+{
+	const VTableIP *vtable = data->vtable;
+	NMRouteManager *self = data->self;
+
+	if (route->rx.rt_source < NM_IP_CONFIG_SOURCE_USER) {
+		_LOGD (vtable->vt->addr_family,
+		       "ignore error adding IPv%c route to kernel: %s",
+		       vtable->vt->is_ip4 ? '4' : '6',
+		       vtable->vt->route_to_string (route, NULL, 0));
+	} else {
+		/* Remember that there was a failure, but for now continue trying
+		 * to sync the remaining routes. */
+		data->success = FALSE;
+	}
+}
+
+static void
+_route_sync_batch_result (NMPlatform *platform, guint request_idx, gboolean success, gpointer user_data)
+{
+	RouteSyncBatchData *data = user_data;
+
+	if (   success
+	    || request_idx < data->first_idx
+	    || request_idx - data->first_idx >= data->submitted->len)
+		return;
+
+	_route_add_failed (data, VTABLE_ROUTE_INDEX (data->vtable, data->submitted, request_idx - data->first_idx));
+}
+
 static gboolean
 _vx_route_sync (const VTableIP *vtable, NMRouteManager *self, int ifindex, const GArray *known_routes, gboolean ignore_kernel_routes, gboolean full_sync)
 {
 	NMRouteManagerPrivate *priv = NM_ROUTE_MANAGER_GET_PRIVATE (self);
-	GArray *plat_routes;
+	GPtrArray *plat_routes;
 	RouteEntries *ipx_routes;
 	RouteIndex *plat_routes_idx, *known_routes_idx;
-	gboolean success = TRUE;
+	RouteSyncBatchData batch_data = {
+		.vtable = vtable,
+		.self = self,
+		.success = TRUE,
+	};
 	guint i, i_type;
 	GArray *to_delete_indexes = NULL;
 	GPtrArray *to_add_routes = NULL;
@@ -469,17 +540,20 @@ _vx_route_sync (const VTableIP *vtable, NMRouteManager *self, int ifindex, const
 
 	nm_platform_process_events (priv->platform);
 
+	/* submit all changes to platform at once and wait only at the end. */
+	nm_platform_batch_begin (priv->platform);
+
 	ipx_routes = vtable->vt->is_ip4 ? &priv->ip4_routes : &priv->ip6_routes;
-	plat_routes = vtable->vt->route_get_all (priv->platform, ifindex,
-	                                         ignore_kernel_routes
-	                                             ? NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT
-	                                             : NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_RTPROT_KERNEL);
-	plat_routes_idx = _route_index_create (vtable, plat_routes);
+	plat_routes = vtable->vt->route_lookup_clone (priv->platform, ifindex,
+	                                              ignore_kernel_routes
+	                                                  ? NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT
+	                                                  : NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_RTPROT_KERNEL);
+	plat_routes_idx = _route_index_create_from_objs (vtable, plat_routes);
 	known_routes_idx = _route_index_create (vtable, known_routes);
 
 	effective_metrics = &g_array_index (ipx_routes->effective_metrics, gint64, 0);
 
-	ASSERT_route_index_valid (vtable, plat_routes, plat_routes_idx, TRUE);
+	ASSERT_route_index_valid (vtable, NULL, plat_routes_idx, TRUE);
 	ASSERT_route_index_valid (vtable, known_routes, known_routes_idx, FALSE);
 
 	_LOGD (vtable->vt->addr_family, "%3d: sync %u IPv%c routes", ifindex, known_routes_idx->len, vtable->vt->is_ip4 ? '4' : '6');
@@ -849,6 +923,9 @@ next:
 	 * Sync @ipx_routes for @ifindex to platform
 	 **************************************************************************/
 
+	batch_data.first_idx = nm_platform_batch_get_n_requests (priv->platform);
+	batch_data.submitted = g_array_new (FALSE, FALSE, vtable->vt->sizeof_route);
+
 	for (i_type = 0; i_type < 2; i_type++) {
 		/* iterate (twice) over @ipx_routes and @plat_routes */
 		cur_plat_route = _get_next_plat_route (plat_routes_idx, TRUE, &i_plat_routes);
@@ -887,28 +964,27 @@ next:
 			if (   !cur_plat_route
 			    || route_dest_cmp_result != 0
 			    || !_route_equals_ignoring_ifindex (vtable, cur_plat_route, cur_ipx_route, *p_effective_metric)) {
-
-				if (!vtable->vt->route_add (priv->platform, ifindex, cur_ipx_route, *p_effective_metric)) {
-					if (cur_ipx_route->rx.rt_source < NM_IP_CONFIG_SOURCE_USER) {
-						_LOGD (vtable->vt->addr_family,
-						       "ignore error adding IPv%c route to kernel: %s",
-						       vtable->vt->is_ip4 ? '4' : '6',
-						       vtable->vt->route_to_string (cur_ipx_route, NULL, 0));
-					} else {
-						/* Remember that there was a failure, but for now continue trying
-						 * to sync the remaining routes. */
-						success = FALSE;
-					}
+				guint n_requests = nm_platform_batch_get_n_requests (priv->platform);
+
+				if (!vtable->vt->route_add (priv->platform, ifindex, cur_ipx_route, *p_effective_metric))
+					_route_add_failed (&batch_data, cur_ipx_route);
+				else if (nm_platform_batch_get_n_requests (priv->platform) > n_requests) {
+					/* the result is reported when the batch ends. */
+					nm_assert (n_requests == batch_data.first_idx + batch_data.submitted->len);
+					g_array_append_vals (batch_data.submitted, cur_ipx_route, 1);
 				}
 			}
 		}
 	}
 
+	nm_platform_batch_end (priv->platform, _route_sync_batch_result, &batch_data);
+	g_array_unref (batch_data.submitted);
+
 	g_free (known_routes_idx);
 	g_free (plat_routes_idx);
-	g_array_unref (plat_routes);
+	g_ptr_array_unref (plat_routes);
 
-	return success;
+	return batch_data.success;
 }
 
 /**
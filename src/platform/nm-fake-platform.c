@@ -49,10 +49,8 @@ typedef struct {
 typedef struct {
 	GHashTable *options;
 	GArray *links;
-	GArray *ip4_addresses;
-	GArray *ip6_addresses;
-	GArray *ip4_routes;
-	GArray *ip6_routes;
+	GHashTable *links_by_name;
+	NMPCache *cache;
 } NMFakePlatformPrivate;
 
 struct _NMFakePlatform {
@@ -110,10 +108,16 @@ static gboolean ip6_address_delete (NMPlatform *platform, int ifindex, struct in
 
 /*****************************************************************************/
 
-static gboolean
-_ip4_address_equal_peer_net (in_addr_t peer1, in_addr_t peer2, guint8 plen)
+static void
+_signal_emit (NMPlatform *platform, const NMPObject *obj, NMPlatformSignalChangeType change_type)
 {
-	return ((peer1 ^ peer2) & nm_utils_ip4_prefix_to_netmask (plen)) == 0;
+	const NMPClass *klass = NMP_OBJECT_GET_CLASS (obj);
+	NMPObject obj_clone;
+
+	/* don't expose the cached @obj directly. A signal handler might call back
+	 * into the platform and modify it. */
+	memcpy (&obj_clone.object, &obj->object, klass->sizeof_public);
+	g_signal_emit_by_name (platform, klass->signal_type, (int) klass->obj_type, obj_clone.object.ifindex, &obj_clone.object, (int) change_type);
 }
 
 /*****************************************************************************/
@@ -258,15 +262,11 @@ static const NMPlatformLink *
 _nm_platform_link_get_by_ifname (NMPlatform *platform, const char *ifname)
 {
 	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
-	guint i;
+	gpointer ifindex;
 
-	for (i = 0; i < priv->links->len; i++) {
-		NMFakePlatformLink *device = &g_array_index (priv->links, NMFakePlatformLink, i);
-
-		if (!strcmp (device->link.name, ifname))
-			return &device->link;
-	}
-	return NULL;
+	if (!g_hash_table_lookup_extended (priv->links_by_name, ifname, NULL, &ifindex))
+		return NULL;
+	return &g_array_index (priv->links, NMFakePlatformLink, GPOINTER_TO_INT (ifindex)).link;
 }
 
 static const NMPlatformLink *
@@ -343,6 +343,10 @@ link_add (NMPlatform *platform,
 	new_device = &g_array_index (priv->links, NMFakePlatformLink, priv->links->len - 1);
 
 	if (device.link.ifindex) {
+		g_hash_table_insert (priv->links_by_name,
+		                     g_strdup (device.link.name),
+		                     GINT_TO_POINTER (device.link.ifindex));
+
 		g_signal_emit_by_name (platform, NM_PLATFORM_SIGNAL_LINK_CHANGED, (int) NMP_OBJECT_TYPE_LINK, device.link.ifindex, &device, (int) NM_PLATFORM_SIGNAL_ADDED);
 
 		link_changed (platform, &g_array_index (priv->links, NMFakePlatformLink, priv->links->len - 1), FALSE);
@@ -359,40 +363,35 @@ link_delete (NMPlatform *platform, int ifindex)
 	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
 	NMFakePlatformLink *device = link_get (platform, ifindex);
 	NMPlatformLink deleted_device;
-	int i;
+	static const NMPObjectType obj_types[] = {
+		NMP_OBJECT_TYPE_IP4_ADDRESS,
+		NMP_OBJECT_TYPE_IP6_ADDRESS,
+		NMP_OBJECT_TYPE_IP4_ROUTE,
+		NMP_OBJECT_TYPE_IP6_ROUTE,
+	};
+	guint i, j;
 
 	if (!device || !device->link.ifindex)
 		return FALSE;
 
+	if (GPOINTER_TO_INT (g_hash_table_lookup (priv->links_by_name, device->link.name)) == ifindex)
+		g_hash_table_remove (priv->links_by_name, device->link.name);
+
 	memcpy (&deleted_device, &device->link, sizeof (deleted_device));
 	memset (&device->link, 0, sizeof (device->link));
 	g_clear_pointer (&device->lnk, nmp_object_unref);
 	g_clear_pointer (&device->udi, g_free);
 
-	/* Remove addresses and routes which belong to the deleted interface */
-	for (i = 0; i < priv->ip4_addresses->len; i++) {
-		NMPlatformIP4Address *address = &g_array_index (priv->ip4_addresses, NMPlatformIP4Address, i);
-
-		if (address->ifindex == ifindex)
-			memset (address, 0, sizeof (*address));
-	}
-	for (i = 0; i < priv->ip6_addresses->len; i++) {
-		NMPlatformIP6Address *address = &g_array_index (priv->ip6_addresses, NMPlatformIP6Address, i);
-
-		if (address->ifindex == ifindex)
-			memset (address, 0, sizeof (*address));
-	}
-	for (i = 0; i < priv->ip4_routes->len; i++) {
-		NMPlatformIP4Route *route = &g_array_index (priv->ip4_routes, NMPlatformIP4Route, i);
+	/* Remove addresses and routes which belong to the deleted interface.
+	 * Like kernel, this happens silently without a signal per object. */
+	for (i = 0; i < G_N_ELEMENTS (obj_types); i++) {
+		gs_unref_ptrarray GPtrArray *objs = NULL;
+		NMPCacheId cache_id;
 
-		if (route->ifindex == ifindex)
-			memset (route, 0, sizeof (*route));
-	}
-	for (i = 0; i < priv->ip6_routes->len; i++) {
-		NMPlatformIP6Route *route = &g_array_index (priv->ip6_routes, NMPlatformIP6Route, i);
-
-		if (route->ifindex == ifindex)
-			memset (route, 0, sizeof (*route));
+		nmp_cache_id_init_addrroute_visible_by_ifindex (&cache_id, obj_types[i], ifindex);
+		objs = nmp_cache_lookup_multi_clone (priv->cache, &cache_id, NULL, NULL);
+		for (j = 0; j < objs->len; j++)
+			nmp_cache_remove (priv->cache, objs->pdata[j], TRUE, NULL, NULL, NULL, NULL);
 	}
 
 	g_signal_emit_by_name (platform, NM_PLATFORM_SIGNAL_LINK_CHANGED, (int) NMP_OBJECT_TYPE_LINK, ifindex, &deleted_device, (int) NM_PLATFORM_SIGNAL_REMOVED);
@@ -872,59 +871,89 @@ mesh_set_ssid (NMPlatform *platform, int ifindex, const guint8 *ssid, gsize len)
 
 /*****************************************************************************/
 
-static GArray *
-ip4_address_get_all (NMPlatform *platform, int ifindex)
+static gboolean
+_ipx_object_add (NMPlatform *platform, NMPObjectType obj_type, const NMPlatformObject *plobj, gboolean notify_unchanged)
 {
 	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
-	GArray *addresses;
-	NMPlatformIP4Address *address;
-	int count = 0, i;
-
-	/* Count addresses */
-	for (i = 0; i < priv->ip4_addresses->len; i++) {
-		address = &g_array_index (priv->ip4_addresses, NMPlatformIP4Address, i);
-		if (address && address->ifindex == ifindex)
-			count++;
+	nm_auto_nmpobj NMPObject *obj = nmp_object_new (obj_type, plobj);
+	nm_auto_nmpobj NMPObject *obj_cache = NULL;
+
+	switch (nmp_cache_update_netlink (priv->cache, obj, &obj_cache, NULL, NULL, NULL)) {
+	case NMP_CACHE_OPS_ADDED:
+		_signal_emit (platform, obj_cache, NM_PLATFORM_SIGNAL_ADDED);
+		break;
+	case NMP_CACHE_OPS_UPDATED:
+		_signal_emit (platform, obj_cache, NM_PLATFORM_SIGNAL_CHANGED);
+		break;
+	case NMP_CACHE_OPS_UNCHANGED:
+		if (notify_unchanged && obj_cache)
+			_signal_emit (platform, obj_cache, NM_PLATFORM_SIGNAL_CHANGED);
+		break;
+	default:
+		g_return_val_if_reached (FALSE);
 	}
+	return TRUE;
+}
 
-	addresses = g_array_sized_new (TRUE, TRUE, sizeof (NMPlatformIP4Address), count);
+static gboolean
+_ipx_object_delete (NMPlatform *platform, const NMPObject *needle)
+{
+	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
+	nm_auto_nmpobj NMPObject *obj_cache = NULL;
+
+	if (nmp_cache_remove (priv->cache, needle, FALSE, &obj_cache, NULL, NULL, NULL) == NMP_CACHE_OPS_REMOVED)
+		_signal_emit (platform, obj_cache, NM_PLATFORM_SIGNAL_REMOVED);
+	return TRUE;
+}
+
+static GPtrArray *
+lookup_clone (NMPlatform *platform, NMPObjectType obj_type, int ifindex, NMPlatformGetRouteFlags flags)
+{
+	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
+	NMPCacheId cache_id;
 
-	/* Fill addresses */
-	for (i = 0; i < priv->ip4_addresses->len; i++) {
-		address = &g_array_index (priv->ip4_addresses, NMPlatformIP4Address, i);
-		if (address && address->ifindex == ifindex)
-			g_array_append_val (addresses, *address);
+	switch (obj_type) {
+	case NMP_OBJECT_TYPE_IP4_ADDRESS:
+	case NMP_OBJECT_TYPE_IP6_ADDRESS:
+		nmp_cache_id_init_addrroute_visible_by_ifindex (&cache_id, obj_type, ifindex);
+		break;
+	case NMP_OBJECT_TYPE_IP4_ROUTE:
+	case NMP_OBJECT_TYPE_IP6_ROUTE:
+		if (!NM_FLAGS_ANY (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT))
+			flags |= NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT;
+		nmp_cache_id_init_routes_visible (&cache_id,
+		                                  obj_type,
+		                                  NM_FLAGS_HAS (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT),
+		                                  NM_FLAGS_HAS (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT),
+		                                  ifindex);
+		break;
+	default:
+		g_return_val_if_reached (NULL);
 	}
 
-	return addresses;
+	return nmp_cache_lookup_multi_clone (priv->cache, &cache_id, NULL, NULL);
 }
 
+/*****************************************************************************/
+
 static GArray *
-ip6_address_get_all (NMPlatform *platform, int ifindex)
+ip4_address_get_all (NMPlatform *platform, int ifindex)
 {
 	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
-	GArray *addresses;
-	NMPlatformIP6Address *address;
-	int count = 0, i;
-
-	/* Count addresses */
-	for (i = 0; i < priv->ip6_addresses->len; i++) {
-		address = &g_array_index (priv->ip6_addresses, NMPlatformIP6Address, i);
-		if (address && address->ifindex == ifindex)
-			count++;
-	}
+	NMPCacheId cache_id;
 
-	addresses = g_array_sized_new (TRUE, TRUE, sizeof (NMPlatformIP6Address), count);
+	nmp_cache_id_init_addrroute_visible_by_ifindex (&cache_id, NMP_OBJECT_TYPE_IP4_ADDRESS, ifindex);
+	return nmp_cache_lookup_multi_to_array (priv->cache, NMP_OBJECT_TYPE_IP4_ADDRESS, &cache_id);
+}
 
-	/* Fill addresses */
-	count = 0;
-	for (i = 0; i < priv->ip6_addresses->len; i++) {
-		address = &g_array_index (priv->ip6_addresses, NMPlatformIP6Address, i);
-		if (address && address->ifindex == ifindex)
-			g_array_append_val (addresses, *address);
-	}
+static GArray *
+ip6_address_get_all (NMPlatform *platform, int ifindex)
+{
+	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
+	NMPCacheId cache_id;
 
-	return addresses;
+	nmp_cache_id_init_addrroute_visible_by_ifindex (&cache_id, NMP_OBJECT_TYPE_IP6_ADDRESS, ifindex);
+	return nmp_cache_lookup_multi_to_array (priv->cache, NMP_OBJECT_TYPE_IP6_ADDRESS, &cache_id);
 }
 
 static gboolean
@@ -938,9 +967,7 @@ ip4_address_add (NMPlatform *platform,
                  guint32 flags,
                  const char *label)
 {
-	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
 	NMPlatformIP4Address address;
-	int i;
 
 	memset (&address, 0, sizeof (address));
 	address.addr_source = NM_IP_CONFIG_SOURCE_KERNEL;
@@ -955,28 +982,7 @@ ip4_address_add (NMPlatform *platform,
 	if (label)
 		g_strlcpy (address.label, label, sizeof (address.label));
 
-	for (i = 0; i < priv->ip4_addresses->len; i++) {
-		NMPlatformIP4Address *item = &g_array_index (priv->ip4_addresses, NMPlatformIP4Address, i);
-		gboolean changed;
-
-		if (   item->ifindex != address.ifindex
-		    || item->address != address.address
-		    || item->plen != address.plen
-		    || !_ip4_address_equal_peer_net (item->peer_address, address.peer_address, address.plen))
-			continue;
-
-		changed = !nm_platform_ip4_address_cmp (item, &address);
-
-		memcpy (item, &address, sizeof (address));
-		if (changed)
-			g_signal_emit_by_name (platform, NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED, (int) NMP_OBJECT_TYPE_IP4_ADDRESS, ifindex, &address, (int) NM_PLATFORM_SIGNAL_CHANGED);
-		return TRUE;
-	}
-
-	g_array_append_val (priv->ip4_addresses, address);
-	g_signal_emit_by_name (platform, NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED, (int) NMP_OBJECT_TYPE_IP4_ADDRESS, ifindex, &address, (int) NM_PLATFORM_SIGNAL_ADDED);
-
-	return TRUE;
+	return _ipx_object_add (platform, NMP_OBJECT_TYPE_IP4_ADDRESS, (const NMPlatformObject *) &address, FALSE);
 }
 
 static gboolean
@@ -989,9 +995,7 @@ ip6_address_add (NMPlatform *platform,
                  guint32 preferred,
                  guint32 flags)
 {
-	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
 	NMPlatformIP6Address address;
-	int i;
 
 	memset (&address, 0, sizeof (address));
 	address.addr_source = NM_IP_CONFIG_SOURCE_KERNEL;
@@ -1004,224 +1008,128 @@ ip6_address_add (NMPlatform *platform,
 	address.preferred = preferred;
 	address.n_ifa_flags = flags;
 
-	for (i = 0; i < priv->ip6_addresses->len; i++) {
-		NMPlatformIP6Address *item = &g_array_index (priv->ip6_addresses, NMPlatformIP6Address, i);
-		gboolean changed;
-
-		if (   item->ifindex != address.ifindex
-		    || !IN6_ARE_ADDR_EQUAL (&item->address, &address.address))
-			continue;
-
-		changed = !nm_platform_ip6_address_cmp (item, &address);
-
-		memcpy (item, &address, sizeof (address));
-		if (changed)
-			g_signal_emit_by_name (platform, NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED, (int) NMP_OBJECT_TYPE_IP6_ADDRESS, ifindex, &address, (int) NM_PLATFORM_SIGNAL_CHANGED);
-		return TRUE;
-	}
-
-	g_array_append_val (priv->ip6_addresses, address);
-	g_signal_emit_by_name (platform, NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED, (int) NMP_OBJECT_TYPE_IP6_ADDRESS, ifindex, &address, (int) NM_PLATFORM_SIGNAL_ADDED);
-
-	return TRUE;
+	return _ipx_object_add (platform, NMP_OBJECT_TYPE_IP6_ADDRESS, (const NMPlatformObject *) &address, FALSE);
 }
 
 static gboolean
 ip4_address_delete (NMPlatform *platform, int ifindex, in_addr_t addr, guint8 plen, in_addr_t peer_address)
 {
-	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
-	int i;
-
-	for (i = 0; i < priv->ip4_addresses->len; i++) {
-		NMPlatformIP4Address *address = &g_array_index (priv->ip4_addresses, NMPlatformIP4Address, i);
-
-		if (   address->ifindex == ifindex
-		    && address->plen == plen
-		    && address->address == addr
-		    && ((peer_address ^ address->peer_address) & nm_utils_ip4_prefix_to_netmask (plen)) == 0) {
-			NMPlatformIP4Address deleted_address;
-
-			memcpy (&deleted_address, address, sizeof (deleted_address));
-			memset (address, 0, sizeof (*address));
-			g_signal_emit_by_name (platform, NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED, (int) NMP_OBJECT_TYPE_IP4_ADDRESS, ifindex, &deleted_address, (int) NM_PLATFORM_SIGNAL_REMOVED);
-			return TRUE;
-		}
-	}
+	NMPObject needle;
 
-	return TRUE;
+	nmp_object_stackinit_id_ip4_address (&needle, ifindex, addr, plen, peer_address);
+	return _ipx_object_delete (platform, &needle);
 }
 
 static gboolean
 ip6_address_delete (NMPlatform *platform, int ifindex, struct in6_addr addr, guint8 plen)
 {
 	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
-	int i;
-
-	for (i = 0; i < priv->ip6_addresses->len; i++) {
-		NMPlatformIP6Address *address = &g_array_index (priv->ip6_addresses, NMPlatformIP6Address, i);
-
-		if (   address->ifindex == ifindex
-		    && address->plen == plen
-		    && IN6_ARE_ADDR_EQUAL (&address->address, &addr)) {
-			NMPlatformIP6Address deleted_address;
-
-			memcpy (&deleted_address, address, sizeof (deleted_address));
-			memset (address, 0, sizeof (*address));
-			g_signal_emit_by_name (platform, NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED, (int) NMP_OBJECT_TYPE_IP6_ADDRESS, ifindex, &deleted_address, (int) NM_PLATFORM_SIGNAL_REMOVED);
-			return TRUE;
-		}
-	}
+	NMPObject needle;
+	const NMPObject *obj;
+
+	/* the cache identifies IPv6 addresses without their prefix length,
+	 * but deleting requires a matching one. */
+	nmp_object_stackinit_id_ip6_address (&needle, ifindex, &addr, plen);
+	obj = nmp_cache_lookup_obj (priv->cache, &needle);
+	if (!obj || obj->ip6_address.plen != plen)
+		return TRUE;
 
-	return TRUE;
+	return _ipx_object_delete (platform, obj);
 }
 
 static const NMPlatformIP4Address *
 ip4_address_get (NMPlatform *platform, int ifindex, in_addr_t addr, guint8 plen, in_addr_t peer_address)
 {
 	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
-	int i;
-
-	for (i = 0; i < priv->ip4_addresses->len; i++) {
-		NMPlatformIP4Address *address = &g_array_index (priv->ip4_addresses, NMPlatformIP4Address, i);
+	NMPObject needle;
+	const NMPObject *obj;
 
-		if (   address->ifindex == ifindex
-		    && address->plen == plen
-		    && address->address == addr
-		    && _ip4_address_equal_peer_net (address->peer_address, peer_address, plen))
-			return address;
-	}
-
-	return NULL;
+	nmp_object_stackinit_id_ip4_address (&needle, ifindex, addr, plen, peer_address);
+	obj = nmp_cache_lookup_obj (priv->cache, &needle);
+	return obj ? &obj->ip4_address : NULL;
 }
 
 static const NMPlatformIP6Address *
 ip6_address_get (NMPlatform *platform, int ifindex, struct in6_addr addr, guint8 plen)
 {
 	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
-	int i;
-
-	for (i = 0; i < priv->ip6_addresses->len; i++) {
-		NMPlatformIP6Address *address = &g_array_index (priv->ip6_addresses, NMPlatformIP6Address, i);
+	NMPObject needle;
+	const NMPObject *obj;
 
-		if (   address->ifindex == ifindex
-		    && address->plen == plen
-		    && IN6_ARE_ADDR_EQUAL (&address->address, &addr))
-			return address;
-	}
-
-	return NULL;
+	nmp_object_stackinit_id_ip6_address (&needle, ifindex, &addr, plen);
+	obj = nmp_cache_lookup_obj (priv->cache, &needle);
+	if (!obj || obj->ip6_address.plen != plen)
+		return NULL;
+	return &obj->ip6_address;
 }
 
 /*****************************************************************************/
 
 static GArray *
-ip4_route_get_all (NMPlatform *platform, int ifindex, NMPlatformGetRouteFlags flags)
+ipx_route_get_all (NMPlatform *platform, int ifindex, NMPObjectType obj_type, NMPlatformGetRouteFlags flags)
 {
 	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
-	GArray *routes;
-	NMPlatformIP4Route *route;
-	guint i;
-
-	routes = g_array_new (TRUE, TRUE, sizeof (NMPlatformIP4Route));
+	NMPCacheId cache_id;
 
 	if (!NM_FLAGS_ANY (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT))
 		flags |= NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT;
 
-	/* Fill routes */
-	for (i = 0; i < priv->ip4_routes->len; i++) {
-		route = &g_array_index (priv->ip4_routes, NMPlatformIP4Route, i);
-		if (route && (!ifindex || route->ifindex == ifindex)) {
-			if (NM_PLATFORM_IP_ROUTE_IS_DEFAULT (route)) {
-				if (NM_FLAGS_HAS (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT))
-					g_array_append_val (routes, *route);
-			} else {
-				if (NM_FLAGS_HAS (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT))
-					g_array_append_val (routes, *route);
-			}
-		}
-	}
+	nmp_cache_id_init_routes_visible (&cache_id,
+	                                  obj_type,
+	                                  NM_FLAGS_HAS (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT),
+	                                  NM_FLAGS_HAS (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT),
+	                                  ifindex);
+	return nmp_cache_lookup_multi_to_array (priv->cache, obj_type, &cache_id);
+}
 
-	return routes;
+static GArray *
+ip4_route_get_all (NMPlatform *platform, int ifindex, NMPlatformGetRouteFlags flags)
+{
+	return ipx_route_get_all (platform, ifindex, NMP_OBJECT_TYPE_IP4_ROUTE, flags);
 }
 
 static GArray *
 ip6_route_get_all (NMPlatform *platform, int ifindex, NMPlatformGetRouteFlags flags)
 {
-	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
-	GArray *routes;
-	NMPlatformIP6Route *route;
-	guint i;
-
-	routes = g_array_new (TRUE, TRUE, sizeof (NMPlatformIP6Route));
-
-	if (!NM_FLAGS_ANY (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT))
-		flags |= NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT;
-
-	/* Fill routes */
-	for (i = 0; i < priv->ip6_routes->len; i++) {
-		route = &g_array_index (priv->ip6_routes, NMPlatformIP6Route, i);
-		if (route && (!ifindex || route->ifindex == ifindex)) {
-			if (NM_PLATFORM_IP_ROUTE_IS_DEFAULT (route)) {
-				if (NM_FLAGS_HAS (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT))
-					g_array_append_val (routes, *route);
-			} else {
-				if (NM_FLAGS_HAS (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT))
-					g_array_append_val (routes, *route);
-			}
-		}
-	}
-
-	return routes;
+	return ipx_route_get_all (platform, ifindex, NMP_OBJECT_TYPE_IP6_ROUTE, flags);
 }
 
 static gboolean
 ip4_route_delete (NMPlatform *platform, int ifindex, in_addr_t network, guint8 plen, guint32 metric)
 {
-	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
-	int i;
-
-	for (i = 0; i < priv->ip4_routes->len; i++) {
-		NMPlatformIP4Route *route = &g_array_index (priv->ip4_routes, NMPlatformIP4Route, i);
-		NMPlatformIP4Route deleted_route;
-
-		if (   route->ifindex != ifindex
-		    || route->network != network
-		    || route->plen != plen
-		    || route->metric != metric)
-			continue;
-
-		memcpy (&deleted_route, route, sizeof (deleted_route));
-		g_array_remove_index (priv->ip4_routes, i);
-		g_signal_emit_by_name (platform, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, (int) NMP_OBJECT_TYPE_IP4_ROUTE, ifindex, &deleted_route, (int) NM_PLATFORM_SIGNAL_REMOVED);
-	}
+	NMPObject needle;
 
-	return TRUE;
+	nmp_object_stackinit_id_ip4_route (&needle, ifindex, network, plen, metric);
+	return _ipx_object_delete (platform, &needle);
 }
 
 static gboolean
 ip6_route_delete (NMPlatform *platform, int ifindex, struct in6_addr network, guint8 plen, guint32 metric)
 {
-	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
-	int i;
+	NMPObject needle;
 
 	metric = nm_utils_ip6_route_metric_normalize (metric);
 
-	for (i = 0; i < priv->ip6_routes->len; i++) {
-		NMPlatformIP6Route *route = &g_array_index (priv->ip6_routes, NMPlatformIP6Route, i);
-		NMPlatformIP6Route deleted_route;
+	nmp_object_stackinit_id_ip6_route (&needle, ifindex, &network, plen, metric);
+	return _ipx_object_delete (platform, &needle);
+}
 
-		if (   route->ifindex != ifindex
-		    || !IN6_ARE_ADDR_EQUAL (&route->network, &network)
-		    || route->plen != plen
-		    || route->metric != metric)
-			continue;
+/* The fake platform only keeps one route per destination. Drop the ones
+ * that a new route on @ifindex replaces. */
+static void
+_route_delete_same_destination (NMPlatform *platform, const NMPCacheId *cache_id, int ifindex)
+{
+	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
+	gs_unref_ptrarray GPtrArray *routes = NULL;
+	guint i;
 
-		memcpy (&deleted_route, route, sizeof (deleted_route));
-		g_array_remove_index (priv->ip6_routes, i);
-		g_signal_emit_by_name (platform, NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED, (int) NMP_OBJECT_TYPE_IP6_ROUTE, ifindex, &deleted_route, (int) NM_PLATFORM_SIGNAL_REMOVED);
-	}
+	routes = nmp_cache_lookup_multi_clone (priv->cache, cache_id, NULL, NULL);
+	for (i = 0; i < routes->len; i++) {
+		const NMPObject *obj = routes->pdata[i];
 
-	return TRUE;
+		if (obj->object.ifindex != ifindex)
+			_ipx_object_delete (platform, obj);
+	}
 }
 
 static gboolean
@@ -1231,7 +1139,7 @@ ip4_route_add (NMPlatform *platform, int ifindex, NMIPConfigSource source,
 {
 	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
 	NMPlatformIP4Route route;
-	guint i;
+	NMPCacheId cache_id;
 	guint8 scope;
 
 	g_assert (plen <= 32);
@@ -1249,47 +1157,29 @@ ip4_route_add (NMPlatform *platform, int ifindex, NMIPConfigSource source,
 	route.scope_inv = nm_platform_route_scope_inv (scope);
 
 	if (gateway) {
-		for (i = 0; i < priv->ip4_routes->len; i++) {
-			NMPlatformIP4Route *item = &g_array_index (priv->ip4_routes,
-			                                           NMPlatformIP4Route, i);
-			guint32 gate = ntohl (item->network) >> (32 - item->plen);
-			guint32 host = ntohl (gateway) >> (32 - item->plen);
+		const NMPlatformIP4Route *const *routes;
+		guint i, len;
+
+		nmp_cache_id_init_addrroute_visible_by_ifindex (&cache_id, NMP_OBJECT_TYPE_IP4_ROUTE, ifindex);
+		routes = (const NMPlatformIP4Route *const *) nmp_cache_lookup_multi (priv->cache, &cache_id, &len);
+		for (i = 0; i < len; i++) {
+			guint32 gate = ntohl (routes[i]->network) >> (32 - routes[i]->plen);
+			guint32 host = ntohl (gateway) >> (32 - routes[i]->plen);
 
-			if (ifindex == item->ifindex && gate == host)
+			if (gate == host)
 				break;
 		}
-		if (i == priv->ip4_routes->len) {
+		if (i == len) {
 			nm_log_warn (LOGD_PLATFORM, "Fake platform: failure adding ip4-route '%d: %s/%d %d': Network Unreachable",
 			             route.ifindex, nm_utils_inet4_ntop (route.network, NULL), route.plen, route.metric);
 			return FALSE;
 		}
 	}
 
-	for (i = 0; i < priv->ip4_routes->len; i++) {
-		NMPlatformIP4Route *item = &g_array_index (priv->ip4_routes, NMPlatformIP4Route, i);
-
-		if (item->network != route.network)
-			continue;
-		if (item->plen != route.plen)
-			continue;
-		if (item->metric != metric)
-			continue;
-
-		if (item->ifindex != route.ifindex) {
-			ip4_route_delete (platform, item->ifindex, item->network, item->plen, item->metric);
-			i--;
-			continue;
-		}
-
-		memcpy (item, &route, sizeof (route));
-		g_signal_emit_by_name (platform, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, (int) NMP_OBJECT_TYPE_IP4_ROUTE, ifindex, &route, (int) NM_PLATFORM_SIGNAL_CHANGED);
-		return TRUE;
-	}
-
-	g_array_append_val (priv->ip4_routes, route);
-	g_signal_emit_by_name (platform, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, (int) NMP_OBJECT_TYPE_IP4_ROUTE, ifindex, &route, (int) NM_PLATFORM_SIGNAL_ADDED);
+	nmp_cache_id_init_routes_by_destination_ip4 (&cache_id, route.network, route.plen, route.metric);
+	_route_delete_same_destination (platform, &cache_id, route.ifindex);
 
-	return TRUE;
+	return _ipx_object_add (platform, NMP_OBJECT_TYPE_IP4_ROUTE, (const NMPlatformObject *) &route, TRUE);
 }
 
 static gboolean
@@ -1299,7 +1189,7 @@ ip6_route_add (NMPlatform *platform, int ifindex, NMIPConfigSource source,
 {
 	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
 	NMPlatformIP6Route route;
-	guint i;
+	NMPCacheId cache_id;
 
 	metric = nm_utils_ip6_route_metric_normalize (metric);
 
@@ -1313,89 +1203,57 @@ ip6_route_add (NMPlatform *platform, int ifindex, NMIPConfigSource source,
 	route.mss = mss;
 
 	if (!IN6_IS_ADDR_UNSPECIFIED(&gateway)) {
-		for (i = 0; i < priv->ip6_routes->len; i++) {
-			NMPlatformIP6Route *item = &g_array_index (priv->ip6_routes,
-			                                           NMPlatformIP6Route, i);
+		const NMPlatformIP6Route *const *routes;
+		guint i, len;
+
+		nmp_cache_id_init_addrroute_visible_by_ifindex (&cache_id, NMP_OBJECT_TYPE_IP6_ROUTE, ifindex);
+		routes = (const NMPlatformIP6Route *const *) nmp_cache_lookup_multi (priv->cache, &cache_id, &len);
+		for (i = 0; i < len; i++) {
+			const NMPlatformIP6Route *item = routes[i];
 			guint8 gate_bits = gateway.s6_addr[item->plen / 8] >> (8 - item->plen % 8);
 			guint8 host_bits = item->network.s6_addr[item->plen / 8] >> (8 - item->plen % 8);
 
-			if (   ifindex == item->ifindex
-			    && memcmp (&gateway, &item->network, item->plen / 8) == 0
+			if (   memcmp (&gateway, &item->network, item->plen / 8) == 0
 			    && gate_bits == host_bits)
 				break;
 		}
-		if (i == priv->ip6_routes->len) {
+		if (i == len) {
 			nm_log_warn (LOGD_PLATFORM, "Fake platform: failure adding ip6-route '%d: %s/%d %d': Network Unreachable",
 			             route.ifindex, nm_utils_inet6_ntop (&route.network, NULL), route.plen, route.metric);
 			return FALSE;
 		}
 	}
 
-	for (i = 0; i < priv->ip6_routes->len; i++) {
-		NMPlatformIP6Route *item = &g_array_index (priv->ip6_routes, NMPlatformIP6Route, i);
-
-		if (!IN6_ARE_ADDR_EQUAL (&item->network, &route.network))
-			continue;
-		if (item->plen != route.plen)
-			continue;
-		if (item->metric != metric)
-			continue;
+	nmp_cache_id_init_routes_by_destination_ip6 (&cache_id, &route.network, route.plen, route.metric);
+	_route_delete_same_destination (platform, &cache_id, route.ifindex);
 
-		if (item->ifindex != route.ifindex) {
-			ip6_route_delete (platform, item->ifindex, item->network, item->plen, item->metric);
-			i--;
-			continue;
-		}
-
-		memcpy (item, &route, sizeof (route));
-		g_signal_emit_by_name (platform, NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED, (int) NMP_OBJECT_TYPE_IP6_ROUTE, ifindex, &route, (int) NM_PLATFORM_SIGNAL_CHANGED);
-		return TRUE;
-	}
-
-	g_array_append_val (priv->ip6_routes, route);
-	g_signal_emit_by_name (platform, NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED, (int) NMP_OBJECT_TYPE_IP6_ROUTE, ifindex, &route, (int) NM_PLATFORM_SIGNAL_ADDED);
-
-	return TRUE;
+	return _ipx_object_add (platform, NMP_OBJECT_TYPE_IP6_ROUTE, (const NMPlatformObject *) &route, TRUE);
 }
 
 static const NMPlatformIP4Route *
 ip4_route_get (NMPlatform *platform, int ifindex, in_addr_t network, guint8 plen, guint32 metric)
 {
 	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
-	int i;
+	NMPObject needle;
+	const NMPObject *obj;
 
-	for (i = 0; i < priv->ip4_routes->len; i++) {
-		NMPlatformIP4Route *route = &g_array_index (priv->ip4_routes, NMPlatformIP4Route, i);
-
-		if (route->ifindex == ifindex
-				&& route->network == network
-				&& route->plen == plen
-				&& route->metric == metric)
-			return route;
-	}
-
-	return NULL;
+	nmp_object_stackinit_id_ip4_route (&needle, ifindex, network, plen, metric);
+	obj = nmp_cache_lookup_obj (priv->cache, &needle);
+	return obj ? &obj->ip4_route : NULL;
 }
 
 static const NMPlatformIP6Route *
 ip6_route_get (NMPlatform *platform, int ifindex, struct in6_addr network, guint8 plen, guint32 metric)
 {
 	NMFakePlatformPrivate *priv = NM_FAKE_PLATFORM_GET_PRIVATE ((NMFakePlatform *) platform);
-	int i;
+	NMPObject needle;
+	const NMPObject *obj;
 
 	metric = nm_utils_ip6_route_metric_normalize (metric);
 
-	for (i = 0; i < priv->ip6_routes->len; i++) {
-		NMPlatformIP6Route *route = &g_array_index (priv->ip6_routes, NMPlatformIP6Route, i);
-
-		if (route->ifindex == ifindex
-				&& IN6_ARE_ADDR_EQUAL (&route->network, &network)
-				&& route->plen == plen
-				&& route->metric == metric)
-			return route;
-	}
-
-	return NULL;
+	nmp_object_stackinit_id_ip6_route (&needle, ifindex, &network, plen, metric);
+	obj = nmp_cache_lookup_obj (priv->cache, &needle);
+	return obj ? &obj->ip6_route : NULL;
 }
 
 /*****************************************************************************/
@@ -1407,10 +1265,8 @@ nm_fake_platform_init (NMFakePlatform *fake_platform)
 
 	priv->options = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 	priv->links = g_array_new (TRUE, TRUE, sizeof (NMFakePlatformLink));
-	priv->ip4_addresses = g_array_new (TRUE, TRUE, sizeof (NMPlatformIP4Address));
-	priv->ip6_addresses = g_array_new (TRUE, TRUE, sizeof (NMPlatformIP6Address));
-	priv->ip4_routes = g_array_new (TRUE, TRUE, sizeof (NMPlatformIP4Route));
-	priv->ip6_routes = g_array_new (TRUE, TRUE, sizeof (NMPlatformIP6Route));
+	priv->links_by_name = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	priv->cache = nmp_cache_new (FALSE);
 }
 
 void
@@ -1448,10 +1304,8 @@ finalize (GObject *object)
 		g_clear_pointer (&device->lnk, nmp_object_unref);
 	}
 	g_array_unref (priv->links);
-	g_array_unref (priv->ip4_addresses);
-	g_array_unref (priv->ip6_addresses);
-	g_array_unref (priv->ip4_routes);
-	g_array_unref (priv->ip6_routes);
+	g_hash_table_unref (priv->links_by_name);
+	nmp_cache_free (priv->cache);
 
 	G_OBJECT_CLASS (nm_fake_platform_parent_class)->finalize (object);
 }
@@ -1534,4 +1388,6 @@ nm_fake_platform_class_init (NMFakePlatformClass *klass)
 	platform_class->ip6_route_add = ip6_route_add;
 	platform_class->ip4_route_delete = ip4_route_delete;
 	platform_class->ip6_route_delete = ip6_route_delete;
+
+	platform_class->lookup_clone = lookup_clone;
 }
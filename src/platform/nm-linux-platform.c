@@ -2420,6 +2420,14 @@ typedef struct {
 	gboolean sysctl_get_warned;
 	GHashTable *sysctl_get_prev_values;
 
+	/* the directory file descriptors for /proc/sys/net/ipv{4,6}/conf/$IFNAME
+	 * together with the values that were last written or read there. */
+	GHashTable *sysctl_ip_conf_dirs;
+
+	/* the entries of @sysctl_ip_conf_dirs which have an open directory
+	 * file descriptor, the most recently used first. */
+	GQueue sysctl_ip_conf_dirs_lru;
+
 	GUdevClient *udev_client;
 
 	struct {
@@ -2438,6 +2446,25 @@ typedef struct {
 		gint is_handling;
 	} delayed_action;
 
+	struct {
+		/* for each open batch the index into @requests of its first
+		 * request. A batch is open while the array is not empty. */
+		GArray *starts;
+
+		/* the #BatchRequest instances submitted by the open batches.
+		 * The first @n_completed have their result already evaluated. */
+		GPtrArray *requests;
+		guint n_completed;
+
+		/* the signal emission depth when the outermost batch was opened.
+		 * Requests issued by signal handlers are not batched. */
+		guint signal_depth;
+
+		gint flushing;
+	} batch;
+
+	guint signal_depth;
+
 	GHashTable *prune_candidates;
 
 	GHashTable *wifi_data;
@@ -2538,6 +2565,8 @@ _log_dbg_sysctl_set_impl (NMPlatform *platform, const char *pathid, int dirfd, c
 		} \
 	} G_STMT_END
 
+static void _sysctl_ip_conf_dirs_clear_values (NMPlatform *platform);
+
 static gboolean
 sysctl_set (NMPlatform *platform, const char *pathid, int dirfd, const char *path, const char *value)
 {
@@ -2562,6 +2591,11 @@ sysctl_set (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 
 		pathid = path;
 
+		/* writing to a global option like conf/all/forwarding or ip_forward
+		 * can change the per-interface values behind our back. */
+		if (g_str_has_prefix (path, "/proc/sys/net/"))
+			_sysctl_ip_conf_dirs_clear_values (platform);
+
 		fd = open (path, O_WRONLY | O_TRUNC | O_CLOEXEC);
 		if (fd == -1) {
 			errsv = errno;
@@ -2743,6 +2777,291 @@ sysctl_get (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 
 /*****************************************************************************/
 
+/* the number of directory file descriptors we keep open at most. On hosts with
+ * many interfaces, the least recently used ones are closed and reopened on
+ * demand. The cached values are kept regardless. */
+#define SYSCTL_IP_CONF_DIRS_MAX_FDS 32
+
+typedef struct {
+	int addr_family;
+	char *ifname;
+	int dirfd;
+
+	/* link in NMLinuxPlatformPrivate's sysctl_ip_conf_dirs_lru, while
+	 * @dirfd is open. */
+	GList lru_link;
+	GQueue *lru;
+
+	/* property name -> the value last written or read. */
+	GHashTable *values;
+} SysctlIPConfDir;
+
+static guint
+_sysctl_ip_conf_dir_hash (gconstpointer ptr)
+{
+	const SysctlIPConfDir *dir = ptr;
+
+	return g_str_hash (dir->ifname) + dir->addr_family;
+}
+
+static gboolean
+_sysctl_ip_conf_dir_equal (gconstpointer a, gconstpointer b)
+{
+	const SysctlIPConfDir *dir_a = a;
+	const SysctlIPConfDir *dir_b = b;
+
+	return    dir_a->addr_family == dir_b->addr_family
+	       && strcmp (dir_a->ifname, dir_b->ifname) == 0;
+}
+
+static void
+_sysctl_ip_conf_dir_close (SysctlIPConfDir *dir)
+{
+	if (dir->dirfd < 0)
+		return;
+	g_queue_unlink (dir->lru, &dir->lru_link);
+	close (dir->dirfd);
+	dir->dirfd = -1;
+}
+
+static void
+_sysctl_ip_conf_dir_free (gpointer ptr)
+{
+	SysctlIPConfDir *dir = ptr;
+
+	_sysctl_ip_conf_dir_close (dir);
+	g_hash_table_unref (dir->values);
+	g_free (dir->ifname);
+	g_slice_free (SysctlIPConfDir, dir);
+}
+
+static void
+_sysctl_ip_conf_dirs_clear_values (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	GHashTableIter iter;
+	SysctlIPConfDir *dir;
+
+	if (!priv->sysctl_ip_conf_dirs)
+		return;
+
+	g_hash_table_iter_init (&iter, priv->sysctl_ip_conf_dirs);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &dir, NULL))
+		g_hash_table_remove_all (dir->values);
+}
+
+static void
+_sysctl_ip_conf_dirs_invalidate (NMPlatform *platform, const char *ifname)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	SysctlIPConfDir needle = { .ifname = (char *) ifname };
+
+	if (   !priv->sysctl_ip_conf_dirs
+	    || !ifname
+	    || !ifname[0])
+		return;
+
+	/* the sysctl directories are re-created by kernel when the
+	 * interface gets renamed or removed. Drop the cached ones. */
+	needle.addr_family = AF_INET;
+	g_hash_table_remove (priv->sysctl_ip_conf_dirs, &needle);
+	needle.addr_family = AF_INET6;
+	g_hash_table_remove (priv->sysctl_ip_conf_dirs, &needle);
+}
+
+static void
+sysctl_ip_conf_invalidate (NMPlatform *platform, int ifindex)
+{
+	const NMPlatformLink *pllink;
+
+	pllink = nm_platform_link_get (platform, ifindex);
+	if (pllink)
+		_sysctl_ip_conf_dirs_invalidate (platform, pllink->name);
+}
+
+#define SYSCTL_IP_CONF_PATHID(buf, dir, property) \
+	({ \
+		const SysctlIPConfDir *const _dir = (dir); \
+		\
+		g_snprintf ((buf), sizeof (buf), "conf:/proc/sys/net/%s/conf/%s/%s", \
+		            _dir->addr_family == AF_INET6 ? "ipv6" : "ipv4", \
+		            _dir->ifname, (property)); \
+		(const char *) (buf); \
+	})
+
+static SysctlIPConfDir *
+_sysctl_ip_conf_dir_get (NMPlatform *platform,
+                         int addr_family,
+                         const char *ifname,
+                         gboolean reopen,
+                         NMPlatformSysctlStats *stats)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	SysctlIPConfDir needle = { .addr_family = addr_family, .ifname = (char *) ifname };
+	SysctlIPConfDir *dir = NULL;
+	char path[NM_STRLEN ("/proc/sys/net/ipv6/conf/") + IFNAMSIZ + 1];
+	int fd, errsv;
+
+	ASSERT_NETNS_CURRENT (platform);
+
+	if (!nm_utils_is_valid_path_component (ifname)) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	if (!priv->sysctl_ip_conf_dirs) {
+		priv->sysctl_ip_conf_dirs = g_hash_table_new_full (_sysctl_ip_conf_dir_hash,
+		                                                   _sysctl_ip_conf_dir_equal,
+		                                                   _sysctl_ip_conf_dir_free,
+		                                                   NULL);
+	} else {
+		dir = g_hash_table_lookup (priv->sysctl_ip_conf_dirs, &needle);
+		if (dir && reopen) {
+			g_hash_table_remove (priv->sysctl_ip_conf_dirs, dir);
+			dir = NULL;
+		} else if (dir && dir->dirfd >= 0) {
+			g_queue_unlink (dir->lru, &dir->lru_link);
+			g_queue_push_head_link (dir->lru, &dir->lru_link);
+			return dir;
+		}
+	}
+
+	if (g_snprintf (path, sizeof (path), "/proc/sys/net/%s/conf/%s",
+	                addr_family == AF_INET6 ? "ipv6" : "ipv4",
+	                ifname) >= sizeof (path)) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	if (priv->sysctl_ip_conf_dirs_lru.length >= SYSCTL_IP_CONF_DIRS_MAX_FDS)
+		_sysctl_ip_conf_dir_close (priv->sysctl_ip_conf_dirs_lru.tail->data);
+
+	stats->n_syscalls++;
+	fd = open (path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd == -1) {
+		errsv = errno;
+		_LOGD ("sysctl: failed to open '%s': (%d) %s",
+		       path, errsv, strerror (errsv));
+		errno = errsv;
+		return NULL;
+	}
+
+	if (!dir) {
+		dir = g_slice_new0 (SysctlIPConfDir);
+		dir->addr_family = addr_family;
+		dir->ifname = g_strdup (ifname);
+		dir->lru = &priv->sysctl_ip_conf_dirs_lru;
+		dir->lru_link.data = dir;
+		dir->values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+		g_hash_table_add (priv->sysctl_ip_conf_dirs, dir);
+	}
+	dir->dirfd = fd;
+	g_queue_push_head_link (dir->lru, &dir->lru_link);
+	return dir;
+}
+
+static gboolean
+sysctl_ip_conf_set_multi (NMPlatform *platform,
+                          int addr_family,
+                          const char *ifname,
+                          const NMPlatformSysctlIPConfSetData *data,
+                          guint n_data,
+                          NMPlatformSysctlStats *stats)
+{
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	SysctlIPConfDir *dir;
+	gboolean success = TRUE;
+	gboolean reopened = FALSE;
+	char pathid[100];
+	guint i;
+
+	if (!nm_platform_netns_push (platform, &netns)) {
+		errno = ENETDOWN;
+		return FALSE;
+	}
+
+	dir = _sysctl_ip_conf_dir_get (platform, addr_family, ifname, FALSE, stats);
+	if (!dir)
+		return FALSE;
+
+	for (i = 0; i < n_data; i++) {
+		const char *property = data[i].property;
+		const char *value = data[i].value;
+		const char *value_cached;
+		int errsv;
+
+		nm_assert (nm_utils_is_valid_path_component (property));
+		nm_assert (value);
+
+		value_cached = g_hash_table_lookup (dir->values, property);
+		if (nm_streq0 (value_cached, value)) {
+			_LOGT ("sysctl: setting '%s' to '%s' (skipped, value is already set)",
+			       SYSCTL_IP_CONF_PATHID (pathid, dir, property), value);
+			stats->n_skipped++;
+			continue;
+		}
+
+		/* open(), write() and close() */
+		stats->n_syscalls += 3;
+		if (sysctl_set (platform, SYSCTL_IP_CONF_PATHID (pathid, dir, property), dir->dirfd, property, value)) {
+			g_hash_table_insert (dir->values, g_strdup (property), g_strdup (value));
+			continue;
+		}
+
+		errsv = errno;
+		g_hash_table_remove (dir->values, property);
+
+		if (   errsv == ENOENT
+		    && !reopened) {
+			/* the cached directory might belong to an interface that is gone
+			 * but we didn't yet process the netlink event. Retry once with
+			 * a freshly opened directory. */
+			reopened = TRUE;
+			dir = _sysctl_ip_conf_dir_get (platform, addr_family, ifname, TRUE, stats);
+			if (!dir)
+				return FALSE;
+			i--;
+			continue;
+		}
+		success = FALSE;
+	}
+
+	return success;
+}
+
+static char *
+sysctl_ip_conf_get (NMPlatform *platform,
+                    int addr_family,
+                    const char *ifname,
+                    const char *property,
+                    NMPlatformSysctlStats *stats)
+{
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	SysctlIPConfDir *dir;
+	char pathid[100];
+	char *contents;
+
+	nm_assert (nm_utils_is_valid_path_component (property));
+
+	if (!nm_platform_netns_push (platform, &netns))
+		return NULL;
+
+	dir = _sysctl_ip_conf_dir_get (platform, addr_family, ifname, FALSE, stats);
+	if (!dir)
+		return NULL;
+
+	/* open(), read() and close() */
+	stats->n_syscalls += 3;
+	contents = sysctl_get (platform, SYSCTL_IP_CONF_PATHID (pathid, dir, property), dir->dirfd, property);
+	if (contents)
+		g_hash_table_insert (dir->values, g_strdup (property), g_strdup (contents));
+	else
+		g_hash_table_remove (dir->values, property);
+	return contents;
+}
+
+/*****************************************************************************/
+
 static gboolean
 check_support_kernel_extended_ifa_flags (NMPlatform *platform)
 {
@@ -2836,6 +3155,7 @@ do_emit_signal (NMPlatform *platform, const NMPObject *obj, NMPCacheOpsType cach
 	/* don't expose @obj directly, but clone the public fields. A signal handler might
 	 * call back into NMPlatform which could invalidate (or modify) @obj. */
 	memcpy (&obj_clone.object, &obj->object, klass->sizeof_public);
+	NM_LINUX_PLATFORM_GET_PRIVATE (platform)->signal_depth++;
 	g_signal_emit (platform,
 	               _nm_platform_signal_id_get (klass->signal_type_id),
 	               0,
@@ -2843,6 +3163,7 @@ do_emit_signal (NMPlatform *platform, const NMPObject *obj, NMPCacheOpsType cach
 	               obj_clone.object.ifindex,
 	               &obj_clone.object,
 	               (int) cache_op);
+	NM_LINUX_PLATFORM_GET_PRIVATE (platform)->signal_depth--;
 }
 
 /*****************************************************************************/
@@ -3408,6 +3729,20 @@ cache_pre_hook (NMPCache *cache, const NMPObject *old, const NMPObject *new, NMP
 				                         NULL);
 			}
 		}
+		{
+			/* the cached sysctl directories are bound to the interface name. */
+			if (   ops_type == NMP_CACHE_OPS_REMOVED
+			    && old /* <-- nonsensical, make coverity happy */)
+				_sysctl_ip_conf_dirs_invalidate (platform, old->link.name);
+			else if (   ops_type == NMP_CACHE_OPS_UPDATED
+			         && old && new /* <-- nonsensical, make coverity happy */
+			         && strcmp (old->link.name, new->link.name) != 0) {
+				_sysctl_ip_conf_dirs_invalidate (platform, old->link.name);
+				_sysctl_ip_conf_dirs_invalidate (platform, new->link.name);
+			} else if (   ops_type == NMP_CACHE_OPS_ADDED
+			           && new /* <-- nonsensical, make coverity happy */)
+				_sysctl_ip_conf_dirs_invalidate (platform, new->link.name);
+		}
 		if (   NM_IN_SET (ops_type, NMP_CACHE_OPS_ADDED, NMP_CACHE_OPS_UPDATED)
 		    && (new && new->_link.netlink.is_in_netlink)
 		    && (!old || !old->_link.netlink.is_in_netlink))
@@ -3992,33 +4327,173 @@ do_add_link_with_lookup (NMPlatform *platform,
 	return !!obj;
 }
 
+/*****************************************************************************/
+
+/* the number of batched requests for which we don't yet wait for the ACK.
+ * Beyond that, the pending requests get flushed first so that ACKs and
+ * notifications don't overrun the receive buffer of the netlink socket. */
+#define BATCH_MAX_IN_FLIGHT 64
+
+typedef struct {
+	NMPObject *obj_id;
+	WaitForNlResponseResult seq_result;
+	bool is_delete:1;
+	bool success:1;
+} BatchRequest;
+
+static BatchRequest *
+_batch_request_new (const NMPObject *obj_id, gboolean is_delete)
+{
+	BatchRequest *req;
+
+	req = g_slice_new0 (BatchRequest);
+	req->obj_id = nmp_object_clone (obj_id, TRUE);
+	req->is_delete = is_delete;
+	return req;
+}
+
+static void
+_batch_request_free (gpointer data)
+{
+	BatchRequest *req = data;
+
+	if (req) {
+		nmp_object_unref (req->obj_id);
+		g_slice_free (BatchRequest, req);
+	}
+}
+
 static gboolean
-do_add_addrroute (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *nlmsg)
+_batch_is_active (NMPlatform *platform)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
-	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
-	int nle;
-	char s_buf[256];
-	const NMPObject *obj;
 
-	nm_assert (NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id),
-	                      NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP6_ADDRESS,
-	                      NMP_OBJECT_TYPE_IP4_ROUTE, NMP_OBJECT_TYPE_IP6_ROUTE));
+	/* requests are only batched for the caller that opened the batch.
+	 * Nested requests (from signal handlers, or while evaluating the results
+	 * of the batch) are handled synchronously. */
+	return    priv->batch.starts->len > 0
+	       && !priv->batch.flushing
+	       && priv->delayed_action.is_handling == 0
+	       && priv->signal_depth == priv->batch.signal_depth;
+}
 
-	event_handler_read_netlink (platform, FALSE);
+static gboolean do_add_addrroute_result (NMPlatform *platform, const NMPObject *obj_id, WaitForNlResponseResult seq_result);
+static gboolean do_delete_object_result (NMPlatform *platform, const NMPObject *obj_id, WaitForNlResponseResult seq_result);
 
-	nle = _nl_send_auto_with_seq (platform, nlmsg, &seq_result, NULL);
-	if (nle < 0) {
-		_LOGE ("do-add-%s[%s]: failure sending netlink request \"%s\" (%d)",
-		       NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
-		       nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
-		       nl_geterror (nle), -nle);
-		return FALSE;
-	}
+static void
+_batch_flush (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	guint i, j;
+
+	if (priv->batch.n_completed >= priv->batch.requests->len)
+		return;
+
+	_LOGt ("batch: wait for %u pending requests", priv->batch.requests->len - priv->batch.n_completed);
+
+	priv->batch.flushing++;
 
+	/* wait once for the ACKs of all pending requests. */
 	delayed_action_handle_all (platform, FALSE);
 
-	nm_assert (seq_result);
+	for (i = priv->batch.n_completed; i < priv->batch.requests->len; i++) {
+		BatchRequest *req = priv->batch.requests->pdata[i];
+
+		if (!req->seq_result) {
+			/* we were not able to wait for the ACK. Don't leave a dangling
+			 * pointer behind. */
+			for (j = 0; j < priv->delayed_action.list_wait_for_nl_response->len; j++) {
+				DelayedActionWaitForNlResponseData *data = &g_array_index (priv->delayed_action.list_wait_for_nl_response, DelayedActionWaitForNlResponseData, j);
+
+				if (data->out_seq_result == &req->seq_result)
+					data->out_seq_result = NULL;
+			}
+		}
+
+		req->success = req->is_delete
+		               ? do_delete_object_result (platform, req->obj_id, req->seq_result)
+		               : do_add_addrroute_result (platform, req->obj_id, req->seq_result);
+	}
+	priv->batch.n_completed = i;
+
+	priv->batch.flushing--;
+}
+
+static void
+_batch_request_queue (NMPlatform *platform, BatchRequest *req)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	g_ptr_array_add (priv->batch.requests, req);
+	if (priv->batch.requests->len - priv->batch.n_completed >= BATCH_MAX_IN_FLIGHT)
+		_batch_flush (platform);
+}
+
+static void
+batch_begin (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	if (priv->batch.starts->len == 0)
+		priv->batch.signal_depth = priv->signal_depth;
+	g_array_append_val (priv->batch.starts, priv->batch.requests->len);
+}
+
+static guint
+batch_get_n_requests (NMPlatform *platform)
+{
+	return NM_LINUX_PLATFORM_GET_PRIVATE (platform)->batch.requests->len;
+}
+
+static gboolean
+batch_end (NMPlatform *platform, NMPlatformBatchResultFunc result_func, gpointer user_data)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	gs_unref_array GArray *results = NULL;
+	gboolean success = TRUE;
+	guint start, i;
+
+	g_return_val_if_fail (priv->batch.starts->len > 0, FALSE);
+
+	start = g_array_index (priv->batch.starts, guint, priv->batch.starts->len - 1);
+	g_array_set_size (priv->batch.starts, priv->batch.starts->len - 1);
+
+	nm_assert (start <= priv->batch.requests->len);
+
+	if (start < priv->batch.requests->len)
+		_batch_flush (platform);
+
+	results = g_array_sized_new (FALSE, FALSE, sizeof (gboolean), priv->batch.requests->len - start);
+	for (i = start; i < priv->batch.requests->len; i++) {
+		const BatchRequest *req = priv->batch.requests->pdata[i];
+		gboolean req_success = req->success;
+
+		g_array_append_val (results, req_success);
+		if (!req_success)
+			success = FALSE;
+	}
+
+	/* drop the requests before notifying the caller, which might call
+	 * back into platform. */
+	g_ptr_array_set_size (priv->batch.requests, start);
+	priv->batch.n_completed = start;
+
+	if (result_func) {
+		for (i = 0; i < results->len; i++)
+			result_func (platform, start + i, g_array_index (results, gboolean, i), user_data);
+	}
+
+	return success;
+}
+
+/*****************************************************************************/
+
+static gboolean
+do_add_addrroute_result (NMPlatform *platform, const NMPObject *obj_id, WaitForNlResponseResult seq_result)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	char s_buf[256];
+	const NMPObject *obj;
 
 	_NMLOG (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
 	            ? LOGL_DEBUG
@@ -4049,30 +4524,56 @@ do_add_addrroute (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *
 }
 
 static gboolean
-do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *nlmsg)
+do_add_addrroute (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *nlmsg)
 {
-	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+	BatchRequest *req = NULL;
 	int nle;
-	char s_buf[256];
-	gboolean success = TRUE;
-	const char *log_detail = "";
 
-	event_handler_read_netlink (platform, FALSE);
+	nm_assert (NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id),
+	                      NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP6_ADDRESS,
+	                      NMP_OBJECT_TYPE_IP4_ROUTE, NMP_OBJECT_TYPE_IP6_ROUTE));
 
-	nle = _nl_send_auto_with_seq (platform, nlmsg, &seq_result, NULL);
+	if (_batch_is_active (platform))
+		req = _batch_request_new (obj_id, FALSE);
+	else
+		event_handler_read_netlink (platform, FALSE);
+
+	nle = _nl_send_auto_with_seq (platform, nlmsg, req ? &req->seq_result : &seq_result, NULL);
 	if (nle < 0) {
-		_LOGE ("do-delete-%s[%s]: failure sending netlink request \"%s\" (%d)",
+		_batch_request_free (req);
+		_LOGE ("do-add-%s[%s]: failure sending netlink request \"%s\" (%d)",
 		       NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
 		       nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
 		       nl_geterror (nle), -nle);
-		goto out;
+		return FALSE;
+	}
+
+	if (req) {
+		/* the result is evaluated when the batch gets flushed. */
+		_batch_request_queue (platform, req);
+		return TRUE;
 	}
 
 	delayed_action_handle_all (platform, FALSE);
 
 	nm_assert (seq_result);
 
+	return do_add_addrroute_result (platform, obj_id, seq_result);
+}
+
+static gboolean
+do_delete_object_result (NMPlatform *platform, const NMPObject *obj_id, WaitForNlResponseResult seq_result)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	char s_buf[256];
+	gboolean success = TRUE;
+	const char *log_detail = "";
+
+	/* a @seq_result of zero means that the request could not be sent. */
+	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN)
+		goto out;
+
 	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK) {
 		/* ok */
 	} else if (NM_IN_SET (-((int) seq_result), ESRCH, ENOENT))
@@ -4104,6 +4605,41 @@ out:
 	return !!nmp_cache_lookup_obj (priv->cache, obj_id);
 }
 
+static gboolean
+do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *nlmsg)
+{
+	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+	BatchRequest *req = NULL;
+	int nle;
+
+	if (   _batch_is_active (platform)
+	    && NMP_OBJECT_GET_TYPE (obj_id) != NMP_OBJECT_TYPE_LINK)
+		req = _batch_request_new (obj_id, TRUE);
+	else
+		event_handler_read_netlink (platform, FALSE);
+
+	nle = _nl_send_auto_with_seq (platform, nlmsg, req ? &req->seq_result : &seq_result, NULL);
+	if (nle < 0) {
+		_batch_request_free (req);
+		_LOGE ("do-delete-%s[%s]: failure sending netlink request \"%s\" (%d)",
+		       NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
+		       nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
+		       nl_geterror (nle), -nle);
+		return do_delete_object_result (platform, obj_id, WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN);
+	}
+
+	if (req) {
+		_batch_request_queue (platform, req);
+		return TRUE;
+	}
+
+	delayed_action_handle_all (platform, FALSE);
+
+	nm_assert (seq_result);
+
+	return do_delete_object_result (platform, obj_id, seq_result);
+}
+
 static WaitForNlResponseResult
 do_change_link_request (NMPlatform *platform,
                         int ifindex,
@@ -5312,6 +5848,15 @@ infiniband_partition_delete (NMPlatform *platform, int parent, int p_key)
 
 /*****************************************************************************/
 
+static void
+wifi_station_changed_cb (WifiData *wifi_data, int quality, guint32 rate, gpointer user_data)
+{
+	_nm_platform_wifi_station_changed (user_data,
+	                                   wifi_utils_get_ifindex (wifi_data),
+	                                   quality,
+	                                   rate);
+}
+
 static WifiData *
 wifi_get_wifi_data (NMPlatform *platform, int ifindex)
 {
@@ -5353,8 +5898,10 @@ wifi_get_wifi_data (NMPlatform *platform, int ifindex)
 #endif
 			}
 
-			if (wifi_data)
+			if (wifi_data) {
+				wifi_utils_set_station_func (wifi_data, wifi_station_changed_cb, platform);
 				g_hash_table_insert (priv->wifi_data, GINT_TO_POINTER (ifindex), wifi_data);
+			}
 		}
 	}
 
@@ -5441,6 +5988,13 @@ wifi_indicate_addressing_running (NMPlatform *platform, int ifindex, gboolean ru
 	wifi_utils_indicate_addressing_running (wifi_data, running);
 }
 
+static gboolean
+wifi_request_station (NMPlatform *platform, int ifindex)
+{
+	WIFI_GET_WIFI_DATA_NETNS (wifi_data, platform, ifindex, FALSE);
+	return wifi_utils_request_station (wifi_data);
+}
+
 /*****************************************************************************/
 
 static gboolean
@@ -5720,6 +6274,21 @@ ip6_address_get (NMPlatform *platform, int ifindex, struct in6_addr addr, guint8
 
 /*****************************************************************************/
 
+static NMPCacheId *
+ipx_route_cache_id_init (NMPCacheId *cache_id, NMPObjectType obj_type, int ifindex, NMPlatformGetRouteFlags flags)
+{
+	nm_assert (NM_IN_SET (obj_type, NMP_OBJECT_TYPE_IP4_ROUTE, NMP_OBJECT_TYPE_IP6_ROUTE));
+
+	if (!NM_FLAGS_ANY (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT))
+		flags |= NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT;
+
+	return nmp_cache_id_init_routes_visible (cache_id,
+	                                         obj_type,
+	                                         NM_FLAGS_HAS (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT),
+	                                         NM_FLAGS_HAS (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT),
+	                                         ifindex);
+}
+
 static GArray *
 ipx_route_get_all (NMPlatform *platform, int ifindex, NMPObjectType obj_type, NMPlatformGetRouteFlags flags)
 {
@@ -5731,18 +6300,9 @@ ipx_route_get_all (NMPlatform *platform, int ifindex, NMPObjectType obj_type, NM
 	gboolean with_rtprot_kernel;
 	guint i, len;
 
-	nm_assert (NM_IN_SET (obj_type, NMP_OBJECT_TYPE_IP4_ROUTE, NMP_OBJECT_TYPE_IP6_ROUTE));
-
-	if (!NM_FLAGS_ANY (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT))
-		flags |= NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT;
-
 	klass = nmp_class_from_type (obj_type);
 
-	nmp_cache_id_init_routes_visible (&cache_id,
-	                                  obj_type,
-	                                  NM_FLAGS_HAS (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT),
-	                                  NM_FLAGS_HAS (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT),
-	                                  ifindex);
+	ipx_route_cache_id_init (&cache_id, obj_type, ifindex, flags);
 
 	routes = (const NMPlatformIPRoute *const*) nmp_cache_lookup_multi (priv->cache, &cache_id, &len);
 
@@ -5759,6 +6319,42 @@ ipx_route_get_all (NMPlatform *platform, int ifindex, NMPObjectType obj_type, NM
 	return array;
 }
 
+static gboolean
+_route_match_no_rtprot_kernel (const NMPObject *obj, gpointer user_data)
+{
+	return obj->ipx_route.rx.rt_source != NM_IP_CONFIG_SOURCE_RTPROT_KERNEL;
+}
+
+static GPtrArray *
+lookup_clone (NMPlatform *platform, NMPObjectType obj_type, int ifindex, NMPlatformGetRouteFlags flags)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	NMPCacheId cache_id;
+
+	switch (obj_type) {
+	case NMP_OBJECT_TYPE_LINK:
+		nmp_cache_id_init_object_type (&cache_id, NMP_OBJECT_TYPE_LINK, TRUE);
+		break;
+	case NMP_OBJECT_TYPE_IP4_ADDRESS:
+	case NMP_OBJECT_TYPE_IP6_ADDRESS:
+		nmp_cache_id_init_addrroute_visible_by_ifindex (&cache_id, obj_type, ifindex);
+		break;
+	case NMP_OBJECT_TYPE_IP4_ROUTE:
+	case NMP_OBJECT_TYPE_IP6_ROUTE:
+		ipx_route_cache_id_init (&cache_id, obj_type, ifindex, flags);
+		return nmp_cache_lookup_multi_clone (priv->cache,
+		                                     &cache_id,
+		                                     NM_FLAGS_HAS (flags, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_RTPROT_KERNEL)
+		                                         ? NULL
+		                                         : _route_match_no_rtprot_kernel,
+		                                     NULL);
+	default:
+		g_return_val_if_reached (NULL);
+	}
+
+	return nmp_cache_lookup_multi_clone (priv->cache, &cache_id, NULL, NULL);
+}
+
 static GArray *
 ip4_route_get_all (NMPlatform *platform, int ifindex, NMPlatformGetRouteFlags flags)
 {
@@ -6418,6 +7014,8 @@ nm_linux_platform_init (NMLinuxPlatform *self)
 	priv->delayed_action.list_master_connected = g_ptr_array_new ();
 	priv->delayed_action.list_refresh_link = g_ptr_array_new ();
 	priv->delayed_action.list_wait_for_nl_response = g_array_new (FALSE, TRUE, sizeof (DelayedActionWaitForNlResponseData));
+	priv->batch.starts = g_array_new (FALSE, FALSE, sizeof (guint));
+	priv->batch.requests = g_ptr_array_new_with_free_func (_batch_request_free);
 	priv->wifi_data = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) wifi_utils_deinit);
 
 	if (use_udev)
@@ -6560,6 +7158,9 @@ finalize (GObject *object)
 	g_ptr_array_unref (priv->delayed_action.list_refresh_link);
 	g_array_unref (priv->delayed_action.list_wait_for_nl_response);
 
+	g_array_unref (priv->batch.starts);
+	g_ptr_array_unref (priv->batch.requests);
+
 	g_source_remove (priv->event_id);
 	g_io_channel_unref (priv->event_channel);
 	nl_socket_free (priv->nlh);
@@ -6571,6 +7172,8 @@ finalize (GObject *object)
 		g_hash_table_destroy (priv->sysctl_get_prev_values);
 	}
 
+	g_clear_pointer (&priv->sysctl_ip_conf_dirs, g_hash_table_unref);
+
 	G_OBJECT_CLASS (nm_linux_platform_parent_class)->finalize (object);
 }
 
@@ -6586,6 +7189,9 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 
 	platform_class->sysctl_set = sysctl_set;
 	platform_class->sysctl_get = sysctl_get;
+	platform_class->sysctl_ip_conf_set_multi = sysctl_ip_conf_set_multi;
+	platform_class->sysctl_ip_conf_get = sysctl_ip_conf_get;
+	platform_class->sysctl_ip_conf_invalidate = sysctl_ip_conf_invalidate;
 
 	platform_class->link_get = _nm_platform_link_get;
 	platform_class->link_get_by_ifname = _nm_platform_link_get_by_ifname;
@@ -6649,6 +7255,7 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	platform_class->wifi_set_powersave = wifi_set_powersave;
 	platform_class->wifi_find_frequency = wifi_find_frequency;
 	platform_class->wifi_indicate_addressing_running = wifi_indicate_addressing_running;
+	platform_class->wifi_request_station = wifi_request_station;
 
 	platform_class->mesh_get_channel = mesh_get_channel;
 	platform_class->mesh_set_channel = mesh_set_channel;
@@ -6678,6 +7285,12 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	platform_class->ip4_route_delete = ip4_route_delete;
 	platform_class->ip6_route_delete = ip6_route_delete;
 
+	platform_class->lookup_clone = lookup_clone;
+
+	platform_class->batch_begin = batch_begin;
+	platform_class->batch_get_n_requests = batch_get_n_requests;
+	platform_class->batch_end = batch_end;
+
 	platform_class->check_support_kernel_extended_ifa_flags = check_support_kernel_extended_ifa_flags;
 	platform_class->check_support_user_ipv6ll = check_support_user_ipv6ll;
 
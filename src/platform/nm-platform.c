@@ -353,6 +353,168 @@ nm_platform_sysctl_set_ip6_hop_limit_safe (NMPlatform *self, const char *iface,
 	return TRUE;
 }
 
+static const char *
+_sysctl_ip_conf_path (int addr_family, const char *ifname, const char *property)
+{
+	return addr_family == AF_INET6
+	       ? nm_utils_ip6_property_path (ifname, property)
+	       : nm_utils_ip4_property_path (ifname, property);
+}
+
+/**
+ * nm_platform_sysctl_ip_conf_set_multi:
+ * @self: platform instance
+ * @addr_family: either AF_INET or AF_INET6
+ * @ifname: the interface name
+ * @data: (array length=n_data): the properties to write below
+ *   /proc/sys/net/ipv{4,6}/conf/@ifname/
+ * @n_data: the number of entries in @data
+ * @stats: (allow-none): if given, the number of syscalls and skipped
+ *   writes are added to it.
+ *
+ * Sets several per-interface IP sysctls at once. The platform implementation
+ * may reuse a directory file descriptor for the interface and skip writes
+ * of values that are known to be set already. Hence, only use it for values
+ * that are owned by NetworkManager.
+ *
+ * Returns: %TRUE if all values were set successfully.
+ */
+gboolean
+nm_platform_sysctl_ip_conf_set_multi (NMPlatform *self,
+                                      int addr_family,
+                                      const char *ifname,
+                                      const NMPlatformSysctlIPConfSetData *data,
+                                      guint n_data,
+                                      NMPlatformSysctlStats *stats)
+{
+	NMPlatformSysctlStats stats_dummy;
+	gboolean success = TRUE;
+	guint i;
+
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (NM_IN_SET (addr_family, AF_INET, AF_INET6), FALSE);
+	g_return_val_if_fail (ifname, FALSE);
+	g_return_val_if_fail (data || n_data == 0, FALSE);
+
+	if (n_data == 0)
+		return TRUE;
+
+	if (!stats)
+		stats = &stats_dummy;
+
+	if (klass->sysctl_ip_conf_set_multi)
+		return klass->sysctl_ip_conf_set_multi (self, addr_family, ifname, data, n_data, stats);
+
+	for (i = 0; i < n_data; i++) {
+		if (!nm_platform_sysctl_set (self, NMP_SYSCTL_PATHID_ABSOLUTE (_sysctl_ip_conf_path (addr_family, ifname, data[i].property)), data[i].value))
+			success = FALSE;
+		/* open(), write() and close() */
+		stats->n_syscalls += 3;
+	}
+	return success;
+}
+
+gboolean
+nm_platform_sysctl_ip_conf_set (NMPlatform *self,
+                                int addr_family,
+                                const char *ifname,
+                                const char *property,
+                                const char *value,
+                                NMPlatformSysctlStats *stats)
+{
+	const NMPlatformSysctlIPConfSetData data = {
+		.property = property,
+		.value = value,
+	};
+
+	g_return_val_if_fail (property, FALSE);
+	g_return_val_if_fail (value, FALSE);
+
+	return nm_platform_sysctl_ip_conf_set_multi (self, addr_family, ifname, &data, 1, stats);
+}
+
+/**
+ * nm_platform_sysctl_ip_conf_get:
+ * @self: platform instance
+ * @addr_family: either AF_INET or AF_INET6
+ * @ifname: the interface name
+ * @property: the property below /proc/sys/net/ipv{4,6}/conf/@ifname/
+ * @stats: (allow-none): if given, the number of syscalls is added to it.
+ *
+ * Reads a per-interface IP sysctl. Contrary to nm_platform_sysctl_ip_conf_set_multi(),
+ * this always reads the actual value and updates the values that the platform
+ * implementation might have cached.
+ *
+ * Returns: (transfer full): the value or %NULL on failure.
+ */
+char *
+nm_platform_sysctl_ip_conf_get (NMPlatform *self,
+                                int addr_family,
+                                const char *ifname,
+                                const char *property,
+                                NMPlatformSysctlStats *stats)
+{
+	NMPlatformSysctlStats stats_dummy;
+
+	_CHECK_SELF (self, klass, NULL);
+
+	g_return_val_if_fail (NM_IN_SET (addr_family, AF_INET, AF_INET6), NULL);
+	g_return_val_if_fail (ifname, NULL);
+	g_return_val_if_fail (property, NULL);
+
+	if (!stats)
+		stats = &stats_dummy;
+
+	if (klass->sysctl_ip_conf_get)
+		return klass->sysctl_ip_conf_get (self, addr_family, ifname, property, stats);
+
+	/* open(), read() and close() */
+	stats->n_syscalls += 3;
+	return nm_platform_sysctl_get (self, NMP_SYSCTL_PATHID_ABSOLUTE (_sysctl_ip_conf_path (addr_family, ifname, property)));
+}
+
+gint64
+nm_platform_sysctl_ip_conf_get_int_checked (NMPlatform *self,
+                                            int addr_family,
+                                            const char *ifname,
+                                            const char *property,
+                                            guint base,
+                                            gint64 min,
+                                            gint64 max,
+                                            gint64 fallback,
+                                            NMPlatformSysctlStats *stats)
+{
+	gs_free char *value = NULL;
+
+	value = nm_platform_sysctl_ip_conf_get (self, addr_family, ifname, property, stats);
+	if (!value) {
+		errno = EINVAL;
+		return fallback;
+	}
+	return _nm_utils_ascii_str_to_int64 (value, base, min, max, fallback);
+}
+
+/**
+ * nm_platform_sysctl_ip_conf_invalidate:
+ * @self: platform instance
+ * @ifindex: the interface index
+ *
+ * Forgets the per-interface IP sysctl values that the platform implementation
+ * might have cached for @ifindex, so that the next write is not skipped even
+ * if somebody else changed the value in the meantime.
+ */
+void
+nm_platform_sysctl_ip_conf_invalidate (NMPlatform *self, int ifindex)
+{
+	_CHECK_SELF_VOID (self, klass);
+
+	g_return_if_fail (ifindex > 0);
+
+	if (klass->sysctl_ip_conf_invalidate)
+		klass->sysctl_ip_conf_invalidate (self, ifindex);
+}
+
 /**
  * nm_platform_sysctl_get:
  * @self: platform instance
@@ -2429,6 +2591,36 @@ nm_platform_wifi_indicate_addressing_running (NMPlatform *self, int ifindex, gbo
 	klass->wifi_indicate_addressing_running (self, ifindex, running);
 }
 
+/**
+ * nm_platform_wifi_request_station:
+ * @self: platform instance
+ * @ifindex: Interface index
+ *
+ * Requests the signal quality and bitrate of the current BSS without
+ * blocking. The result is announced with
+ * %NM_PLATFORM_SIGNAL_WIFI_STATION_CHANGED.
+ *
+ * Returns: %FALSE if the platform cannot do this asynchronously. Use
+ *   nm_platform_wifi_get_quality() and nm_platform_wifi_get_rate() then.
+ */
+gboolean
+nm_platform_wifi_request_station (NMPlatform *self, int ifindex)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+
+	if (!klass->wifi_request_station)
+		return FALSE;
+	return klass->wifi_request_station (self, ifindex);
+}
+
+void
+_nm_platform_wifi_station_changed (NMPlatform *self, int ifindex, int quality, guint32 rate)
+{
+	g_signal_emit (self, signals[NM_PLATFORM_SIGNAL_ID_WIFI_STATION], 0, ifindex, quality, (guint) rate);
+}
+
 guint32
 nm_platform_mesh_get_channel (NMPlatform *self, int ifindex)
 {
@@ -2557,6 +2749,47 @@ nm_platform_ip6_address_get_peer (const NMPlatformIP6Address *addr)
 	return &addr->peer_address;
 }
 
+static GPtrArray *
+_lookup_clone (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatformGetRouteFlags flags)
+{
+	const NMPClass *obj_class = nmp_class_from_type (obj_type);
+	gs_unref_array GArray *array = NULL;
+	GPtrArray *result;
+	guint i;
+
+	_CHECK_SELF (self, klass, NULL);
+
+	if (klass->lookup_clone)
+		return klass->lookup_clone (self, obj_type, ifindex, flags);
+
+	/* platform implementations without a cache of #NMPObject instances
+	 * (the fake platform) only provide copies. Wrap them. */
+	switch (obj_type) {
+	case NMP_OBJECT_TYPE_IP4_ADDRESS:
+		array = klass->ip4_address_get_all (self, ifindex);
+		break;
+	case NMP_OBJECT_TYPE_IP6_ADDRESS:
+		array = klass->ip6_address_get_all (self, ifindex);
+		break;
+	case NMP_OBJECT_TYPE_IP4_ROUTE:
+		array = klass->ip4_route_get_all (self, ifindex, flags);
+		break;
+	case NMP_OBJECT_TYPE_IP6_ROUTE:
+		array = klass->ip6_route_get_all (self, ifindex, flags);
+		break;
+	default:
+		g_return_val_if_reached (NULL);
+	}
+
+	result = g_ptr_array_new_full (array->len, (GDestroyNotify) nmp_object_unref);
+	for (i = 0; i < array->len; i++) {
+		g_ptr_array_add (result,
+		                 nmp_object_new (obj_type,
+		                                 (const NMPlatformObject *) &array->data[i * obj_class->sizeof_public]));
+	}
+	return result;
+}
+
 GArray *
 nm_platform_ip4_address_get_all (NMPlatform *self, int ifindex)
 {
@@ -2577,6 +2810,33 @@ nm_platform_ip6_address_get_all (NMPlatform *self, int ifindex)
 	return klass->ip6_address_get_all (self, ifindex);
 }
 
+/**
+ * nm_platform_ip4_address_lookup_clone:
+ * @self: platform instance
+ * @ifindex: Interface index
+ *
+ * Like nm_platform_ip4_address_get_all(), but the addresses are not copied.
+ * The result holds a reference to the #NMPObject instances from the platform
+ * cache, which stay valid until the array is freed.
+ *
+ * Returns: (transfer full): a #GPtrArray of #NMPObject instances.
+ */
+GPtrArray *
+nm_platform_ip4_address_lookup_clone (NMPlatform *self, int ifindex)
+{
+	g_return_val_if_fail (ifindex > 0, NULL);
+
+	return _lookup_clone (self, NMP_OBJECT_TYPE_IP4_ADDRESS, ifindex, NM_PLATFORM_GET_ROUTE_FLAGS_NONE);
+}
+
+GPtrArray *
+nm_platform_ip6_address_lookup_clone (NMPlatform *self, int ifindex)
+{
+	g_return_val_if_fail (ifindex > 0, NULL);
+
+	return _lookup_clone (self, NMP_OBJECT_TYPE_IP6_ADDRESS, ifindex, NM_PLATFORM_GET_ROUTE_FLAGS_NONE);
+}
+
 gboolean
 nm_platform_ip4_address_add (NMPlatform *self,
                              int ifindex,
@@ -2706,48 +2966,200 @@ nm_platform_ip6_address_get (NMPlatform *self, int ifindex, struct in6_addr addr
 	return klass->ip6_address_get (self, ifindex, address, plen);
 }
 
-static const NMPlatformIP4Address *
-array_contains_ip4_address (const GArray *addresses, const NMPlatformIP4Address *address, gint32 now)
+/* When syncing addresses, an address already configured in platform is not
+ * re-added if its remaining lifetimes differ by no more than this many seconds
+ * from the requested ones. */
+#define ADDRESS_SYNC_LIFETIME_TOLERANCE 5
+
+/* The IPv6 address flags that NetworkManager sets and that kernel reports back. */
+#define ADDRESS_SYNC_IP6_FLAGS (IFA_F_NODAD | IFA_F_HOMEADDRESS | IFA_F_MANAGETEMPADDR | IFA_F_NOPREFIXROUTE)
+
+static gboolean
+_address_sync_lifetime_equal (guint32 a, guint32 b)
+{
+	if (   a == NM_PLATFORM_LIFETIME_PERMANENT
+	    || b == NM_PLATFORM_LIFETIME_PERMANENT)
+		return a == b;
+	return (a > b ? a - b : b - a) <= ADDRESS_SYNC_LIFETIME_TOLERANCE;
+}
+
+static gboolean
+_address_sync_lifetimes_unchanged (const NMPlatformIPAddress *plat_address,
+                                   guint32 lifetime,
+                                   guint32 preferred,
+                                   gint32 now)
+{
+	guint32 plat_lifetime, plat_preferred;
+
+	if (!nm_utils_lifetime_get (plat_address->timestamp, plat_address->lifetime, plat_address->preferred,
+	                            now, &plat_lifetime, &plat_preferred))
+		return FALSE;
+
+	return    _address_sync_lifetime_equal (plat_lifetime, lifetime)
+	       && _address_sync_lifetime_equal (plat_preferred, preferred);
+}
+
+static guint
+_ip4_address_sync_id_hash (gconstpointer ptr)
+{
+	const NMPlatformIP4Address *a = ptr;
+	guint h = 1105;
+
+	h = (h * 33) + a->address;
+	h = (h * 33) + a->plen;
+	h = (h * 33) + (a->peer_address & nm_utils_ip4_prefix_to_netmask (a->plen));
+	return h;
+}
+
+static gboolean
+_ip4_address_sync_id_equal (gconstpointer ptr_a, gconstpointer ptr_b)
+{
+	const NMPlatformIP4Address *a = ptr_a;
+	const NMPlatformIP4Address *b = ptr_b;
+
+	return    a->address == b->address
+	       && a->plen == b->plen
+	       && ((a->peer_address ^ b->peer_address) & nm_utils_ip4_prefix_to_netmask (a->plen)) == 0;
+}
+
+static guint
+_ip6_address_sync_id_hash (gconstpointer ptr)
 {
-	guint len = addresses ? addresses->len : 0;
+	const NMPlatformIP6Address *a = ptr;
+	guint h = 1107;
+	guint32 w;
 	guint i;
 
-	for (i = 0; i < len; i++) {
-		const NMPlatformIP4Address *candidate = &g_array_index (addresses, NMPlatformIP4Address, i);
+	for (i = 0; i < 4; i++) {
+		memcpy (&w, &a->address.s6_addr[i * 4], sizeof (w));
+		h = (h * 33) + w;
+	}
+	h = (h * 33) + a->plen;
+	return h;
+}
 
-		if (   candidate->address == address->address
-		    && candidate->plen == address->plen
-		    && ((candidate->peer_address ^ address->peer_address) & nm_utils_ip4_prefix_to_netmask (address->plen)) == 0) {
-			guint32 lifetime, preferred;
+static gboolean
+_ip6_address_sync_id_equal (gconstpointer ptr_a, gconstpointer ptr_b)
+{
+	const NMPlatformIP6Address *a = ptr_a;
+	const NMPlatformIP6Address *b = ptr_b;
 
-			if (nm_utils_lifetime_get (candidate->timestamp, candidate->lifetime, candidate->preferred,
-			                           now, &lifetime, &preferred))
-				return candidate;
-		}
+	return    IN6_ARE_ADDR_EQUAL (&a->address, &b->address)
+	       && a->plen == b->plen;
+}
+
+/* Index the non-expired addresses of @addresses by their ID, so that
+ * platform addresses can be matched without scanning the whole array. As
+ * before, the first non-expired address wins if there are duplicates. */
+static GHashTable *
+_address_sync_build_index (const GArray *addresses, gboolean is_v4, gint32 now)
+{
+	GHashTable *index;
+	guint i;
+
+	if (!addresses || !addresses->len)
+		return NULL;
+
+	index = is_v4
+	        ? g_hash_table_new (_ip4_address_sync_id_hash, _ip4_address_sync_id_equal)
+	        : g_hash_table_new (_ip6_address_sync_id_hash, _ip6_address_sync_id_equal);
+
+	for (i = 0; i < addresses->len; i++) {
+		const NMPlatformIPAddress *candidate;
+		guint32 lifetime, preferred;
+
+		candidate = is_v4
+		            ? (const NMPlatformIPAddress *) &g_array_index (addresses, NMPlatformIP4Address, i)
+		            : (const NMPlatformIPAddress *) &g_array_index (addresses, NMPlatformIP6Address, i);
+
+		if (!nm_utils_lifetime_get (candidate->timestamp, candidate->lifetime, candidate->preferred,
+		                            now, &lifetime, &preferred))
+			continue;
+		if (!g_hash_table_contains (index, candidate))
+			g_hash_table_add (index, (gpointer) candidate);
 	}
 
-	return NULL;
+	return index;
 }
 
 static gboolean
-array_contains_ip6_address (const GArray *addresses, const NMPlatformIP6Address *address, gint32 now)
+_ip4_address_sync_unchanged (const NMPlatformIP4Address *plat_address,
+                             const NMPlatformIP4Address *known_address,
+                             gint32 now)
 {
-	guint len = addresses ? addresses->len : 0;
-	guint i;
+	guint32 lifetime, preferred;
 
-	for (i = 0; i < len; i++) {
-		NMPlatformIP6Address *candidate = &g_array_index (addresses, NMPlatformIP6Address, i);
+	if (plat_address->peer_address != known_address->peer_address)
+		return FALSE;
+	if (strcmp (plat_address->label, known_address->label) != 0)
+		return FALSE;
+	if (!nm_utils_lifetime_get (known_address->timestamp, known_address->lifetime, known_address->preferred,
+	                            now, &lifetime, &preferred))
+		return FALSE;
+	return _address_sync_lifetimes_unchanged ((const NMPlatformIPAddress *) plat_address,
+	                                          lifetime, preferred, now);
+}
 
-		if (IN6_ARE_ADDR_EQUAL (&candidate->address, &address->address) && candidate->plen == address->plen) {
-			guint32 lifetime, preferred;
+static gboolean
+_ip6_address_sync_unchanged (const NMPlatformIP6Address *plat_address,
+                             const NMPlatformIP6Address *known_address,
+                             gint32 now)
+{
+	guint32 lifetime, preferred;
 
-			if (nm_utils_lifetime_get (candidate->timestamp, candidate->lifetime, candidate->preferred,
-			                           now, &lifetime, &preferred))
-				return TRUE;
-		}
+	/* kernel reports the address itself as peer, if there is none. */
+	if (!IN6_ARE_ADDR_EQUAL (nm_platform_ip6_address_get_peer (plat_address),
+	                         nm_platform_ip6_address_get_peer (known_address)))
+		return FALSE;
+	if (   (plat_address->n_ifa_flags & ADDRESS_SYNC_IP6_FLAGS)
+	    != (known_address->n_ifa_flags & ADDRESS_SYNC_IP6_FLAGS))
+		return FALSE;
+	if (!nm_utils_lifetime_get (known_address->timestamp, known_address->lifetime, known_address->preferred,
+	                            now, &lifetime, &preferred))
+		return FALSE;
+	return _address_sync_lifetimes_unchanged ((const NMPlatformIPAddress *) plat_address,
+	                                          lifetime, preferred, now);
+}
+
+typedef struct {
+	/* the index of the first add-request in the batch. */
+	guint first_idx;
+	/* the known addresses for the batched add-requests, by index. */
+	GPtrArray *submitted;
+	/* the known addresses whose add-request failed. */
+	GHashTable *failed;
+} AddressSyncBatchData;
+
+static void
+_address_sync_batch_track (NMPlatform *self,
+                           AddressSyncBatchData *data,
+                           guint n_requests_before,
+                           gconstpointer known_address)
+{
+	if (nm_platform_batch_get_n_requests (self) == n_requests_before) {
+		/* the request completed synchronously. */
+		return;
 	}
 
-	return FALSE;
+	nm_assert (n_requests_before == data->first_idx + data->submitted->len);
+	g_ptr_array_add (data->submitted, (gpointer) known_address);
+}
+
+static void
+_address_sync_batch_result (NMPlatform *self, guint request_idx, gboolean success, gpointer user_data)
+{
+	AddressSyncBatchData *data = user_data;
+
+	/* failures of the delete-requests are ignored, as we don't wait for
+	 * them in the non-batched case either. */
+	if (   success
+	    || request_idx < data->first_idx
+	    || request_idx - data->first_idx >= data->submitted->len)
+		return;
+
+	if (!data->failed)
+		data->failed = g_hash_table_new (NULL, NULL);
+	g_hash_table_add (data->failed, data->submitted->pdata[request_idx - data->first_idx]);
 }
 
 static gboolean
@@ -2841,6 +3253,66 @@ ip4_addr_subnets_is_secondary (const NMPlatformIP4Address *address, GHashTable *
 	return FALSE;
 }
 
+/**
+ * nm_platform_batch_begin:
+ * @self: platform instance
+ *
+ * Opens a batch of requests. Until the matching nm_platform_batch_end(),
+ * adding and deleting addresses and routes may only submit the request to
+ * kernel without waiting for its completion. Such a request returns %TRUE
+ * and increments nm_platform_batch_get_n_requests(); its actual result is
+ * reported by nm_platform_batch_end(). Requests that don't increment the
+ * counter completed synchronously and their return value is final.
+ *
+ * Batches can be nested.
+ */
+void
+nm_platform_batch_begin (NMPlatform *self)
+{
+	_CHECK_SELF_VOID (self, klass);
+
+	if (klass->batch_begin)
+		klass->batch_begin (self);
+}
+
+/**
+ * nm_platform_batch_get_n_requests:
+ * @self: platform instance
+ *
+ * Returns: the number of pending requests in the open batches. The
+ *   next request that gets batched is identified by this index.
+ */
+guint
+nm_platform_batch_get_n_requests (NMPlatform *self)
+{
+	_CHECK_SELF (self, klass, 0);
+
+	if (klass->batch_get_n_requests)
+		return klass->batch_get_n_requests (self);
+	return 0;
+}
+
+/**
+ * nm_platform_batch_end:
+ * @self: platform instance
+ * @result_func: (allow-none): called for each request of the batch
+ * @user_data: user data for @result_func
+ *
+ * Closes the batch opened by the last nm_platform_batch_begin() and waits
+ * once for the completion of all requests submitted in it.
+ *
+ * Returns: %TRUE if all batched requests succeeded.
+ */
+gboolean
+nm_platform_batch_end (NMPlatform *self, NMPlatformBatchResultFunc result_func, gpointer user_data)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	if (klass->batch_end)
+		return klass->batch_end (self, result_func, user_data);
+	return TRUE;
+}
+
 /**
  * nm_platform_ip4_address_sync:
  * @self: platform instance
@@ -2853,7 +3325,9 @@ ip4_addr_subnets_is_secondary (const NMPlatformIP4Address *address, GHashTable *
  *
  * A convenience function to synchronize addresses for a specific interface
  * with the least possible disturbance. It simply removes addresses that are
- * not listed and adds addresses that are.
+ * not listed and adds addresses that are. Addresses that are already
+ * configured with the same parameters (and lifetimes that differ only
+ * slightly) are left alone. All changes are submitted as one batch.
  *
  * Returns: %TRUE on success.
  */
@@ -2866,14 +3340,23 @@ nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known
 	gint32 now = nm_utils_get_monotonic_timestamp_s ();
 	GHashTable *plat_subnets;
 	GHashTable *known_subnets;
+	GHashTable *known_index;
+	GHashTable *unchanged = NULL;
+	GHashTableIter iter;
 	GPtrArray *ptr;
+	AddressSyncBatchData batch_data = { 0 };
+	guint n_skipped = 0;
+	gboolean success = TRUE;
 	int i, j;
 
 	_CHECK_SELF (self, klass, FALSE);
 
+	nm_platform_batch_begin (self);
+
 	addresses = nm_platform_ip4_address_get_all (self, ifindex);
 	plat_subnets = ip4_addr_subnets_build_index (addresses, TRUE);
 	known_subnets = ip4_addr_subnets_build_index (known_addresses, FALSE);
+	known_index = _address_sync_build_index (known_addresses, TRUE, now);
 
 	/* Delete unknown addresses */
 	for (i = 0; i < addresses->len; i++) {
@@ -2884,7 +3367,7 @@ nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known
 			continue;
 		}
 
-		known_address = array_contains_ip4_address (known_addresses, address, now);
+		known_address = known_index ? g_hash_table_lookup (known_index, address) : NULL;
 		if (known_address) {
 			gboolean secondary;
 
@@ -2895,7 +3378,13 @@ nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known
 				known_address = NULL;
 		}
 
-		if (!known_address) {
+		if (known_address) {
+			if (_ip4_address_sync_unchanged (address, known_address, now)) {
+				if (!unchanged)
+					unchanged = g_hash_table_new (NULL, NULL);
+				g_hash_table_insert (unchanged, (gpointer) known_address, address);
+			}
+		} else {
 			nm_platform_ip4_address_delete (self, ifindex,
 			                                address->address,
 			                                address->plen,
@@ -2919,16 +3408,34 @@ nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known
 			}
 		}
 	}
+
+	if (unchanged) {
+		/* secondary addresses that were deleted together with their primary
+		 * must be added again. */
+		g_hash_table_iter_init (&iter, unchanged);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &address)) {
+			if (!address->ifindex)
+				g_hash_table_iter_remove (&iter);
+		}
+	}
+
 	ip4_addr_subnets_destroy_index (plat_subnets, addresses);
 	g_array_free (addresses, TRUE);
+	if (known_index)
+		g_hash_table_unref (known_index);
 
 	if (out_added_addresses)
 		*out_added_addresses = NULL;
 
-	if (!known_addresses)
+	if (!known_addresses) {
+		nm_assert (!unchanged);
+		nm_platform_batch_end (self, NULL, NULL);
 		return TRUE;
+	}
 
 	/* Add missing addresses */
+	batch_data.first_idx = nm_platform_batch_get_n_requests (self);
+	batch_data.submitted = g_ptr_array_new ();
 	for (i = 0; i < known_addresses->len; i++) {
 		guint32 lifetime, preferred;
 
@@ -2938,11 +3445,21 @@ nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known
 		                            now, &lifetime, &preferred))
 			continue;
 
-		if (!nm_platform_ip4_address_add (self, ifindex, known_address->address, known_address->plen,
-		                                  known_address->peer_address, lifetime, preferred,
-		                                  0, known_address->label)) {
-			ip4_addr_subnets_destroy_index (known_subnets, known_addresses);
-			return FALSE;
+		if (unchanged && g_hash_table_contains (unchanged, known_address))
+			n_skipped++;
+		else {
+			guint n_requests = nm_platform_batch_get_n_requests (self);
+
+			if (!nm_platform_ip4_address_add (self, ifindex, known_address->address, known_address->plen,
+			                                  known_address->peer_address, lifetime, preferred,
+			                                  0, known_address->label)) {
+				/* like before batching, stop at the first failure. Requests
+				 * that were already batched can only fail once the batch
+				 * ends, and don't stop the following ones. */
+				success = FALSE;
+				break;
+			}
+			_address_sync_batch_track (self, &batch_data, n_requests, known_address);
 		}
 
 		if (out_added_addresses) {
@@ -2952,9 +3469,28 @@ nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known
 		}
 	}
 
+	nm_platform_batch_end (self, _address_sync_batch_result, &batch_data);
+
+	if (batch_data.failed) {
+		success = FALSE;
+		if (out_added_addresses && *out_added_addresses) {
+			for (i = (*out_added_addresses)->len - 1; i >= 0; i--) {
+				if (g_hash_table_contains (batch_data.failed, (*out_added_addresses)->pdata[i]))
+					g_ptr_array_remove_index (*out_added_addresses, i);
+			}
+		}
+		g_hash_table_unref (batch_data.failed);
+	}
+	g_ptr_array_unref (batch_data.submitted);
+
+	if (n_skipped)
+		_LOGD ("address: sync: %u IPv4 addresses on ifindex %d already up to date", n_skipped, ifindex);
+
 	ip4_addr_subnets_destroy_index (known_subnets, known_addresses);
+	if (unchanged)
+		g_hash_table_unref (unchanged);
 
-	return TRUE;
+	return success;
 }
 
 /**
@@ -2966,51 +3502,101 @@ nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known
  *
  * A convenience function to synchronize addresses for a specific interface
  * with the least possible disturbance. It simply removes addresses that are
- * not listed and adds addresses that are.
+ * not listed and adds addresses that are. Addresses that are already
+ * configured with the same parameters (and lifetimes that differ only
+ * slightly) are left alone. All changes are submitted as one batch.
  *
  * Returns: %TRUE on success.
  */
 gboolean
 nm_platform_ip6_address_sync (NMPlatform *self, int ifindex, const GArray *known_addresses, gboolean keep_link_local)
 {
-	GArray *addresses;
-	NMPlatformIP6Address *address;
+	GPtrArray *addresses;
+	const NMPlatformIP6Address *address;
+	const NMPlatformIP6Address *known_address;
 	gint32 now = nm_utils_get_monotonic_timestamp_s ();
+	GHashTable *known_index;
+	GHashTable *unchanged = NULL;
+	AddressSyncBatchData batch_data = { 0 };
+	guint n_skipped = 0;
+	gboolean success = TRUE;
 	int i;
 
+	_CHECK_SELF (self, klass, FALSE);
+
+	nm_platform_batch_begin (self);
+
+	known_index = _address_sync_build_index (known_addresses, FALSE, now);
+
 	/* Delete unknown addresses */
-	addresses = nm_platform_ip6_address_get_all (self, ifindex);
+	addresses = nm_platform_ip6_address_lookup_clone (self, ifindex);
 	for (i = 0; i < addresses->len; i++) {
-		address = &g_array_index (addresses, NMPlatformIP6Address, i);
+		address = &((const NMPObject *) addresses->pdata[i])->ip6_address;
 
 		/* Leave link local address management to the kernel */
 		if (keep_link_local && IN6_IS_ADDR_LINKLOCAL (&address->address))
 			continue;
 
-		if (!array_contains_ip6_address (known_addresses, address, now))
+		known_address = known_index ? g_hash_table_lookup (known_index, address) : NULL;
+		if (!known_address)
 			nm_platform_ip6_address_delete (self, ifindex, address->address, address->plen);
+		else if (_ip6_address_sync_unchanged (address, known_address, now)) {
+			if (!unchanged)
+				unchanged = g_hash_table_new (NULL, NULL);
+			g_hash_table_add (unchanged, (gpointer) known_address);
+		}
 	}
-	g_array_free (addresses, TRUE);
+	g_ptr_array_unref (addresses);
+	if (known_index)
+		g_hash_table_unref (known_index);
 
-	if (!known_addresses)
+	if (!known_addresses) {
+		nm_platform_batch_end (self, NULL, NULL);
 		return TRUE;
+	}
 
 	/* Add missing addresses */
+	batch_data.first_idx = nm_platform_batch_get_n_requests (self);
+	batch_data.submitted = g_ptr_array_new ();
 	for (i = 0; i < known_addresses->len; i++) {
-		const NMPlatformIP6Address *known_address = &g_array_index (known_addresses, NMPlatformIP6Address, i);
 		guint32 lifetime, preferred;
+		guint n_requests;
+
+		known_address = &g_array_index (known_addresses, NMPlatformIP6Address, i);
 
 		if (!nm_utils_lifetime_get (known_address->timestamp, known_address->lifetime, known_address->preferred,
 		                            now, &lifetime, &preferred))
 			continue;
 
+		if (unchanged && g_hash_table_contains (unchanged, known_address)) {
+			n_skipped++;
+			continue;
+		}
+
+		n_requests = nm_platform_batch_get_n_requests (self);
 		if (!nm_platform_ip6_address_add (self, ifindex, known_address->address,
 		                                  known_address->plen, known_address->peer_address,
-		                                  lifetime, preferred, known_address->n_ifa_flags))
-			return FALSE;
+		                                  lifetime, preferred, known_address->n_ifa_flags)) {
+			success = FALSE;
+			break;
+		}
+		_address_sync_batch_track (self, &batch_data, n_requests, known_address);
 	}
 
-	return TRUE;
+	nm_platform_batch_end (self, _address_sync_batch_result, &batch_data);
+
+	if (batch_data.failed) {
+		success = FALSE;
+		g_hash_table_unref (batch_data.failed);
+	}
+	g_ptr_array_unref (batch_data.submitted);
+
+	if (n_skipped)
+		_LOGD ("address: sync: %u IPv6 addresses on ifindex %d already up to date", n_skipped, ifindex);
+
+	if (unchanged)
+		g_hash_table_unref (unchanged);
+	return success;
 }
 
 gboolean
@@ -3044,6 +3630,33 @@ nm_platform_ip6_route_get_all (NMPlatform *self, int ifindex, NMPlatformGetRoute
 	return klass->ip6_route_get_all (self, ifindex, flags);
 }
 
+/**
+ * nm_platform_ip4_route_lookup_clone:
+ * @self: platform instance
+ * @ifindex: Interface index
+ * @flags: which routes to return
+ *
+ * Like nm_platform_ip4_route_get_all(), but without copying the routes.
+ * See nm_platform_ip4_address_lookup_clone().
+ *
+ * Returns: (transfer full): a #GPtrArray of #NMPObject instances.
+ */
+GPtrArray *
+nm_platform_ip4_route_lookup_clone (NMPlatform *self, int ifindex, NMPlatformGetRouteFlags flags)
+{
+	g_return_val_if_fail (ifindex >= 0, NULL);
+
+	return _lookup_clone (self, NMP_OBJECT_TYPE_IP4_ROUTE, ifindex, flags);
+}
+
+GPtrArray *
+nm_platform_ip6_route_lookup_clone (NMPlatform *self, int ifindex, NMPlatformGetRouteFlags flags)
+{
+	g_return_val_if_fail (ifindex >= 0, NULL);
+
+	return _lookup_clone (self, NMP_OBJECT_TYPE_IP6_ROUTE, ifindex, flags);
+}
+
 /**
  * nm_platform_ip4_route_add:
  * @self:
@@ -4368,6 +4981,7 @@ const NMPlatformVTableRoute nm_platform_vtable_route_v4 = {
 	.route_cmp                      = (int (*) (const NMPlatformIPXRoute *a, const NMPlatformIPXRoute *b)) nm_platform_ip4_route_cmp,
 	.route_to_string                = (const char *(*) (const NMPlatformIPXRoute *route, char *buf, gsize len)) nm_platform_ip4_route_to_string,
 	.route_get_all                  = nm_platform_ip4_route_get_all,
+	.route_lookup_clone             = nm_platform_ip4_route_lookup_clone,
 	.route_add                      = _vtr_v4_route_add,
 	.route_delete                   = _vtr_v4_route_delete,
 	.route_delete_default           = _vtr_v4_route_delete_default,
@@ -4381,6 +4995,7 @@ const NMPlatformVTableRoute nm_platform_vtable_route_v6 = {
 	.route_cmp                      = (int (*) (const NMPlatformIPXRoute *a, const NMPlatformIPXRoute *b)) nm_platform_ip6_route_cmp,
 	.route_to_string                = (const char *(*) (const NMPlatformIPXRoute *route, char *buf, gsize len)) nm_platform_ip6_route_to_string,
 	.route_get_all                  = nm_platform_ip6_route_get_all,
+	.route_lookup_clone             = nm_platform_ip6_route_lookup_clone,
 	.route_add                      = _vtr_v6_route_add,
 	.route_delete                   = _vtr_v6_route_delete,
 	.route_delete_default           = _vtr_v6_route_delete_default,
@@ -4494,4 +5109,15 @@ nm_platform_class_init (NMPlatformClass *platform_class)
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_IP6_ADDRESS, NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED, log_ip6_address);
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_IP4_ROUTE,   NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED,   log_ip4_route);
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_IP6_ROUTE,   NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED,   log_ip6_route);
+
+	signals[NM_PLATFORM_SIGNAL_ID_WIFI_STATION] =
+	    g_signal_new (NM_PLATFORM_SIGNAL_WIFI_STATION_CHANGED,
+	                  G_OBJECT_CLASS_TYPE (object_class),
+	                  G_SIGNAL_RUN_FIRST,
+	                  0,
+	                  NULL, NULL, NULL,
+	                  G_TYPE_NONE, 3,
+	                  G_TYPE_INT,  /* ifindex */
+	                  G_TYPE_INT,  /* quality */
+	                  G_TYPE_UINT  /* rate */);
 }
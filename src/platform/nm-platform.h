@@ -176,6 +176,7 @@ typedef enum { /*< skip >*/
 	NM_PLATFORM_SIGNAL_ID_IP6_ADDRESS,
 	NM_PLATFORM_SIGNAL_ID_IP4_ROUTE,
 	NM_PLATFORM_SIGNAL_ID_IP6_ROUTE,
+	NM_PLATFORM_SIGNAL_ID_WIFI_STATION,
 	_NM_PLATFORM_SIGNAL_ID_LAST,
 } NMPlatformSignalIdType;
 
@@ -379,6 +380,7 @@ typedef struct {
 	int (*route_cmp) (const NMPlatformIPXRoute *a, const NMPlatformIPXRoute *b);
 	const char *(*route_to_string) (const NMPlatformIPXRoute *route, char *buf, gsize len);
 	GArray *(*route_get_all) (NMPlatform *self, int ifindex, NMPlatformGetRouteFlags flags);
+	GPtrArray *(*route_lookup_clone) (NMPlatform *self, int ifindex, NMPlatformGetRouteFlags flags);
 	gboolean (*route_add) (NMPlatform *self, int ifindex, const NMPlatformIPXRoute *route, gint64 metric);
 	gboolean (*route_delete) (NMPlatform *self, int ifindex, const NMPlatformIPXRoute *route);
 	gboolean (*route_delete_default) (NMPlatform *self, int ifindex, guint32 metric);
@@ -487,8 +489,34 @@ typedef enum {
 	NM_PLATFORM_LINK_DUPLEX_FULL,
 } NMPlatformLinkDuplexType;
 
+typedef struct {
+	const char *property;
+	const char *value;
+} NMPlatformSysctlIPConfSetData;
+
+typedef struct {
+	/* the number of syscalls issued to access sysctl files. */
+	guint n_syscalls;
+
+	/* the number of writes that were skipped, because the
+	 * value was known to be set already. */
+	guint n_skipped;
+} NMPlatformSysctlStats;
+
 /*****************************************************************************/
 
+/**
+ * NMPlatformBatchResultFunc:
+ * @self: the platform instance
+ * @request_idx: the index of the request, as returned by
+ *   nm_platform_batch_get_n_requests() right before submitting it.
+ * @success: whether the request succeeded
+ * @user_data: user data
+ *
+ * Reports the result of a request that was submitted in a batch.
+ */
+typedef void (*NMPlatformBatchResultFunc) (NMPlatform *self, guint request_idx, gboolean success, gpointer user_data);
+
 struct _NMPlatformPrivate;
 
 struct _NMPlatform {
@@ -502,6 +530,18 @@ typedef struct {
 
 	gboolean (*sysctl_set) (NMPlatform *, const char *pathid, int dirfd, const char *path, const char *value);
 	char * (*sysctl_get) (NMPlatform *, const char *pathid, int dirfd, const char *path);
+	gboolean (*sysctl_ip_conf_set_multi) (NMPlatform *,
+	                                      int addr_family,
+	                                      const char *ifname,
+	                                      const NMPlatformSysctlIPConfSetData *data,
+	                                      guint n_data,
+	                                      NMPlatformSysctlStats *stats);
+	char * (*sysctl_ip_conf_get) (NMPlatform *,
+	                              int addr_family,
+	                              const char *ifname,
+	                              const char *property,
+	                              NMPlatformSysctlStats *stats);
+	void (*sysctl_ip_conf_invalidate) (NMPlatform *, int ifindex);
 
 	const NMPlatformLink *(*link_get) (NMPlatform *platform, int ifindex);
 	const NMPlatformLink *(*link_get_by_ifname) (NMPlatform *platform, const char *ifname);
@@ -615,6 +655,7 @@ typedef struct {
 	void        (*wifi_set_powersave)    (NMPlatform *, int ifindex, guint32 powersave);
 	guint32     (*wifi_find_frequency)   (NMPlatform *, int ifindex, const guint32 *freqs);
 	void        (*wifi_indicate_addressing_running) (NMPlatform *, int ifindex, gboolean running);
+	gboolean    (*wifi_request_station) (NMPlatform *, int ifindex);
 
 	guint32     (*mesh_get_channel)      (NMPlatform *, int ifindex);
 	gboolean    (*mesh_set_channel)      (NMPlatform *, int ifindex, guint32 channel);
@@ -646,6 +687,7 @@ typedef struct {
 
 	GArray * (*ip4_route_get_all) (NMPlatform *, int ifindex, NMPlatformGetRouteFlags flags);
 	GArray * (*ip6_route_get_all) (NMPlatform *, int ifindex, NMPlatformGetRouteFlags flags);
+	GPtrArray *(*lookup_clone) (NMPlatform *, NMPObjectType obj_type, int ifindex, NMPlatformGetRouteFlags flags);
 	gboolean (*ip4_route_add) (NMPlatform *, int ifindex, NMIPConfigSource source,
 	                           in_addr_t network, guint8 plen, in_addr_t gateway,
 	                           in_addr_t pref_src, guint32 metric, guint32 mss);
@@ -657,6 +699,10 @@ typedef struct {
 	const NMPlatformIP4Route *(*ip4_route_get) (NMPlatform *, int ifindex, in_addr_t network, guint8 plen, guint32 metric);
 	const NMPlatformIP6Route *(*ip6_route_get) (NMPlatform *, int ifindex, struct in6_addr network, guint8 plen, guint32 metric);
 
+	void     (*batch_begin) (NMPlatform *);
+	guint    (*batch_get_n_requests) (NMPlatform *);
+	gboolean (*batch_end) (NMPlatform *, NMPlatformBatchResultFunc result_func, gpointer user_data);
+
 	gboolean (*check_support_kernel_extended_ifa_flags) (NMPlatform *);
 	gboolean (*check_support_user_ipv6ll) (NMPlatform *);
 } NMPlatformClass;
@@ -678,6 +724,11 @@ typedef struct {
 #define NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED "ip4-route-changed"
 #define NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED "ip6-route-changed"
 
+/* Emitted with the result of nm_platform_wifi_request_station() and when
+ * the driver reports a change of the current BSS or its signal strength.
+ * Arguments are (int ifindex, int quality, guint32 rate). */
+#define NM_PLATFORM_SIGNAL_WIFI_STATION_CHANGED "wifi-station-changed"
+
 const char *nm_platform_signal_change_type_to_string (NMPlatformSignalChangeType change_type);
 
 /*****************************************************************************/
@@ -738,6 +789,34 @@ gint64 nm_platform_sysctl_get_int_checked (NMPlatform *self, const char *pathid,
 
 gboolean nm_platform_sysctl_set_ip6_hop_limit_safe (NMPlatform *self, const char *iface, int value);
 
+gboolean nm_platform_sysctl_ip_conf_set_multi (NMPlatform *self,
+                                               int addr_family,
+                                               const char *ifname,
+                                               const NMPlatformSysctlIPConfSetData *data,
+                                               guint n_data,
+                                               NMPlatformSysctlStats *stats);
+gboolean nm_platform_sysctl_ip_conf_set (NMPlatform *self,
+                                         int addr_family,
+                                         const char *ifname,
+                                         const char *property,
+                                         const char *value,
+                                         NMPlatformSysctlStats *stats);
+char *nm_platform_sysctl_ip_conf_get (NMPlatform *self,
+                                      int addr_family,
+                                      const char *ifname,
+                                      const char *property,
+                                      NMPlatformSysctlStats *stats);
+gint64 nm_platform_sysctl_ip_conf_get_int_checked (NMPlatform *self,
+                                                   int addr_family,
+                                                   const char *ifname,
+                                                   const char *property,
+                                                   guint base,
+                                                   gint64 min,
+                                                   gint64 max,
+                                                   gint64 fallback,
+                                                   NMPlatformSysctlStats *stats);
+void nm_platform_sysctl_ip_conf_invalidate (NMPlatform *self, int ifindex);
+
 const NMPlatformLink *nm_platform_link_get (NMPlatform *self, int ifindex);
 const NMPlatformLink *nm_platform_link_get_by_ifname (NMPlatform *self, const char *ifname);
 const NMPlatformLink *nm_platform_link_get_by_address (NMPlatform *self, gconstpointer address, size_t length);
@@ -877,6 +956,8 @@ void        nm_platform_wifi_set_mode         (NMPlatform *self, int ifindex, NM
 void        nm_platform_wifi_set_powersave    (NMPlatform *self, int ifindex, guint32 powersave);
 guint32     nm_platform_wifi_find_frequency   (NMPlatform *self, int ifindex, const guint32 *freqs);
 void        nm_platform_wifi_indicate_addressing_running (NMPlatform *self, int ifindex, gboolean running);
+gboolean    nm_platform_wifi_request_station  (NMPlatform *self, int ifindex);
+void        _nm_platform_wifi_station_changed (NMPlatform *self, int ifindex, int quality, guint32 rate);
 
 guint32     nm_platform_mesh_get_channel      (NMPlatform *self, int ifindex);
 gboolean    nm_platform_mesh_set_channel      (NMPlatform *self, int ifindex, guint32 channel);
@@ -912,6 +993,8 @@ NMPlatformError nm_platform_link_sit_add (NMPlatform *self,
 const NMPlatformIP6Address *nm_platform_ip6_address_get (NMPlatform *self, int ifindex, struct in6_addr address, guint8 plen);
 GArray *nm_platform_ip4_address_get_all (NMPlatform *self, int ifindex);
 GArray *nm_platform_ip6_address_get_all (NMPlatform *self, int ifindex);
+GPtrArray *nm_platform_ip4_address_lookup_clone (NMPlatform *self, int ifindex);
+GPtrArray *nm_platform_ip6_address_lookup_clone (NMPlatform *self, int ifindex);
 gboolean nm_platform_ip4_address_add (NMPlatform *self,
                                       int ifindex,
                                       in_addr_t address,
@@ -931,6 +1014,10 @@ gboolean nm_platform_ip6_address_add (NMPlatform *self,
                                       guint32 flags);
 gboolean nm_platform_ip4_address_delete (NMPlatform *self, int ifindex, in_addr_t address, guint8 plen, in_addr_t peer_address);
 gboolean nm_platform_ip6_address_delete (NMPlatform *self, int ifindex, struct in6_addr address, guint8 plen);
+void nm_platform_batch_begin (NMPlatform *self);
+guint nm_platform_batch_get_n_requests (NMPlatform *self);
+gboolean nm_platform_batch_end (NMPlatform *self, NMPlatformBatchResultFunc result_func, gpointer user_data);
+
 gboolean nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known_addresses, GPtrArray **out_added_addresses);
 gboolean nm_platform_ip6_address_sync (NMPlatform *self, int ifindex, const GArray *known_addresses, gboolean keep_link_local);
 gboolean nm_platform_address_flush (NMPlatform *self, int ifindex);
@@ -939,6 +1026,8 @@ const NMPlatformIP4Route *nm_platform_ip4_route_get (NMPlatform *self, int ifind
 const NMPlatformIP6Route *nm_platform_ip6_route_get (NMPlatform *self, int ifindex, struct in6_addr network, guint8 plen, guint32 metric);
 GArray *nm_platform_ip4_route_get_all (NMPlatform *self, int ifindex, NMPlatformGetRouteFlags flags);
 GArray *nm_platform_ip6_route_get_all (NMPlatform *self, int ifindex, NMPlatformGetRouteFlags flags);
+GPtrArray *nm_platform_ip4_route_lookup_clone (NMPlatform *self, int ifindex, NMPlatformGetRouteFlags flags);
+GPtrArray *nm_platform_ip6_route_lookup_clone (NMPlatform *self, int ifindex, NMPlatformGetRouteFlags flags);
 gboolean nm_platform_ip4_route_add (NMPlatform *self, int ifindex, NMIPConfigSource source,
                                     in_addr_t network, guint8 plen, in_addr_t gateway,
                                     in_addr_t pref_src, guint32 metric, guint32 mss);
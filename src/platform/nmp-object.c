@@ -1445,6 +1445,41 @@ nmp_cache_lookup_multi_to_array (const NMPCache *cache, NMPObjectType obj_type,
 	return array;
 }
 
+/**
+ * nmp_cache_lookup_multi_clone:
+ * @cache: the platform cache
+ * @cache_id: the id of the objects to look up
+ * @match_fn: (allow-none): only return objects for which @match_fn returns %TRUE
+ * @user_data: user data for @match_fn
+ *
+ * Contrary to nmp_cache_lookup_multi_to_array(), the objects are not copied.
+ * Instead, the returned array holds a reference to each cached #NMPObject,
+ * so that they stay alive when they are removed from the cache later on.
+ *
+ * Returns: (transfer full): a #GPtrArray of #NMPObject instances which
+ *   unrefs the objects when being freed. Never %NULL.
+ */
+GPtrArray *
+nmp_cache_lookup_multi_clone (const NMPCache *cache, const NMPCacheId *cache_id, NMPObjectMatchFn match_fn, gpointer user_data)
+{
+	guint len, i;
+	const NMPlatformObject *const *objects;
+	GPtrArray *array;
+
+	objects = nmp_cache_lookup_multi (cache, cache_id, &len);
+	array = g_ptr_array_new_full (len, (GDestroyNotify) nmp_object_unref);
+
+	for (i = 0; i < len; i++) {
+		NMPObject *obj = NMP_OBJECT_UP_CAST (objects[i]);
+
+		if (   match_fn
+		    && !match_fn (obj, user_data))
+			continue;
+		g_ptr_array_add (array, nmp_object_ref (obj));
+	}
+	return array;
+}
+
 const NMPObject *
 nmp_cache_lookup_obj (const NMPCache *cache, const NMPObject *obj)
 {
@@ -410,6 +410,7 @@ NMPCacheId *nmp_cache_id_init_routes_by_destination_ip6 (NMPCacheId *id, const s
 
 const NMPlatformObject *const *nmp_cache_lookup_multi (const NMPCache *cache, const NMPCacheId *cache_id, guint *out_len);
 GArray *nmp_cache_lookup_multi_to_array (const NMPCache *cache, NMPObjectType obj_type, const NMPCacheId *cache_id);
+GPtrArray *nmp_cache_lookup_multi_clone (const NMPCache *cache, const NMPCacheId *cache_id, NMPObjectMatchFn match_fn, gpointer user_data);
 const NMPObject *nmp_cache_lookup_obj (const NMPCache *cache, const NMPObject *obj);
 const NMPObject *nmp_cache_lookup_link (const NMPCache *cache, int ifindex);
 
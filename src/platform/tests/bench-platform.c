@@ -0,0 +1,373 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+/* Benchmark the platform layer on top of NMFakePlatform.
+ *
+ * Every scenario records the latency of each operation and prints
+ * the throughput together with the latency percentiles. Run it with
+ * for example "--count 10000 --count 100000 --count 1000000". */
+
+#include "nm-default.h"
+
+#include <stdlib.h>
+#include <linux/rtnetlink.h>
+
+#include "platform/nm-fake-platform.h"
+#include "platform/nmp-object.h"
+#include "nm-core-utils.h"
+#include "nm-route-manager.h"
+
+#include "nm-test-utils-core.h"
+
+NMTST_DEFINE ();
+
+static struct {
+	char **counts;
+	int iterations;
+} global_opt = {
+	.iterations = 5,
+};
+
+/*****************************************************************************/
+
+typedef struct {
+	const char *name;
+	GArray *samples;
+	guint64 n_objects;
+} Stats;
+
+static void
+stats_init (Stats *stats, const char *name, guint reserve)
+{
+	stats->name = name;
+	stats->samples = g_array_sized_new (FALSE, FALSE, sizeof (gint64), reserve);
+	stats->n_objects = 0;
+}
+
+static void
+stats_add (Stats *stats, gint64 start_ns, guint n_objects)
+{
+	gint64 duration = nm_utils_get_monotonic_timestamp_ns () - start_ns;
+
+	g_array_append_val (stats->samples, duration);
+	stats->n_objects += n_objects;
+}
+
+static int
+_cmp_gint64 (gconstpointer a, gconstpointer b)
+{
+	gint64 x = *((const gint64 *) a);
+	gint64 y = *((const gint64 *) b);
+
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static double
+_percentile_us (const GArray *sorted, guint percent)
+{
+	guint idx;
+
+	idx = ((guint64) (sorted->len - 1) * percent) / 100;
+	return g_array_index (sorted, gint64, idx) / 1000.0;
+}
+
+static void
+stats_print_and_clear (Stats *stats, guint count)
+{
+	gint64 total = 0;
+	guint i;
+
+	if (stats->samples->len > 0) {
+		for (i = 0; i < stats->samples->len; i++)
+			total += g_array_index (stats->samples, gint64, i);
+		g_array_sort (stats->samples, _cmp_gint64);
+
+		g_print ("%-18s %8u %8u ops %10.1f obj/s  p50 %9.2fus  p90 %9.2fus  p99 %9.2fus  max %9.2fus\n",
+		         stats->name,
+		         count,
+		         stats->samples->len,
+		         total > 0 ? (double) stats->n_objects * NM_UTILS_NS_PER_SECOND / total : 0.0,
+		         _percentile_us (stats->samples, 50),
+		         _percentile_us (stats->samples, 90),
+		         _percentile_us (stats->samples, 99),
+		         g_array_index (stats->samples, gint64, stats->samples->len - 1) / 1000.0);
+	}
+	g_array_unref (stats->samples);
+	stats->samples = NULL;
+}
+
+/*****************************************************************************/
+
+static in_addr_t
+_ip4_nth (guint n)
+{
+	/* 10.0.0.0/8 has room for any count we care about. */
+	return htonl ((10u << 24) | (n & 0xFFFFFF));
+}
+
+static void
+bench_cache_update (guint count)
+{
+	NMPCache *cache;
+	NMPlatformIP4Route route;
+	Stats stats;
+	guint i, pass;
+
+	cache = nmp_cache_new (FALSE);
+
+	for (pass = 0; pass < 2; pass++) {
+		stats_init (&stats, pass == 0 ? "cache-add" : "cache-update", count);
+		for (i = 0; i < count; i++) {
+			nm_auto_nmpobj NMPObject *obj = NULL;
+			gint64 start;
+
+			memset (&route, 0, sizeof (route));
+			route.ifindex = 1 + (i % 64);
+			route.network = _ip4_nth (i);
+			route.plen = 32;
+			route.metric = 100;
+			route.mss = pass;
+			route.rt_source = NM_IP_CONFIG_SOURCE_RTPROT_STATIC;
+			obj = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, (const NMPlatformObject *) &route);
+
+			start = nm_utils_get_monotonic_timestamp_ns ();
+			nmp_cache_update_netlink (cache, obj, NULL, NULL, NULL, NULL);
+			stats_add (&stats, start, 1);
+		}
+		stats_print_and_clear (&stats, count);
+	}
+
+	nmp_cache_free (cache);
+}
+
+static void
+bench_address (int ifindex, guint count)
+{
+	gs_unref_array GArray *known_full = NULL;
+	gs_unref_array GArray *known_half = NULL;
+	gs_unref_array GArray *empty = NULL;
+	Stats stats;
+	guint i;
+	int iter;
+
+	empty = g_array_new (FALSE, TRUE, sizeof (NMPlatformIP4Address));
+	known_full = g_array_sized_new (FALSE, TRUE, sizeof (NMPlatformIP4Address), count);
+	known_half = g_array_sized_new (FALSE, TRUE, sizeof (NMPlatformIP4Address), count / 2 + 1);
+	for (i = 0; i < count; i++) {
+		NMPlatformIP4Address a = {
+			.ifindex = ifindex,
+			.address = _ip4_nth (i),
+			.peer_address = _ip4_nth (i),
+			.plen = 32,
+			.timestamp = nm_utils_get_monotonic_timestamp_s (),
+			.lifetime = NM_PLATFORM_LIFETIME_PERMANENT,
+			.preferred = NM_PLATFORM_LIFETIME_PERMANENT,
+		};
+
+		g_array_append_val (known_full, a);
+		if (i % 2 == 0)
+			g_array_append_val (known_half, a);
+	}
+
+	stats_init (&stats, "address-add", count);
+	for (i = 0; i < count; i++) {
+		const NMPlatformIP4Address *a = &g_array_index (known_full, NMPlatformIP4Address, i);
+		gint64 start = nm_utils_get_monotonic_timestamp_ns ();
+
+		nm_platform_ip4_address_add (NM_PLATFORM_GET, ifindex, a->address, a->plen, a->peer_address,
+		                             a->lifetime, a->preferred, 0, NULL);
+		stats_add (&stats, start, 1);
+	}
+	stats_print_and_clear (&stats, count);
+
+	/* Each sync either drops or restores every other address. */
+	stats_init (&stats, "address-sync", 2 * global_opt.iterations);
+	for (iter = 0; iter < global_opt.iterations; iter++) {
+		gint64 start;
+
+		start = nm_utils_get_monotonic_timestamp_ns ();
+		nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, known_half, NULL);
+		stats_add (&stats, start, count - known_half->len);
+
+		start = nm_utils_get_monotonic_timestamp_ns ();
+		nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, known_full, NULL);
+		stats_add (&stats, start, count - known_half->len);
+	}
+	stats_print_and_clear (&stats, count);
+
+	nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, empty, NULL);
+}
+
+static void
+bench_route (int ifindex, guint count)
+{
+	gs_unref_object NMRouteManager *route_manager = NULL;
+	gs_unref_array GArray *known_full = NULL;
+	gs_unref_array GArray *known_half = NULL;
+	gs_unref_array GArray *empty = NULL;
+	Stats stats;
+	guint i;
+	int iter;
+
+	route_manager = nm_route_manager_new (NM_PLATFORM_GET);
+
+	known_full = g_array_sized_new (FALSE, TRUE, sizeof (NMPlatformIP4Route), count);
+	known_half = g_array_sized_new (FALSE, TRUE, sizeof (NMPlatformIP4Route), count / 2 + 1);
+	empty = g_array_new (FALSE, TRUE, sizeof (NMPlatformIP4Route));
+	for (i = 0; i < count; i++) {
+		NMPlatformIP4Route r = {
+			.ifindex = ifindex,
+			.rt_source = NM_IP_CONFIG_SOURCE_USER,
+			.network = _ip4_nth (i),
+			.plen = 32,
+			.metric = 100,
+		};
+
+		g_array_append_val (known_full, r);
+		if (i % 2 == 0)
+			g_array_append_val (known_half, r);
+	}
+
+	stats_init (&stats, "route-sync", 1 + 2 * global_opt.iterations);
+
+	{
+		gint64 start = nm_utils_get_monotonic_timestamp_ns ();
+
+		nm_route_manager_ip4_route_sync (route_manager, ifindex, known_full, TRUE, TRUE);
+		stats_add (&stats, start, count);
+	}
+
+	for (iter = 0; iter < global_opt.iterations; iter++) {
+		gint64 start;
+
+		start = nm_utils_get_monotonic_timestamp_ns ();
+		nm_route_manager_ip4_route_sync (route_manager, ifindex, known_half, TRUE, TRUE);
+		stats_add (&stats, start, count - known_half->len);
+
+		start = nm_utils_get_monotonic_timestamp_ns ();
+		nm_route_manager_ip4_route_sync (route_manager, ifindex, known_full, TRUE, TRUE);
+		stats_add (&stats, start, count - known_half->len);
+	}
+	stats_print_and_clear (&stats, count);
+
+	nm_route_manager_ip4_route_sync (route_manager, ifindex, empty, TRUE, TRUE);
+}
+
+static void
+bench_link_storm (guint count)
+{
+	Stats stats_add_link;
+	Stats stats_delete_link;
+	gs_unref_array GArray *ifindexes = NULL;
+	guint i;
+
+	ifindexes = g_array_sized_new (FALSE, FALSE, sizeof (int), count);
+
+	stats_init (&stats_add_link, "link-add", count);
+	for (i = 0; i < count; i++) {
+		const NMPlatformLink *plink = NULL;
+		char name[IFNAMSIZ];
+		gint64 start;
+
+		nm_sprintf_buf (name, "bench%u", i);
+
+		start = nm_utils_get_monotonic_timestamp_ns ();
+		if (nm_platform_link_dummy_add (NM_PLATFORM_GET, name, &plink) != NM_PLATFORM_ERROR_SUCCESS)
+			g_error ("failed to add link %s", name);
+		stats_add (&stats_add_link, start, 1);
+
+		g_array_append_val (ifindexes, plink->ifindex);
+	}
+	stats_print_and_clear (&stats_add_link, count);
+
+	stats_init (&stats_delete_link, "link-delete", count);
+	for (i = 0; i < count; i++) {
+		gint64 start = nm_utils_get_monotonic_timestamp_ns ();
+
+		nm_platform_link_delete (NM_PLATFORM_GET, g_array_index (ifindexes, int, i));
+		stats_add (&stats_delete_link, start, 1);
+	}
+	stats_print_and_clear (&stats_delete_link, count);
+}
+
+/*****************************************************************************/
+
+static gboolean
+read_argv (int *argc, char ***argv)
+{
+	GOptionContext *context;
+	GOptionEntry options[] = {
+		{ "count", 'n', 0, G_OPTION_ARG_STRING_ARRAY, &global_opt.counts, "Number of objects per scenario (can be repeated)", "N" },
+		{ "iterations", 'i', 0, G_OPTION_ARG_INT, &global_opt.iterations, "Number of sync rounds per scenario", "N" },
+		{ 0 },
+	};
+	gs_free_error GError *error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_set_summary (context, "Benchmark NMPlatform operations on the fake platform.");
+	g_option_context_add_main_entries (context, options, NULL);
+
+	if (!g_option_context_parse (context, argc, argv, &error)) {
+		g_warning ("Error parsing command line arguments: %s", error->message);
+		g_option_context_free (context);
+		return FALSE;
+	}
+
+	g_option_context_free (context);
+	return TRUE;
+}
+
+int
+main (int argc, char **argv)
+{
+	static const char *const default_counts[] = { "10000", NULL };
+	const char *const *counts;
+	int ifindex;
+	guint i;
+
+	nmtst_init_with_logging (&argc, &argv, "ERR", "ALL");
+
+	if (!read_argv (&argc, &argv))
+		return 2;
+
+	counts = global_opt.counts ? (const char *const *) global_opt.counts : default_counts;
+
+	nm_fake_platform_setup ();
+
+	ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, "eth0");
+	g_assert (ifindex > 0);
+
+	for (i = 0; counts[i]; i++) {
+		gint64 count = _nm_utils_ascii_str_to_int64 (counts[i], 10, 1, 0xFFFFFF, -1);
+
+		if (count < 0) {
+			g_warning ("Invalid count '%s'", counts[i]);
+			return 2;
+		}
+
+		bench_cache_update (count);
+		bench_address (ifindex, count);
+		bench_route (ifindex, count);
+		bench_link_storm (count);
+	}
+
+	g_strfreev (global_opt.counts);
+	return EXIT_SUCCESS;
+}
@@ -354,6 +354,66 @@ test_ip4_address_peer_zero (void)
 
 /*****************************************************************************/
 
+static void
+test_ip4_address_sync (void)
+{
+	const int ifindex = DEVICE_IFINDEX;
+	SignalData *address_added = add_signal_ifindex (NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED, NM_PLATFORM_SIGNAL_ADDED, ip4_address_callback, ifindex);
+	SignalData *address_changed = add_signal_ifindex (NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED, NM_PLATFORM_SIGNAL_CHANGED, ip4_address_callback, ifindex);
+	SignalData *address_removed = add_signal_ifindex (NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED, NM_PLATFORM_SIGNAL_REMOVED, ip4_address_callback, ifindex);
+	gs_unref_array GArray *known = NULL;
+	NMPlatformIP4Address *a;
+	const NMPlatformIP4Address *plat;
+	gint32 now = nm_utils_get_monotonic_timestamp_s ();
+	guint i;
+
+	/* addresses in different subnets, so that they are all primary. */
+	known = g_array_new (FALSE, TRUE, sizeof (NMPlatformIP4Address));
+	g_array_set_size (known, 3);
+	for (i = 0; i < known->len; i++) {
+		a = &g_array_index (known, NMPlatformIP4Address, i);
+		a->address = nmtst_inet4_from_string ("192.0.2.1") + htonl (i << 8);
+		a->peer_address = a->address;
+		a->plen = 24;
+		a->timestamp = now;
+		a->lifetime = 2000;
+		a->preferred = 1000;
+	}
+
+	g_assert (nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, known, NULL));
+	accept_signals (address_added, 3, 3);
+
+	/* nothing changed: the addresses are not touched. */
+	g_assert (nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, known, NULL));
+	ensure_no_signal (address_added);
+	ensure_no_signal (address_changed);
+	ensure_no_signal (address_removed);
+
+	/* a longer lifetime is applied. */
+	a = &g_array_index (known, NMPlatformIP4Address, 1);
+	a->lifetime = 3000;
+	g_assert (nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, known, NULL));
+	plat = nm_platform_ip4_address_get (NM_PLATFORM_GET, ifindex, a->address, a->plen, a->peer_address);
+	g_assert (plat);
+	nmtstp_ip_address_assert_lifetime ((const NMPlatformIPAddress *) plat, -1, 3000, 1000);
+	ensure_no_signal (address_added);
+	ensure_no_signal (address_removed);
+	accept_signals (address_changed, 0, 1);
+
+	/* addresses no longer known are removed. */
+	g_array_set_size (known, 2);
+	g_assert (nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, known, NULL));
+	accept_signal (address_removed);
+	ensure_no_signal (address_added);
+	ensure_no_signal (address_changed);
+
+	free_signal (address_added);
+	free_signal (address_changed);
+	free_signal (address_removed);
+}
+
+/*****************************************************************************/
+
 NMTstpSetupFunc const _nmtstp_setup_platform_func = SETUP;
 
 void
@@ -424,4 +484,6 @@ _nmtstp_setup_tests (void)
 
 	_g_test_add_func ("/address/ipv4/peer", test_ip4_address_peer);
 	_g_test_add_func ("/address/ipv4/peer/zero", test_ip4_address_peer_zero);
+
+	_g_test_add_func ("/address/ipv4/sync", test_ip4_address_sync);
 }
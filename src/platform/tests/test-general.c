@@ -21,9 +21,14 @@
 #include "nm-default.h"
 
 #include <linux/rtnetlink.h>
+#include <linux/nl80211.h>
+#include <net/ethernet.h>
+#include <netlink/netlink.h>
+#include <netlink/msg.h>
 
 #include "platform/nm-platform-utils.h"
 #include "platform/nm-linux-platform.h"
+#include "platform/wifi/wifi-utils-nl80211.h"
 
 #include "nm-test-utils-core.h"
 
@@ -53,6 +58,254 @@ test_link_get_all (void)
 
 /*****************************************************************************/
 
+typedef struct {
+	int ifindex;
+	int quality;
+	guint rate;
+	guint count;
+} WifiStationData;
+
+static void
+_wifi_station_changed_cb (NMPlatform *platform, int ifindex, int quality, guint rate, gpointer user_data)
+{
+	WifiStationData *data = user_data;
+
+	data->ifindex = ifindex;
+	data->quality = quality;
+	data->rate = rate;
+	data->count++;
+}
+
+static void
+test_wifi_station_changed (void)
+{
+	gs_unref_object NMPlatform *platform = NULL;
+	WifiStationData data = { 0 };
+	gulong id;
+
+	platform = nm_linux_platform_new (NM_PLATFORM_NETNS_SUPPORT_DEFAULT);
+
+	id = g_signal_connect (platform, NM_PLATFORM_SIGNAL_WIFI_STATION_CHANGED,
+	                       G_CALLBACK (_wifi_station_changed_cb), &data);
+
+	_nm_platform_wifi_station_changed (platform, 5, 42, 54000);
+	g_assert_cmpint (data.count, ==, 1);
+	g_assert_cmpint (data.ifindex, ==, 5);
+	g_assert_cmpint (data.quality, ==, 42);
+	g_assert_cmpint (data.rate, ==, 54000);
+
+	/* -1 means the driver reported no signal at all */
+	_nm_platform_wifi_station_changed (platform, 5, -1, 0);
+	g_assert_cmpint (data.count, ==, 2);
+	g_assert_cmpint (data.quality, ==, -1);
+	g_assert_cmpint (data.rate, ==, 0);
+
+	/* loopback is not a wifi link, so there is nothing to request and the
+	 * caller has to fall back to polling. */
+	g_assert (!nm_platform_wifi_request_station (platform, 1));
+	g_assert_cmpint (data.count, ==, 2);
+
+	g_signal_handler_disconnect (platform, id);
+}
+
+/*****************************************************************************/
+
+#define WIFI_IFINDEX 42
+
+static const guint8 wifi_bssid[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+static const guint8 wifi_peer[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+
+static struct nl_msg *
+_nl80211_msg_new (guint32 seq, guint8 cmd)
+{
+	struct nl_msg *msg;
+	struct genlmsghdr *gnlh;
+
+	msg = nlmsg_alloc ();
+	g_assert (msg);
+	g_assert (nlmsg_put (msg, 0, seq, 0x42, GENL_HDRLEN, seq ? NLM_F_MULTI : 0));
+	gnlh = nlmsg_data (nlmsg_hdr (msg));
+	gnlh->cmd = cmd;
+	gnlh->version = 1;
+	gnlh->reserved = 0;
+	g_assert (nla_put_u32 (msg, NL80211_ATTR_IFINDEX, WIFI_IFINDEX) >= 0);
+	return msg;
+}
+
+static void
+_nl80211_feed (WifiData *wifi, struct nl_msg *msg)
+{
+	_wifi_nl80211_process_msg (wifi, msg);
+	nlmsg_free (msg);
+}
+
+static void
+_nl80211_feed_bss (WifiData *wifi, guint32 seq, const guint8 *bssid, int signal_dbm)
+{
+	struct nl_msg *msg;
+	struct nlattr *bss;
+
+	msg = _nl80211_msg_new (seq, NL80211_CMD_NEW_SCAN_RESULTS);
+	bss = nla_nest_start (msg, NL80211_ATTR_BSS);
+	g_assert (bss);
+	g_assert (nla_put (msg, NL80211_BSS_BSSID, ETH_ALEN, bssid) >= 0);
+	g_assert (nla_put_u32 (msg, NL80211_BSS_FREQUENCY, 2412) >= 0);
+	g_assert (nla_put_u32 (msg, NL80211_BSS_STATUS, NL80211_BSS_STATUS_ASSOCIATED) >= 0);
+	g_assert (nla_put_u32 (msg, NL80211_BSS_SIGNAL_MBM, (guint32) (signal_dbm * 100)) >= 0);
+	nla_nest_end (msg, bss);
+	_nl80211_feed (wifi, msg);
+}
+
+/* a @signal_dbm of zero leaves out the signal, like some drivers do. */
+static void
+_nl80211_feed_station (WifiData *wifi, guint32 seq, const guint8 *mac, int signal_dbm, guint16 bitrate)
+{
+	struct nl_msg *msg;
+	struct nlattr *sinfo;
+	struct nlattr *rinfo;
+
+	msg = _nl80211_msg_new (seq, NL80211_CMD_NEW_STATION);
+	g_assert (nla_put (msg, NL80211_ATTR_MAC, ETH_ALEN, mac) >= 0);
+	sinfo = nla_nest_start (msg, NL80211_ATTR_STA_INFO);
+	g_assert (sinfo);
+	if (signal_dbm)
+		g_assert (nla_put_u8 (msg, NL80211_STA_INFO_SIGNAL, (guint8) (gint8) signal_dbm) >= 0);
+	rinfo = nla_nest_start (msg, NL80211_STA_INFO_TX_BITRATE);
+	g_assert (rinfo);
+	g_assert (nla_put_u16 (msg, NL80211_RATE_INFO_BITRATE, bitrate) >= 0);
+	nla_nest_end (msg, rinfo);
+	nla_nest_end (msg, sinfo);
+	_nl80211_feed (wifi, msg);
+}
+
+static void
+_nl80211_feed_done (WifiData *wifi, guint32 seq)
+{
+	struct nl_msg *msg;
+
+	msg = nlmsg_alloc ();
+	g_assert (msg);
+	g_assert (nlmsg_put (msg, 0, seq, NLMSG_DONE, sizeof (int), NLM_F_MULTI));
+	_nl80211_feed (wifi, msg);
+}
+
+static void
+_nl80211_feed_error (WifiData *wifi, guint32 seq, int error)
+{
+	struct nl_msg *msg;
+	struct nlmsgerr *err;
+
+	msg = nlmsg_alloc ();
+	g_assert (msg);
+	g_assert (nlmsg_put (msg, 0, seq, NLMSG_ERROR, sizeof (*err), 0));
+	err = nlmsg_data (nlmsg_hdr (msg));
+	memset (err, 0, sizeof (*err));
+	err->error = error;
+	err->msg.nlmsg_seq = seq;
+	_nl80211_feed (wifi, msg);
+}
+
+static void
+_wifi_nl80211_station_cb (WifiData *wifi, int quality, guint32 rate, gpointer user_data)
+{
+	WifiStationData *data = user_data;
+
+	data->quality = quality;
+	data->rate = rate;
+	data->count++;
+}
+
+static void
+test_wifi_nl80211_station_request (void)
+{
+	WifiData *wifi;
+	WifiStationData data = { 0 };
+	guint32 seq, seq2;
+
+	wifi = _wifi_nl80211_new_for_testing ("wlan-test", WIFI_IFINDEX);
+	if (!wifi) {
+		g_test_skip ("cannot open a generic netlink socket");
+		return;
+	}
+	wifi_utils_set_station_func (wifi, _wifi_nl80211_station_cb, &data);
+
+	/* the BSSID is not known yet, so the scan list is dumped first */
+	g_assert (wifi_utils_request_station (wifi));
+	seq = _wifi_nl80211_get_request_seq (wifi);
+	g_assert_cmpint (seq, !=, 0);
+
+	/* while in flight, no new request is sent */
+	g_assert (wifi_utils_request_station (wifi));
+	g_assert_cmpint (_wifi_nl80211_get_request_seq (wifi), ==, seq);
+
+	_nl80211_feed_bss (wifi, seq, wifi_bssid, -60);
+	_nl80211_feed_done (wifi, seq);
+	seq2 = _wifi_nl80211_get_request_seq (wifi);
+	g_assert_cmpint (seq2, !=, 0);
+	g_assert_cmpint (seq2, !=, seq);
+	g_assert_cmpint (data.count, ==, 0);
+
+	/* only the entry of the current BSSID counts, not the peers of an
+	 * adhoc network, nor the replies of an earlier dump. */
+	_nl80211_feed_station (wifi, seq2, wifi_peer, -30, 540);
+	_nl80211_feed_station (wifi, seq2, wifi_bssid, -55, 1300);
+	_nl80211_feed_station (wifi, seq, wifi_bssid, -20, 60);
+	_nl80211_feed_done (wifi, seq2);
+	g_assert_cmpint (_wifi_nl80211_get_request_seq (wifi), ==, 0);
+	g_assert_cmpint (data.count, ==, 1);
+	g_assert_cmpint (data.quality, ==, 65);
+	g_assert_cmpint (data.rate, ==, 130000);
+
+	/* with the BSSID cached, the station is dumped right away */
+	g_assert (wifi_utils_request_station (wifi));
+	seq = _wifi_nl80211_get_request_seq (wifi);
+	g_assert_cmpint (seq, !=, 0);
+	_nl80211_feed_error (wifi, seq, -ENODEV);
+	g_assert_cmpint (_wifi_nl80211_get_request_seq (wifi), ==, 0);
+	g_assert_cmpint (data.count, ==, 2);
+	g_assert_cmpint (data.quality, ==, -1);
+	g_assert_cmpint (data.rate, ==, 0);
+
+	/* a failed receive drops the dump in flight. On overrun, events may be
+	 * lost too, so it is requested again. */
+	g_assert (wifi_utils_request_station (wifi));
+	seq = _wifi_nl80211_get_request_seq (wifi);
+	g_assert_cmpint (seq, !=, 0);
+	_wifi_nl80211_recv_failed (wifi, -NLE_NOMEM);
+	seq2 = _wifi_nl80211_get_request_seq (wifi);
+	g_assert_cmpint (seq2, !=, 0);
+	g_assert_cmpint (seq2, !=, seq);
+	_wifi_nl80211_recv_failed (wifi, -NLE_MSG_TRUNC);
+	g_assert_cmpint (_wifi_nl80211_get_request_seq (wifi), ==, 0);
+	_nl80211_feed_done (wifi, seq2);
+	g_assert_cmpint (data.count, ==, 2);
+
+	/* a dump that never finishes is given up on */
+	g_assert (wifi_utils_request_station (wifi));
+	g_assert_cmpint (_wifi_nl80211_get_request_seq (wifi), !=, 0);
+	_wifi_nl80211_request_timeout (wifi);
+	g_assert_cmpint (_wifi_nl80211_get_request_seq (wifi), ==, 0);
+	g_assert_cmpint (data.count, ==, 2);
+
+	/* without a station signal, the beacon signal of the BSS is used */
+	g_assert (wifi_utils_request_station (wifi));
+	seq = _wifi_nl80211_get_request_seq (wifi);
+	_nl80211_feed_bss (wifi, seq, wifi_bssid, -60);
+	_nl80211_feed_done (wifi, seq);
+	seq2 = _wifi_nl80211_get_request_seq (wifi);
+	g_assert_cmpint (seq2, !=, seq);
+	_nl80211_feed_station (wifi, seq2, wifi_bssid, 0, 60);
+	_nl80211_feed_done (wifi, seq2);
+	g_assert_cmpint (_wifi_nl80211_get_request_seq (wifi), ==, 0);
+	g_assert_cmpint (data.count, ==, 3);
+	g_assert_cmpint (data.quality, ==, 60);
+	g_assert_cmpint (data.rate, ==, 6000);
+
+	wifi_utils_deinit (wifi);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -62,6 +315,8 @@ main (int argc, char **argv)
 
 	g_test_add_func ("/general/init_linux_platform", test_init_linux_platform);
 	g_test_add_func ("/general/link_get_all", test_link_get_all);
+	g_test_add_func ("/general/wifi_station_changed", test_wifi_station_changed);
+	g_test_add_func ("/general/wifi_nl80211_station_request", test_wifi_nl80211_station_request);
 
 	return g_test_run ();
 }
@@ -2488,6 +2488,71 @@ test_sysctl_netns_switch (void)
 
 /*****************************************************************************/
 
+static void
+test_sysctl_ip_conf_multi (void)
+{
+	NMPlatform *const PL = NM_PLATFORM_GET;
+	const char *const IFNAME = "nm-dummy-0";
+	const NMPlatformSysctlIPConfSetData data[] = {
+		{ "accept_ra_defrtr", "0" },
+		{ "use_tempaddr",     "1" },
+	};
+	NMPlatformSysctlStats stats = { 0 };
+	int ifindex;
+	guint i;
+
+	for (i = 0; i < 2; i++) {
+		ifindex = nmtstp_link_dummy_add (PL, -1, IFNAME)->ifindex;
+
+		memset (&stats, 0, sizeof (stats));
+		g_assert (nm_platform_sysctl_ip_conf_set_multi (PL, AF_INET6, IFNAME, data, G_N_ELEMENTS (data), &stats));
+		g_assert_cmpint (stats.n_skipped, ==, 0);
+		_sysctl_assert_eq (PL, "/proc/sys/net/ipv6/conf/nm-dummy-0/accept_ra_defrtr", "0");
+		_sysctl_assert_eq (PL, "/proc/sys/net/ipv6/conf/nm-dummy-0/use_tempaddr", "1");
+
+		/* the second time, the values are known and the writes are skipped. */
+		memset (&stats, 0, sizeof (stats));
+		g_assert (nm_platform_sysctl_ip_conf_set_multi (PL, AF_INET6, IFNAME, data, G_N_ELEMENTS (data), &stats));
+		if (NM_IS_LINUX_PLATFORM (PL)) {
+			g_assert_cmpint (stats.n_skipped, ==, G_N_ELEMENTS (data));
+			g_assert_cmpint (stats.n_syscalls, ==, 0);
+		}
+
+		/* reading the value updates the cache. */
+		g_assert (nm_platform_sysctl_set (PL, NMP_SYSCTL_PATHID_ABSOLUTE ("/proc/sys/net/ipv6/conf/nm-dummy-0/use_tempaddr"), "2"));
+		g_assert_cmpint (nm_platform_sysctl_ip_conf_get_int_checked (PL, AF_INET6, IFNAME, "use_tempaddr", 10, 0, 2, -1, NULL), ==, 2);
+		g_assert (nm_platform_sysctl_ip_conf_set (PL, AF_INET6, IFNAME, "use_tempaddr", "1", NULL));
+		_sysctl_assert_eq (PL, "/proc/sys/net/ipv6/conf/nm-dummy-0/use_tempaddr", "1");
+
+		if (NM_IS_LINUX_PLATFORM (PL)) {
+			FILE *f;
+
+			/* a value changed behind our back is only written again after
+			 * invalidating the cache. */
+			f = fopen ("/proc/sys/net/ipv6/conf/nm-dummy-0/use_tempaddr", "w");
+			g_assert (f);
+			g_assert_cmpint (fputs ("2", f), >=, 0);
+			g_assert_cmpint (fclose (f), ==, 0);
+
+			memset (&stats, 0, sizeof (stats));
+			g_assert (nm_platform_sysctl_ip_conf_set (PL, AF_INET6, IFNAME, "use_tempaddr", "1", &stats));
+			g_assert_cmpint (stats.n_skipped, ==, 1);
+			_sysctl_assert_eq (PL, "/proc/sys/net/ipv6/conf/nm-dummy-0/use_tempaddr", "2");
+
+			nm_platform_sysctl_ip_conf_invalidate (PL, ifindex);
+			memset (&stats, 0, sizeof (stats));
+			g_assert (nm_platform_sysctl_ip_conf_set (PL, AF_INET6, IFNAME, "use_tempaddr", "1", &stats));
+			g_assert_cmpint (stats.n_skipped, ==, 0);
+			_sysctl_assert_eq (PL, "/proc/sys/net/ipv6/conf/nm-dummy-0/use_tempaddr", "1");
+		}
+
+		/* re-creating the link with the same name must not reuse the stale directory. */
+		nmtstp_link_del (PL, -1, ifindex, IFNAME);
+	}
+}
+
+/*****************************************************************************/
+
 NMTstpSetupFunc const _nmtstp_setup_platform_func = SETUP;
 
 void
@@ -2544,5 +2609,6 @@ _nmtstp_setup_tests (void)
 
 		g_test_add_func ("/general/sysctl/rename", test_sysctl_rename);
 		g_test_add_func ("/general/sysctl/netns-switch", test_sysctl_netns_switch);
+		g_test_add_func ("/general/sysctl/ip-conf-multi", test_sysctl_ip_conf_multi);
 	}
 }
@@ -24,6 +24,7 @@
 
 #include "nm-core-utils.h"
 #include "platform/nm-platform-utils.h"
+#include "platform/nmp-object.h"
 
 #include "test-common.h"
 
@@ -313,6 +314,115 @@ test_ip6_route (void)
 
 /*****************************************************************************/
 
+typedef struct {
+	guint n_requests;
+	gboolean results[3];
+} BatchData;
+
+static void
+batch_result_cb (NMPlatform *platform, guint request_idx, gboolean success, gpointer user_data)
+{
+	BatchData *data = user_data;
+
+	g_assert_cmpint (request_idx, <, G_N_ELEMENTS (data->results));
+	data->results[request_idx] = success;
+	data->n_requests++;
+}
+
+static gboolean
+batch_ip4_route_add (BatchData *data, guint i, int ifindex, const char *network, guint8 plen, const char *gateway)
+{
+	guint n_requests = nm_platform_batch_get_n_requests (NM_PLATFORM_GET);
+	gboolean success;
+
+	success = nm_platform_ip4_route_add (NM_PLATFORM_GET, ifindex, NM_IP_CONFIG_SOURCE_USER,
+	                                     nmtst_inet4_from_string (network), plen,
+	                                     gateway ? nmtst_inet4_from_string (gateway) : INADDR_ANY,
+	                                     0, 20, 0);
+	if (nm_platform_batch_get_n_requests (NM_PLATFORM_GET) > n_requests) {
+		/* pending. The result is reported by nm_platform_batch_end(). */
+		g_assert (success);
+		g_assert_cmpint (n_requests, ==, i);
+		return FALSE;
+	}
+	data->results[i] = success;
+	return TRUE;
+}
+
+static void
+test_ip4_route_batch (void)
+{
+	int ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+	BatchData data = { 0 };
+	guint n_completed = 0;
+
+	g_assert_cmpint (nm_platform_batch_get_n_requests (NM_PLATFORM_GET), ==, 0);
+
+	nm_platform_batch_begin (NM_PLATFORM_GET);
+
+	/* the gateway route depends on the device route that is submitted
+	 * right before it. */
+	n_completed += batch_ip4_route_add (&data, 0, ifindex, "198.51.100.0", 24, NULL);
+	n_completed += batch_ip4_route_add (&data, 1, ifindex, "203.0.113.0", 24, "198.51.100.1");
+	/* the gateway is not reachable. */
+	n_completed += batch_ip4_route_add (&data, 2, ifindex, "203.0.113.128", 25, "192.0.2.99");
+
+	nm_platform_batch_end (NM_PLATFORM_GET, batch_result_cb, &data);
+
+	g_assert_cmpint (n_completed + data.n_requests, ==, 3);
+	g_assert_cmpint (nm_platform_batch_get_n_requests (NM_PLATFORM_GET), ==, 0);
+	g_assert (data.results[0]);
+	g_assert (data.results[1]);
+	g_assert (!data.results[2]);
+
+	nmtstp_assert_ip4_route_exists (NULL, TRUE, DEVICE_NAME, nmtst_inet4_from_string ("198.51.100.0"), 24, 20);
+	nmtstp_assert_ip4_route_exists (NULL, TRUE, DEVICE_NAME, nmtst_inet4_from_string ("203.0.113.0"), 24, 20);
+	nmtstp_assert_ip4_route_exists (NULL, FALSE, DEVICE_NAME, nmtst_inet4_from_string ("203.0.113.128"), 25, 20);
+
+	nm_platform_batch_begin (NM_PLATFORM_GET);
+	g_assert (nm_platform_ip4_route_delete (NM_PLATFORM_GET, ifindex, nmtst_inet4_from_string ("203.0.113.0"), 24, 20));
+	g_assert (nm_platform_ip4_route_delete (NM_PLATFORM_GET, ifindex, nmtst_inet4_from_string ("198.51.100.0"), 24, 20));
+	g_assert (nm_platform_batch_end (NM_PLATFORM_GET, NULL, NULL));
+
+	nmtstp_assert_ip4_route_exists (NULL, FALSE, DEVICE_NAME, nmtst_inet4_from_string ("198.51.100.0"), 24, 20);
+	nmtstp_assert_ip4_route_exists (NULL, FALSE, DEVICE_NAME, nmtst_inet4_from_string ("203.0.113.0"), 24, 20);
+}
+
+static void
+test_ip4_route_lookup_clone (void)
+{
+	int ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+	in_addr_t network = nmtst_inet4_from_string ("192.0.2.7");
+	gs_unref_ptrarray GPtrArray *routes = NULL;
+	gs_unref_ptrarray GPtrArray *routes2 = NULL;
+	gs_unref_array GArray *routes_copy = NULL;
+	const NMPlatformIP4Route *route = NULL;
+	guint i;
+
+	g_assert (nm_platform_ip4_route_add (NM_PLATFORM_GET, ifindex, NM_IP_CONFIG_SOURCE_USER, network, 32, INADDR_ANY, 0, 1024, 0));
+
+	routes = nm_platform_ip4_route_lookup_clone (NM_PLATFORM_GET, ifindex, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT);
+	routes_copy = nm_platform_ip4_route_get_all (NM_PLATFORM_GET, ifindex, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT);
+	g_assert_cmpint (routes->len, ==, routes_copy->len);
+
+	for (i = 0; i < routes->len; i++) {
+		const NMPObject *obj = routes->pdata[i];
+
+		g_assert_cmpint (NMP_OBJECT_GET_TYPE (obj), ==, NMP_OBJECT_TYPE_IP4_ROUTE);
+		if (obj->ip4_route.network == network && obj->ip4_route.metric == 1024)
+			route = &obj->ip4_route;
+	}
+	g_assert (route);
+
+	/* the objects stay valid after they are removed from the cache. */
+	g_assert (nm_platform_ip4_route_delete (NM_PLATFORM_GET, ifindex, network, 32, 1024));
+	g_assert_cmpint (route->network, ==, network);
+	g_assert_cmpint (route->ifindex, ==, ifindex);
+
+	routes2 = nm_platform_ip4_route_lookup_clone (NM_PLATFORM_GET, ifindex, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT);
+	g_assert_cmpint (routes2->len, ==, routes->len - 1);
+}
+
 static void
 test_ip4_zero_gateway (void)
 {
@@ -360,6 +470,8 @@ _nmtstp_setup_tests (void)
 	g_test_add_func ("/route/ip4", test_ip4_route);
 	g_test_add_func ("/route/ip6", test_ip6_route);
 	g_test_add_func ("/route/ip4_metric0", test_ip4_route_metric0);
+	g_test_add_func ("/route/ip4_batch", test_ip4_route_batch);
+	g_test_add_func ("/route/ip4_lookup_clone", test_ip4_route_lookup_clone);
 
 	if (nmtstp_is_root_test ())
 		g_test_add_func ("/route/ip4_zero_gateway", test_ip4_zero_gateway);
@@ -36,6 +36,7 @@
 #include "wifi-utils-nl80211.h"
 #include "platform/nm-platform.h"
 #include "nm-utils.h"
+#include "nm-core-utils.h"
 
 
 /*****************************************************************************
@@ -139,6 +140,12 @@ genlmsg_parse (struct nlmsghdr *nlh, int hdrlen, struct nlattr *tb[],
  * Reimplementation of libnl3/genl functions:
  *****************************************************************************/
 
+struct probe_response_data {
+	gint32 family_id;
+	const char *mcast_name;
+	gint32 mcast_id;
+};
+
 static int
 probe_response (struct nl_msg *msg, void *arg)
 {
@@ -154,25 +161,48 @@ probe_response (struct nl_msg *msg, void *arg)
 	};
 	struct nlattr *tb[CTRL_ATTR_MAX+1];
 	struct nlmsghdr *nlh = nlmsg_hdr (msg);
-	gint32 *response_data = arg;
+	struct probe_response_data *response_data = arg;
 
 	if (genlmsg_parse (nlh, 0, tb, CTRL_ATTR_MAX, ctrl_policy))
 		return NL_SKIP;
 
 	if (tb[CTRL_ATTR_FAMILY_ID])
-		*response_data = nla_get_u16 (tb[CTRL_ATTR_FAMILY_ID]);
+		response_data->family_id = nla_get_u16 (tb[CTRL_ATTR_FAMILY_ID]);
+
+	if (tb[CTRL_ATTR_MCAST_GROUPS] && response_data->mcast_name) {
+		struct nlattr *tb_grp[CTRL_ATTR_MCAST_GRP_MAX + 1];
+		struct nlattr *grp;
+		int rem;
+
+		nla_for_each_nested (grp, tb[CTRL_ATTR_MCAST_GROUPS], rem) {
+			if (nla_parse_nested (tb_grp, CTRL_ATTR_MCAST_GRP_MAX, grp, NULL) < 0)
+				continue;
+			if (   !tb_grp[CTRL_ATTR_MCAST_GRP_NAME]
+			    || !tb_grp[CTRL_ATTR_MCAST_GRP_ID])
+				continue;
+			if (strcmp (nla_data (tb_grp[CTRL_ATTR_MCAST_GRP_NAME]), response_data->mcast_name) != 0)
+				continue;
+			response_data->mcast_id = nla_get_u32 (tb_grp[CTRL_ATTR_MCAST_GRP_ID]);
+		}
+	}
 
 	return NL_STOP;
 }
 
+/* Also looks up the id of the multicast group @mcast_name, if given. */
 static int
-genl_ctrl_resolve (struct nl_sock *sk, const char *name)
+genl_ctrl_resolve (struct nl_sock *sk, const char *name,
+                   const char *mcast_name, int *out_mcast_id)
 {
 	struct nl_msg *msg;
 	struct nl_cb *cb, *orig;
 	int rc;
 	int result = -NLE_OBJ_NOTFOUND;
-	gint32 response_data = -1;
+	struct probe_response_data response_data = {
+		.family_id = -1,
+		.mcast_name = mcast_name,
+		.mcast_id = -1,
+	};
 
 	if (!(orig = nl_socket_get_cb (sk)))
 		goto out;
@@ -210,8 +240,10 @@ genl_ctrl_resolve (struct nl_sock *sk, const char *name)
 	if (rc < 0)
 		goto out_msg_free;
 
-	if (response_data > 0)
-		result = response_data;
+	if (response_data.family_id > 0)
+		result = response_data.family_id;
+	if (out_mcast_id)
+		*out_mcast_id = response_data.mcast_id;
 
 out_msg_free:
 	nlmsg_free (msg);
@@ -229,6 +261,28 @@ out:
  * </libn-genl-3>
  *****************************************************************************/
 
+struct nl80211_station_info {
+	guint32 txrate;
+	gboolean txrate_valid;
+	guint8 signal;
+	gboolean signal_valid;
+};
+
+struct nl80211_bss_info {
+	guint32 freq;
+	guint8 bssid[ETH_ALEN];
+	guint8 ssid[32];
+	guint32 ssid_len;
+	guint32 beacon_signal;
+	gboolean valid;
+};
+
+typedef enum {
+	NL80211_REQUEST_NONE,
+	NL80211_REQUEST_BSS,
+	NL80211_REQUEST_STATION,
+} Nl80211Request;
+
 typedef struct {
 	WifiData parent;
 	struct nl_sock *nl_sock;
@@ -237,6 +291,22 @@ typedef struct {
 	guint32 *freqs;
 	int num_freqs;
 	int phy;
+
+	/* Non-blocking socket for station requests and for MLME events
+	 * (CQM notifications and station changes). */
+	struct nl_sock *event_sock;
+	guint event_id;
+
+	/* The dump in flight on @event_sock: the current BSS, if it is not
+	 * cached, and then the station entry of its BSSID. */
+	Nl80211Request request;
+	guint32 request_seq;
+	guint request_timeout_id;
+	struct nl80211_station_info station_info;
+	gboolean station_found;
+	gboolean station_signal_missing;
+	struct nl80211_bss_info bss_info;
+	gint32 bss_info_timestamp;
 } WifiDataNl80211;
 
 static int
@@ -362,6 +432,10 @@ wifi_nl80211_deinit (WifiData *parent)
 {
 	WifiDataNl80211 *nl80211 = (WifiDataNl80211 *) parent;
 
+	nm_clear_g_source (&nl80211->request_timeout_id);
+	nm_clear_g_source (&nl80211->event_id);
+	if (nl80211->event_sock)
+		nl_socket_free (nl80211->event_sock);
 	if (nl80211->nl_sock)
 		nl_socket_free (nl80211->nl_sock);
 	if (nl80211->nl_cb)
@@ -483,15 +557,6 @@ nl80211_xbm_to_percent (gint32 xbm, guint32 divisor)
 			   ((float) SIGNAL_MAX_DBM - (float) NOISE_FLOOR_DBM));
 }
 
-struct nl80211_bss_info {
-	guint32 freq;
-	guint8 bssid[ETH_ALEN];
-	guint8 ssid[32];
-	guint32 ssid_len;
-	guint32 beacon_signal;
-	gboolean valid;
-};
-
 #define WLAN_EID_SSID	0
 
 static void
@@ -642,13 +707,6 @@ wifi_nl80211_get_bssid (WifiData *data, guint8 *out_bssid)
 	return bss_info.valid;
 }
 
-struct nl80211_station_info {
-	guint32 txrate;
-	gboolean txrate_valid;
-	guint8 signal;
-	gboolean signal_valid;
-};
-
 static int
 nl80211_station_handler (struct nl_msg *msg, void *arg)
 {
@@ -764,6 +822,341 @@ wifi_nl80211_get_qual (WifiData *data)
 	return sta_info.signal;
 }
 
+/* How long to wait for a dump on the event socket to finish. */
+#define REQUEST_TIMEOUT_SEC  5
+
+/* Drivers that don't report STA_INFO_SIGNAL get the beacon signal from the
+ * scan list instead; don't dump the scan list more often than this for them. */
+#define BSS_INFO_MAX_AGE_SEC 10
+
+static void
+nl80211_request_clear (WifiDataNl80211 *nl80211)
+{
+	nl80211->request = NL80211_REQUEST_NONE;
+	nl80211->request_seq = 0;
+	nm_clear_g_source (&nl80211->request_timeout_id);
+	memset (&nl80211->station_info, 0, sizeof (nl80211->station_info));
+	nl80211->station_found = FALSE;
+}
+
+static gboolean
+nl80211_request_timeout_cb (gpointer user_data)
+{
+	WifiDataNl80211 *nl80211 = user_data;
+
+	nl80211->request_timeout_id = 0;
+	nm_log_dbg (LOGD_WIFI, "(%s): nl80211 %s dump did not finish",
+	            nl80211->parent.iface,
+	            nl80211->request == NL80211_REQUEST_BSS ? "scan" : "station");
+	nl80211_request_clear (nl80211);
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+nl80211_request_send (WifiDataNl80211 *nl80211, Nl80211Request request)
+{
+	struct nl_msg *msg;
+	int err;
+
+	nl80211_request_clear (nl80211);
+
+	msg = nl80211_alloc_msg (nl80211,
+	                         request == NL80211_REQUEST_BSS
+	                             ? NL80211_CMD_GET_SCAN
+	                             : NL80211_CMD_GET_STATION,
+	                         NLM_F_DUMP);
+	if (!msg)
+		return FALSE;
+
+	err = nl_send_auto_complete (nl80211->event_sock, msg);
+	if (err < 0) {
+		nm_log_dbg (LOGD_WIFI, "(%s): failed to request %s info: %s",
+		            nl80211->parent.iface,
+		            request == NL80211_REQUEST_BSS ? "BSS" : "station",
+		            nl_geterror (err));
+		nlmsg_free (msg);
+		return FALSE;
+	}
+
+	if (request == NL80211_REQUEST_BSS)
+		memset (&nl80211->bss_info, 0, sizeof (nl80211->bss_info));
+
+	nl80211->request = request;
+	nl80211->request_seq = nlmsg_hdr (msg)->nlmsg_seq;
+	nl80211->request_timeout_id = g_timeout_add_seconds (REQUEST_TIMEOUT_SEC,
+	                                                     nl80211_request_timeout_cb,
+	                                                     nl80211);
+	nlmsg_free (msg);
+	return TRUE;
+}
+
+static gboolean
+wifi_nl80211_request_station (WifiData *data)
+{
+	WifiDataNl80211 *nl80211 = (WifiDataNl80211 *) data;
+	gboolean need_bss;
+
+	if (!nl80211->event_id)
+		return FALSE;
+
+	/* a dump is already in flight. */
+	if (nl80211->request != NL80211_REQUEST_NONE)
+		return TRUE;
+
+	/* The station dump also contains the peers of an adhoc or mesh network,
+	 * so it is filtered by the BSSID of the current BSS. That is looked up
+	 * once and cached until we connect, roam or the station is gone. */
+	need_bss = !nl80211->bss_info.valid;
+	if (   !need_bss
+	    && nl80211->station_signal_missing
+	    && nm_utils_get_monotonic_timestamp_s () - nl80211->bss_info_timestamp >= BSS_INFO_MAX_AGE_SEC)
+		need_bss = TRUE;
+
+	return nl80211_request_send (nl80211,
+	                             need_bss
+	                                 ? NL80211_REQUEST_BSS
+	                                 : NL80211_REQUEST_STATION);
+}
+
+static void
+nl80211_request_done (WifiDataNl80211 *nl80211, gboolean success)
+{
+	Nl80211Request request = nl80211->request;
+	struct nl80211_station_info info = nl80211->station_info;
+	gboolean found = nl80211->station_found;
+
+	nl80211_request_clear (nl80211);
+
+	if (request == NL80211_REQUEST_BSS) {
+		if (success && nl80211->bss_info.valid) {
+			nl80211->bss_info_timestamp = nm_utils_get_monotonic_timestamp_s ();
+			nl80211_request_send (nl80211, NL80211_REQUEST_STATION);
+			return;
+		}
+		/* not associated */
+		nl80211->bss_info.valid = FALSE;
+		wifi_data_station_changed ((WifiData *) nl80211, -1, 0);
+		return;
+	}
+
+	if (!success || !found) {
+		/* the cached BSS is gone, look it up again next time. */
+		nl80211->bss_info.valid = FALSE;
+		wifi_data_station_changed ((WifiData *) nl80211, -1, 0);
+		return;
+	}
+
+	nl80211->station_signal_missing = !info.signal_valid;
+	if (!info.signal_valid) {
+		/* Some drivers don't report STA_INFO_SIGNAL. Like nl80211_get_ap_info(),
+		 * fall back to the beacon signal of the current BSS (both are in percent). */
+		info.signal = nl80211->bss_info.beacon_signal;
+	}
+
+	wifi_data_station_changed ((WifiData *) nl80211, info.signal, info.txrate);
+}
+
+static int
+nl80211_event_handler (struct nl_msg *msg, void *arg)
+{
+	WifiDataNl80211 *nl80211 = arg;
+	struct nlmsghdr *nlh = nlmsg_hdr (msg);
+	struct genlmsghdr *gnlh = nlmsg_data (nlh);
+	struct nlattr *tb[NL80211_ATTR_MAX + 1];
+
+	if (nla_parse (tb, NL80211_ATTR_MAX, genlmsg_attrdata (gnlh, 0),
+	               genlmsg_attrlen (gnlh, 0), NULL) < 0)
+		return NL_SKIP;
+
+	if (   !tb[NL80211_ATTR_IFINDEX]
+	    || nla_get_u32 (tb[NL80211_ATTR_IFINDEX]) != nl80211->parent.ifindex)
+		return NL_SKIP;
+
+	if (nlh->nlmsg_seq) {
+		/* A reply to one of our dumps. Whatever is left of an earlier one
+		 * that was given up on is dropped. */
+		if (   nl80211->request == NL80211_REQUEST_NONE
+		    || nlh->nlmsg_seq != nl80211->request_seq)
+			return NL_SKIP;
+
+		if (   nl80211->request == NL80211_REQUEST_BSS
+		    && gnlh->cmd == NL80211_CMD_NEW_SCAN_RESULTS)
+			nl80211_bss_dump_handler (msg, &nl80211->bss_info);
+		else if (   nl80211->request == NL80211_REQUEST_STATION
+		         && gnlh->cmd == NL80211_CMD_NEW_STATION
+		         && tb[NL80211_ATTR_MAC]
+		         && nla_len (tb[NL80211_ATTR_MAC]) == ETH_ALEN
+		         && memcmp (nla_data (tb[NL80211_ATTR_MAC]), nl80211->bss_info.bssid, ETH_ALEN) == 0) {
+			nl80211_station_handler (msg, &nl80211->station_info);
+			nl80211->station_found = TRUE;
+		}
+		return NL_SKIP;
+	}
+
+	switch (gnlh->cmd) {
+	case NL80211_CMD_CONNECT:
+	case NL80211_CMD_ROAM:
+	case NL80211_CMD_DISCONNECT:
+	case NL80211_CMD_DEL_STATION:
+		/* The current BSS may have changed. A dump in flight would still
+		 * report on the old one, so start over. */
+		nl80211->bss_info.valid = FALSE;
+		nl80211_request_clear (nl80211);
+		wifi_nl80211_request_station ((WifiData *) nl80211);
+		break;
+	case NL80211_CMD_NOTIFY_CQM:
+	case NL80211_CMD_NEW_STATION:
+		wifi_nl80211_request_station ((WifiData *) nl80211);
+		break;
+	default:
+		break;
+	}
+	return NL_SKIP;
+}
+
+static int
+nl80211_event_finish_handler (struct nl_msg *msg, void *arg)
+{
+	WifiDataNl80211 *nl80211 = arg;
+
+	if (   nl80211->request != NL80211_REQUEST_NONE
+	    && nlmsg_hdr (msg)->nlmsg_seq == nl80211->request_seq)
+		nl80211_request_done (nl80211, TRUE);
+	return NL_SKIP;
+}
+
+static int
+nl80211_event_error_handler (struct sockaddr_nl *nla, struct nlmsgerr *err, void *arg)
+{
+	WifiDataNl80211 *nl80211 = arg;
+
+	if (   nl80211->request != NL80211_REQUEST_NONE
+	    && err->msg.nlmsg_seq == nl80211->request_seq)
+		nl80211_request_done (nl80211, FALSE);
+	return NL_SKIP;
+}
+
+static void
+nl80211_event_recv_failed (WifiDataNl80211 *nl80211, int err)
+{
+	nm_log_dbg (LOGD_WIFI, "(%s): failed to receive nl80211 events: (%d) %s",
+	            nl80211->parent.iface, err, nl_geterror (err));
+
+	/* The rest of the dump in flight may be gone, don't wait for it. */
+	nl80211_request_clear (nl80211);
+
+	/* On overrun (ENOBUFS) events were lost as well, so ask again. */
+	if (err == -NLE_NOMEM)
+		wifi_nl80211_request_station ((WifiData *) nl80211);
+}
+
+static gboolean
+nl80211_event_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	WifiDataNl80211 *nl80211 = user_data;
+	int err;
+
+	if (condition & (G_IO_ERR | G_IO_HUP)) {
+		nm_log_warn (LOGD_WIFI, "(%s): nl80211 event socket closed", nl80211->parent.iface);
+		nl80211->event_id = 0;
+		nl80211_request_clear (nl80211);
+		return G_SOURCE_REMOVE;
+	}
+
+	err = nl_recvmsgs_default (nl80211->event_sock);
+	if (err < 0 && err != -NLE_AGAIN)
+		nl80211_event_recv_failed (nl80211, err);
+	return G_SOURCE_CONTINUE;
+}
+
+/* Roughly the point below which roaming decisions and the signal strength
+ * shown to the user start to matter. */
+#define CQM_RSSI_THRESHOLD_DBM  -70
+#define CQM_RSSI_HYSTERESIS_DB  4
+
+static void
+nl80211_set_cqm_rssi (WifiDataNl80211 *nl80211, gint32 threshold, guint32 hysteresis)
+{
+	struct nl_msg *msg;
+	struct nlattr *cqm;
+	int err;
+
+	msg = nl80211_alloc_msg (nl80211, NL80211_CMD_SET_CQM, 0);
+	if (!msg)
+		return;
+
+	cqm = nla_nest_start (msg, NL80211_ATTR_CQM);
+	if (!cqm)
+		goto nla_put_failure;
+	NLA_PUT_U32 (msg, NL80211_ATTR_CQM_RSSI_THOLD, threshold);
+	NLA_PUT_U32 (msg, NL80211_ATTR_CQM_RSSI_HYST, hysteresis);
+	nla_nest_end (msg, cqm);
+
+	err = nl80211_send_and_recv (nl80211, msg, NULL, NULL);
+	if (err < 0) {
+		nm_log_dbg (LOGD_PLATFORM | LOGD_WIFI, "(%s): driver does not support CQM RSSI events: %s",
+		            nl80211->parent.iface, nl_geterror (err));
+	}
+	return;
+
+nla_put_failure:
+	nlmsg_free (msg);
+}
+
+static void
+nl80211_event_init (WifiDataNl80211 *nl80211, int mlme_group)
+{
+	GIOChannel *channel;
+	int err;
+
+	nl80211->event_sock = nl_socket_alloc ();
+	if (!nl80211->event_sock)
+		return;
+
+	/* multicast events arrive with a sequence number of zero */
+	nl_socket_disable_seq_check (nl80211->event_sock);
+	nl_socket_modify_cb (nl80211->event_sock, NL_CB_VALID, NL_CB_CUSTOM, nl80211_event_handler, nl80211);
+	nl_socket_modify_cb (nl80211->event_sock, NL_CB_FINISH, NL_CB_CUSTOM, nl80211_event_finish_handler, nl80211);
+	nl_socket_modify_err_cb (nl80211->event_sock, NL_CB_CUSTOM, nl80211_event_error_handler, nl80211);
+
+	err = nl_connect (nl80211->event_sock, NETLINK_GENERIC);
+	if (err < 0)
+		goto error;
+
+	if (mlme_group >= 0) {
+		err = nl_socket_add_membership (nl80211->event_sock, mlme_group);
+		if (err < 0)
+			goto error;
+	}
+
+	err = nl_socket_set_nonblocking (nl80211->event_sock);
+	if (err < 0)
+		goto error;
+
+	channel = g_io_channel_unix_new (nl_socket_get_fd (nl80211->event_sock));
+	nl80211->event_id = g_io_add_watch (channel,
+	                                    G_IO_IN | G_IO_ERR | G_IO_HUP,
+	                                    nl80211_event_cb,
+	                                    nl80211);
+	g_io_channel_unref (channel);
+
+	/* Get notified when the signal crosses the threshold in either
+	 * direction, instead of waiting for the next poll.
+	 *
+	 * nl80211 only takes a single threshold here, so changes that don't
+	 * cross it produce no event; those are still picked up by the periodic
+	 * poll in NMDeviceWifi. */
+	if (mlme_group >= 0)
+		nl80211_set_cqm_rssi (nl80211, CQM_RSSI_THRESHOLD_DBM, CQM_RSSI_HYSTERESIS_DB);
+	return;
+
+error:
+	nm_log_dbg (LOGD_PLATFORM | LOGD_WIFI, "(%s): failed to set up nl80211 event socket: %s",
+	            nl80211->parent.iface, nl_geterror (err));
+	nl_socket_free (nl80211->event_sock);
+	nl80211->event_sock = NULL;
+}
+
 #if HAVE_NL80211_CRITICAL_PROTOCOL_CMDS
 static gboolean
 wifi_nl80211_indicate_addressing_running (WifiData *data, gboolean running)
@@ -1035,6 +1428,7 @@ wifi_nl80211_init (const char *iface, int ifindex)
 	WifiDataNl80211 *nl80211;
 	struct nl_msg *msg;
 	struct nl80211_device_info device_info = {};
+	int mlme_group = -1;
 
 	nl80211 = wifi_data_new (iface, ifindex, sizeof (*nl80211));
 	nl80211->parent.get_mode = wifi_nl80211_get_mode;
@@ -1045,6 +1439,7 @@ wifi_nl80211_init (const char *iface, int ifindex)
 	nl80211->parent.get_bssid = wifi_nl80211_get_bssid;
 	nl80211->parent.get_rate = wifi_nl80211_get_rate;
 	nl80211->parent.get_qual = wifi_nl80211_get_qual;
+	nl80211->parent.request_station = wifi_nl80211_request_station;
 #if HAVE_NL80211_CRITICAL_PROTOCOL_CMDS
 	nl80211->parent.indicate_addressing_running = wifi_nl80211_indicate_addressing_running;
 #endif
@@ -1057,7 +1452,7 @@ wifi_nl80211_init (const char *iface, int ifindex)
 	if (nl_connect (nl80211->nl_sock, NETLINK_GENERIC))
 		goto error;
 
-	nl80211->id = genl_ctrl_resolve (nl80211->nl_sock, "nl80211");
+	nl80211->id = genl_ctrl_resolve (nl80211->nl_sock, "nl80211", "mlme", &mlme_group);
 	if (nl80211->id < 0)
 		goto error;
 
@@ -1120,6 +1515,8 @@ wifi_nl80211_init (const char *iface, int ifindex)
 	if (device_info.can_wowlan)
 		nl80211->parent.get_wowlan = wifi_nl80211_get_wowlan;
 
+	nl80211_event_init (nl80211, mlme_group);
+
 	nm_log_info (LOGD_PLATFORM | LOGD_WIFI,
 	             "(%s): using nl80211 for WiFi device control",
 	             nl80211->parent.iface);
@@ -1131,3 +1528,59 @@ error:
 	return NULL;
 }
 
+/*****************************************************************************/
+
+WifiData *
+_wifi_nl80211_new_for_testing (const char *iface, int ifindex)
+{
+	WifiDataNl80211 *nl80211;
+
+	nl80211 = wifi_data_new (iface, ifindex, sizeof (*nl80211));
+	nl80211->parent.request_station = wifi_nl80211_request_station;
+	nl80211->parent.deinit = wifi_nl80211_deinit;
+	nl80211->phy = -1;
+
+	/* Without the nl80211 family, requests go out with a family id of zero
+	 * and the kernel only acknowledges them. The replies come from the test. */
+	nl80211_event_init (nl80211, -1);
+	if (!nl80211->event_id) {
+		wifi_utils_deinit ((WifiData *) nl80211);
+		return NULL;
+	}
+	return (WifiData *) nl80211;
+}
+
+guint32
+_wifi_nl80211_get_request_seq (WifiData *data)
+{
+	return ((WifiDataNl80211 *) data)->request_seq;
+}
+
+void
+_wifi_nl80211_process_msg (WifiData *data, struct nl_msg *msg)
+{
+	struct nlmsghdr *nlh = nlmsg_hdr (msg);
+
+	/* dispatch like nl_recvmsgs() does for the event socket. */
+	if (nlh->nlmsg_type == NLMSG_DONE)
+		nl80211_event_finish_handler (msg, data);
+	else if (nlh->nlmsg_type == NLMSG_ERROR)
+		nl80211_event_error_handler (NULL, nlmsg_data (nlh), data);
+	else
+		nl80211_event_handler (msg, data);
+}
+
+void
+_wifi_nl80211_recv_failed (WifiData *data, int err)
+{
+	nl80211_event_recv_failed ((WifiDataNl80211 *) data, err);
+}
+
+void
+_wifi_nl80211_request_timeout (WifiData *data)
+{
+	WifiDataNl80211 *nl80211 = (WifiDataNl80211 *) data;
+
+	if (nm_clear_g_source (&nl80211->request_timeout_id))
+		nl80211_request_timeout_cb (nl80211);
+}
@@ -25,4 +25,12 @@
 
 WifiData *wifi_nl80211_init (const char *iface, int ifindex);
 
+/* for testing */
+struct nl_msg;
+WifiData *_wifi_nl80211_new_for_testing (const char *iface, int ifindex);
+guint32 _wifi_nl80211_get_request_seq (WifiData *data);
+void _wifi_nl80211_process_msg (WifiData *data, struct nl_msg *msg);
+void _wifi_nl80211_recv_failed (WifiData *data, int err);
+void _wifi_nl80211_request_timeout (WifiData *data);
+
 #endif  /* __WIFI_UTILS_NL80211_H__ */
@@ -52,6 +52,14 @@ struct WifiData {
 	 */
 	int (*get_qual) (WifiData *data);
 
+	/* Request quality and bitrate asynchronously; the result is reported
+	 * with wifi_data_station_changed().
+	 */
+	gboolean (*request_station) (WifiData *data);
+
+	WifiStationFunc station_func;
+	gpointer station_user_data;
+
 	void (*deinit) (WifiData *data);
 
 	gboolean (*get_wowlan) (WifiData *data);
@@ -71,5 +79,6 @@ struct WifiData {
 
 gpointer wifi_data_new (const char *iface, int ifindex, gsize len);
 void wifi_data_free (WifiData *data);
+void wifi_data_station_changed (WifiData *data, int quality, guint32 rate);
 
 #endif  /* __WIFI_UTILS_PRIVATE_H__ */
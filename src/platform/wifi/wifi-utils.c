@@ -56,6 +56,13 @@ wifi_data_free (WifiData *data)
 	g_free (data);
 }
 
+void
+wifi_data_station_changed (WifiData *data, int quality, guint32 rate)
+{
+	if (data->station_func)
+		data->station_func (data, quality, rate, data->station_user_data);
+}
+
 /*****************************************************************************/
 
 WifiData *
@@ -165,6 +172,23 @@ wifi_utils_get_qual (WifiData *data)
 	return data->get_qual (data);
 }
 
+void
+wifi_utils_set_station_func (WifiData *data, WifiStationFunc func, gpointer user_data)
+{
+	g_return_if_fail (data != NULL);
+
+	data->station_func = func;
+	data->station_user_data = user_data;
+}
+
+gboolean
+wifi_utils_request_station (WifiData *data)
+{
+	g_return_val_if_fail (data != NULL, FALSE);
+
+	return data->request_station ? data->request_station (data) : FALSE;
+}
+
 gboolean
 wifi_utils_get_wowlan (WifiData *data)
 {
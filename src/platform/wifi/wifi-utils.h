@@ -28,6 +28,9 @@
 
 typedef struct WifiData WifiData;
 
+/* @quality is 0 - 100%, or -1 if unknown; @rate is in Kbps */
+typedef void (*WifiStationFunc) (WifiData *data, int quality, guint32 rate, gpointer user_data);
+
 gboolean wifi_utils_is_wifi (int dirfd, const char *ifname);
 
 WifiData *wifi_utils_init (const char *iface, int ifindex, gboolean check_scan);
@@ -60,6 +63,12 @@ guint32 wifi_utils_get_rate (WifiData *data);
 /* Returns quality 0 - 100% on succes, or -1 on error */
 int wifi_utils_get_qual (WifiData *data);
 
+void wifi_utils_set_station_func (WifiData *data, WifiStationFunc func, gpointer user_data);
+
+/* Requests quality and bitrate of the current BSS without blocking. The result
+ * is passed to the station func. Returns FALSE if not supported. */
+gboolean wifi_utils_request_station (WifiData *data);
+
 /* Tells the driver DHCP or SLAAC is running */
 gboolean wifi_utils_indicate_addressing_running (WifiData *data, gboolean running);
 
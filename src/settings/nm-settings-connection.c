@@ -42,6 +42,10 @@
 #define SETTINGS_TIMESTAMPS_FILE  NMSTATEDIR "/timestamps"
 #define SETTINGS_SEEN_BSSIDS_FILE NMSTATEDIR "/seen-bssids"
 
+/* Changes to the timestamps and seen-bssids databases are kept in memory
+ * and written out at most once per this many seconds. */
+#define SETTINGS_DB_FLUSH_DELAY_SEC 10
+
 #define AUTOCONNECT_RETRIES_UNSET       -2
 #define AUTOCONNECT_RETRIES_FOREVER     -1
 #define AUTOCONNECT_RETRIES_DEFAULT      4
@@ -141,6 +145,124 @@ G_DEFINE_TYPE_WITH_CODE (NMSettingsConnection, nm_settings_connection, NM_TYPE_E
 
 /*****************************************************************************/
 
+/* The timestamps and seen-bssids files are keyfiles with one entry per
+ * connection UUID. Each is parsed once and then served from memory;
+ * modifications mark it dirty and are written out coalesced. */
+typedef struct {
+	const char *filename;
+	const char *group;
+	char list_separator;
+	GKeyFile *keyfile;
+	guint flush_id;
+	bool dirty:1;
+} SettingsDb;
+
+static SettingsDb _db_timestamps = {
+	.filename = SETTINGS_TIMESTAMPS_FILE,
+	.group = "timestamps",
+};
+
+static SettingsDb _db_seen_bssids = {
+	.filename = SETTINGS_SEEN_BSSIDS_FILE,
+	.group = "seen-bssids",
+	.list_separator = ',',
+};
+
+static GKeyFile *
+_db_get (SettingsDb *db)
+{
+	gs_free_error GError *error = NULL;
+
+	if (G_LIKELY (db->keyfile))
+		return db->keyfile;
+
+	db->keyfile = g_key_file_new ();
+	if (db->list_separator)
+		g_key_file_set_list_separator (db->keyfile, db->list_separator);
+	if (!g_key_file_load_from_file (db->keyfile, db->filename, G_KEY_FILE_KEEP_COMMENTS, &error)) {
+		if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+			nm_log_warn (LOGD_SETTINGS, "error parsing %s file '%s': %s",
+			             db->group, db->filename, error->message);
+		}
+	}
+	return db->keyfile;
+}
+
+static void
+_db_write (SettingsDb *db)
+{
+	gs_free char *data = NULL;
+	gs_free_error GError *error = NULL;
+	gsize len;
+
+	nm_clear_g_source (&db->flush_id);
+
+	if (!db->dirty)
+		return;
+
+	/* g_file_set_contents() replaces the file atomically. */
+	data = g_key_file_to_data (db->keyfile, &len, NULL);
+	if (!g_file_set_contents (db->filename, data, len, &error)) {
+		/* stay dirty, so that the next change or flush retries. */
+		nm_log_warn (LOGD_SETTINGS, "error writing %s file '%s': %s",
+		             db->group, db->filename, error->message);
+		return;
+	}
+	db->dirty = FALSE;
+}
+
+static gboolean
+_db_flush_cb (gpointer user_data)
+{
+	SettingsDb *db = user_data;
+
+	db->flush_id = 0;
+	_db_write (db);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+_db_set_dirty (SettingsDb *db)
+{
+	db->dirty = TRUE;
+	if (!db->flush_id)
+		db->flush_id = g_timeout_add_seconds (SETTINGS_DB_FLUSH_DELAY_SEC, _db_flush_cb, db);
+}
+
+/**
+ * nm_settings_connection_flush_databases:
+ *
+ * Writes pending changes of the timestamps and seen-bssids databases
+ * to disk right away.
+ **/
+void
+nm_settings_connection_flush_databases (void)
+{
+	_db_write (&_db_timestamps);
+	_db_write (&_db_seen_bssids);
+}
+
+static void
+_db_reset (SettingsDb *db, const char *filename)
+{
+	nm_clear_g_source (&db->flush_id);
+	g_clear_pointer (&db->keyfile, g_key_file_unref);
+	db->dirty = FALSE;
+	db->filename = filename;
+}
+
+/* for testing: use other files and drop the cached content, so that
+ * they are read again. The strings must stay valid. */
+void
+_nm_settings_connection_set_database_files (const char *timestamps_file,
+                                            const char *seen_bssids_file)
+{
+	_db_reset (&_db_timestamps, timestamps_file ?: SETTINGS_TIMESTAMPS_FILE);
+	_db_reset (&_db_seen_bssids, seen_bssids_file ?: SETTINGS_SEEN_BSSIDS_FILE);
+}
+
+/*****************************************************************************/
+
 static void
 _emit_updated (NMSettingsConnection *self, gboolean by_user)
 {
@@ -701,39 +823,16 @@ nm_settings_connection_delete (NMSettingsConnection *self,
 }
 
 static void
-remove_entry_from_db (NMSettingsConnection *self, const char* db_name)
+remove_entry_from_db (NMSettingsConnection *self, SettingsDb *db)
 {
-	GKeyFile *key_file;
-	const char *db_file;
+	const char *connection_uuid;
 
-	if (strcmp (db_name, "timestamps") == 0)
-		db_file = SETTINGS_TIMESTAMPS_FILE;
-	else if (strcmp (db_name, "seen-bssids") == 0)
-		db_file = SETTINGS_SEEN_BSSIDS_FILE;
-	else
+	connection_uuid = nm_settings_connection_get_uuid (self);
+	if (!connection_uuid)
 		return;
 
-	key_file = g_key_file_new ();
-	if (g_key_file_load_from_file (key_file, db_file, G_KEY_FILE_KEEP_COMMENTS, NULL)) {
-		const char *connection_uuid;
-		char *data;
-		gsize len;
-		GError *error = NULL;
-
-		connection_uuid = nm_settings_connection_get_uuid (self);
-
-		g_key_file_remove_key (key_file, db_name, connection_uuid, NULL);
-		data = g_key_file_to_data (key_file, &len, &error);
-		if (data) {
-			g_file_set_contents (db_file, data, len, &error);
-			g_free (data);
-		}
-		if (error) {
-			_LOGW ("error writing %s file '%s': %s", db_name, db_file, error->message);
-			g_error_free (error);
-		}
-	}
-	g_key_file_free (key_file);
+	if (g_key_file_remove_key (_db_get (db), db->group, connection_uuid, NULL))
+		_db_set_dirty (db);
 }
 
 static void
@@ -756,10 +855,10 @@ do_delete (NMSettingsConnection *self,
 	g_object_unref (for_agents);
 
 	/* Remove timestamp from timestamps database file */
-	remove_entry_from_db (self, "timestamps");
+	remove_entry_from_db (self, &_db_timestamps);
 
 	/* Remove connection from seen-bssids database file */
-	remove_entry_from_db (self, "seen-bssids");
+	remove_entry_from_db (self, &_db_seen_bssids);
 
 	nm_settings_connection_signal_remove (self);
 
@@ -1539,6 +1638,8 @@ typedef struct {
 	NMConnection *new_settings;
 	gboolean save_to_disk;
 	char *audit_args;
+	NMSettingsConnectionCommitFunc callback;
+	gpointer callback_data;
 } UpdateInfo;
 
 typedef struct {
@@ -1605,7 +1706,9 @@ update_complete (NMSettingsConnection *self,
                  UpdateInfo *info,
                  GError *error)
 {
-	if (error)
+	if (!info->context)
+		info->callback (self, error, info->callback_data);
+	else if (error)
 		g_dbus_method_invocation_return_gerror (info->context, error);
 	else
 		g_dbus_method_invocation_return_value (info->context, NULL);
@@ -1762,6 +1865,96 @@ get_update_modify_permission (NMConnection *old, NMConnection *new)
 	return NM_AUTH_PERMISSION_SETTINGS_MODIFY_SYSTEM;
 }
 
+/**
+ * nm_settings_connection_update_check:
+ * @self: the #NMSettingsConnection
+ * @new_settings: the settings to replace those of @self with
+ * @subject: the requestor
+ * @error: location to store an error on failure
+ *
+ * Checks that @subject may update @self with @new_settings, short of
+ * authorizing the request.
+ *
+ * Returns: the permission that the update must be authorized for, or %NULL
+ *   if the update is not allowed.
+ */
+const char *
+nm_settings_connection_update_check (NMSettingsConnection *self,
+                                     NMConnection *new_settings,
+                                     NMAuthSubject *subject,
+                                     GError **error)
+{
+	char *error_desc = NULL;
+
+	g_return_val_if_fail (NM_IS_SETTINGS_CONNECTION (self), NULL);
+	g_return_val_if_fail (NM_IS_CONNECTION (new_settings), NULL);
+
+	if (!check_writable (NM_CONNECTION (self), error))
+		return NULL;
+
+	/* Ensure the caller can view this connection, like auth_start() does */
+	if (!nm_auth_is_subject_in_acl (NM_CONNECTION (self), subject, &error_desc)) {
+		g_set_error_literal (error,
+		                     NM_SETTINGS_ERROR,
+		                     NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                     error_desc);
+		g_free (error_desc);
+		return NULL;
+	}
+
+	if (!nm_auth_is_subject_in_acl (new_settings, subject, &error_desc)) {
+		g_set_error_literal (error,
+		                     NM_SETTINGS_ERROR,
+		                     NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                     error_desc);
+		g_free (error_desc);
+		return NULL;
+	}
+
+	return get_update_modify_permission (NM_CONNECTION (self), new_settings);
+}
+
+/**
+ * nm_settings_connection_update:
+ * @self: the #NMSettingsConnection
+ * @new_settings: the settings to replace those of @self with
+ * @save_to_disk: whether to commit the new settings to disk
+ * @subject: the requestor, already authorized for the update
+ * @callback: called when the update completes
+ * @user_data: data for @callback
+ *
+ * Performs an update that was already checked with
+ * nm_settings_connection_update_check() and authorized by the caller, the
+ * same way the Update D-Bus method does after authorization.
+ */
+void
+nm_settings_connection_update (NMSettingsConnection *self,
+                               NMConnection *new_settings,
+                               gboolean save_to_disk,
+                               NMAuthSubject *subject,
+                               NMSettingsConnectionCommitFunc callback,
+                               gpointer user_data)
+{
+	NMSettingsConnectionPrivate *priv;
+	UpdateInfo *info;
+
+	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (self));
+	g_return_if_fail (NM_IS_CONNECTION (new_settings));
+	g_return_if_fail (callback);
+
+	priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
+
+	info = g_malloc0 (sizeof (*info));
+	info->agent_mgr = g_object_ref (priv->agent_mgr);
+	info->subject = g_object_ref (subject);
+	info->save_to_disk = save_to_disk;
+	info->new_settings = g_object_ref (new_settings);
+	info->callback = callback;
+	info->callback_data = user_data;
+
+	update_auth_cb (self, NULL, subject, NULL, info);
+}
+
 static void
 settings_connection_update_helper (NMSettingsConnection *self,
                                    GDBusMethodInvocation *context,
@@ -2189,6 +2382,8 @@ nm_settings_connection_get_timestamp (NMSettingsConnection *self,
  * @flush_to_disk: if %TRUE, commit timestamp update to persistent storage
  *
  * Updates the connection and timestamps database with the provided timestamp.
+ * The database is written to disk shortly after, see
+ * nm_settings_connection_flush_databases().
  **/
 void
 nm_settings_connection_update_timestamp (NMSettingsConnection *self,
@@ -2197,10 +2392,7 @@ nm_settings_connection_update_timestamp (NMSettingsConnection *self,
 {
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
 	const char *connection_uuid;
-	GKeyFile *timestamps_file;
-	char *data, *tmp;
-	gsize len;
-	GError *error = NULL;
+	char tmp[30];
 
 	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (self));
 
@@ -2211,29 +2403,12 @@ nm_settings_connection_update_timestamp (NMSettingsConnection *self,
 	if (flush_to_disk == FALSE)
 		return;
 
-	/* Save timestamp to timestamps database file */
-	timestamps_file = g_key_file_new ();
-	if (!g_key_file_load_from_file (timestamps_file, SETTINGS_TIMESTAMPS_FILE, G_KEY_FILE_KEEP_COMMENTS, &error)) {
-		if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
-			_LOGW ("error parsing timestamps file '%s': %s", SETTINGS_TIMESTAMPS_FILE, error->message);
-		g_clear_error (&error);
-	}
-
+	/* Save timestamp to timestamps database. The file is written
+	 * out later, together with other pending changes. */
 	connection_uuid = nm_settings_connection_get_uuid (self);
-	tmp = g_strdup_printf ("%" G_GUINT64_FORMAT, timestamp);
-	g_key_file_set_value (timestamps_file, "timestamps", connection_uuid, tmp);
-	g_free (tmp);
-
-	data = g_key_file_to_data (timestamps_file, &len, &error);
-	if (data) {
-		g_file_set_contents (SETTINGS_TIMESTAMPS_FILE, data, len, &error);
-		g_free (data);
-	}
-	if (error) {
-		_LOGW ("error saving timestamp to file '%s': %s", SETTINGS_TIMESTAMPS_FILE, error->message);
-		g_error_free (error);
-	}
-	g_key_file_free (timestamps_file);
+	nm_sprintf_buf (tmp, "%" G_GUINT64_FORMAT, timestamp);
+	g_key_file_set_value (_db_get (&_db_timestamps), _db_timestamps.group, connection_uuid, tmp);
+	_db_set_dirty (&_db_timestamps);
 }
 
 /**
@@ -2249,17 +2424,14 @@ nm_settings_connection_read_and_fill_timestamp (NMSettingsConnection *self)
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
 	const char *connection_uuid;
 	guint64 timestamp = 0;
-	GKeyFile *timestamps_file;
 	GError *err = NULL;
 	char *tmp_str;
 
 	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (self));
 
-	/* Get timestamp from database file */
-	timestamps_file = g_key_file_new ();
-	g_key_file_load_from_file (timestamps_file, SETTINGS_TIMESTAMPS_FILE, G_KEY_FILE_KEEP_COMMENTS, NULL);
+	/* Get timestamp from database */
 	connection_uuid = nm_settings_connection_get_uuid (self);
-	tmp_str = g_key_file_get_value (timestamps_file, "timestamps", connection_uuid, &err);
+	tmp_str = g_key_file_get_value (_db_get (&_db_timestamps), _db_timestamps.group, connection_uuid, &err);
 	if (tmp_str) {
 		timestamp = g_ascii_strtoull (tmp_str, NULL, 10);
 		g_free (tmp_str);
@@ -2273,7 +2445,6 @@ nm_settings_connection_read_and_fill_timestamp (NMSettingsConnection *self)
 		_LOGD ("failed to read connection timestamp: %s", err->message);
 		g_clear_error (&err);
 	}
-	g_key_file_free (timestamps_file);
 }
 
 /**
@@ -2330,6 +2501,7 @@ nm_settings_connection_has_seen_bssid (NMSettingsConnection *self,
  * the seen-bssids database
  *
  * Updates the connection and seen-bssids database with the provided BSSID.
+ * Like for timestamps, the database is written to disk with a delay.
  **/
 void
 nm_settings_connection_add_seen_bssid (NMSettingsConnection *self,
@@ -2337,11 +2509,8 @@ nm_settings_connection_add_seen_bssid (NMSettingsConnection *self,
 {
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
 	const char *connection_uuid;
-	GKeyFile *seen_bssids_file;
-	char *data, *bssid_str;
+	char *bssid_str;
 	const char **list;
-	gsize len;
-	GError *error = NULL;
 	GHashTableIter iter;
 	guint n;
 
@@ -2361,33 +2530,11 @@ nm_settings_connection_add_seen_bssid (NMSettingsConnection *self,
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &bssid_str))
 		list[n++] = bssid_str;
 
-	/* Save BSSID to seen-bssids file */
-	seen_bssids_file = g_key_file_new ();
-	g_key_file_set_list_separator (seen_bssids_file, ',');
-	if (!g_key_file_load_from_file (seen_bssids_file, SETTINGS_SEEN_BSSIDS_FILE, G_KEY_FILE_KEEP_COMMENTS, &error)) {
-		if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
-			_LOGW ("error parsing seen-bssids file '%s': %s",
-			       SETTINGS_SEEN_BSSIDS_FILE, error->message);
-		}
-		g_clear_error (&error);
-	}
-
+	/* Save BSSID to seen-bssids database */
 	connection_uuid = nm_settings_connection_get_uuid (self);
-	g_key_file_set_string_list (seen_bssids_file, "seen-bssids", connection_uuid, list, n);
+	g_key_file_set_string_list (_db_get (&_db_seen_bssids), _db_seen_bssids.group, connection_uuid, list, n);
 	g_free (list);
-
-	data = g_key_file_to_data (seen_bssids_file, &len, &error);
-	if (data) {
-		g_file_set_contents (SETTINGS_SEEN_BSSIDS_FILE, data, len, &error);
-		g_free (data);
-	}
-	g_key_file_free (seen_bssids_file);
-
-	if (error) {
-		_LOGW ("error saving seen-bssids to file '%s': %s",
-		       SETTINGS_SEEN_BSSIDS_FILE, error->message);
-		g_error_free (error);
-	}
+	_db_set_dirty (&_db_seen_bssids);
 }
 
 /**
@@ -2402,19 +2549,13 @@ nm_settings_connection_read_and_fill_seen_bssids (NMSettingsConnection *self)
 {
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
 	const char *connection_uuid;
-	GKeyFile *seen_bssids_file;
 	char **tmp_strv = NULL;
 	gsize i, len = 0;
 	NMSettingWireless *s_wifi;
 
-	/* Get seen BSSIDs from database file */
-	seen_bssids_file = g_key_file_new ();
-	g_key_file_set_list_separator (seen_bssids_file, ',');
-	if (g_key_file_load_from_file (seen_bssids_file, SETTINGS_SEEN_BSSIDS_FILE, G_KEY_FILE_KEEP_COMMENTS, NULL)) {
-		connection_uuid = nm_settings_connection_get_uuid (self);
-		tmp_strv = g_key_file_get_string_list (seen_bssids_file, "seen-bssids", connection_uuid, &len, NULL);
-	}
-	g_key_file_free (seen_bssids_file);
+	/* Get seen BSSIDs from database */
+	connection_uuid = nm_settings_connection_get_uuid (self);
+	tmp_strv = g_key_file_get_string_list (_db_get (&_db_seen_bssids), _db_seen_bssids.group, connection_uuid, &len, NULL);
 
 	/* Update connection's seen-bssids */
 	if (tmp_strv) {
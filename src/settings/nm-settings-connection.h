@@ -146,6 +146,18 @@ void nm_settings_connection_replace_and_commit (NMSettingsConnection *self,
                                                 NMSettingsConnectionCommitFunc callback,
                                                 gpointer user_data);
 
+const char *nm_settings_connection_update_check (NMSettingsConnection *self,
+                                                 NMConnection *new_settings,
+                                                 NMAuthSubject *subject,
+                                                 GError **error);
+
+void nm_settings_connection_update (NMSettingsConnection *self,
+                                    NMConnection *new_settings,
+                                    gboolean save_to_disk,
+                                    NMAuthSubject *subject,
+                                    NMSettingsConnectionCommitFunc callback,
+                                    gpointer user_data);
+
 void nm_settings_connection_delete (NMSettingsConnection *self,
                                     NMSettingsConnectionDeleteFunc callback,
                                     gpointer user_data);
@@ -203,6 +215,12 @@ void nm_settings_connection_add_seen_bssid (NMSettingsConnection *self,
 
 void nm_settings_connection_read_and_fill_seen_bssids (NMSettingsConnection *self);
 
+void nm_settings_connection_flush_databases (void);
+
+/* for testing */
+void _nm_settings_connection_set_database_files (const char *timestamps_file,
+                                                 const char *seen_bssids_file);
+
 int nm_settings_connection_get_autoconnect_retries (NMSettingsConnection *self);
 void nm_settings_connection_set_autoconnect_retries (NMSettingsConnection *self,
                                                      int retries);
@@ -156,6 +156,11 @@ typedef struct {
 	GSList *unmanaged_specs;
 	GSList *unrecognized_specs;
 
+	/* the specs compiled for matching. They are rebuilt whenever
+	 * the plugins report changed specs. */
+	NMMatchSpecCompiled *unmanaged_specs_compiled;
+	NMMatchSpecCompiled *unrecognized_specs_compiled;
+
 	gboolean started;
 	gboolean startup_complete;
 
@@ -514,12 +519,12 @@ nm_settings_has_connection (NMSettings *self, NMSettingsConnection *connection)
 	return FALSE;
 }
 
-const GSList *
+const NMMatchSpecCompiled *
 nm_settings_get_unmanaged_specs (NMSettings *self)
 {
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
 
-	return priv->unmanaged_specs;
+	return priv->unmanaged_specs_compiled;
 }
 
 static NMSettingsPlugin *
@@ -681,6 +686,7 @@ find_spec (GSList *spec_list, const char *spec)
 
 static void
 update_specs (NMSettings *self, GSList **specs_ptr,
+              NMMatchSpecCompiled **specs_compiled_ptr,
               GSList * (*get_specs_func) (NMSettingsPlugin *))
 {
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
@@ -688,6 +694,7 @@ update_specs (NMSettings *self, GSList **specs_ptr,
 
 	g_slist_free_full (*specs_ptr, g_free);
 	*specs_ptr = NULL;
+	g_clear_pointer (specs_compiled_ptr, nm_match_spec_compiled_free);
 
 	for (iter = priv->plugins; iter; iter = g_slist_next (iter)) {
 		GSList *specs, *specs_iter;
@@ -702,6 +709,8 @@ update_specs (NMSettings *self, GSList **specs_ptr,
 
 		g_slist_free (specs);
 	}
+
+	*specs_compiled_ptr = nm_match_spec_compile (*specs_ptr);
 }
 
 static void
@@ -712,6 +721,7 @@ unmanaged_specs_changed (NMSettingsPlugin *config,
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
 
 	update_specs (self, &priv->unmanaged_specs,
+	              &priv->unmanaged_specs_compiled,
 	              nm_settings_plugin_get_unmanaged_specs);
 	_notify (self, PROP_UNMANAGED_SPECS);
 }
@@ -724,6 +734,7 @@ unrecognized_specs_changed (NMSettingsPlugin *config,
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
 
 	update_specs (self, &priv->unrecognized_specs,
+	              &priv->unrecognized_specs_compiled,
 	              nm_settings_plugin_get_unrecognized_specs);
 }
 
@@ -1524,6 +1535,412 @@ impl_settings_add_connection_unsaved (NMSettings *self,
 	impl_settings_add_connection_helper (self, context, settings, FALSE);
 }
 
+/*****************************************************************************/
+
+typedef struct _BulkRequest BulkRequest;
+
+typedef struct {
+	BulkRequest *request;
+	NMSettingsConnection *target;
+	NMConnection *connection;
+	const char *perm;
+	GError *error;
+	char *path;
+} BulkItem;
+
+struct _BulkRequest {
+	NMSettings *self;
+	GDBusMethodInvocation *context;
+	NMAuthSubject *subject;
+	gboolean update;
+	guint n_pending;
+	guint len;
+	BulkItem items[];
+};
+
+static BulkRequest *
+bulk_request_new (NMSettings *self,
+                  GDBusMethodInvocation *context,
+                  NMAuthSubject *subject,
+                  gboolean update,
+                  guint len)
+{
+	BulkRequest *request;
+	guint i;
+
+	request = g_malloc0 (sizeof (BulkRequest) + len * sizeof (BulkItem));
+	request->self = g_object_ref (self);
+	request->context = context;
+	request->subject = g_object_ref (subject);
+	request->update = update;
+	request->len = len;
+	for (i = 0; i < len; i++)
+		request->items[i].request = request;
+	return request;
+}
+
+static void
+bulk_request_free (gpointer data)
+{
+	BulkRequest *request = data;
+	guint i;
+
+	for (i = 0; i < request->len; i++) {
+		BulkItem *item = &request->items[i];
+
+		g_clear_object (&item->target);
+		g_clear_object (&item->connection);
+		g_clear_error (&item->error);
+		g_free (item->path);
+	}
+	g_object_unref (request->subject);
+	g_object_unref (request->self);
+	g_free (request);
+}
+
+static void
+bulk_request_return (BulkRequest *request)
+{
+	GVariantBuilder builder;
+	guint i;
+
+	if (request->update) {
+		g_variant_builder_init (&builder, G_VARIANT_TYPE ("as"));
+		for (i = 0; i < request->len; i++) {
+			BulkItem *item = &request->items[i];
+
+			g_variant_builder_add (&builder, "s",
+			                       item->error ? item->error->message : "");
+		}
+		g_dbus_method_invocation_return_value (request->context,
+		                                       g_variant_new ("(as)", &builder));
+	} else {
+		g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(os)"));
+		for (i = 0; i < request->len; i++) {
+			BulkItem *item = &request->items[i];
+
+			g_variant_builder_add (&builder, "(os)",
+			                       item->path ?: "/",
+			                       item->error ? item->error->message : "");
+		}
+		g_dbus_method_invocation_return_value (request->context,
+		                                       g_variant_new ("(a(os))", &builder));
+	}
+}
+
+static void
+bulk_request_unpend (BulkRequest *request)
+{
+	if (--request->n_pending > 0)
+		return;
+
+	bulk_request_return (request);
+	bulk_request_free (request);
+}
+
+static void
+bulk_update_cb (NMSettingsConnection *connection,
+                GError *error,
+                gpointer user_data)
+{
+	BulkItem *item = user_data;
+
+	if (error)
+		item->error = g_error_copy (error);
+	bulk_request_unpend (item->request);
+}
+
+static void
+bulk_item_add (BulkItem *item)
+{
+	BulkRequest *request = item->request;
+	NMSettingsConnection *added;
+
+	added = nm_settings_add_connection (request->self, item->connection, TRUE, &item->error);
+	if (added) {
+		item->path = g_strdup (nm_connection_get_path (NM_CONNECTION (added)));
+		send_agent_owned_secrets (request->self, added, request->subject);
+	}
+	nm_audit_log_connection_op (NM_AUDIT_OP_CONN_ADD, added, !!added, NULL,
+	                            request->subject,
+	                            item->error ? item->error->message : NULL);
+}
+
+static void
+bulk_item_update (BulkItem *item)
+{
+	BulkRequest *request = item->request;
+
+	if (!nm_settings_has_connection (request->self, item->target)) {
+		item->error = g_error_new_literal (NM_SETTINGS_ERROR,
+		                                   NM_SETTINGS_ERROR_INVALID_CONNECTION,
+		                                   "The connection was removed.");
+		return;
+	}
+
+	request->n_pending++;
+	nm_settings_connection_update (item->target,
+	                               item->connection,
+	                               TRUE,
+	                               request->subject,
+	                               bulk_update_cb,
+	                               item);
+}
+
+static void
+pk_bulk_cb (NMAuthChain *chain,
+            GError *chain_error,
+            GDBusMethodInvocation *context,
+            gpointer user_data)
+{
+	NMSettings *self = NM_SETTINGS (user_data);
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	BulkRequest *request;
+	guint i;
+
+	priv->auths = g_slist_remove (priv->auths, chain);
+
+	request = nm_auth_chain_steal_data (chain, "request");
+	g_assert (request);
+
+	/* Keep the request alive until the loop is done, so that it is
+	 * answered once. */
+	request->n_pending = 1;
+
+	g_object_freeze_notify (G_OBJECT (self));
+
+	for (i = 0; i < request->len; i++) {
+		BulkItem *item = &request->items[i];
+
+		if (item->error)
+			continue;
+
+		if (chain_error) {
+			item->error = g_error_new (NM_SETTINGS_ERROR,
+			                           NM_SETTINGS_ERROR_FAILED,
+			                           "Error checking authorization: %s",
+			                           chain_error->message);
+		} else if (nm_auth_chain_get_result (chain, item->perm) != NM_AUTH_CALL_RESULT_YES) {
+			item->error = g_error_new_literal (NM_SETTINGS_ERROR,
+			                                   NM_SETTINGS_ERROR_PERMISSION_DENIED,
+			                                   "Insufficient privileges.");
+		} else {
+			if (request->update)
+				bulk_item_update (item);
+			else
+				bulk_item_add (item);
+			continue;
+		}
+
+		nm_audit_log_connection_op (request->update ? NM_AUDIT_OP_CONN_UPDATE : NM_AUDIT_OP_CONN_ADD,
+		                            item->target, FALSE, NULL, request->subject,
+		                            item->error->message);
+	}
+
+	g_object_thaw_notify (G_OBJECT (self));
+
+	nm_auth_chain_unref (chain);
+	bulk_request_unpend (request);
+}
+
+static void
+bulk_request_authorize (BulkRequest *request)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (request->self);
+	NMAuthChain *chain;
+	gboolean need_own = FALSE, need_system = FALSE;
+	guint i;
+
+	for (i = 0; i < request->len; i++) {
+		const char *perm = request->items[i].perm;
+
+		if (request->items[i].error)
+			continue;
+		if (perm == NM_AUTH_PERMISSION_SETTINGS_MODIFY_OWN)
+			need_own = TRUE;
+		else
+			need_system = TRUE;
+	}
+
+	if (!need_own && !need_system) {
+		/* Nothing left to authorize; every item already failed. */
+		bulk_request_return (request);
+		bulk_request_free (request);
+		return;
+	}
+
+	chain = nm_auth_chain_new_subject (request->subject, request->context, pk_bulk_cb, request->self);
+	if (!chain) {
+		g_dbus_method_invocation_return_error_literal (request->context,
+		                                               NM_SETTINGS_ERROR,
+		                                               NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                                               "Unable to authenticate the request.");
+		bulk_request_free (request);
+		return;
+	}
+
+	priv->auths = g_slist_append (priv->auths, chain);
+	nm_auth_chain_set_data (chain, "request", request, bulk_request_free);
+	if (need_own)
+		nm_auth_chain_add_call (chain, NM_AUTH_PERMISSION_SETTINGS_MODIFY_OWN, TRUE);
+	if (need_system)
+		nm_auth_chain_add_call (chain, NM_AUTH_PERMISSION_SETTINGS_MODIFY_SYSTEM, TRUE);
+}
+
+static NMConnection *
+bulk_connection_new_from_dbus (GVariant *settings, GError **error)
+{
+	NMConnection *connection;
+
+	connection = _nm_simple_connection_new_from_dbus (settings,
+	                                                    NM_SETTING_PARSE_FLAGS_STRICT
+	                                                  | NM_SETTING_PARSE_FLAGS_NORMALIZE,
+	                                                  error);
+	if (connection && !nm_connection_verify_secrets (connection, error))
+		g_clear_object (&connection);
+	return connection;
+}
+
+static void
+impl_settings_add_connections (NMSettings *self,
+                               GDBusMethodInvocation *context,
+                               GVariant *connections)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	gs_unref_object NMAuthSubject *subject = NULL;
+	gs_unref_hashtable GHashTable *uuids = NULL;
+	BulkRequest *request;
+	GHashTableIter iter;
+	NMSettingsConnection *candidate;
+	guint i;
+
+	if (!get_plugin (self, NM_SETTINGS_PLUGIN_CAP_MODIFY_CONNECTIONS)) {
+		g_dbus_method_invocation_return_error_literal (context,
+		                                               NM_SETTINGS_ERROR,
+		                                               NM_SETTINGS_ERROR_NOT_SUPPORTED,
+		                                               "None of the registered plugins support add.");
+		return;
+	}
+
+	subject = nm_auth_subject_new_unix_process_from_context (context);
+	if (!subject) {
+		g_dbus_method_invocation_return_error_literal (context,
+		                                               NM_SETTINGS_ERROR,
+		                                               NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                                               "Unable to determine UID of request.");
+		return;
+	}
+
+	/* Index the existing UUIDs once instead of scanning per profile */
+	uuids = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_iter_init (&iter, priv->connections);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &candidate))
+		g_hash_table_add (uuids, (gpointer) nm_settings_connection_get_uuid (candidate));
+
+	request = bulk_request_new (self, context, subject, FALSE,
+	                            g_variant_n_children (connections));
+
+	for (i = 0; i < request->len; i++) {
+		BulkItem *item = &request->items[i];
+		gs_unref_variant GVariant *settings = NULL;
+		NMSettingConnection *s_con;
+		char *error_desc = NULL;
+
+		settings = g_variant_get_child_value (connections, i);
+		item->connection = bulk_connection_new_from_dbus (settings, &item->error);
+		if (!item->connection)
+			goto next;
+
+		if (is_adhoc_wpa (item->connection)) {
+			item->error = g_error_new_literal (NM_SETTINGS_ERROR,
+			                                   NM_SETTINGS_ERROR_INVALID_CONNECTION,
+			                                   "WPA Ad-Hoc disabled due to kernel bugs");
+			goto next;
+		}
+
+		if (!nm_auth_is_subject_in_acl (item->connection, subject, &error_desc)) {
+			item->error = g_error_new_literal (NM_SETTINGS_ERROR,
+			                                   NM_SETTINGS_ERROR_PERMISSION_DENIED,
+			                                   error_desc);
+			g_free (error_desc);
+			goto next;
+		}
+
+		if (!nm_g_hash_table_add (uuids, (gpointer) nm_connection_get_uuid (item->connection))) {
+			item->error = g_error_new_literal (NM_SETTINGS_ERROR,
+			                                   NM_SETTINGS_ERROR_UUID_EXISTS,
+			                                   "A connection with this UUID already exists.");
+			goto next;
+		}
+
+		s_con = nm_connection_get_setting_connection (item->connection);
+		if (nm_setting_connection_get_num_permissions (s_con) == 1)
+			item->perm = NM_AUTH_PERMISSION_SETTINGS_MODIFY_OWN;
+		else
+			item->perm = NM_AUTH_PERMISSION_SETTINGS_MODIFY_SYSTEM;
+
+next:
+		if (item->error)
+			nm_audit_log_connection_op (NM_AUDIT_OP_CONN_ADD, NULL, FALSE, NULL, subject, item->error->message);
+	}
+
+	bulk_request_authorize (request);
+}
+
+static void
+impl_settings_update_connections (NMSettings *self,
+                                  GDBusMethodInvocation *context,
+                                  GVariant *connections)
+{
+	gs_unref_object NMAuthSubject *subject = NULL;
+	BulkRequest *request;
+	guint i;
+
+	subject = nm_auth_subject_new_unix_process_from_context (context);
+	if (!subject) {
+		g_dbus_method_invocation_return_error_literal (context,
+		                                               NM_SETTINGS_ERROR,
+		                                               NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                                               "Unable to determine UID of request.");
+		return;
+	}
+
+	request = bulk_request_new (self, context, subject, TRUE,
+	                            g_variant_n_children (connections));
+
+	for (i = 0; i < request->len; i++) {
+		BulkItem *item = &request->items[i];
+		gs_unref_variant GVariant *settings = NULL;
+		const char *path;
+		NMSettingsConnection *target;
+
+		g_variant_get_child (connections, i, "(&o@a{sa{sv}})", &path, &settings);
+
+		target = nm_settings_get_connection_by_path (self, path);
+		if (!target) {
+			item->error = g_error_new_literal (NM_SETTINGS_ERROR,
+			                                   NM_SETTINGS_ERROR_INVALID_CONNECTION,
+			                                   "Connection could not be found.");
+			nm_audit_log_connection_op (NM_AUDIT_OP_CONN_UPDATE, NULL, FALSE, NULL,
+			                            subject, item->error->message);
+			continue;
+		}
+		item->target = g_object_ref (target);
+
+		item->connection = bulk_connection_new_from_dbus (settings, &item->error);
+		if (item->connection) {
+			item->perm = nm_settings_connection_update_check (target, item->connection,
+			                                                  subject, &item->error);
+		}
+		if (item->error) {
+			nm_audit_log_connection_op (NM_AUDIT_OP_CONN_UPDATE, target, FALSE, NULL,
+			                            subject, item->error->message);
+		}
+	}
+
+	bulk_request_authorize (request);
+}
+
 static void
 impl_settings_load_connections (NMSettings *self,
                                 GDBusMethodInvocation *context,
@@ -1927,7 +2344,7 @@ have_connection_for_device (NMSettings *self, NMDevice *device)
 	}
 
 	/* See if there's a known non-NetworkManager configuration for the device */
-	if (nm_device_spec_match_list (device, priv->unrecognized_specs))
+	if (nm_device_spec_match_list (device, priv->unrecognized_specs_compiled))
 		return TRUE;
 
 	return FALSE;
@@ -2337,7 +2754,7 @@ get_property (GObject *object, guint prop_id,
 {
 	NMSettings *self = NM_SETTINGS (object);
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
-	const GSList *specs, *iter;
+	const GSList *iter;
 	GHashTableIter citer;
 	GPtrArray *array;
 	const char *path;
@@ -2345,8 +2762,7 @@ get_property (GObject *object, guint prop_id,
 	switch (prop_id) {
 	case PROP_UNMANAGED_SPECS:
 		array = g_ptr_array_new ();
-		specs = nm_settings_get_unmanaged_specs (self);
-		for (iter = specs; iter; iter = g_slist_next (iter))
+		for (iter = priv->unmanaged_specs; iter; iter = g_slist_next (iter))
 			g_ptr_array_add (array, g_strdup (iter->data));
 		g_ptr_array_add (array, NULL);
 		g_value_take_boxed (value, (char **) g_ptr_array_free (array, FALSE));
@@ -2456,6 +2872,8 @@ finalize (GObject *object)
 
 	g_slist_free_full (priv->unmanaged_specs, g_free);
 	g_slist_free_full (priv->unrecognized_specs, g_free);
+	nm_match_spec_compiled_free (priv->unmanaged_specs_compiled);
+	nm_match_spec_compiled_free (priv->unrecognized_specs_compiled);
 
 	g_slist_free_full (priv->plugins, g_object_unref);
 
@@ -2562,6 +2980,8 @@ nm_settings_class_init (NMSettingsClass *class)
 	                                        "GetConnectionByUuid", impl_settings_get_connection_by_uuid,
 	                                        "AddConnection", impl_settings_add_connection,
 	                                        "AddConnectionUnsaved", impl_settings_add_connection_unsaved,
+	                                        "AddConnections", impl_settings_add_connections,
+	                                        "UpdateConnections", impl_settings_update_connections,
 	                                        "LoadConnections", impl_settings_load_connections,
 	                                        "ReloadConnections", impl_settings_reload_connections,
 	                                        "SaveHostname", impl_settings_save_hostname,
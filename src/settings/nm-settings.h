@@ -118,7 +118,7 @@ NMSettingsConnection *nm_settings_get_connection_by_uuid (NMSettings *settings,
 
 gboolean nm_settings_has_connection (NMSettings *self, NMSettingsConnection *connection);
 
-const GSList *nm_settings_get_unmanaged_specs (NMSettings *self);
+const NMMatchSpecCompiled *nm_settings_get_unmanaged_specs (NMSettings *self);
 
 char *nm_settings_get_hostname (NMSettings *self);
 
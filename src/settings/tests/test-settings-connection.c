@@ -0,0 +1,287 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <pwd.h>
+#include <sys/stat.h>
+
+#include "nm-common-macros.h"
+#include "nm-auth-manager.h"
+#include "nm-auth-subject.h"
+#include "settings/nm-settings-connection.h"
+
+#include "nm-test-utils-core.h"
+
+#define UUID_1 "8b9ddeb3-ba9c-4d93-9ab1-1a6e5b7e5a91"
+#define UUID_2 "4e4e3b3c-6e0a-4a8e-a1f8-0e1e41c3d6f2"
+
+typedef struct {
+	char *dir;
+	char *subdir;
+	char *timestamps_file;
+	char *seen_bssids_file;
+} Fixture;
+
+static void
+fixture_setup (Fixture *f, gconstpointer user_data)
+{
+	GError *error = NULL;
+
+	f->dir = g_dir_make_tmp ("nm-test-settings-connection-XXXXXX", &error);
+	g_assert_no_error (error);
+
+	/* the files are in a directory that doesn't exist yet, so that
+	 * a test can make writing them fail. */
+	f->subdir = g_build_filename (f->dir, "state", NULL);
+	f->timestamps_file = g_build_filename (f->subdir, "timestamps", NULL);
+	f->seen_bssids_file = g_build_filename (f->subdir, "seen-bssids", NULL);
+	_nm_settings_connection_set_database_files (f->timestamps_file, f->seen_bssids_file);
+}
+
+static void
+fixture_teardown (Fixture *f, gconstpointer user_data)
+{
+	_nm_settings_connection_set_database_files (NULL, NULL);
+
+	unlink (f->timestamps_file);
+	unlink (f->seen_bssids_file);
+	rmdir (f->subdir);
+	rmdir (f->dir);
+	g_free (f->timestamps_file);
+	g_free (f->seen_bssids_file);
+	g_free (f->subdir);
+	g_free (f->dir);
+}
+
+static NMSettingsConnection *
+_connection_new (const char *uuid)
+{
+	gs_unref_object NMConnection *con = NULL;
+	NMSettingsConnection *self;
+
+	con = nmtst_create_minimal_connection ("test", uuid, NM_SETTING_WIRED_SETTING_NAME, NULL);
+	self = g_object_new (NM_TYPE_SETTINGS_CONNECTION, NULL);
+	nm_connection_replace_settings_from_connection (NM_CONNECTION (self), con);
+	return self;
+}
+
+static void
+_mkdir (Fixture *f)
+{
+	g_assert_cmpint (mkdir (f->subdir, 0755), ==, 0);
+}
+
+static char *
+_read_value (const char *filename, const char *group, const char *key)
+{
+	gs_free_error GError *error = NULL;
+	GKeyFile *keyfile;
+	char *value;
+
+	keyfile = g_key_file_new ();
+	g_key_file_load_from_file (keyfile, filename, G_KEY_FILE_NONE, &error);
+	g_assert_no_error (error);
+	value = g_key_file_get_value (keyfile, group, key, NULL);
+	g_key_file_unref (keyfile);
+	return value;
+}
+
+/*****************************************************************************/
+
+static void
+test_timestamps_roundtrip (Fixture *f, gconstpointer user_data)
+{
+	gs_unref_object NMSettingsConnection *c1 = NULL;
+	gs_unref_object NMSettingsConnection *c2 = NULL;
+	gs_free char *value = NULL;
+	guint64 timestamp = 0;
+
+	_mkdir (f);
+
+	c1 = _connection_new (UUID_1);
+	c2 = _connection_new (UUID_2);
+
+	nm_settings_connection_update_timestamp (c1, 1000, TRUE);
+	nm_settings_connection_update_timestamp (c1, 2000, TRUE);
+
+	/* only kept in memory */
+	nm_settings_connection_update_timestamp (c2, 3000, FALSE);
+	g_assert (nm_settings_connection_get_timestamp (c2, &timestamp));
+	g_assert_cmpint (timestamp, ==, 3000);
+
+	/* the write is delayed */
+	g_assert (!g_file_test (f->timestamps_file, G_FILE_TEST_EXISTS));
+
+	nm_settings_connection_flush_databases ();
+
+	value = _read_value (f->timestamps_file, "timestamps", UUID_1);
+	g_assert_cmpstr (value, ==, "2000");
+	g_clear_pointer (&value, g_free);
+	value = _read_value (f->timestamps_file, "timestamps", UUID_2);
+	g_assert_cmpstr (value, ==, NULL);
+
+	/* read back from disk, not from the cached keyfile */
+	_nm_settings_connection_set_database_files (f->timestamps_file, f->seen_bssids_file);
+	g_clear_object (&c1);
+	c1 = _connection_new (UUID_1);
+	g_assert (!nm_settings_connection_get_timestamp (c1, NULL));
+	nm_settings_connection_read_and_fill_timestamp (c1);
+	g_assert (nm_settings_connection_get_timestamp (c1, &timestamp));
+	g_assert_cmpint (timestamp, ==, 2000);
+}
+
+static void
+test_timestamps_write_failure (Fixture *f, gconstpointer user_data)
+{
+	gs_unref_object NMSettingsConnection *c1 = NULL;
+	gs_free char *value = NULL;
+
+	c1 = _connection_new (UUID_1);
+	nm_settings_connection_update_timestamp (c1, 1000, TRUE);
+
+	/* the directory is missing, writing fails */
+	g_test_expect_message ("NetworkManager", G_LOG_LEVEL_MESSAGE,
+	                       "*error writing timestamps file*");
+	nm_settings_connection_flush_databases ();
+	g_test_assert_expected_messages ();
+	g_assert (!g_file_test (f->timestamps_file, G_FILE_TEST_EXISTS));
+
+	/* the change is still pending and written by the next flush */
+	_mkdir (f);
+	nm_settings_connection_flush_databases ();
+
+	value = _read_value (f->timestamps_file, "timestamps", UUID_1);
+	g_assert_cmpstr (value, ==, "1000");
+}
+
+static void
+test_seen_bssids (Fixture *f, gconstpointer user_data)
+{
+	gs_unref_object NMSettingsConnection *c1 = NULL;
+	gs_free char **bssids = NULL;
+
+	_mkdir (f);
+
+	c1 = _connection_new (UUID_1);
+	nm_settings_connection_add_seen_bssid (c1, "00:11:22:33:44:55");
+	g_assert (!g_file_test (f->seen_bssids_file, G_FILE_TEST_EXISTS));
+
+	nm_settings_connection_flush_databases ();
+	g_assert (g_file_test (f->seen_bssids_file, G_FILE_TEST_EXISTS));
+
+	_nm_settings_connection_set_database_files (f->timestamps_file, f->seen_bssids_file);
+	g_clear_object (&c1);
+	c1 = _connection_new (UUID_1);
+	g_assert (!nm_settings_connection_has_seen_bssid (c1, "00:11:22:33:44:55"));
+	nm_settings_connection_read_and_fill_seen_bssids (c1);
+	g_assert (nm_settings_connection_has_seen_bssid (c1, "00:11:22:33:44:55"));
+
+	/* the strings are owned by the connection */
+	bssids = nm_settings_connection_get_seen_bssids (c1);
+	g_assert (bssids);
+	g_assert_cmpint (g_strv_length (bssids), ==, 1);
+}
+
+/*****************************************************************************/
+
+static NMConnection *
+_connection_new_with_owner (const char *uuid, const char *user)
+{
+	NMConnection *con;
+
+	con = nmtst_create_minimal_connection ("test", uuid, NM_SETTING_WIRED_SETTING_NAME, NULL);
+	g_assert (nm_setting_connection_add_permission (nm_connection_get_setting_connection (con),
+	                                                "user", user, NULL));
+	return con;
+}
+
+static void
+test_update_check_acl (void)
+{
+	gs_unref_object NMSettingsConnection *self = NULL;
+	gs_unref_object NMConnection *mine = NULL;
+	gs_unref_object NMConnection *other = NULL;
+	gs_unref_object NMAuthSubject *subject = NULL;
+	GError *error = NULL;
+	struct passwd *pw;
+	const char *perm;
+
+	pw = getpwnam ("nobody");
+	if (!pw || pw->pw_uid == 0) {
+		g_test_skip ("no unprivileged user \"nobody\"");
+		return;
+	}
+
+	subject = g_object_new (NM_TYPE_AUTH_SUBJECT,
+	                        NM_AUTH_SUBJECT_SUBJECT_TYPE, (int) NM_AUTH_SUBJECT_TYPE_UNIX_PROCESS,
+	                        NM_AUTH_SUBJECT_UNIX_PROCESS_DBUS_SENDER, ":1.42",
+	                        NM_AUTH_SUBJECT_UNIX_PROCESS_PID, (gulong) getpid (),
+	                        NM_AUTH_SUBJECT_UNIX_PROCESS_UID, (gulong) pw->pw_uid,
+	                        NULL);
+	g_assert (nm_auth_subject_is_unix_process (subject));
+
+	mine = _connection_new_with_owner (UUID_1, pw->pw_name);
+	other = _connection_new_with_owner (UUID_1, "root");
+
+	self = g_object_new (NM_TYPE_SETTINGS_CONNECTION, NULL);
+
+	/* the subject may not see the existing connection, even though the
+	 * new settings would grant access. */
+	nm_connection_replace_settings_from_connection (NM_CONNECTION (self), other);
+	perm = nm_settings_connection_update_check (self, mine, subject, &error);
+	g_assert_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_PERMISSION_DENIED);
+	g_assert (!perm);
+	g_clear_error (&error);
+
+	/* nor take over a connection to hand it to someone else */
+	nm_connection_replace_settings_from_connection (NM_CONNECTION (self), mine);
+	perm = nm_settings_connection_update_check (self, other, subject, &error);
+	g_assert_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_PERMISSION_DENIED);
+	g_assert (!perm);
+	g_clear_error (&error);
+
+	perm = nm_settings_connection_update_check (self, mine, subject, &error);
+	g_assert_no_error (error);
+	g_assert_cmpstr (perm, ==, NM_AUTH_PERMISSION_SETTINGS_MODIFY_OWN);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	nmtst_init_assert_logging (&argc, &argv, "INFO", "DEFAULT");
+
+	/* NMSettingsConnection needs the auth manager singleton. */
+	nm_auth_manager_setup (FALSE);
+
+	g_test_add ("/settings/connection/timestamps/roundtrip", Fixture, NULL,
+	            fixture_setup, test_timestamps_roundtrip, fixture_teardown);
+	g_test_add ("/settings/connection/timestamps/write-failure", Fixture, NULL,
+	            fixture_setup, test_timestamps_write_failure, fixture_teardown);
+	g_test_add ("/settings/connection/seen-bssids", Fixture, NULL,
+	            fixture_setup, test_seen_bssids, fixture_teardown);
+	g_test_add_func ("/settings/connection/update-check/acl", test_update_check_acl);
+
+	return g_test_run ();
+}
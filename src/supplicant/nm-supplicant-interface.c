@@ -84,7 +84,12 @@ typedef struct {
 	GCancellable * assoc_cancellable;
 	char *         net_path;
 	guint32        blobs_left;
-	GHashTable *   bss_proxies;
+	GHashTable *   bss_infos;
+	GPtrArray *    bss_fetch_queue;
+	guint          bss_fetch_id;
+	GCancellable * bss_cancellable;
+	GDBusConnection *bss_connection;
+	guint          bss_props_changed_id;
 	char *         current_bss;
 
 	gint32         last_scan; /* timestamp as returned by nm_utils_get_monotonic_timestamp_s() */
@@ -139,103 +144,311 @@ emit_error_helper (NMSupplicantInterface *self, GError *error)
 	g_free (name);
 }
 
+/* State of a BSS as reported by wpa_supplicant. We don't create a #GDBusProxy
+ * for every BSS, as each of them would add its own match rule to the bus.
+ * Instead, PropertiesChanged for all BSSs of the interface is received by
+ * one subscription and the properties are tracked here. */
+typedef struct _BssFetchData BssFetchData;
+
+typedef struct {
+	char *path;
+	GHashTable *props;
+	/* the pending GetAll call, if any */
+	BssFetchData *fetch;
+	bool inited:1;
+} BssInfo;
+
+struct _BssFetchData {
+	NMSupplicantInterface *self;
+	/* cleared when the BSS goes away while the call is pending */
+	BssInfo *info;
+};
+
 static void
-bss_props_changed_cb (GDBusProxy *proxy,
-                      GVariant *changed_properties,
-                      char **invalidated_properties,
-                      gpointer user_data)
+bss_info_free (gpointer data)
 {
-	NMSupplicantInterface *self = NM_SUPPLICANT_INTERFACE (user_data);
-	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+	BssInfo *info = data;
 
-	if (priv->scanning)
-		priv->last_scan = nm_utils_get_monotonic_timestamp_s ();
+	if (info->fetch)
+		info->fetch->info = NULL;
+	g_hash_table_unref (info->props);
+	g_free (info->path);
+	g_slice_free (BssInfo, info);
+}
 
-	g_signal_emit (self, signals[BSS_UPDATED], 0,
-	               g_dbus_proxy_get_object_path (proxy),
-	               changed_properties);
+static void
+bss_info_merge_props (BssInfo *info, GVariant *props)
+{
+	GVariantIter iter;
+	const char *name;
+	GVariant *value;
+
+	g_variant_iter_init (&iter, props);
+	while (g_variant_iter_next (&iter, "{&sv}", &name, &value))
+		g_hash_table_insert (info->props, g_strdup (name), value);
 }
 
 static GVariant *
-_get_bss_proxy_properties (NMSupplicantInterface *self, GDBusProxy *proxy)
+bss_info_get_props (BssInfo *info)
 {
-	gs_strfreev char **properties = NULL;
 	GVariantBuilder builder;
-	char **iter;
-
-	iter = properties = g_dbus_proxy_get_cached_property_names (proxy);
-	if (!iter)
-		return NULL;
+	GHashTableIter iter;
+	const char *name;
+	GVariant *value;
 
 	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
-	while (*iter) {
-		GVariant *copy = g_dbus_proxy_get_cached_property (proxy, *iter);
+	g_hash_table_iter_init (&iter, info->props);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &name, (gpointer *) &value))
+		g_variant_builder_add (&builder, "{sv}", name, value);
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
 
-		g_variant_builder_add (&builder, "{sv}", *iter++, copy);
-		g_variant_unref (copy);
-	}
+static void
+bss_info_emit_new (NMSupplicantInterface *self, BssInfo *info)
+{
+	gs_unref_variant GVariant *props = NULL;
+
+	props = bss_info_get_props (info);
+	g_signal_emit (self, signals[NEW_BSS], 0, info->path, props);
+}
+
+static gboolean
+bss_path_is_ours (NMSupplicantInterface *self, const char *object_path)
+{
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+	gsize len;
 
-	return g_variant_builder_end (&builder);
+	if (!priv->object_path)
+		return FALSE;
+	len = strlen (priv->object_path);
+	return    strncmp (object_path, priv->object_path, len) == 0
+	       && object_path[len] == '/';
 }
 
-#define BSS_PROXY_INITED "bss-proxy-inited"
+static void
+bss_props_changed_cb (GDBusConnection *connection,
+                      const char *sender_name,
+                      const char *object_path,
+                      const char *interface_name,
+                      const char *signal_name,
+                      GVariant *parameters,
+                      gpointer user_data)
+{
+	NMSupplicantInterface *self = NM_SUPPLICANT_INTERFACE (user_data);
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+	gs_unref_variant GVariant *changed_properties = NULL;
+	BssInfo *info;
+
+	if (!g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(sa{sv}as)")))
+		return;
+	if (!bss_path_is_ours (self, object_path))
+		return;
+
+	info = g_hash_table_lookup (priv->bss_infos, object_path);
+	if (!info)
+		return;
+
+	g_variant_get (parameters, "(&s@a{sv}as)", NULL, &changed_properties, NULL);
+
+	/* Property changes that arrive while GetAll is pending are older than
+	 * its reply, so just record them. */
+	bss_info_merge_props (info, changed_properties);
+	if (!info->inited)
+		return;
+
+	if (priv->scanning)
+		priv->last_scan = nm_utils_get_monotonic_timestamp_s ();
+
+	g_signal_emit (self, signals[BSS_UPDATED], 0,
+	               object_path,
+	               changed_properties);
+}
 
 static void
-on_bss_proxy_acquired (GDBusProxy *proxy, GAsyncResult *result, gpointer user_data)
+bss_get_all_cb (GDBusConnection *connection, GAsyncResult *result, gpointer user_data)
 {
+	BssFetchData *data = user_data;
 	NMSupplicantInterface *self;
+	NMSupplicantInterfacePrivate *priv;
 	gs_free_error GError *error = NULL;
+	gs_unref_variant GVariant *variant = NULL;
 	gs_unref_variant GVariant *props = NULL;
+	BssInfo *info;
 
-	if (!g_async_initable_init_finish (G_ASYNC_INITABLE (proxy), result, &error)) {
-		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
-			self = NM_SUPPLICANT_INTERFACE (user_data);
-			_LOGD ("failed to acquire BSS proxy: (%s)", error->message);
-			g_hash_table_remove (NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self)->bss_proxies,
-			                     g_dbus_proxy_get_object_path (proxy));
-		}
+	self = data->self;
+	info = data->info;
+	g_slice_free (BssFetchData, data);
+
+	variant = g_dbus_connection_call_finish (connection, result, &error);
+
+	/* The BSS was removed, or the interface unsubscribed, while the call
+	 * was pending. A BSS with the same path might have been added since,
+	 * but this reply is not for it. */
+	if (!info)
+		return;
+	info->fetch = NULL;
+
+	if (   !variant
+	    && g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		return;
+
+	priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+
+	if (!variant) {
+		_LOGD ("failed to get BSS properties for %s: (%s)", info->path, error->message);
+		g_hash_table_remove (priv->bss_infos, info->path);
 		return;
 	}
 
-	self = NM_SUPPLICANT_INTERFACE (user_data);
-	props = _get_bss_proxy_properties (self, proxy);
-	if (!props)
+	/* BSSAdded already provided the properties. */
+	if (info->inited)
 		return;
 
-	g_object_set_data (G_OBJECT (proxy), BSS_PROXY_INITED, GUINT_TO_POINTER (TRUE));
+	g_variant_get (variant, "(@a{sv})", &props);
+	bss_info_merge_props (info, props);
+	info->inited = TRUE;
+	bss_info_emit_new (self, info);
+}
+
+static gboolean
+bss_fetch_cb (gpointer user_data)
+{
+	NMSupplicantInterface *self = user_data;
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+	gs_unref_ptrarray GPtrArray *queue = NULL;
+	guint i;
 
-	g_signal_emit (self, signals[NEW_BSS], 0,
-	               g_dbus_proxy_get_object_path (proxy),
-	               g_variant_ref_sink (props));
+	priv->bss_fetch_id = 0;
+
+	queue = priv->bss_fetch_queue;
+	priv->bss_fetch_queue = NULL;
+	if (!queue)
+		return G_SOURCE_REMOVE;
+
+	_LOGD ("fetching properties of %u new BSSs", queue->len);
+
+	/* Issue all GetAll calls at once without waiting for the replies
+	 * in between. */
+	for (i = 0; i < queue->len; i++) {
+		const char *path = queue->pdata[i];
+		BssFetchData *data;
+		BssInfo *info;
+
+		info = g_hash_table_lookup (priv->bss_infos, path);
+		if (!info || info->inited || info->fetch)
+			continue;
+
+		data = g_slice_new (BssFetchData);
+		data->self = self;
+		data->info = info;
+		info->fetch = data;
+		g_dbus_connection_call (priv->bss_connection,
+		                        WPAS_DBUS_SERVICE,
+		                        path,
+		                        DBUS_INTERFACE_PROPERTIES,
+		                        "GetAll",
+		                        g_variant_new ("(s)", WPAS_DBUS_IFACE_BSS),
+		                        G_VARIANT_TYPE ("(a{sv})"),
+		                        G_DBUS_CALL_FLAGS_NONE,
+		                        -1,
+		                        priv->bss_cancellable,
+		                        (GAsyncReadyCallback) bss_get_all_cb,
+		                        data);
+	}
+	return G_SOURCE_REMOVE;
 }
 
 static void
-handle_new_bss (NMSupplicantInterface *self, const char *object_path)
+bss_queue_fetch (NMSupplicantInterface *self, const char *object_path)
 {
 	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
-	GDBusProxy *bss_proxy;
+
+	if (!priv->bss_fetch_queue)
+		priv->bss_fetch_queue = g_ptr_array_new_with_free_func (g_free);
+	g_ptr_array_add (priv->bss_fetch_queue, g_strdup (object_path));
+	if (!priv->bss_fetch_id)
+		priv->bss_fetch_id = g_idle_add (bss_fetch_cb, self);
+}
+
+static void
+handle_new_bss (NMSupplicantInterface *self, const char *object_path, GVariant *props)
+{
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+	BssInfo *info;
 
 	g_return_if_fail (object_path != NULL);
 
-	if (g_hash_table_lookup (priv->bss_proxies, object_path))
+	info = g_hash_table_lookup (priv->bss_infos, object_path);
+	if (!info) {
+		info = g_slice_new0 (BssInfo);
+		info->path = g_strdup (object_path);
+		info->props = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
+		g_hash_table_insert (priv->bss_infos, info->path, info);
+	} else if (info->inited)
 		return;
 
-	bss_proxy = g_object_new (G_TYPE_DBUS_PROXY,
-	                          "g-bus-type", G_BUS_TYPE_SYSTEM,
-	                          "g-flags", G_DBUS_PROXY_FLAGS_NONE,
-	                          "g-name", WPAS_DBUS_SERVICE,
-	                          "g-object-path", object_path,
-	                          "g-interface-name", WPAS_DBUS_IFACE_BSS,
-	                          NULL);
-	g_hash_table_insert (priv->bss_proxies,
-	                     (char *) g_dbus_proxy_get_object_path (bss_proxy),
-	                     bss_proxy);
-	g_signal_connect (bss_proxy, "g-properties-changed", G_CALLBACK (bss_props_changed_cb), self);
-	g_async_initable_init_async (G_ASYNC_INITABLE (bss_proxy),
-	                             G_PRIORITY_DEFAULT,
-	                             priv->other_cancellable,
-	                             (GAsyncReadyCallback) on_bss_proxy_acquired,
-	                             self);
+	if (props) {
+		/* BSSAdded carries all properties of the BSS, no need to fetch them. */
+		bss_info_merge_props (info, props);
+		info->inited = TRUE;
+		bss_info_emit_new (self, info);
+		return;
+	}
+
+	/* Before the interface proxy is ready, bss_subscribe() queues the fetch. */
+	if (priv->bss_connection)
+		bss_queue_fetch (self, object_path);
+}
+
+static void
+bss_subscribe (NMSupplicantInterface *self)
+{
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+	GHashTableIter iter;
+	BssInfo *info;
+
+	if (priv->bss_props_changed_id)
+		return;
+
+	priv->bss_connection = g_object_ref (g_dbus_proxy_get_connection (priv->iface_proxy));
+	priv->bss_props_changed_id = g_dbus_connection_signal_subscribe (priv->bss_connection,
+	                                                                 WPAS_DBUS_SERVICE,         /* name */
+	                                                                 DBUS_INTERFACE_PROPERTIES, /* interface */
+	                                                                 "PropertiesChanged",       /* signal name */
+	                                                                 NULL,                      /* path */
+	                                                                 WPAS_DBUS_IFACE_BSS,       /* arg0 */
+	                                                                 G_DBUS_SIGNAL_FLAGS_NONE,
+	                                                                 bss_props_changed_cb,
+	                                                                 self,
+	                                                                 NULL);
+
+	g_hash_table_iter_init (&iter, priv->bss_infos);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
+		if (!info->inited)
+			bss_queue_fetch (self, info->path);
+	}
+}
+
+static void
+bss_unsubscribe (NMSupplicantInterface *self)
+{
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+
+	nm_clear_g_source (&priv->bss_fetch_id);
+	g_clear_pointer (&priv->bss_fetch_queue, g_ptr_array_unref);
+
+	/* don't let pending GetAll replies emit BSSs anymore. */
+	if (priv->bss_cancellable) {
+		g_cancellable_cancel (priv->bss_cancellable);
+		g_clear_object (&priv->bss_cancellable);
+		priv->bss_cancellable = g_cancellable_new ();
+	}
+
+	if (priv->bss_props_changed_id) {
+		g_dbus_connection_signal_unsubscribe (priv->bss_connection, priv->bss_props_changed_id);
+		priv->bss_props_changed_id = 0;
+	}
+	g_clear_object (&priv->bss_connection);
 }
 
 static void
@@ -274,6 +487,7 @@ set_state (NMSupplicantInterface *self, guint32 new_state)
 
 		if (priv->iface_proxy)
 			g_signal_handlers_disconnect_by_data (priv->iface_proxy, self);
+		bss_unsubscribe (self);
 	}
 
 	priv->state = new_state;
@@ -583,10 +797,8 @@ wpas_iface_scan_done (GDBusProxy *proxy,
 {
 	NMSupplicantInterface *self = NM_SUPPLICANT_INTERFACE (user_data);
 	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
-	GVariant *props;
 	GHashTableIter iter;
-	char *bss_path;
-	GDBusProxy *bss_proxy;
+	BssInfo *info;
 
 	/* Cache last scan completed time */
 	priv->last_scan = nm_utils_get_monotonic_timestamp_s ();
@@ -594,17 +806,10 @@ wpas_iface_scan_done (GDBusProxy *proxy,
 	g_signal_emit (self, signals[SCAN_DONE], 0, success);
 
 	/* Emit NEW_BSS so that wifi device has the APs (in case it removed them) */
-	g_hash_table_iter_init (&iter, priv->bss_proxies);
-	while (g_hash_table_iter_next (&iter, (gpointer) &bss_path, (gpointer) &bss_proxy)) {
-		if (g_object_get_data (G_OBJECT (bss_proxy), BSS_PROXY_INITED)) {
-			props = _get_bss_proxy_properties (self, bss_proxy);
-			if (props) {
-				g_signal_emit (self, signals[NEW_BSS], 0,
-				               bss_path,
-				               g_variant_ref_sink (props));
-				g_variant_unref (props);
-			}
-		}
+	g_hash_table_iter_init (&iter, priv->bss_infos);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
+		if (info->inited)
+			bss_info_emit_new (self, info);
 	}
 }
 
@@ -620,7 +825,7 @@ wpas_iface_bss_added (GDBusProxy *proxy,
 	if (priv->scanning)
 		priv->last_scan = nm_utils_get_monotonic_timestamp_s ();
 
-	handle_new_bss (self, path);
+	handle_new_bss (self, path, props);
 }
 
 static void
@@ -632,7 +837,7 @@ wpas_iface_bss_removed (GDBusProxy *proxy,
 	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
 
 	g_signal_emit (self, signals[BSS_REMOVED], 0, path);
-	g_hash_table_remove (priv->bss_proxies, path);
+	g_hash_table_remove (priv->bss_infos, path);
 }
 
 static void
@@ -680,7 +885,7 @@ props_changed_cb (GDBusProxy *proxy,
 	if (g_variant_lookup (changed_properties, "BSSs", "^a&o", &array)) {
 		iter = array;
 		while (*iter)
-			handle_new_bss (self, *iter++);
+			handle_new_bss (self, *iter++, NULL);
 		g_free (array);
 	}
 
@@ -734,6 +939,8 @@ on_iface_proxy_acquired (GDBusProxy *proxy, GAsyncResult *result, gpointer user_
 	self = NM_SUPPLICANT_INTERFACE (user_data);
 	priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
 
+	bss_subscribe (self);
+
 	_nm_dbus_signal_connect (priv->iface_proxy, "ScanDone", G_VARIANT_TYPE ("(b)"),
 	                         G_CALLBACK (wpas_iface_scan_done), self);
 	_nm_dbus_signal_connect (priv->iface_proxy, "BSSAdded", G_VARIANT_TYPE ("(oa{sv})"),
@@ -1468,7 +1675,8 @@ nm_supplicant_interface_init (NMSupplicantInterface * self)
 	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
 
 	priv->state = NM_SUPPLICANT_INTERFACE_STATE_INIT;
-	priv->bss_proxies = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
+	priv->bss_infos = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, bss_info_free);
+	priv->bss_cancellable = g_cancellable_new ();
 }
 
 static void
@@ -1537,8 +1745,11 @@ dispose (GObject *object)
 	nm_clear_g_cancellable (&priv->other_cancellable);
 	nm_clear_g_cancellable (&priv->assoc_cancellable);
 
+	bss_unsubscribe ((NMSupplicantInterface *) object);
+	nm_clear_g_cancellable (&priv->bss_cancellable);
+
 	g_clear_object (&priv->wpas_proxy);
-	g_clear_pointer (&priv->bss_proxies, (GDestroyNotify) g_hash_table_destroy);
+	g_clear_pointer (&priv->bss_infos, (GDestroyNotify) g_hash_table_destroy);
 
 	g_clear_pointer (&priv->net_path, g_free);
 	g_clear_pointer (&priv->dev, g_free);
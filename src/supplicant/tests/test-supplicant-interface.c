@@ -0,0 +1,410 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include <string.h>
+
+#include "nm-dbus-compat.h"
+#include "supplicant/nm-supplicant-interface.h"
+#include "supplicant/nm-supplicant-types.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************
+ * A minimal wpa_supplicant on a private bus. The GetAll calls for BSSs are
+ * held back, so that the test decides when and in which order they are
+ * answered.
+ *****************************************************************************/
+
+#define WPAS_DBUS_IFACE_INTERFACE WPAS_DBUS_INTERFACE ".Interface"
+
+#define IFACE_PATH  WPAS_DBUS_PATH "/Interfaces/0"
+#define BSS_PATH(n) IFACE_PATH "/BSSs/" G_STRINGIFY (n)
+
+static const char *const mock_xml =
+	"<node>"
+	"  <interface name='" WPAS_DBUS_INTERFACE "'>"
+	"    <method name='CreateInterface'>"
+	"      <arg name='args' type='a{sv}' direction='in'/>"
+	"      <arg name='path' type='o' direction='out'/>"
+	"    </method>"
+	"    <method name='GetInterface'>"
+	"      <arg name='ifname' type='s' direction='in'/>"
+	"      <arg name='path' type='o' direction='out'/>"
+	"    </method>"
+	"  </interface>"
+	"  <interface name='" WPAS_DBUS_IFACE_INTERFACE "'>"
+	"    <method name='NetworkReply'>"
+	"      <arg name='path' type='o' direction='in'/>"
+	"      <arg name='field' type='s' direction='in'/>"
+	"      <arg name='value' type='s' direction='in'/>"
+	"    </method>"
+	"    <signal name='BSSAdded'>"
+	"      <arg name='path' type='o'/>"
+	"      <arg name='properties' type='a{sv}'/>"
+	"    </signal>"
+	"    <signal name='BSSRemoved'>"
+	"      <arg name='path' type='o'/>"
+	"    </signal>"
+	"    <property name='State' type='s' access='read'/>"
+	"    <property name='BSSs' type='ao' access='read'/>"
+	"    <property name='BSSExpireAge' type='u' access='readwrite'/>"
+	"    <property name='BSSExpireCount' type='u' access='readwrite'/>"
+	"  </interface>"
+	"</node>";
+
+/* the bus is shared by all tests, because the supplicant interface uses
+ * the system bus singleton. */
+static GTestDBus *test_bus;
+
+typedef struct {
+	GDBusConnection *conn;
+	GDBusNodeInfo *node_info;
+	guint reg_ids[2];
+	guint filter_id;
+
+	/* held back GetAll calls, filled from the GDBus worker thread. */
+	GMutex lock;
+	GPtrArray *get_all;
+
+	NMSupplicantInterface *iface;
+	GHashTable *new_bss;
+} Fixture;
+
+static void
+mock_method_call (GDBusConnection *connection,
+                  const char *sender,
+                  const char *object_path,
+                  const char *interface_name,
+                  const char *method_name,
+                  GVariant *parameters,
+                  GDBusMethodInvocation *invocation,
+                  gpointer user_data)
+{
+	if (NM_IN_STRSET (method_name, "CreateInterface", "GetInterface"))
+		g_dbus_method_invocation_return_value (invocation, g_variant_new ("(o)", IFACE_PATH));
+	else if (nm_streq (method_name, "NetworkReply")) {
+		g_dbus_method_invocation_return_dbus_error (invocation,
+		                                            "fi.w1.wpa_supplicant1.InvalidArgs",
+		                                            "invalid network");
+	} else
+		g_assert_not_reached ();
+}
+
+static GVariant *
+mock_get_property (GDBusConnection *connection,
+                   const char *sender,
+                   const char *object_path,
+                   const char *interface_name,
+                   const char *property_name,
+                   GError **error,
+                   gpointer user_data)
+{
+	if (nm_streq (property_name, "State"))
+		return g_variant_new_string ("inactive");
+	if (nm_streq (property_name, "BSSs"))
+		return g_variant_new_objv (NULL, 0);
+	return g_variant_new_uint32 (0);
+}
+
+static gboolean
+mock_set_property (GDBusConnection *connection,
+                   const char *sender,
+                   const char *object_path,
+                   const char *interface_name,
+                   const char *property_name,
+                   GVariant *value,
+                   GError **error,
+                   gpointer user_data)
+{
+	return TRUE;
+}
+
+static const GDBusInterfaceVTable mock_vtable = {
+	.method_call = mock_method_call,
+	.get_property = mock_get_property,
+	.set_property = mock_set_property,
+};
+
+static GDBusMessage *
+mock_filter (GDBusConnection *connection,
+             GDBusMessage *message,
+             gboolean incoming,
+             gpointer user_data)
+{
+	Fixture *f = user_data;
+
+	if (   incoming
+	    && g_dbus_message_get_message_type (message) == G_DBUS_MESSAGE_TYPE_METHOD_CALL
+	    && nm_streq0 (g_dbus_message_get_member (message), "GetAll")
+	    && g_str_has_prefix (g_dbus_message_get_path (message), IFACE_PATH "/BSSs/")) {
+		g_mutex_lock (&f->lock);
+		g_ptr_array_add (f->get_all, message);
+		g_mutex_unlock (&f->lock);
+		return NULL;
+	}
+	return message;
+}
+
+static guint
+mock_get_n_get_all (Fixture *f)
+{
+	guint n;
+
+	g_mutex_lock (&f->lock);
+	n = f->get_all->len;
+	g_mutex_unlock (&f->lock);
+	return n;
+}
+
+static void
+mock_reply_get_all (Fixture *f, guint idx, const char *ssid)
+{
+	gs_unref_object GDBusMessage *reply = NULL;
+	GDBusMessage *call;
+	GVariantBuilder props;
+
+	g_mutex_lock (&f->lock);
+	call = f->get_all->pdata[idx];
+	g_mutex_unlock (&f->lock);
+
+	g_variant_builder_init (&props, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add (&props, "{sv}", "SSID",
+	                       g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, ssid, strlen (ssid), 1));
+
+	reply = g_dbus_message_new_method_reply (call);
+	g_dbus_message_set_body (reply, g_variant_new ("(a{sv})", &props));
+	g_assert (g_dbus_connection_send_message (f->conn, reply, G_DBUS_SEND_MESSAGE_FLAGS_NONE, NULL, NULL));
+}
+
+static void
+mock_emit (Fixture *f, const char *signal_name, GVariant *parameters)
+{
+	g_assert (g_dbus_connection_emit_signal (f->conn, NULL, IFACE_PATH,
+	                                         WPAS_DBUS_IFACE_INTERFACE, signal_name,
+	                                         parameters, NULL));
+}
+
+static void
+mock_announce_bsss (Fixture *f, const char *const *paths)
+{
+	GVariantBuilder changed;
+
+	g_variant_builder_init (&changed, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add (&changed, "{sv}", "BSSs", g_variant_new_objv (paths, -1));
+	g_assert (g_dbus_connection_emit_signal (f->conn, NULL, IFACE_PATH,
+	                                         DBUS_INTERFACE_PROPERTIES, "PropertiesChanged",
+	                                         g_variant_new ("(sa{sv}as)", WPAS_DBUS_IFACE_INTERFACE, &changed, NULL),
+	                                         NULL));
+}
+
+/*****************************************************************************/
+
+static void
+new_bss_cb (NMSupplicantInterface *iface, const char *path, GVariant *props, Fixture *f)
+{
+	gs_unref_variant GVariant *ssid = NULL;
+	const char *data;
+	gsize len;
+
+	ssid = g_variant_lookup_value (props, "SSID", G_VARIANT_TYPE_BYTESTRING);
+	g_assert (ssid);
+	data = g_variant_get_fixed_array (ssid, &len, 1);
+
+	/* each BSS must be announced once, with its latest properties. */
+	g_assert (!g_hash_table_contains (f->new_bss, path));
+	g_hash_table_insert (f->new_bss, g_strdup (path), g_strndup (data, len));
+}
+
+#define iterate_until(condition) \
+	G_STMT_START { \
+		gint64 _end = g_get_monotonic_time () + 5 * G_USEC_PER_SEC; \
+		\
+		while (!(condition)) { \
+			g_assert (g_get_monotonic_time () < _end); \
+			g_main_context_iteration (NULL, FALSE); \
+		} \
+	} G_STMT_END
+
+static void
+iterate_for (guint timeout_ms)
+{
+	gint64 end = g_get_monotonic_time () + timeout_ms * 1000;
+
+	while (g_get_monotonic_time () < end)
+		g_main_context_iteration (NULL, FALSE);
+}
+
+static void
+fixture_setup (Fixture *f, gconstpointer user_data)
+{
+	gs_free_error GError *error = NULL;
+	gs_unref_variant GVariant *ret = NULL;
+
+	if (!test_bus)
+		return;
+
+	f->conn = g_dbus_connection_new_for_address_sync (g_test_dbus_get_bus_address (test_bus),
+	                                                  G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+	                                                  G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+	                                                  NULL, NULL, &error);
+	g_assert_no_error (error);
+
+	g_mutex_init (&f->lock);
+	f->get_all = g_ptr_array_new_with_free_func (g_object_unref);
+	f->filter_id = g_dbus_connection_add_filter (f->conn, mock_filter, f, NULL);
+
+	f->node_info = g_dbus_node_info_new_for_xml (mock_xml, &error);
+	g_assert_no_error (error);
+	f->reg_ids[0] = g_dbus_connection_register_object (f->conn, WPAS_DBUS_PATH,
+	                                                   f->node_info->interfaces[0],
+	                                                   &mock_vtable, f, NULL, &error);
+	g_assert_no_error (error);
+	f->reg_ids[1] = g_dbus_connection_register_object (f->conn, IFACE_PATH,
+	                                                   f->node_info->interfaces[1],
+	                                                   &mock_vtable, f, NULL, &error);
+	g_assert_no_error (error);
+
+	ret = g_dbus_connection_call_sync (f->conn, DBUS_SERVICE_DBUS, DBUS_PATH_DBUS, DBUS_INTERFACE_DBUS,
+	                                   "RequestName", g_variant_new ("(su)", WPAS_DBUS_SERVICE, 4),
+	                                   G_VARIANT_TYPE ("(u)"), G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+	g_assert_no_error (error);
+
+	f->new_bss = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	f->iface = nm_supplicant_interface_new ("wlan-test", TRUE, FALSE, NM_SUPPLICANT_FEATURE_NO);
+	g_signal_connect (f->iface, NM_SUPPLICANT_INTERFACE_NEW_BSS, G_CALLBACK (new_bss_cb), f);
+
+	nm_supplicant_interface_set_supplicant_available (f->iface, TRUE);
+	iterate_until (nm_supplicant_interface_get_state (f->iface) >= NM_SUPPLICANT_INTERFACE_STATE_READY);
+}
+
+static void
+fixture_teardown (Fixture *f, gconstpointer user_data)
+{
+	if (!test_bus)
+		return;
+
+	g_signal_handlers_disconnect_by_data (f->iface, f);
+	g_clear_object (&f->iface);
+	g_hash_table_unref (f->new_bss);
+
+	g_dbus_connection_unregister_object (f->conn, f->reg_ids[0]);
+	g_dbus_connection_unregister_object (f->conn, f->reg_ids[1]);
+	g_dbus_connection_remove_filter (f->conn, f->filter_id);
+	g_dbus_node_info_unref (f->node_info);
+	g_clear_object (&f->conn);
+	g_ptr_array_unref (f->get_all);
+	g_mutex_clear (&f->lock);
+}
+
+/*****************************************************************************/
+
+static void
+test_bss_readded_while_fetching (Fixture *f, gconstpointer user_data)
+{
+	const char *const paths[] = { BSS_PATH (1), BSS_PATH (2), NULL };
+
+	if (!test_bus) {
+		g_test_skip ("dbus-daemon not available");
+		return;
+	}
+
+	mock_announce_bsss (f, paths);
+	iterate_until (mock_get_n_get_all (f) == 2);
+
+	/* BSS 1 goes away and comes back before its properties arrived. */
+	mock_emit (f, "BSSRemoved", g_variant_new ("(o)", BSS_PATH (1)));
+	mock_announce_bsss (f, paths);
+	iterate_until (mock_get_n_get_all (f) == 3);
+
+	/* the stale reply is dropped. As replies are processed in order, it
+	 * is handled before BSS 2 shows up. */
+	g_assert (nm_streq (g_dbus_message_get_path (f->get_all->pdata[0]), BSS_PATH (1)));
+	mock_reply_get_all (f, 0, "stale");
+	mock_reply_get_all (f, 1, "two");
+	iterate_until (g_hash_table_contains (f->new_bss, BSS_PATH (2)));
+	g_assert (!g_hash_table_contains (f->new_bss, BSS_PATH (1)));
+
+	g_assert (nm_streq (g_dbus_message_get_path (f->get_all->pdata[2]), BSS_PATH (1)));
+	mock_reply_get_all (f, 2, "one");
+	iterate_until (g_hash_table_contains (f->new_bss, BSS_PATH (1)));
+	g_assert_cmpstr (g_hash_table_lookup (f->new_bss, BSS_PATH (1)), ==, "one");
+	g_assert_cmpstr (g_hash_table_lookup (f->new_bss, BSS_PATH (2)), ==, "two");
+}
+
+static void
+test_bss_fetch_after_down (Fixture *f, gconstpointer user_data)
+{
+	const char *const paths[] = { BSS_PATH (3), NULL };
+
+	if (!test_bus) {
+		g_test_skip ("dbus-daemon not available");
+		return;
+	}
+
+	mock_announce_bsss (f, paths);
+	iterate_until (mock_get_n_get_all (f) == 1);
+
+	/* the interface is torn down while GetAll is pending. */
+	nm_supplicant_interface_set_supplicant_available (f->iface, FALSE);
+	g_assert_cmpint (nm_supplicant_interface_get_state (f->iface), ==, NM_SUPPLICANT_INTERFACE_STATE_DOWN);
+
+	mock_reply_get_all (f, 0, "three");
+	iterate_for (200);
+	g_assert_cmpint (g_hash_table_size (f->new_bss), ==, 0);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	gs_free char *dbus_daemon = NULL;
+	gs_unref_object GDBusConnection *system_bus = NULL;
+	int result;
+
+	nmtst_init_assert_logging (&argc, &argv, "INFO", "DEFAULT");
+
+	dbus_daemon = g_find_program_in_path ("dbus-daemon");
+	if (dbus_daemon) {
+		test_bus = g_test_dbus_new (G_TEST_DBUS_NONE);
+		g_test_dbus_up (test_bus);
+
+		/* the supplicant interface talks to the system bus. */
+		g_setenv ("DBUS_SYSTEM_BUS_ADDRESS", g_test_dbus_get_bus_address (test_bus), TRUE);
+		system_bus = g_bus_get_sync (G_BUS_TYPE_SYSTEM, NULL, NULL);
+		g_assert (system_bus);
+		g_dbus_connection_set_exit_on_close (system_bus, FALSE);
+	}
+
+	g_test_add ("/supplicant/interface/bss-readded-while-fetching", Fixture, NULL,
+	            fixture_setup, test_bss_readded_while_fetching, fixture_teardown);
+	g_test_add ("/supplicant/interface/bss-fetch-after-down", Fixture, NULL,
+	            fixture_setup, test_bss_fetch_after_down, fixture_teardown);
+
+	result = g_test_run ();
+
+	if (test_bus) {
+		g_test_dbus_down (test_bus);
+		g_clear_object (&test_bus);
+	}
+	return result;
+}
@@ -0,0 +1,766 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-sd.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+#include <netinet/if_ether.h>
+#include <linux/filter.h>
+#include <linux/if_infiniband.h>
+#include <linux/if_packet.h>
+
+#include "nm-sd-adapt.h"
+
+/*****************************************************************************
+ * Shared raw socket for the DHCPv4 clients
+ *
+ * Until it has a lease, the systemd DHCPv4 client receives on a packet
+ * socket. Upstream opens one such socket per client, each with a BPF
+ * filter matching the client's interface, xid and MAC address. With many
+ * interfaces that means many sockets, and every one of them runs its
+ * filter on every IP packet.
+ *
+ * Instead, dhcp_network_bind_raw_socket() is patched to call
+ * nm_sd_dhcp_raw_bind(). All clients using the same port share one packet
+ * socket, whose filter only accepts DHCP replies arriving on one of the
+ * interfaces that currently have a client. Each client gets one end of a
+ * SOCK_SEQPACKET socketpair, so that the systemd code can keep using its
+ * fd unchanged: what the client sends is forwarded to the packet socket,
+ * and the replies are dispatched to the client that matches the ingress
+ * interface, xid and hardware address. When the client closes its end,
+ * it is unregistered.
+ *
+ * The packet socket and the ends of the socketpairs are watched through
+ * one epoll fd, so the main loop polls a single fd no matter how many
+ * clients there are. After handing replies to the clients, the sd_event
+ * is run right away, so that a reply is handled within one wakeup, and
+ * what the clients send in response is forwarded in the same go.
+ *****************************************************************************/
+
+typedef struct {
+	struct iphdr ip;
+	struct udphdr udp;
+	guint8 op;
+	guint8 htype;
+	guint8 hlen;
+	guint8 hops;
+	guint32 xid;
+	guint16 secs;
+	guint16 flags;
+	guint32 ciaddr;
+	guint32 yiaddr;
+	guint32 siaddr;
+	guint32 giaddr;
+	guint8 chaddr[16];
+	guint8 sname[64];
+	guint8 file[128];
+	guint32 magic;
+} _nm_packed DhcpPacket;
+
+#define BOOTREPLY          2
+#define DHCP_MAGIC_COOKIE  0x63825363
+
+/* the jump offsets of classic BPF are 8 bit wide, which limits how many
+ * interfaces the filter can list. Beyond that, the filter accepts DHCP
+ * replies from any interface and unknown ones are dropped on dispatch. */
+#define FILTER_MAX_IFINDEXES G_MAXUINT8
+
+#define BUF_SIZE 65536
+
+/* how many packets to handle per wakeup at most. */
+#define MAX_BURST 64
+
+typedef struct {
+	int ifindex;
+	guint32 xid;
+	guint16 arp_type;
+	guint8 hlen;
+	guint8 chaddr[ETH_ALEN];
+} ClientKey;
+
+typedef struct {
+	/* must be the first field, the client is its own key. */
+	ClientKey key;
+	NMSdDhcpRawMux *mux;
+	union {
+		struct sockaddr_ll ll;
+		guint8 buf[offsetof (struct sockaddr_ll, sll_addr) + INFINIBAND_ALEN];
+	} link;
+	socklen_t link_len;
+	int fd;
+} Client;
+
+struct _NMSdDhcpRawMux {
+	guint16 port;
+	gboolean global;
+	gboolean dispatching;
+	int fd;
+	int epoll_fd;
+	GIOChannel *channel;
+	guint watch_id;
+	GHashTable *clients;
+	GHashTable *clients_by_fd;
+	GHashTable *ifindexes;
+	guint8 *buf;
+};
+
+static GSList *global_muxes;
+
+/*****************************************************************************/
+
+static guint
+client_key_hash (gconstpointer ptr)
+{
+	const ClientKey *key = ptr;
+	guint h;
+	guint i;
+
+	h = (guint) key->ifindex;
+	h = (h * 33) + key->xid;
+	h = (h * 33) + key->arp_type;
+	h = (h * 33) + key->hlen;
+	for (i = 0; i < ETH_ALEN; i++)
+		h = (h * 33) + key->chaddr[i];
+	return h;
+}
+
+static gboolean
+client_key_equal (gconstpointer a, gconstpointer b)
+{
+	const ClientKey *key_a = a;
+	const ClientKey *key_b = b;
+
+	return    key_a->ifindex == key_b->ifindex
+	       && key_a->xid == key_b->xid
+	       && key_a->arp_type == key_b->arp_type
+	       && key_a->hlen == key_b->hlen
+	       && memcmp (key_a->chaddr, key_b->chaddr, ETH_ALEN) == 0;
+}
+
+static void
+client_free (gpointer data)
+{
+	Client *client = data;
+
+	/* closing the fd also removes it from the epoll set. */
+	g_hash_table_remove (client->mux->clients_by_fd, GINT_TO_POINTER (client->fd));
+	close (client->fd);
+	g_slice_free (Client, client);
+}
+
+/*****************************************************************************/
+
+#define _filter_append(array, code, k, jt, jf) \
+	G_STMT_START { \
+		struct sock_filter _insn = { (code), (jt), (jf), (k) }; \
+		\
+		g_array_append_val ((array), _insn); \
+	} G_STMT_END
+
+#define _filter_stmt(array, code, k)  _filter_append (array, code, k, 0, 0)
+#define _filter_ignore(array)         _filter_stmt (array, BPF_RET + BPF_K, 0)
+
+/**
+ * _nm_sd_dhcp_raw_build_filter:
+ * @port: the DHCP client port
+ * @ifindexes: (allow-none): the interfaces to accept replies on
+ * @n_ifindexes: the number of entries in @ifindexes
+ *
+ * Builds the filter of the shared packet socket. It performs the checks
+ * of the upstream per-client filter that don't depend on the client, and
+ * in addition rejects packets that were sent by this host or arrived on
+ * an interface without DHCP client.
+ *
+ * Returns: (transfer full): an array of struct sock_filter.
+ */
+GArray *
+_nm_sd_dhcp_raw_build_filter (guint16 port, const int *ifindexes, guint n_ifindexes)
+{
+	GArray *filter;
+	guint i;
+
+	filter = g_array_new (FALSE, FALSE, sizeof (struct sock_filter));
+
+	_filter_stmt   (filter, BPF_LD + BPF_W + BPF_ABS, SKF_AD_OFF + SKF_AD_PKTTYPE);                /* A <- packet type */
+	_filter_append (filter, BPF_JMP + BPF_JEQ + BPF_K, PACKET_OUTGOING, 0, 1);                     /* outgoing ? */
+	_filter_ignore (filter);
+	_filter_stmt   (filter, BPF_LD + BPF_W + BPF_LEN, 0);                                          /* A <- packet length */
+	_filter_append (filter, BPF_JMP + BPF_JGE + BPF_K, sizeof (DhcpPacket), 1, 0);                 /* packet >= DhcpPacket ? */
+	_filter_ignore (filter);
+	_filter_stmt   (filter, BPF_LD + BPF_B + BPF_ABS, G_STRUCT_OFFSET (DhcpPacket, ip.protocol));  /* A <- IP protocol */
+	_filter_append (filter, BPF_JMP + BPF_JEQ + BPF_K, IPPROTO_UDP, 1, 0);                         /* IP protocol == UDP ? */
+	_filter_ignore (filter);
+	_filter_stmt   (filter, BPF_LD + BPF_B + BPF_ABS, G_STRUCT_OFFSET (DhcpPacket, ip.frag_off));  /* A <- Flags */
+	_filter_stmt   (filter, BPF_ALU + BPF_AND + BPF_K, 0x20);                                      /* A <- A & 0x20 (More Fragments bit) */
+	_filter_append (filter, BPF_JMP + BPF_JEQ + BPF_K, 0, 1, 0);                                   /* A == 0 ? */
+	_filter_ignore (filter);
+	_filter_stmt   (filter, BPF_LD + BPF_H + BPF_ABS, G_STRUCT_OFFSET (DhcpPacket, ip.frag_off));  /* A <- Flags + Fragment offset */
+	_filter_stmt   (filter, BPF_ALU + BPF_AND + BPF_K, 0x1fff);                                    /* A <- A & 0x1fff (Fragment offset) */
+	_filter_append (filter, BPF_JMP + BPF_JEQ + BPF_K, 0, 1, 0);                                   /* A == 0 ? */
+	_filter_ignore (filter);
+	_filter_stmt   (filter, BPF_LD + BPF_H + BPF_ABS, G_STRUCT_OFFSET (DhcpPacket, udp.dest));     /* A <- UDP destination port */
+	_filter_append (filter, BPF_JMP + BPF_JEQ + BPF_K, port, 1, 0);                                /* UDP destination port == DHCP client port ? */
+	_filter_ignore (filter);
+	_filter_stmt   (filter, BPF_LD + BPF_B + BPF_ABS, G_STRUCT_OFFSET (DhcpPacket, op));           /* A <- DHCP op */
+	_filter_append (filter, BPF_JMP + BPF_JEQ + BPF_K, BOOTREPLY, 1, 0);                           /* op == BOOTREPLY ? */
+	_filter_ignore (filter);
+	_filter_stmt   (filter, BPF_LD + BPF_W + BPF_ABS, G_STRUCT_OFFSET (DhcpPacket, magic));        /* A <- DHCP magic cookie */
+	_filter_append (filter, BPF_JMP + BPF_JEQ + BPF_K, DHCP_MAGIC_COOKIE, 1, 0);                   /* cookie == DHCP magic cookie ? */
+	_filter_ignore (filter);
+
+	if (n_ifindexes <= FILTER_MAX_IFINDEXES) {
+		_filter_stmt (filter, BPF_LD + BPF_W + BPF_ABS, SKF_AD_OFF + SKF_AD_IFINDEX);              /* A <- ingress ifindex */
+		for (i = 0; i < n_ifindexes; i++)
+			_filter_append (filter, BPF_JMP + BPF_JEQ + BPF_K, ifindexes[i], n_ifindexes - i, 0);  /* ifindex == ifindexes[i] ? */
+		_filter_ignore (filter);
+	}
+
+	_filter_stmt   (filter, BPF_RET + BPF_K, 65535);                                               /* return all */
+
+	return filter;
+}
+
+static void
+mux_update_filter (NMSdDhcpRawMux *mux)
+{
+	gs_free int *ifindexes = NULL;
+	GArray *filter;
+	struct sock_fprog fprog;
+	GHashTableIter iter;
+	gpointer ifindex;
+	guint n = 0;
+
+	if (mux->fd < 0)
+		return;
+
+	ifindexes = g_new (int, g_hash_table_size (mux->ifindexes) + 1);
+	g_hash_table_iter_init (&iter, mux->ifindexes);
+	while (g_hash_table_iter_next (&iter, &ifindex, NULL))
+		ifindexes[n++] = GPOINTER_TO_INT (ifindex);
+
+	filter = _nm_sd_dhcp_raw_build_filter (mux->port, ifindexes, n);
+	fprog.len = filter->len;
+	fprog.filter = (struct sock_filter *) filter->data;
+	if (setsockopt (mux->fd, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof (fprog)) < 0) {
+		nm_log_warn (LOGD_DHCP4, "dhcp4: failure to update the filter of the shared raw socket: %s",
+		             g_strerror (errno));
+	}
+	g_array_unref (filter);
+}
+
+/*****************************************************************************/
+
+static Client *
+mux_dispatch (NMSdDhcpRawMux *mux,
+              int ifindex,
+              guint8 *packet,
+              gsize len,
+              gboolean csum_not_ready)
+{
+	DhcpPacket *dhcp = (DhcpPacket *) packet;
+	ClientKey key = { 0 };
+	Client *client;
+
+	if (len < sizeof (DhcpPacket))
+		return NULL;
+
+	key.ifindex = ifindex;
+	key.xid = ntohl (dhcp->xid);
+	key.arp_type = dhcp->htype;
+	key.hlen = dhcp->hlen;
+	memcpy (key.chaddr, dhcp->chaddr, ETH_ALEN);
+
+	client = g_hash_table_lookup (mux->clients, &key);
+	if (!client)
+		return NULL;
+
+	if (csum_not_ready)
+		dhcp->udp.check = 0;
+
+	if (send (client->fd, packet, len, MSG_DONTWAIT | MSG_NOSIGNAL) < 0) {
+		nm_log_dbg (LOGD_DHCP4, "dhcp4: failure to pass reply to client on ifindex %d: %s",
+		            ifindex, g_strerror (errno));
+		return NULL;
+	}
+	return client;
+}
+
+/**
+ * _nm_sd_dhcp_raw_mux_dispatch:
+ * @mux: the #NMSdDhcpRawMux
+ * @ifindex: the interface the packet arrived on
+ * @packet: the packet, starting with the IP header
+ * @len: the length of @packet
+ * @csum_not_ready: whether the UDP checksum was not yet computed
+ *
+ * Passes a packet received on the shared socket to the client that waits
+ * for it. If the checksum is not ready, it is cleared in @packet so that
+ * the client doesn't reject it.
+ *
+ * Returns: %TRUE if the packet was handed to a client.
+ */
+gboolean
+_nm_sd_dhcp_raw_mux_dispatch (NMSdDhcpRawMux *mux,
+                              int ifindex,
+                              guint8 *packet,
+                              gsize len,
+                              gboolean csum_not_ready)
+{
+	return !!mux_dispatch (mux, ifindex, packet, len, csum_not_ready);
+}
+
+static gboolean
+mux_receive_one (NMSdDhcpRawMux *mux, ClientKey *out_key)
+{
+	union {
+		struct cmsghdr cmsg;
+		guint8 buf[CMSG_SPACE (sizeof (struct tpacket_auxdata))];
+	} control;
+	struct sockaddr_ll sll = { 0 };
+	struct iovec iov = {
+		.iov_base = mux->buf,
+		.iov_len = BUF_SIZE,
+	};
+	struct msghdr msg = {
+		.msg_name = &sll,
+		.msg_namelen = sizeof (sll),
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = &control,
+		.msg_controllen = sizeof (control),
+	};
+	struct cmsghdr *cmsg;
+	gboolean csum_not_ready = FALSE;
+	Client *client;
+	ssize_t n;
+
+	n = recvmsg (mux->fd, &msg, MSG_DONTWAIT);
+	if (n < 0) {
+		if (errno != EAGAIN && errno != EINTR)
+			nm_log_dbg (LOGD_DHCP4, "dhcp4: failure to receive on the shared raw socket: %s", g_strerror (errno));
+		return FALSE;
+	}
+
+	out_key->ifindex = 0;
+	if (sll.sll_pkttype == PACKET_OUTGOING)
+		return TRUE;
+
+	for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+		if (   cmsg->cmsg_level == SOL_PACKET
+		    && cmsg->cmsg_type == PACKET_AUXDATA
+		    && cmsg->cmsg_len == CMSG_LEN (sizeof (struct tpacket_auxdata))) {
+			struct tpacket_auxdata *aux = (struct tpacket_auxdata *) CMSG_DATA (cmsg);
+
+			csum_not_ready = NM_FLAGS_HAS (aux->tp_status, TP_STATUS_CSUMNOTREADY);
+			break;
+		}
+	}
+
+	client = mux_dispatch (mux, sll.sll_ifindex, mux->buf, n, csum_not_ready);
+	if (client)
+		*out_key = client->key;
+	return TRUE;
+}
+
+static void
+mux_remove_client (NMSdDhcpRawMux *mux, Client *client);
+
+/* Forwards what the client sent, and removes the client
+ * once it closed its end. */
+static void
+client_forward (Client *client, gboolean hangup)
+{
+	NMSdDhcpRawMux *mux = client->mux;
+	guint i;
+	ssize_t n;
+
+	for (i = 0; i < MAX_BURST; i++) {
+		n = recv (client->fd, mux->buf, BUF_SIZE, MSG_DONTWAIT);
+		if (n > 0) {
+			if (   mux->fd >= 0
+			    && sendto (mux->fd, mux->buf, n, 0, (struct sockaddr *) &client->link, client->link_len) < 0) {
+				nm_log_dbg (LOGD_DHCP4, "dhcp4: failure to send on the shared raw socket for ifindex %d: %s",
+				            client->key.ifindex, g_strerror (errno));
+			}
+			continue;
+		}
+		if (n < 0 && NM_IN_SET (errno, EAGAIN, EINTR) && !hangup)
+			return;
+		break;
+	}
+	if (i == MAX_BURST)
+		return;
+
+	/* the client closed its end of the socketpair. */
+	mux_remove_client (mux, client);
+}
+
+static void
+mux_handle_events (NMSdDhcpRawMux *mux)
+{
+	struct epoll_event events[MAX_BURST];
+	ClientKey keys[MAX_BURST];
+	gboolean shared_ready = FALSE;
+	guint n_keys = 0;
+	Client *client;
+	guint i;
+	int n;
+
+	n = epoll_wait (mux->epoll_fd, events, G_N_ELEMENTS (events), 0);
+	if (n < 0) {
+		if (errno != EINTR)
+			nm_log_dbg (LOGD_DHCP4, "dhcp4: failure to wait on the shared raw socket: %s", g_strerror (errno));
+		return;
+	}
+
+	/* First forward what the clients sent. The packet socket comes last,
+	 * because handing replies to the clients runs the sd_event, which can
+	 * add and remove clients and thus reuse the fds in @events. */
+	for (i = 0; i < (guint) n; i++) {
+		if (events[i].data.fd == mux->fd) {
+			shared_ready = TRUE;
+			continue;
+		}
+		client = g_hash_table_lookup (mux->clients_by_fd, GINT_TO_POINTER (events[i].data.fd));
+		if (client)
+			client_forward (client, NM_FLAGS_ANY (events[i].events, EPOLLHUP | EPOLLERR));
+	}
+
+	if (!shared_ready)
+		return;
+
+	for (i = 0; i < MAX_BURST; i++) {
+		if (!mux_receive_one (mux, &keys[n_keys]))
+			break;
+		if (keys[n_keys].ifindex > 0)
+			n_keys++;
+	}
+	if (!n_keys || !mux->global)
+		return;
+
+	/* let the clients handle their replies now, instead of on the
+	 * next wakeup, and send their answers right away. The clients are
+	 * looked up again, running the sd_event may have replaced them. */
+	nm_sd_event_run_ready (n_keys);
+	for (i = 0; i < n_keys; i++) {
+		client = g_hash_table_lookup (mux->clients, &keys[i]);
+		if (client)
+			client_forward (client, FALSE);
+	}
+}
+
+static void
+mux_free_if_unused (NMSdDhcpRawMux *mux)
+{
+	if (   mux->global
+	    && !mux->dispatching
+	    && g_hash_table_size (mux->clients) == 0) {
+		global_muxes = g_slist_remove (global_muxes, mux);
+		_nm_sd_dhcp_raw_mux_free (mux);
+	}
+}
+
+static gboolean
+mux_io_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	NMSdDhcpRawMux *mux = user_data;
+
+	/* the last client may go away while handling the events, but
+	 * the mux must stay around until they are all handled. */
+	mux->dispatching = TRUE;
+	mux_handle_events (mux);
+	mux->dispatching = FALSE;
+	mux_free_if_unused (mux);
+	return G_SOURCE_CONTINUE;
+}
+
+static void
+mux_epoll_add (NMSdDhcpRawMux *mux, int fd)
+{
+	struct epoll_event event = {
+		.events = EPOLLIN,
+		.data.fd = fd,
+	};
+
+	if (epoll_ctl (mux->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+		nm_log_warn (LOGD_DHCP4, "dhcp4: failure to watch fd %d of the shared raw socket: %s",
+		             fd, g_strerror (errno));
+	}
+}
+
+/**
+ * _nm_sd_dhcp_raw_mux_new:
+ * @port: the DHCP client port
+ * @fd: the packet socket to share, or -1
+ *
+ * Creates a multiplexer. It takes ownership of @fd. Without packet socket,
+ * the packets sent by the clients are dropped and replies can only be
+ * injected with _nm_sd_dhcp_raw_mux_dispatch().
+ *
+ * Returns: the new #NMSdDhcpRawMux, or %NULL with errno set if no
+ *   epoll fd could be created.
+ */
+NMSdDhcpRawMux *
+_nm_sd_dhcp_raw_mux_new (guint16 port, int fd)
+{
+	NMSdDhcpRawMux *mux;
+	int epoll_fd;
+
+	epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+	if (epoll_fd < 0) {
+		int errsv = errno;
+
+		if (fd >= 0)
+			close (fd);
+		errno = errsv;
+		return NULL;
+	}
+
+	mux = g_slice_new0 (NMSdDhcpRawMux);
+	mux->port = port;
+	mux->fd = fd;
+	mux->epoll_fd = epoll_fd;
+	mux->clients = g_hash_table_new_full (client_key_hash, client_key_equal, NULL, client_free);
+	mux->clients_by_fd = g_hash_table_new (NULL, NULL);
+	mux->ifindexes = g_hash_table_new (NULL, NULL);
+	mux->buf = g_malloc (BUF_SIZE);
+
+	if (fd >= 0)
+		mux_epoll_add (mux, fd);
+	mux->channel = g_io_channel_unix_new (epoll_fd);
+	mux->watch_id = g_io_add_watch (mux->channel, G_IO_IN, mux_io_cb, mux);
+	return mux;
+}
+
+void
+_nm_sd_dhcp_raw_mux_free (NMSdDhcpRawMux *mux)
+{
+	g_hash_table_destroy (mux->clients);
+	g_hash_table_destroy (mux->clients_by_fd);
+	g_hash_table_destroy (mux->ifindexes);
+	nm_clear_g_source (&mux->watch_id);
+	g_io_channel_unref (mux->channel);
+	close (mux->epoll_fd);
+	if (mux->fd >= 0)
+		close (mux->fd);
+	g_free (mux->buf);
+	g_slice_free (NMSdDhcpRawMux, mux);
+}
+
+guint
+_nm_sd_dhcp_raw_mux_get_n_clients (NMSdDhcpRawMux *mux)
+{
+	return g_hash_table_size (mux->clients);
+}
+
+static void
+mux_ifindex_ref (NMSdDhcpRawMux *mux, int ifindex)
+{
+	guint n;
+
+	n = GPOINTER_TO_UINT (g_hash_table_lookup (mux->ifindexes, GINT_TO_POINTER (ifindex)));
+	g_hash_table_insert (mux->ifindexes, GINT_TO_POINTER (ifindex), GUINT_TO_POINTER (n + 1));
+	if (n == 0)
+		mux_update_filter (mux);
+}
+
+static void
+mux_ifindex_unref (NMSdDhcpRawMux *mux, int ifindex)
+{
+	guint n;
+
+	n = GPOINTER_TO_UINT (g_hash_table_lookup (mux->ifindexes, GINT_TO_POINTER (ifindex)));
+	g_return_if_fail (n > 0);
+	if (n > 1) {
+		g_hash_table_insert (mux->ifindexes, GINT_TO_POINTER (ifindex), GUINT_TO_POINTER (n - 1));
+		return;
+	}
+	g_hash_table_remove (mux->ifindexes, GINT_TO_POINTER (ifindex));
+	mux_update_filter (mux);
+}
+
+static void
+mux_remove_client (NMSdDhcpRawMux *mux, Client *client)
+{
+	int ifindex = client->key.ifindex;
+
+	if (!g_hash_table_remove (mux->clients, client))
+		return;
+	mux_ifindex_unref (mux, ifindex);
+	mux_free_if_unused (mux);
+}
+
+/**
+ * _nm_sd_dhcp_raw_mux_add_client:
+ * @mux: the #NMSdDhcpRawMux
+ * @ifindex: the interface of the client
+ * @xid: the transaction id of the client
+ * @mac_addr: the hardware address of the client
+ * @mac_addr_len: the length of @mac_addr
+ * @bcast_addr: the hardware broadcast address, of length @mac_addr_len
+ * @arp_type: the ARP hardware type
+ * @dhcp_hlen: how many bytes of @mac_addr are sent in chaddr
+ * @link: (allow-none): returns the address the client sends to
+ *
+ * Returns: the file descriptor for the client, or a negative errno.
+ */
+int
+_nm_sd_dhcp_raw_mux_add_client (NMSdDhcpRawMux *mux,
+                                int ifindex,
+                                guint32 xid,
+                                const guint8 *mac_addr,
+                                gsize mac_addr_len,
+                                const guint8 *bcast_addr,
+                                guint16 arp_type,
+                                guint8 dhcp_hlen,
+                                struct sockaddr_ll *link)
+{
+	Client *client, *old;
+	int fds[2];
+
+	g_return_val_if_fail (ifindex > 0, -EINVAL);
+	g_return_val_if_fail (mac_addr_len <= INFINIBAND_ALEN, -EINVAL);
+	g_return_val_if_fail (dhcp_hlen <= MIN (mac_addr_len, ETH_ALEN), -EINVAL);
+
+	if (socketpair (AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0, fds) < 0)
+		return -errno;
+
+	client = g_slice_new0 (Client);
+	client->key.ifindex = ifindex;
+	client->key.xid = xid;
+	client->key.arp_type = arp_type;
+	client->key.hlen = dhcp_hlen;
+	memcpy (client->key.chaddr, mac_addr, dhcp_hlen);
+	client->mux = mux;
+	client->link.ll.sll_family = AF_PACKET;
+	client->link.ll.sll_protocol = htons (ETH_P_IP);
+	client->link.ll.sll_ifindex = ifindex;
+	client->link.ll.sll_hatype = htons (arp_type);
+	client->link.ll.sll_halen = mac_addr_len;
+	memcpy (client->link.ll.sll_addr, bcast_addr, mac_addr_len);
+	client->link_len = MAX (sizeof (struct sockaddr_ll), offsetof (struct sockaddr_ll, sll_addr) + mac_addr_len);
+	client->fd = fds[0];
+
+	mux_ifindex_ref (mux, ifindex);
+	old = g_hash_table_lookup (mux->clients, client);
+	if (old) {
+		/* a stale registration, whose fd the client didn't close yet. */
+		g_hash_table_remove (mux->clients, old);
+		mux_ifindex_unref (mux, ifindex);
+	}
+	g_hash_table_add (mux->clients, client);
+	g_hash_table_insert (mux->clients_by_fd, GINT_TO_POINTER (client->fd), client);
+	mux_epoll_add (mux, client->fd);
+
+	if (link)
+		memcpy (link, &client->link, client->link_len);
+
+	return fds[1];
+}
+
+/*****************************************************************************/
+
+static int
+mux_open_socket (guint16 port)
+{
+	GArray *filter;
+	struct sock_fprog fprog;
+	struct sockaddr_ll sll = {
+		.sll_family = AF_PACKET,
+		.sll_protocol = htons (ETH_P_IP),
+	};
+	int fd, on = 1;
+	int errsv;
+
+	/* don't pass a protocol yet, so that no packet is queued before
+	 * the filter is in place. */
+	fd = socket (AF_PACKET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	if (fd < 0)
+		return -errno;
+
+	if (setsockopt (fd, SOL_PACKET, PACKET_AUXDATA, &on, sizeof (on)) < 0)
+		goto fail;
+
+	filter = _nm_sd_dhcp_raw_build_filter (port, NULL, 0);
+	fprog.len = filter->len;
+	fprog.filter = (struct sock_filter *) filter->data;
+	if (setsockopt (fd, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof (fprog)) < 0) {
+		errsv = errno;
+		g_array_unref (filter);
+		close (fd);
+		return -errsv;
+	}
+	g_array_unref (filter);
+
+	if (bind (fd, (struct sockaddr *) &sll, sizeof (sll)) < 0)
+		goto fail;
+
+	return fd;
+
+fail:
+	errsv = errno;
+	close (fd);
+	return -errsv;
+}
+
+int
+nm_sd_dhcp_raw_bind (int ifindex,
+                     struct sockaddr_ll *link,
+                     uint32_t xid,
+                     const uint8_t *mac_addr,
+                     size_t mac_addr_len,
+                     const uint8_t *bcast_addr,
+                     uint16_t arp_type,
+                     uint8_t dhcp_hlen,
+                     uint16_t port)
+{
+	NMSdDhcpRawMux *mux = NULL;
+	GSList *iter;
+	int fd;
+
+	for (iter = global_muxes; iter; iter = iter->next) {
+		if (((NMSdDhcpRawMux *) iter->data)->port == port) {
+			mux = iter->data;
+			break;
+		}
+	}
+
+	if (!mux) {
+		fd = mux_open_socket (port);
+		if (fd < 0)
+			return fd;
+		mux = _nm_sd_dhcp_raw_mux_new (port, fd);
+		if (!mux)
+			return -errno;
+		mux->global = TRUE;
+		global_muxes = g_slist_prepend (global_muxes, mux);
+	}
+
+	fd = _nm_sd_dhcp_raw_mux_add_client (mux, ifindex, xid, mac_addr, mac_addr_len,
+	                                     bcast_addr, arp_type, dhcp_hlen, link);
+	if (fd < 0)
+		mux_free_if_unused (mux);
+	return fd;
+}
@@ -34,6 +34,8 @@ typedef struct SDEventSource {
 	guint *default_source_id;
 } SDEventSource;
 
+static guint default_source_id = 0;
+
 static gboolean
 event_prepare (GSource *source, gint *timeout_)
 {
@@ -98,8 +100,6 @@ event_attach (sd_event *event, GMainContext *context)
 	guint *p_default_source_id = NULL;
 
 	if (!e) {
-		static guint default_source_id = 0;
-
 		if (default_source_id) {
 			/* The default event cannot be registered multiple times. */
 			g_return_val_if_reached (0);
@@ -132,6 +132,54 @@ nm_sd_event_attach_default (void)
 	return event_attach (NULL, NULL);
 }
 
+/**
+ * nm_sd_event_run_ready:
+ * @max: how many event sources to dispatch at most
+ *
+ * Dispatches the sources of the default sd_event that are ready right now,
+ * instead of waiting for the next iteration of the main loop. Does nothing
+ * while the sd_event is in the middle of an iteration, then the main loop
+ * gets to them anyway.
+ */
+void
+nm_sd_event_run_ready (guint max)
+{
+	sd_event *e;
+
+	if (!default_source_id)
+		return;
+	if (sd_event_default (&e) < 0)
+		return;
+
+	if (sd_event_get_state (e) == SD_EVENT_INITIAL) {
+		while (   max-- > 0
+		       && sd_event_run (e, 0) > 0)
+			;
+	}
+	sd_event_unref (e);
+}
+
+/*****************************************************************************
+ * Coalesced timers
+ *
+ * The timers of sd_event only share a wakeup if their accuracy windows
+ * overlap. Instead of widening the accuracy of each timer, the timers
+ * added with nm_sd_event_add_time_coalesced() are moved to the next tick
+ * of a common 250 msec clock, like the slots of a timer wheel. All timers
+ * falling into the same tick then expire at the very same time.
+ *****************************************************************************/
+
+#define TIMER_SLOT_USEC ((guint64) 250000)
+
+guint64
+_nm_sd_event_timer_slot (guint64 usec)
+{
+	if (   usec == 0
+	    || usec > G_MAXUINT64 - TIMER_SLOT_USEC)
+		return usec;
+	return ((usec + TIMER_SLOT_USEC - 1) / TIMER_SLOT_USEC) * TIMER_SLOT_USEC;
+}
+
 /*****************************************************************************/
 
 /* ensure that defines in nm-sd.h correspond to the internal defines. */
@@ -141,3 +189,17 @@ nm_sd_event_attach_default (void)
 
 /*****************************************************************************/
 
+int
+nm_sd_event_add_time_coalesced (sd_event *e,
+                                sd_event_source **s,
+                                clockid_t clock,
+                                uint64_t usec,
+                                sd_event_time_handler_t callback,
+                                void *userdata)
+{
+	/* the timer already expires on a tick, don't let sd_event move it. */
+	return sd_event_add_time (e, s, clock, _nm_sd_event_timer_slot (usec), 1, callback, userdata);
+}
+
+/*****************************************************************************/
+
@@ -27,6 +27,10 @@
 /*****************************************************************************/
 
 guint nm_sd_event_attach_default (void);
+void nm_sd_event_run_ready (guint max);
+
+/* for testing */
+guint64 _nm_sd_event_timer_slot (guint64 usec);
 
 /*****************************************************************************
  * expose internal systemd API
@@ -39,5 +43,35 @@ struct sd_dhcp_lease;
 int dhcp_lease_save(struct sd_dhcp_lease *lease, const char *lease_file);
 int dhcp_lease_load(struct sd_dhcp_lease **ret, const char *lease_file);
 
+/*****************************************************************************
+ * shared raw socket of the DHCPv4 clients, only exposed for tests.
+ *****************************************************************************/
+
+struct sockaddr_ll;
+
+typedef struct _NMSdDhcpRawMux NMSdDhcpRawMux;
+
+NMSdDhcpRawMux *_nm_sd_dhcp_raw_mux_new (guint16 port, int fd);
+void _nm_sd_dhcp_raw_mux_free (NMSdDhcpRawMux *mux);
+
+int _nm_sd_dhcp_raw_mux_add_client (NMSdDhcpRawMux *mux,
+                                    int ifindex,
+                                    guint32 xid,
+                                    const guint8 *mac_addr,
+                                    gsize mac_addr_len,
+                                    const guint8 *bcast_addr,
+                                    guint16 arp_type,
+                                    guint8 dhcp_hlen,
+                                    struct sockaddr_ll *link);
+guint _nm_sd_dhcp_raw_mux_get_n_clients (NMSdDhcpRawMux *mux);
+
+gboolean _nm_sd_dhcp_raw_mux_dispatch (NMSdDhcpRawMux *mux,
+                                       int ifindex,
+                                       guint8 *packet,
+                                       gsize len,
+                                       gboolean csum_not_ready);
+
+GArray *_nm_sd_dhcp_raw_build_filter (guint16 port, const int *ifindexes, guint n_ifindexes);
+
 #endif /* __NM_SD_H__ */
 
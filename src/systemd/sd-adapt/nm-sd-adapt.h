@@ -175,6 +175,36 @@ static inline bool is_main_thread(void) {
         return TRUE;
 }
 
+/*****************************************************************************/
+
+struct sockaddr_ll;
+
+/* Implemented in nm-sd-dhcp-raw.c. Instead of opening one packet socket per
+ * DHCP client, the clients share one socket and get their replies through
+ * a socketpair. */
+int nm_sd_dhcp_raw_bind (int ifindex,
+                         struct sockaddr_ll *link,
+                         uint32_t xid,
+                         const uint8_t *mac_addr,
+                         size_t mac_addr_len,
+                         const uint8_t *bcast_addr,
+                         uint16_t arp_type,
+                         uint8_t dhcp_hlen,
+                         uint16_t port);
+
+struct sd_event;
+struct sd_event_source;
+
+/* Implemented in nm-sd.c. Like sd_event_add_time(), but the timer expires
+ * on the next tick of a clock shared by all such timers, so that timers
+ * of many clients that are due at about the same time share one wakeup. */
+int nm_sd_event_add_time_coalesced (struct sd_event *e,
+                                    struct sd_event_source **s,
+                                    clockid_t clock,
+                                    uint64_t usec,
+                                    int (*callback) (struct sd_event_source *s, uint64_t usec, void *userdata),
+                                    void *userdata);
+
 #endif /* (NETWORKMANAGER_COMPILATION) == NM_NETWORKMANAGER_COMPILATION_SYSTEMD */
 
 #endif /* NM_SD_ADAPT_H */
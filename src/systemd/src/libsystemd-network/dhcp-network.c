@@ -33,6 +33,7 @@
 #include "fd-util.h"
 #include "socket-util.h"
 
+#if 0 /* NM_IGNORED */
 static int _bind_raw_socket(int ifindex, union sockaddr_union *link,
                             uint32_t xid, const uint8_t *mac_addr,
                             size_t mac_addr_len,
@@ -125,6 +126,7 @@ static int _bind_raw_socket(int ifindex, union sockaddr_union *link,
 
         return r;
 }
+#endif /* NM_IGNORED */
 
 int dhcp_network_bind_raw_socket(int ifindex, union sockaddr_union *link,
                                  uint32_t xid, const uint8_t *mac_addr,
@@ -154,8 +156,13 @@ int dhcp_network_bind_raw_socket(int ifindex, union sockaddr_union *link,
         } else
                 return -EINVAL;
 
+#if 0 /* NM_IGNORED */
         return _bind_raw_socket(ifindex, link, xid, mac_addr, mac_addr_len,
                                 bcast_addr, &eth_mac, arp_type, dhcp_hlen, port);
+#else /* NM_IGNORED */
+        return nm_sd_dhcp_raw_bind(ifindex, &link->ll, xid, mac_addr, mac_addr_len,
+                                   bcast_addr, arp_type, dhcp_hlen, port);
+#endif /* NM_IGNORED */
 }
 
 int dhcp_network_bind_udp_socket(be32_t address, uint16_t port) {
@@ -973,11 +973,19 @@ static int client_timeout_resend(
 
         client->timeout_resend = sd_event_source_unref(client->timeout_resend);
 
+#if 0 /* NM_IGNORED */
         r = sd_event_add_time(client->event,
                               &client->timeout_resend,
                               clock_boottime_or_monotonic(),
                               next_timeout, 10 * USEC_PER_MSEC,
                               client_timeout_resend, client);
+#else /* NM_IGNORED */
+        r = nm_sd_event_add_time_coalesced(client->event,
+                                           &client->timeout_resend,
+                                           clock_boottime_or_monotonic(),
+                                           next_timeout,
+                                           client_timeout_resend, client);
+#endif /* NM_IGNORED */
         if (r < 0)
                 goto error;
 
@@ -24,6 +24,7 @@
 
 #include "nm-config.h"
 #include "nm-test-device.h"
+#include "devices/nm-device-private.h"
 #include "platform/nm-fake-platform.h"
 #include "nm-bus-manager.h"
 
@@ -122,6 +123,57 @@ setup_config (GError **error, const char *config_file, const char *intern_config
 	return config;
 }
 
+static void
+test_config_connection_default_invalidate (NMConfig *config)
+{
+	const NMConfigData *config_data = nm_config_get_data_orig (config);
+	gs_unref_object NMDevice *dev = nm_test_device_new ("00:00:00:00:00:50");
+	char *value;
+	guint generation;
+
+	/* fill the cache for @dev */
+	value = nm_config_data_get_connection_default (config_data, "ipv4.route-metric", dev);
+	g_assert_cmpstr (value, ==, "50");
+	g_free (value);
+	value = nm_config_data_get_connection_default (config_data, "ipv6.ip6_privacy", dev);
+	g_assert_cmpstr (value, ==, "0");
+	g_free (value);
+
+	/* a new MAC address must not return the cached value */
+	generation = nm_device_get_spec_match_generation (dev);
+	_nm_device_set_perm_hw_address_for_testing (dev, "00:00:00:00:00:52");
+	g_assert_cmpint (nm_device_get_spec_match_generation (dev), !=, generation);
+
+	value = nm_config_data_get_connection_default (config_data, "ipv4.route-metric", dev);
+	g_assert_cmpstr (value, ==, "52");
+	g_free (value);
+
+	/* the same for a rename, matched by [connection.public] */
+	generation = nm_device_get_spec_match_generation (dev);
+	_nm_device_set_iface_for_testing (dev, "wlan1");
+	g_assert_cmpint (nm_device_get_spec_match_generation (dev), !=, generation);
+
+	value = nm_config_data_get_connection_default (config_data, "ipv6.ip6_privacy", dev);
+	g_assert_cmpstr (value, ==, "2");
+	g_free (value);
+
+	/* the MAC still matches after the rename */
+	value = nm_config_data_get_connection_default (config_data, "ipv4.route-metric", dev);
+	g_assert_cmpstr (value, ==, "52");
+	g_free (value);
+
+	/* and back again */
+	_nm_device_set_iface_for_testing (dev, "dummy");
+	_nm_device_set_perm_hw_address_for_testing (dev, "00:00:00:00:00:50");
+
+	value = nm_config_data_get_connection_default (config_data, "ipv4.route-metric", dev);
+	g_assert_cmpstr (value, ==, "50");
+	g_free (value);
+	value = nm_config_data_get_connection_default (config_data, "ipv6.ip6_privacy", dev);
+	g_assert_cmpstr (value, ==, "0");
+	g_free (value);
+}
+
 static void
 test_config_simple (void)
 {
@@ -185,6 +237,21 @@ test_config_simple (void)
 	g_assert_cmpstr (value, ==, "52");
 	g_free (value);
 
+	/* lookups are cached per device. Repeat them. */
+	value = nm_config_data_get_connection_default (nm_config_get_data_orig (config), "ipv4.route-metric", dev51);
+	g_assert_cmpstr (value, ==, "51");
+	g_free (value);
+
+	value = nm_config_data_get_connection_default (nm_config_get_data_orig (config), "ipv4.route-metric", NULL);
+	g_assert_cmpstr (value, ==, "50");
+	g_free (value);
+
+	value = nm_config_data_get_connection_default (nm_config_get_data_orig (config), "ipv6.route-metric", NULL);
+	g_assert_cmpstr (value, ==, NULL);
+	g_free (value);
+
+	test_config_connection_default_invalidate (config);
+
 
 	value = nm_config_data_get_connection_default (nm_config_get_data_orig (config), "dummy.test1", dev51);
 	g_assert_cmpstr (value, ==, "yes");
@@ -993,6 +1060,119 @@ test_config_state_file (void)
 
 /*****************************************************************************/
 
+#define DEVICE_STATE_UUID_1 "1b4e5f0e-3d6c-4a8b-9f3e-0c2d6a7b8e91"
+#define DEVICE_STATE_UUID_2 "6e1c7a42-8d0f-4b5e-a3c9-2f7d1e0b4a63"
+
+static void
+_assert_device_state (NMConfig *config, int ifindex, NMConfigDeviceStateManagedType managed, const char *connection_uuid)
+{
+	gs_free NMConfigDeviceStateData *device_state = NULL;
+
+	device_state = nm_config_device_state_load (config, ifindex);
+	g_assert (device_state);
+	g_assert_cmpint (device_state->ifindex, ==, ifindex);
+	g_assert_cmpint (device_state->managed, ==, managed);
+	g_assert_cmpstr (device_state->connection_uuid, ==, connection_uuid);
+}
+
+static void
+test_config_device_state (void)
+{
+	NMConfig *config;
+	gs_free_error GError *error = NULL;
+	GMainLoop *loop;
+	gs_free char *dir = NULL;
+	gs_free char *state_file = NULL;
+	gs_free char *legacy_dir = NULL;
+	gs_free char *legacy_file = NULL;
+	gs_free char *other_file = NULL;
+	gs_free char *file_data = NULL;
+	gboolean ret;
+
+	loop = g_main_loop_new (NULL, FALSE);
+
+	dir = g_dir_make_tmp ("nm-test-device-state-XXXXXX", &error);
+	nmtst_assert_success (dir, error);
+	state_file = g_build_filename (dir, "devices.state", NULL);
+	legacy_dir = g_build_filename (dir, "devices", NULL);
+	legacy_file = g_build_filename (legacy_dir, "7", NULL);
+	other_file = g_build_filename (legacy_dir, "7.tmp", NULL);
+
+	/* the per-device files of older versions are taken over */
+	g_assert_cmpint (g_mkdir (legacy_dir, 0755), ==, 0);
+	ret = g_file_set_contents (legacy_file,
+	                           "[device]\n"
+	                           "managed=true\n"
+	                           "connection-uuid="DEVICE_STATE_UUID_1"\n",
+	                           -1, &error);
+	nmtst_assert_success (ret, error);
+	ret = g_file_set_contents (other_file, "", -1, &error);
+	nmtst_assert_success (ret, error);
+
+	config = setup_config (NULL, SRCDIR "/NetworkManager.conf", "", NULL, "/no/such/dir", "",
+	                       "--device-state-file", state_file, NULL);
+
+	_assert_device_state (config, 7, NM_CONFIG_DEVICE_STATE_MANAGED_TYPE_MANAGED, DEVICE_STATE_UUID_1);
+	_assert_device_state (config, 8, NM_CONFIG_DEVICE_STATE_MANAGED_TYPE_UNKNOWN, NULL);
+
+	/* changes are not written right away, but together after a delay */
+	g_assert (nm_config_device_state_write (config, 8, FALSE, NULL, NULL));
+	g_assert (nm_config_device_state_write (config, 9, TRUE, NULL, DEVICE_STATE_UUID_1));
+	g_assert (nm_config_device_state_write (config, 9, TRUE, NULL, DEVICE_STATE_UUID_2));
+	g_assert (!g_file_test (state_file, G_FILE_TEST_EXISTS));
+
+	g_assert (!nmtst_main_loop_run (loop, 2500));
+	g_assert (g_file_get_contents (state_file, &file_data, NULL, NULL));
+	g_assert (strstr (file_data, "[device-7]"));
+	g_assert (strstr (file_data, "[device-8]"));
+	g_assert (strstr (file_data, "connection-uuid="DEVICE_STATE_UUID_2));
+	nm_clear_g_free (&file_data);
+
+	/* ... and the old files are removed after the first write */
+	g_assert (!g_file_test (legacy_file, G_FILE_TEST_EXISTS));
+	g_assert (g_file_test (other_file, G_FILE_TEST_EXISTS));
+
+	/* a failed write is retried on the next flush */
+	g_assert_cmpint (unlink (state_file), ==, 0);
+	g_assert_cmpint (g_mkdir (state_file, 0755), ==, 0);
+	g_assert (nm_config_device_state_write (config, 9, FALSE, NULL, NULL));
+	g_test_expect_message ("NetworkManager", G_LOG_LEVEL_MESSAGE, "*device-state: write * failed*");
+	nm_config_device_state_flush (config);
+	g_test_assert_expected_messages ();
+
+	g_assert_cmpint (rmdir (state_file), ==, 0);
+	nm_config_device_state_flush (config);
+	g_assert (g_file_get_contents (state_file, &file_data, NULL, NULL));
+	g_assert (!strstr (file_data, DEVICE_STATE_UUID_2));
+	nm_clear_g_free (&file_data);
+
+	/* the state of a removed link is dropped */
+	nm_config_device_state_remove (config, 8);
+	_assert_device_state (config, 8, NM_CONFIG_DEVICE_STATE_MANAGED_TYPE_UNKNOWN, NULL);
+	nm_config_device_state_flush (config);
+	g_assert (g_file_get_contents (state_file, &file_data, NULL, NULL));
+	g_assert (!strstr (file_data, "[device-8]"));
+	nm_clear_g_free (&file_data);
+
+	g_object_unref (config);
+
+	/* read back what was written */
+	config = setup_config (NULL, SRCDIR "/NetworkManager.conf", "", NULL, "/no/such/dir", "",
+	                       "--device-state-file", state_file, NULL);
+	_assert_device_state (config, 7, NM_CONFIG_DEVICE_STATE_MANAGED_TYPE_MANAGED, DEVICE_STATE_UUID_1);
+	_assert_device_state (config, 8, NM_CONFIG_DEVICE_STATE_MANAGED_TYPE_UNKNOWN, NULL);
+	_assert_device_state (config, 9, NM_CONFIG_DEVICE_STATE_MANAGED_TYPE_UNMANAGED, NULL);
+	g_object_unref (config);
+
+	g_assert_cmpint (unlink (state_file), ==, 0);
+	g_assert_cmpint (unlink (other_file), ==, 0);
+	g_assert_cmpint (rmdir (legacy_dir), ==, 0);
+	g_assert_cmpint (rmdir (dir), ==, 0);
+	g_main_loop_unref (loop);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -1024,6 +1204,7 @@ main (int argc, char **argv)
 	g_test_add_func ("/config/enable", test_config_enable);
 
 	g_test_add_func ("/config/state-file", test_config_state_file);
+	g_test_add_func ("/config/device-state", test_config_device_state);
 
 	/* This one has to come last, because it leaves its values in
 	 * nm-config.c's global variables, and there's no way to reset
@@ -0,0 +1,224 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ */
+
+#include "nm-default.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+
+#include "nm-connectivity.h"
+
+#include "nm-test-utils-core.h"
+
+#define SERVER_RESPONSE "NetworkManager is online"
+
+/*****************************************************************************/
+
+#if WITH_CONCHECK
+
+/* A minimal HTTP server on 127.0.0.1. Each connection is handled in its own
+ * thread, it reads the request headers and answers with SERVER_RESPONSE. */
+
+static gboolean
+_server_run (GThreadedSocketService *service,
+             GSocketConnection *connection,
+             GObject *source_object,
+             gpointer user_data)
+{
+	gs_unref_object GDataInputStream *in = NULL;
+	GOutputStream *out;
+	gs_free char *reply = NULL;
+
+	in = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+	g_data_input_stream_set_newline_type (in, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+
+	while (TRUE) {
+		gs_free char *line = NULL;
+
+		line = g_data_input_stream_read_line (in, NULL, NULL, NULL);
+		if (!line)
+			return TRUE;
+		if (!line[0])
+			break;
+	}
+
+	reply = g_strdup_printf ("HTTP/1.1 200 OK\r\n"
+	                         "Content-Type: text/plain\r\n"
+	                         "Content-Length: %u\r\n"
+	                         "Connection: close\r\n"
+	                         "\r\n"
+	                         "%s",
+	                         (guint) strlen (SERVER_RESPONSE),
+	                         SERVER_RESPONSE);
+	out = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+	g_output_stream_write_all (out, reply, strlen (reply), NULL, NULL, NULL);
+	return TRUE;
+}
+
+static GSocketService *
+_server_new (char **out_uri)
+{
+	GSocketService *service;
+	gs_unref_object GInetAddress *inet_addr = NULL;
+	gs_unref_object GSocketAddress *addr = NULL;
+	gs_unref_object GSocketAddress *effective_addr = NULL;
+	GError *error = NULL;
+
+	service = g_threaded_socket_service_new (4);
+	g_signal_connect (service, "run", G_CALLBACK (_server_run), NULL);
+
+	inet_addr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+	addr = g_inet_socket_address_new (inet_addr, 0);
+	g_socket_listener_add_address (G_SOCKET_LISTENER (service),
+	                               addr,
+	                               G_SOCKET_TYPE_STREAM,
+	                               G_SOCKET_PROTOCOL_TCP,
+	                               NULL,
+	                               &effective_addr,
+	                               &error);
+	g_assert_no_error (error);
+
+	*out_uri = g_strdup_printf ("http://127.0.0.1:%u/",
+	                            (guint) g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (effective_addr)));
+
+	g_socket_service_start (service);
+	return service;
+}
+
+/*****************************************************************************/
+
+static gboolean
+_can_bind_to_device (void)
+{
+	int fd;
+	int r;
+
+	/* SO_BINDTODEVICE needs CAP_NET_RAW. */
+	fd = socket (AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	g_assert_cmpint (fd, >=, 0);
+	r = setsockopt (fd, SOL_SOCKET, SO_BINDTODEVICE, "lo", strlen ("lo") + 1);
+	close (fd);
+	return r == 0;
+}
+
+typedef struct {
+	GMainLoop *loop;
+	int ifindex;
+	NMConnectivityState state;
+} DeviceStateData;
+
+static void
+_device_state_changed (NMConnectivity *connectivity,
+                       int ifindex,
+                       guint state,
+                       DeviceStateData *data)
+{
+	g_assert_cmpint (ifindex, ==, data->ifindex);
+
+	if (state == NM_CONNECTIVITY_UNKNOWN)
+		return;
+	data->state = state;
+	g_main_loop_quit (data->loop);
+}
+
+static void
+do_test_device_check (const char *response, NMConnectivityState expected)
+{
+	gs_unref_object GSocketService *service = NULL;
+	gs_unref_object NMConnectivity *connectivity = NULL;
+	gs_free char *uri = NULL;
+	DeviceStateData data = { 0 };
+
+	if (!_can_bind_to_device ()) {
+		g_test_skip ("binding a socket to an interface is not permitted");
+		return;
+	}
+
+	data.ifindex = if_nametoindex ("lo");
+	g_assert_cmpint (data.ifindex, >, 0);
+	data.loop = g_main_loop_new (NULL, FALSE);
+	data.state = NM_CONNECTIVITY_UNKNOWN;
+
+	service = _server_new (&uri);
+
+	connectivity = nm_connectivity_new (uri, 300, response);
+	g_signal_connect (connectivity, NM_CONNECTIVITY_DEVICE_STATE_CHANGED,
+	                  G_CALLBACK (_device_state_changed), &data);
+
+	nm_connectivity_device_add (connectivity, data.ifindex, "lo");
+	g_assert_cmpint (nm_connectivity_device_get_state (connectivity, data.ifindex), ==, NM_CONNECTIVITY_UNKNOWN);
+
+	/* if binding the socket to "lo" failed, the check stays UNKNOWN and
+	 * the loop times out. So this also asserts the bind. */
+	if (!nmtst_main_loop_run (data.loop, 5000))
+		g_assert_not_reached ();
+
+	g_assert_cmpint (data.state, ==, expected);
+	g_assert_cmpint (nm_connectivity_device_get_state (connectivity, data.ifindex), ==, expected);
+
+	/* the global state is not affected by per-device checks. */
+	g_assert_cmpint (nm_connectivity_get_state (connectivity), !=, expected);
+
+	nm_connectivity_device_remove (connectivity, data.ifindex);
+	g_assert_cmpint (nm_connectivity_device_get_state (connectivity, data.ifindex), ==, NM_CONNECTIVITY_UNKNOWN);
+
+	g_signal_handlers_disconnect_by_func (connectivity, _device_state_changed, &data);
+	g_socket_service_stop (service);
+	g_main_loop_unref (data.loop);
+}
+
+#endif /* WITH_CONCHECK */
+
+static void
+test_device_check_full (void)
+{
+#if WITH_CONCHECK
+	do_test_device_check (NULL, NM_CONNECTIVITY_FULL);
+#else
+	g_test_skip ("built without connectivity checking");
+#endif
+}
+
+static void
+test_device_check_portal (void)
+{
+#if WITH_CONCHECK
+	do_test_device_check ("unexpected response", NM_CONNECTIVITY_PORTAL);
+#else
+	g_test_skip ("built without connectivity checking");
+#endif
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	nmtst_init_with_logging (&argc, &argv, NULL, "ALL");
+
+	g_test_add_func ("/connectivity/device-check/full", test_device_check_full);
+	g_test_add_func ("/connectivity/device-check/portal", test_device_check_portal);
+
+	return g_test_run ();
+}
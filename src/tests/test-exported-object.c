@@ -0,0 +1,249 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include <arpa/inet.h>
+
+#include "nm-exported-object.h"
+#include "nm-ip4-config.h"
+
+#include "nm-test-utils-core.h"
+
+/* The deprecated "PropertiesChanged" signal is only emitted for interfaces
+ * that are exported on a D-Bus connection, so the objects are exported on
+ * a private bus. The emissions are watched on the interface skeletons. */
+
+static GTestDBus *test_bus;
+
+typedef struct {
+	NMIP4Config *config;
+	GDBusInterface *iface;
+	gulong signal_id;
+	guint count;
+	GVariant *last;
+
+	/* unexport this object from our handler */
+	NMIP4Config *unexport_other;
+} Watch;
+
+static void
+_iterate (void)
+{
+	while (g_main_context_iteration (NULL, FALSE))
+		;
+}
+
+static void
+_properties_changed_cb (GDBusInterface *iface, GVariant *properties, Watch *w)
+{
+	w->count++;
+	g_clear_pointer (&w->last, g_variant_unref);
+	w->last = g_variant_ref (properties);
+
+	if (w->unexport_other)
+		nm_exported_object_unexport (NM_EXPORTED_OBJECT (w->unexport_other));
+}
+
+static void
+_watch_init (Watch *w)
+{
+	memset (w, 0, sizeof (*w));
+	w->config = nm_ip4_config_new (1);
+	nm_exported_object_export (NM_EXPORTED_OBJECT (w->config));
+	w->iface = g_dbus_object_get_interface (G_DBUS_OBJECT (w->config),
+	                                        NM_DBUS_INTERFACE_IP4_CONFIG);
+	g_assert (w->iface);
+	w->signal_id = g_signal_connect (w->iface, "properties-changed",
+	                                 G_CALLBACK (_properties_changed_cb), w);
+}
+
+static void
+_watch_clear (Watch *w)
+{
+	nm_clear_g_signal_handler (w->iface, &w->signal_id);
+	if (nm_exported_object_is_exported (NM_EXPORTED_OBJECT (w->config)))
+		nm_exported_object_unexport (NM_EXPORTED_OBJECT (w->config));
+	g_clear_object (&w->iface);
+	g_clear_object (&w->config);
+	g_clear_pointer (&w->last, g_variant_unref);
+}
+
+/*****************************************************************************/
+
+static void
+test_coalesce (void)
+{
+	Watch w1, w2;
+	const char *gateway = NULL;
+	gs_unref_variant GVariant *nameservers = NULL;
+
+	if (!test_bus) {
+		g_test_skip ("dbus-daemon not available");
+		return;
+	}
+
+	_watch_init (&w1);
+	_watch_init (&w2);
+	_iterate ();
+	w1.count = 0;
+	w2.count = 0;
+
+	nm_ip4_config_set_gateway (w1.config, nmtst_inet4_from_string ("192.168.1.1"));
+	nm_ip4_config_set_gateway (w1.config, nmtst_inet4_from_string ("192.168.1.2"));
+	nm_ip4_config_add_nameserver (w1.config, nmtst_inet4_from_string ("192.168.1.3"));
+	nm_ip4_config_set_gateway (w2.config, nmtst_inet4_from_string ("10.0.0.1"));
+
+	/* nothing is emitted synchronously */
+	g_assert_cmpint (w1.count, ==, 0);
+	g_assert_cmpint (w2.count, ==, 0);
+
+	_iterate ();
+
+	/* one signal per object, carrying the latest values only */
+	g_assert_cmpint (w1.count, ==, 1);
+	g_assert (g_variant_lookup (w1.last, "Gateway", "&s", &gateway));
+	g_assert_cmpstr (gateway, ==, "192.168.1.2");
+	nameservers = g_variant_lookup_value (w1.last, "Nameservers", G_VARIANT_TYPE ("au"));
+	g_assert (nameservers);
+	g_assert_cmpint (g_variant_n_children (nameservers), ==, 1);
+
+	g_assert_cmpint (w2.count, ==, 1);
+	g_assert (g_variant_lookup (w2.last, "Gateway", "&s", &gateway));
+	g_assert_cmpstr (gateway, ==, "10.0.0.1");
+
+	/* nothing left over */
+	_iterate ();
+	g_assert_cmpint (w1.count, ==, 1);
+	g_assert_cmpint (w2.count, ==, 1);
+
+	_watch_clear (&w1);
+	_watch_clear (&w2);
+}
+
+/*****************************************************************************/
+
+#define N_WATCHES 200
+
+static void
+test_unexport_pending (void)
+{
+	Watch *w;
+	guint i;
+
+	if (!test_bus) {
+		g_test_skip ("dbus-daemon not available");
+		return;
+	}
+
+	w = g_new (Watch, N_WATCHES);
+	for (i = 0; i < N_WATCHES; i++)
+		_watch_init (&w[i]);
+	_iterate ();
+
+	for (i = 0; i < N_WATCHES; i++) {
+		w[i].count = 0;
+		nm_ip4_config_set_gateway (w[i].config, 0x01000000 + i);
+	}
+
+	/* Unexport every other object while its notification is pending, in
+	 * reverse order. The rest must still get their signal. */
+	for (i = N_WATCHES; i > 0; i--) {
+		if ((i - 1) % 2 == 0)
+			nm_exported_object_unexport (NM_EXPORTED_OBJECT (w[i - 1].config));
+	}
+
+	_iterate ();
+
+	for (i = 0; i < N_WATCHES; i++)
+		g_assert_cmpint (w[i].count, ==, i % 2 == 0 ? 0 : 1);
+
+	for (i = 0; i < N_WATCHES; i++)
+		_watch_clear (&w[i]);
+	g_free (w);
+}
+
+static void
+test_unexport_during_dispatch (void)
+{
+	Watch w1, w2;
+
+	if (!test_bus) {
+		g_test_skip ("dbus-daemon not available");
+		return;
+	}
+
+	_watch_init (&w1);
+	_watch_init (&w2);
+	_iterate ();
+	w1.count = 0;
+	w2.count = 0;
+
+	/* both are pending; emitting the first one unexports the second,
+	 * which then must not emit anymore. */
+	w1.unexport_other = w2.config;
+	nm_ip4_config_set_gateway (w1.config, nmtst_inet4_from_string ("192.168.1.1"));
+	nm_ip4_config_set_gateway (w2.config, nmtst_inet4_from_string ("192.168.1.2"));
+
+	_iterate ();
+
+	g_assert_cmpint (w1.count, ==, 1);
+	g_assert_cmpint (w2.count, ==, 0);
+	g_assert (!nm_exported_object_is_exported (NM_EXPORTED_OBJECT (w2.config)));
+
+	_watch_clear (&w1);
+	_watch_clear (&w2);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	gs_free char *dbus_daemon = NULL;
+	gs_unref_object GDBusConnection *system_bus = NULL;
+	int result;
+
+	nmtst_init_assert_logging (&argc, &argv, "INFO", "DEFAULT");
+
+	dbus_daemon = g_find_program_in_path ("dbus-daemon");
+	if (dbus_daemon) {
+		test_bus = g_test_dbus_new (G_TEST_DBUS_NONE);
+		g_test_dbus_up (test_bus);
+
+		/* NMBusManager exports the objects on the system bus. */
+		g_setenv ("DBUS_SYSTEM_BUS_ADDRESS", g_test_dbus_get_bus_address (test_bus), TRUE);
+		system_bus = g_bus_get_sync (G_BUS_TYPE_SYSTEM, NULL, NULL);
+		g_assert (system_bus);
+		g_dbus_connection_set_exit_on_close (system_bus, FALSE);
+	}
+
+	g_test_add_func ("/exported-object/coalesce", test_coalesce);
+	g_test_add_func ("/exported-object/unexport-pending", test_unexport_pending);
+	g_test_add_func ("/exported-object/unexport-during-dispatch", test_unexport_during_dispatch);
+
+	result = g_test_run ();
+
+	if (test_bus) {
+		g_test_dbus_down (test_bus);
+		g_clear_object (&test_bus);
+	}
+	return result;
+}
@@ -898,6 +898,127 @@ test_nm_utils_new_vlan_name (void)
 
 /*****************************************************************************/
 
+static void
+_ring_log_handler (const char *log_domain,
+                   GLogLevelFlags log_level,
+                   const char *message,
+                   gpointer user_data)
+{
+	(*((guint *) user_data))++;
+}
+
+static void
+test_nm_logging_ring (void)
+{
+	gs_free char *dump = NULL;
+	gs_strfreev char **lines = NULL;
+	GError *error = NULL;
+	GLogLevelFlags old_fatal;
+	guint handler_id;
+	guint n_backend = 0;
+	char long_msg[1000];
+	const char *s, *s2;
+	guint i, n;
+
+	/* count what reaches the logging backend, instead of expecting each
+	 * message. */
+	old_fatal = g_log_set_always_fatal (G_LOG_FATAL_MASK);
+	handler_id = g_log_set_handler ("NetworkManager", G_LOG_LEVEL_MASK, _ring_log_handler, &n_backend);
+	g_assert (nm_logging_setup ("WARN", "DEFAULT", NULL, NULL));
+
+	g_assert (!nm_logging_ring_setup ("KEEP", &error));
+	g_assert_error (error, NM_MANAGER_ERROR, NM_MANAGER_ERROR_UNKNOWN_LOG_LEVEL);
+	g_clear_error (&error);
+	g_assert (!nm_logging_ring_setup ("foo", &error));
+	g_assert_error (error, NM_MANAGER_ERROR, NM_MANAGER_ERROR_UNKNOWN_LOG_LEVEL);
+	g_clear_error (&error);
+
+	/* disabled */
+	g_assert (nm_logging_ring_setup (NULL, &error));
+	g_assert_no_error (error);
+	g_assert (!nm_logging_enabled (LOGL_DEBUG, LOGD_CORE));
+	nm_log_dbg (LOGD_CORE, "ring-test: off");
+	dump = nm_logging_ring_dump ();
+	g_assert (!strstr (dump, "ring-test: off"));
+	nm_clear_g_free (&dump);
+
+	/* the ring has its own level, regardless of the backend's. Messages
+	 * only enabled for the ring don't reach the backend. */
+	g_assert (nm_logging_ring_setup ("DEBUG", &error));
+	g_assert_no_error (error);
+	g_assert (nm_logging_enabled (LOGL_DEBUG, LOGD_WIFI));
+	g_assert (!nm_logging_enabled (LOGL_TRACE, LOGD_WIFI));
+	g_assert (!nm_logging_enabled (LOGL_DEBUG, LOGD_VPN_PLUGIN));
+	g_assert_cmpstr (nm_logging_level_to_string (), ==, "WARN");
+
+	nm_log_trace (LOGD_CORE, "ring-test: trace");
+	nm_log_dbg (LOGD_WIFI, "ring-test: debug %d", 1);
+	nm_log_info (LOGD_CORE, "ring-test: info");
+	g_assert_cmpint (n_backend, ==, 0);
+	nm_log_warn (LOGD_CORE, "ring-test: warn");
+	g_assert_cmpint (n_backend, ==, 1);
+
+	dump = nm_logging_ring_dump ();
+	g_assert (!strstr (dump, "ring-test: trace"));
+	s = strstr (dump, "<debug> [WIFI] ");
+	g_assert (s);
+	s = strstr (s, ": ring-test: debug 1\n");
+	g_assert (s);
+	s2 = strstr (s, "<info>  [CORE] ");
+	g_assert (s2);
+	g_assert (strstr (s2, ": ring-test: info\n"));
+	g_assert (strstr (s2, "<warn>  [CORE] "));
+	g_assert (strstr (s2, ": ring-test: warn\n"));
+	nm_clear_g_free (&dump);
+
+	/* long messages are truncated */
+	memset (long_msg, 'x', sizeof (long_msg) - 1);
+	long_msg[sizeof (long_msg) - 1] = '\0';
+	nm_log_dbg (LOGD_CORE, "ring-test: long %s", long_msg);
+	dump = nm_logging_ring_dump ();
+	s = strstr (dump, "ring-test: long x");
+	g_assert (s);
+	s2 = strchr (s, '\n');
+	g_assert (s2);
+	g_assert_cmpint (s2 - s, ==, 255);
+	nm_clear_g_free (&dump);
+
+	/* after wrapping around, only the latest messages are kept, oldest first */
+	for (i = 0; i < 5000; i++)
+		nm_log_dbg (LOGD_CORE, "ring-test: wrap %u", i);
+	g_assert_cmpint (n_backend, ==, 1);
+	dump = nm_logging_ring_dump ();
+	g_assert (!strstr (dump, "ring-test: debug"));
+	lines = g_strsplit (dump, "\n", -1);
+	n = g_strv_length (lines);
+	g_assert_cmpstr (lines[n - 1], ==, "");
+	n--;
+	g_assert_cmpint (n, >, 0);
+	g_assert_cmpint (n, <, 5000);
+	for (i = 0; i < n; i++) {
+		gs_free char *expected = g_strdup_printf (": ring-test: wrap %u", 5000 - n + i);
+
+		g_assert (g_str_has_suffix (lines[i], expected));
+	}
+	nm_clear_g_free (&dump);
+
+	/* disabling keeps what was recorded, but records nothing new */
+	g_assert (nm_logging_ring_setup ("OFF", &error));
+	g_assert_no_error (error);
+	g_assert (!nm_logging_enabled (LOGL_DEBUG, LOGD_CORE));
+	nm_log_dbg (LOGD_CORE, "ring-test: disabled");
+	dump = nm_logging_ring_dump ();
+	g_assert (!strstr (dump, "ring-test: disabled"));
+	g_assert (g_str_has_suffix (dump, ": ring-test: wrap 4999\n"));
+	g_assert_cmpint (n_backend, ==, 1);
+
+	g_assert (nm_logging_setup ("DEBUG", "DEFAULT", NULL, NULL));
+	g_log_remove_handler ("NetworkManager", handler_id);
+	g_log_set_always_fatal (old_fatal);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -911,6 +1032,7 @@ main (int argc, char **argv)
 	g_test_add_func ("/general/nm_ethernet_address_is_valid", test_nm_ethernet_address_is_valid);
 	g_test_add_func ("/general/nm_multi_index", test_nm_multi_index);
 	g_test_add_func ("/general/nm_utils_new_vlan_name", test_nm_utils_new_vlan_name);
+	g_test_add_func ("/general/nm_logging_ring", test_nm_logging_ring);
 
 	return g_test_run ();
 }
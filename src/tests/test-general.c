@@ -988,12 +988,14 @@ test_match_spec_ifname (const char *spec_str, const char **matches, const char *
 {
 	const char *m;
 	GSList *specs, *specs_reverse = NULL, *specs_resplit, *specs_i, *specs_j;
+	NMMatchSpecCompiled *specs_compiled;
 	guint i;
 	gs_free char *specs_joined = NULL;
 
 	g_assert (spec_str);
 
 	specs = nm_match_spec_split (spec_str);
+	specs_compiled = nm_match_spec_compile (specs);
 
 	/* assert that split(join(specs)) == specs */
 	specs_joined = nm_match_spec_join (specs);
@@ -1015,10 +1017,12 @@ test_match_spec_ifname (const char *spec_str, const char **matches, const char *
 	for (i = 0; matches && matches[i]; i++) {
 		g_assert (nm_match_spec_interface_name (specs, matches[i]) == NM_MATCH_SPEC_MATCH);
 		g_assert (nm_match_spec_interface_name (specs_reverse, matches[i]) == NM_MATCH_SPEC_MATCH);
+		g_assert (nm_match_spec_compiled_match_device (specs_compiled, matches[i], NULL, NULL, NULL) == NM_MATCH_SPEC_MATCH);
 	}
 	for (i = 0; neg_matches && neg_matches[i]; i++) {
 		g_assert (nm_match_spec_interface_name (specs, neg_matches[i]) == NM_MATCH_SPEC_NEG_MATCH);
 		g_assert (nm_match_spec_interface_name (specs_reverse, neg_matches[i]) == NM_MATCH_SPEC_NEG_MATCH);
+		g_assert (nm_match_spec_compiled_match_device (specs_compiled, neg_matches[i], NULL, NULL, NULL) == NM_MATCH_SPEC_NEG_MATCH);
 	}
 	for (i = 0; (m = _test_match_spec_all[i]); i++) {
 		if (_test_match_spec_contains (matches, m))
@@ -1027,12 +1031,79 @@ test_match_spec_ifname (const char *spec_str, const char **matches, const char *
 			continue;
 		g_assert (nm_match_spec_interface_name (specs, m) == NM_MATCH_SPEC_NO_MATCH);
 		g_assert (nm_match_spec_interface_name (specs_reverse, m) == NM_MATCH_SPEC_NO_MATCH);
+		g_assert (nm_match_spec_compiled_match_device (specs_compiled, m, NULL, NULL, NULL) == NM_MATCH_SPEC_NO_MATCH);
 	}
 
+	nm_match_spec_compiled_free (specs_compiled);
 	g_slist_free (specs_reverse);
 	g_slist_free_full (specs, g_free);
 }
 
+/*****************************************************************************/
+
+static void
+_do_test_match_spec_device (const char *spec_str,
+                            const char *interface_name,
+                            const char *device_type,
+                            const char *hwaddr,
+                            const char *s390_subchannels,
+                            NMMatchSpecMatchType expected)
+{
+	GSList *specs;
+	NMMatchSpecCompiled *specs_compiled;
+	NMMatchSpecMatchType m = NM_MATCH_SPEC_NO_MATCH;
+
+	specs = nm_match_spec_split (spec_str);
+	specs_compiled = nm_match_spec_compile (specs);
+
+	/* combine the individual matchers like NMDevice does. */
+	if (hwaddr)
+		m = MAX (m, nm_match_spec_hwaddr (specs, hwaddr));
+	if (interface_name)
+		m = MAX (m, nm_match_spec_interface_name (specs, interface_name));
+	m = MAX (m, nm_match_spec_device_type (specs, device_type));
+	if (s390_subchannels)
+		m = MAX (m, nm_match_spec_s390_subchannels (specs, s390_subchannels));
+	g_assert_cmpint (m, ==, expected);
+
+	g_assert_cmpint (nm_match_spec_compiled_match_device (specs_compiled,
+	                                                      interface_name,
+	                                                      device_type,
+	                                                      hwaddr,
+	                                                      s390_subchannels), ==, expected);
+
+	nm_match_spec_compiled_free (specs_compiled);
+	g_slist_free_full (specs, g_free);
+}
+
+static void
+test_nm_match_spec_compiled_device (void)
+{
+	g_assert (!nm_match_spec_compile (NULL));
+	g_assert_cmpint (nm_match_spec_compiled_match_device (NULL, "eth0", "ethernet", NULL, NULL), ==, NM_MATCH_SPEC_NO_MATCH);
+
+	_do_test_match_spec_device ("mac:00:11:22:33:44:55", "eth0", "ethernet", "00:11:22:33:44:55", NULL, NM_MATCH_SPEC_MATCH);
+	_do_test_match_spec_device ("MAC:00:11:22:33:44:55", "eth0", "ethernet", "00:11:22:33:44:55", NULL, NM_MATCH_SPEC_MATCH);
+	_do_test_match_spec_device ("mac:00:11:22:33:44:55", "eth0", "ethernet", "00:11:22:33:44:56", NULL, NM_MATCH_SPEC_NO_MATCH);
+	_do_test_match_spec_device ("00:11:22:33:44:55", "eth0", "ethernet", "00:11:22:33:44:55", NULL, NM_MATCH_SPEC_MATCH);
+	_do_test_match_spec_device ("mac:aa:bb:cc:dd:ee:ff", "eth0", "ethernet", "AA:BB:CC:DD:EE:FF", NULL, NM_MATCH_SPEC_MATCH);
+	_do_test_match_spec_device ("interface-name:eth*,except:mac:00:11:22:33:44:55", "eth0", "ethernet", "00:11:22:33:44:55", NULL, NM_MATCH_SPEC_NEG_MATCH);
+	_do_test_match_spec_device ("interface-name:eth*,except:00:11:22:33:44:55", "eth0", "ethernet", "00:11:22:33:44:55", NULL, NM_MATCH_SPEC_MATCH);
+	_do_test_match_spec_device ("type:ethernet", "eth0", "ethernet", NULL, NULL, NM_MATCH_SPEC_MATCH);
+	_do_test_match_spec_device ("type:ethernet", "eth0", "wifi", NULL, NULL, NM_MATCH_SPEC_NO_MATCH);
+	_do_test_match_spec_device ("ethernet", "eth0", "ethernet", NULL, NULL, NM_MATCH_SPEC_NO_MATCH);
+	_do_test_match_spec_device ("type:ethernet,except:interface-name:eth1", "eth1", "ethernet", NULL, NULL, NM_MATCH_SPEC_NEG_MATCH);
+	_do_test_match_spec_device ("except:type:wifi,interface-name:wlan?", "wlan0", "wifi", NULL, NULL, NM_MATCH_SPEC_NEG_MATCH);
+	_do_test_match_spec_device ("except:type:wifi,interface-name:wlan?", "wlan0", "ethernet", NULL, NULL, NM_MATCH_SPEC_MATCH);
+	_do_test_match_spec_device ("s390-subchannels:0.0.8000", "eth0", "ethernet", NULL, "0.0.8000", NM_MATCH_SPEC_MATCH);
+	_do_test_match_spec_device ("s390-subchannels:0.0.8000", "eth0", "ethernet", NULL, "0.0.8001", NM_MATCH_SPEC_NO_MATCH);
+	_do_test_match_spec_device ("type:ethernet,except:s390-subchannels:0.0.8000", "eth0", "ethernet", NULL, "0.0.8000", NM_MATCH_SPEC_NEG_MATCH);
+	_do_test_match_spec_device ("mac:80:00:02:08:fe:80:00:00:00:00:00:00:00:02:c9:03:00:00:0f:65",
+	                            "ib0", "infiniband",
+	                            "80:00:02:09:fe:80:00:00:00:00:00:00:00:02:c9:03:00:00:0f:65",
+	                            NULL, NM_MATCH_SPEC_MATCH);
+}
+
 static void
 test_nm_match_spec_interface_name (void)
 {
@@ -1108,6 +1179,13 @@ _do_test_match_spec_match_config (const char *file, gint line, const char *spec_
 	if (expected != match_result)
 		g_error ("%s:%d: faild comparing \"%s\" with %u.%u.%u. Expected %d, but got %d", file, line, spec_str, v_maj, v_min, v_mic, (int) expected, (int) match_result);
 
+	{
+		NMMatchSpecCompiled *specs_compiled = nm_match_spec_compile (specs);
+
+		g_assert_cmpint (nm_match_spec_compiled_match_config (specs_compiled, version, NULL), ==, match_result);
+		nm_match_spec_compiled_free (specs_compiled);
+	}
+
 	if (g_slist_length (specs) == 1 && match_result != NM_MATCH_SPEC_NEG_MATCH) {
 		/* there is only one spec in the list... test that we match except: */
 		char *sss = g_strdup_printf ("except:%s", (char *) specs->data);
@@ -1513,6 +1591,7 @@ main (int argc, char **argv)
 
 	g_test_add_func ("/general/nm_match_spec_interface_name", test_nm_match_spec_interface_name);
 	g_test_add_func ("/general/nm_match_spec_match_config", test_nm_match_spec_match_config);
+	g_test_add_func ("/general/nm_match_spec_compiled_device", test_nm_match_spec_compiled_device);
 	g_test_add_func ("/general/duplicate_decl_specifier", test_duplicate_decl_specifier);
 
 	g_test_add_func ("/general/reverse_dns/ip4", test_reverse_dns_ip4);
@@ -21,6 +21,14 @@
 
 #include "systemd/nm-sd.h"
 
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <net/ethernet.h>
+#include <linux/filter.h>
+#include <linux/if_packet.h>
+#include <net/if_arp.h>
+
 #include "nm-test-utils-core.h"
 
 /*****************************************************************************
@@ -91,6 +99,172 @@ test_dhcp_create (void)
 
 /*****************************************************************************/
 
+/* offsets in a DHCP packet, starting with the IP header */
+#define PKT_UDP_CHECK  26
+#define PKT_HTYPE      29
+#define PKT_HLEN       30
+#define PKT_XID        32
+#define PKT_CHADDR     56
+#define PKT_LEN        300
+
+static void
+_dhcp_raw_packet_init (guint8 *packet, guint32 xid, const guint8 *chaddr)
+{
+	memset (packet, 0, PKT_LEN);
+	packet[PKT_UDP_CHECK] = 0xab;
+	packet[PKT_UDP_CHECK + 1] = 0xcd;
+	packet[PKT_HTYPE] = ARPHRD_ETHER;
+	packet[PKT_HLEN] = ETH_ALEN;
+	xid = htonl (xid);
+	memcpy (&packet[PKT_XID], &xid, sizeof (xid));
+	memcpy (&packet[PKT_CHADDR], chaddr, ETH_ALEN);
+}
+
+static gboolean
+_dhcp_raw_recv (int fd, guint8 *packet)
+{
+	ssize_t n;
+
+	n = recv (fd, packet, PKT_LEN, MSG_DONTWAIT);
+	if (n < 0) {
+		g_assert_cmpint (errno, ==, EAGAIN);
+		return FALSE;
+	}
+	g_assert_cmpint (n, ==, PKT_LEN);
+	return TRUE;
+}
+
+static void
+test_dhcp_raw_mux (void)
+{
+	static const guint8 mac_a[ETH_ALEN] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 };
+	static const guint8 mac_b[ETH_ALEN] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x66 };
+	static const guint8 bcast[ETH_ALEN] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+	NMSdDhcpRawMux *mux;
+	struct sockaddr_ll link = { 0 };
+	guint8 packet[PKT_LEN];
+	guint8 received[PKT_LEN];
+	int fd1, fd2, fd3;
+	gint64 end;
+
+	mux = _nm_sd_dhcp_raw_mux_new (68, -1);
+
+	/* a xid of zero is valid and must not be confused with a missing entry. */
+	fd1 = _nm_sd_dhcp_raw_mux_add_client (mux, 2, 0, mac_a, ETH_ALEN, bcast, ARPHRD_ETHER, ETH_ALEN, &link);
+	g_assert_cmpint (fd1, >=, 0);
+	g_assert_cmpint (link.sll_family, ==, AF_PACKET);
+	g_assert_cmpint (link.sll_ifindex, ==, 2);
+	g_assert_cmpint (link.sll_halen, ==, ETH_ALEN);
+	g_assert (memcmp (link.sll_addr, bcast, ETH_ALEN) == 0);
+
+	fd2 = _nm_sd_dhcp_raw_mux_add_client (mux, 3, 0, mac_a, ETH_ALEN, bcast, ARPHRD_ETHER, ETH_ALEN, NULL);
+	g_assert_cmpint (fd2, >=, 0);
+	fd3 = _nm_sd_dhcp_raw_mux_add_client (mux, 2, 0, mac_b, ETH_ALEN, bcast, ARPHRD_ETHER, ETH_ALEN, NULL);
+	g_assert_cmpint (fd3, >=, 0);
+	g_assert_cmpint (_nm_sd_dhcp_raw_mux_get_n_clients (mux), ==, 3);
+
+	/* replies are dispatched by ingress interface and chaddr. */
+	_dhcp_raw_packet_init (packet, 0, mac_a);
+	g_assert (_nm_sd_dhcp_raw_mux_dispatch (mux, 2, packet, PKT_LEN, FALSE));
+	g_assert (_dhcp_raw_recv (fd1, received));
+	g_assert (memcmp (packet, received, PKT_LEN) == 0);
+	g_assert (!_dhcp_raw_recv (fd2, received));
+	g_assert (!_dhcp_raw_recv (fd3, received));
+
+	_dhcp_raw_packet_init (packet, 0, mac_b);
+	g_assert (_nm_sd_dhcp_raw_mux_dispatch (mux, 2, packet, PKT_LEN, TRUE));
+	g_assert (!_dhcp_raw_recv (fd1, received));
+	g_assert (_dhcp_raw_recv (fd3, received));
+	g_assert_cmpint (received[PKT_UDP_CHECK], ==, 0);
+	g_assert_cmpint (received[PKT_UDP_CHECK + 1], ==, 0);
+
+	_dhcp_raw_packet_init (packet, 0, mac_b);
+	g_assert (!_nm_sd_dhcp_raw_mux_dispatch (mux, 3, packet, PKT_LEN, FALSE));
+	_dhcp_raw_packet_init (packet, 1, mac_a);
+	g_assert (!_nm_sd_dhcp_raw_mux_dispatch (mux, 2, packet, PKT_LEN, FALSE));
+	_dhcp_raw_packet_init (packet, 0, mac_a);
+	g_assert (!_nm_sd_dhcp_raw_mux_dispatch (mux, 2, packet, 100, FALSE));
+
+	/* a client is unregistered when it closes its end. */
+	close (fd1);
+	end = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+	while (_nm_sd_dhcp_raw_mux_get_n_clients (mux) == 3) {
+		g_assert (g_get_monotonic_time () < end);
+		g_main_context_iteration (NULL, FALSE);
+	}
+	g_assert_cmpint (_nm_sd_dhcp_raw_mux_get_n_clients (mux), ==, 2);
+	g_assert (!_nm_sd_dhcp_raw_mux_dispatch (mux, 2, packet, PKT_LEN, FALSE));
+	g_assert (_nm_sd_dhcp_raw_mux_dispatch (mux, 3, packet, PKT_LEN, FALSE));
+	g_assert (_dhcp_raw_recv (fd2, received));
+
+	_nm_sd_dhcp_raw_mux_free (mux);
+	close (fd2);
+	close (fd3);
+}
+
+static void
+_dhcp_raw_filter_check (guint n_ifindexes)
+{
+	gs_free int *ifindexes = NULL;
+	GArray *filter;
+	const struct sock_filter *insns;
+	struct sock_fprog fprog;
+	guint i, n_jumps = 0;
+	int fd;
+
+	ifindexes = g_new (int, n_ifindexes + 1);
+	for (i = 0; i < n_ifindexes; i++)
+		ifindexes[i] = i + 1;
+
+	filter = _nm_sd_dhcp_raw_build_filter (68, ifindexes, n_ifindexes);
+	insns = (const struct sock_filter *) filter->data;
+
+	g_assert_cmpint (filter->len, >, 2);
+	g_assert_cmpint (insns[filter->len - 1].code, ==, BPF_RET + BPF_K);
+	g_assert_cmpint (insns[filter->len - 1].k, ==, 65535);
+
+	/* every matching interface must jump to "return all". */
+	for (i = 0; i < filter->len; i++) {
+		if (   insns[i].code == BPF_LD + BPF_W + BPF_ABS
+		    && insns[i].k == SKF_AD_OFF + SKF_AD_IFINDEX) {
+			for (i++; insns[i].code == BPF_JMP + BPF_JEQ + BPF_K; i++) {
+				g_assert_cmpint (insns[i].k, ==, ifindexes[n_jumps]);
+				g_assert_cmpint (i + 1 + insns[i].jt, ==, filter->len - 1);
+				n_jumps++;
+			}
+			g_assert_cmpint (insns[i].code, ==, BPF_RET + BPF_K);
+			g_assert_cmpint (insns[i].k, ==, 0);
+		}
+	}
+	if (n_ifindexes > G_MAXUINT8)
+		g_assert_cmpint (n_jumps, ==, 0);
+	else
+		g_assert_cmpint (n_jumps, ==, n_ifindexes);
+
+	/* the kernel validates the program when attaching it, which doesn't
+	 * need privileges. */
+	fd = socket (AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	g_assert_cmpint (fd, >=, 0);
+	fprog.len = filter->len;
+	fprog.filter = (struct sock_filter *) filter->data;
+	g_assert_cmpint (setsockopt (fd, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof (fprog)), ==, 0);
+	close (fd);
+
+	g_array_unref (filter);
+}
+
+static void
+test_dhcp_raw_filter (void)
+{
+	_dhcp_raw_filter_check (0);
+	_dhcp_raw_filter_check (1);
+	_dhcp_raw_filter_check (3);
+	_dhcp_raw_filter_check (G_MAXUINT8);
+	_dhcp_raw_filter_check (G_MAXUINT8 + 1);
+}
+
+/*****************************************************************************/
+
 static void
 test_lldp_create (void)
 {
@@ -169,6 +343,79 @@ test_sd_event (void)
 	}
 }
 
+static void
+test_sd_event_timer_slot (void)
+{
+	const guint64 tick = 250000;
+	guint64 base = 1000 * tick;
+
+	g_assert_cmpint (_nm_sd_event_timer_slot (0), ==, 0);
+	g_assert_cmpint (_nm_sd_event_timer_slot (G_MAXUINT64), ==, G_MAXUINT64);
+
+	/* a timer on a tick stays there */
+	g_assert_cmpint (_nm_sd_event_timer_slot (base), ==, base);
+
+	/* timers due within one tick expire together, on the next tick */
+	g_assert_cmpint (_nm_sd_event_timer_slot (base + 1), ==, base + tick);
+	g_assert_cmpint (_nm_sd_event_timer_slot (base + tick / 2), ==, base + tick);
+	g_assert_cmpint (_nm_sd_event_timer_slot (base + tick - 1), ==, base + tick);
+	g_assert_cmpint (_nm_sd_event_timer_slot (base + tick + 1), ==, base + 2 * tick);
+}
+
+static int
+_test_sd_event_io_cb (sd_event_source *s, int fd, uint32_t revents, void *userdata)
+{
+	char buf[16];
+
+	g_assert_cmpint (recv (fd, buf, sizeof (buf), MSG_DONTWAIT), ==, 1);
+	(*((guint *) userdata))++;
+	return 0;
+}
+
+static void
+test_sd_event_run_ready (void)
+{
+	sd_event *event = NULL;
+	sd_event_source *source = NULL;
+	guint sd_id;
+	guint n_called = 0;
+	int fds[2];
+	int r;
+
+	/* without attached default event, this does nothing. */
+	nm_sd_event_run_ready (1);
+	g_assert_cmpint (sd_event_default (NULL), ==, 0);
+
+	g_assert_cmpint (socketpair (AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0, fds), ==, 0);
+
+	sd_id = nm_sd_event_attach_default ();
+	r = sd_event_default (&event);
+	g_assert (r >= 0 && event);
+	r = sd_event_add_io (event, &source, fds[0], EPOLLIN, _test_sd_event_io_cb, &n_called);
+	g_assert (r >= 0 && source);
+
+	/* a source that became ready is dispatched without going through
+	 * the main loop. */
+	nm_sd_event_run_ready (1);
+	g_assert_cmpint (n_called, ==, 0);
+	g_assert_cmpint (send (fds[1], "x", 1, 0), ==, 1);
+	nm_sd_event_run_ready (1);
+	g_assert_cmpint (n_called, ==, 1);
+
+	g_assert_cmpint (send (fds[1], "x", 1, 0), ==, 1);
+	nm_sd_event_run_ready (0);
+	g_assert_cmpint (n_called, ==, 1);
+	nm_sd_event_run_ready (1);
+	g_assert_cmpint (n_called, ==, 2);
+
+	source = sd_event_source_unref (source);
+	event = sd_event_unref (event);
+	nm_clear_g_source (&sd_id);
+	g_assert_cmpint (sd_event_default (NULL), ==, 0);
+	close (fds[0]);
+	close (fds[1]);
+}
+
 /*****************************************************************************/
 
 NMTST_DEFINE ();
@@ -179,8 +426,12 @@ main (int argc, char **argv)
 	nmtst_init_assert_logging (&argc, &argv, "INFO", "ALL");
 
 	g_test_add_func ("/systemd/dhcp/create", test_dhcp_create);
+	g_test_add_func ("/systemd/dhcp/raw-mux", test_dhcp_raw_mux);
+	g_test_add_func ("/systemd/dhcp/raw-filter", test_dhcp_raw_filter);
 	g_test_add_func ("/systemd/lldp/create", test_lldp_create);
 	g_test_add_func ("/systemd/sd-event", test_sd_event);
+	g_test_add_func ("/systemd/sd-event/timer-slot", test_sd_event_timer_slot);
+	g_test_add_func ("/systemd/sd-event/run-ready", test_sd_event_run_ready);
 
 	return g_test_run ();
 }